@@ -33,6 +33,24 @@ cdslisttime_ms=`echo "$cdslistkernel_ms" "$cdslistuser_ms" + p | dc`
 cdslistmem_MiB=`echo "$cdslistmem_KiB" 1024 / p | dc`
 echo "  cds list: $cdslisttime_ms ms  $cdslistmem_MiB MiB"
 
+/usr/bin/time -o "$tmpfile" \
+    ./build/x64-linux/release/cdslistperf "$count" lean > /dev/null
+read leanlistkernel_s leanlistuser_s leanlistmem_KiB < "$tmpfile"
+leanlistkernel_ms=`echo "$leanlistkernel_s" 1000 \* p | dc`
+leanlistuser_ms=`echo "$leanlistuser_s" 1000 \* p | dc`
+leanlisttime_ms=`echo "$leanlistkernel_ms" "$leanlistuser_ms" + p | dc`
+leanlistmem_MiB=`echo "$leanlistmem_KiB" 1024 / p | dc`
+echo "  cds lean list: $leanlisttime_ms ms  $leanlistmem_MiB MiB"
+
+/usr/bin/time -o "$tmpfile" \
+    ./build/x64-linux/release/cdslistperf "$count" pool > /dev/null
+read poollistkernel_s poollistuser_s poollistmem_KiB < "$tmpfile"
+poollistkernel_ms=`echo "$poollistkernel_s" 1000 \* p | dc`
+poollistuser_ms=`echo "$poollistuser_s" 1000 \* p | dc`
+poollisttime_ms=`echo "$poollistkernel_ms" "$poollistuser_ms" + p | dc`
+poollistmem_MiB=`echo "$poollistmem_KiB" 1024 / p | dc`
+echo "  cds list (pool): $poollisttime_ms ms  $poollistmem_MiB MiB"
+
 /usr/bin/time -o "$tmpfile" \
     ./build/x64-linux/release/stllistperf "$count" > /dev/null
 read stllistkernel_s stllistuser_s stllistmem_KiB < "$tmpfile"
@@ -61,6 +79,85 @@ else
 fi
 
 
+printf "Testing deques: insert, walk and delete %'d items\n" $count
+
+/usr/bin/time -o "$tmpfile" \
+    ./build/x64-linux/release/cdsdequeperf "$count" > /dev/null
+read cdsdequekernel_s cdsdequeuser_s cdsdequemem_KiB < "$tmpfile"
+cdsdequekernel_ms=`echo "$cdsdequekernel_s" 1000 \* p | dc`
+cdsdequeuser_ms=`echo "$cdsdequeuser_s" 1000 \* p | dc`
+cdsdequetime_ms=`echo "$cdsdequekernel_ms" "$cdsdequeuser_ms" + p | dc`
+cdsdequemem_MiB=`echo "$cdsdequemem_KiB" 1024 / p | dc`
+echo "  cds deque: $cdsdequetime_ms ms  $cdsdequemem_MiB MiB"
+echo "  cds list: $cdslisttime_ms ms  $cdslistmem_MiB MiB"
+
+/usr/bin/time -o "$tmpfile" \
+    ./build/x64-linux/release/stldequeperf "$count" > /dev/null
+read stldequekernel_s stldequeuser_s stldequemem_KiB < "$tmpfile"
+stldequekernel_ms=`echo "$stldequekernel_s" 1000 \* p | dc`
+stldequeuser_ms=`echo "$stldequeuser_s" 1000 \* p | dc`
+stldequetime_ms=`echo "$stldequekernel_ms" "$stldequeuser_ms" + p | dc`
+stldequemem_MiB=`echo "$stldequemem_KiB" 1024 / p | dc`
+echo "  stl deque: $stldequetime_ms ms  $stldequemem_MiB MiB"
+
+tmp1=`echo "$cdsdequetime_ms" | cut -d. -f1`
+tmp2=`echo "$stldequetime_ms" | cut -d. -f1`
+if [ "$tmp1" -lt "$tmp2" ]; then
+    tmp=`echo "$stldequetime_ms" "$cdsdequetime_ms" - 100 \* "$cdsdequetime_ms" / p | dc`
+    echo "  stl took ${tmp}% more time than cds"
+else
+    tmp=`echo "$cdsdequetime_ms" "$stldequetime_ms" - 100 \* "$stldequetime_ms" / p | dc`
+    echo "  cds took ${tmp}% more time than stl"
+fi
+
+if [ "$cdsdequemem_MiB" -lt "$stldequemem_MiB" ]; then
+    tmp=`echo "$stldequemem_MiB" "$cdsdequemem_MiB" - 100 \* "$cdsdequemem_MiB" / p | dc`
+    echo "  stl used ${tmp}% more memory than cds"
+else
+    tmp=`echo "$cdsdequemem_MiB" "$stldequemem_MiB" - 100 \* "$stldequemem_MiB" / p | dc`
+    echo "  cds used ${tmp}% more memory than stl"
+fi
+
+
+printf "Testing singly-linked lists: queue and stack of %'d items\n" $count
+
+/usr/bin/time -o "$tmpfile" \
+    ./build/x64-linux/release/cdsslistperf "$count" > /dev/null
+read cdsslistkernel_s cdsslistuser_s cdsslistmem_KiB < "$tmpfile"
+cdsslistkernel_ms=`echo "$cdsslistkernel_s" 1000 \* p | dc`
+cdsslistuser_ms=`echo "$cdsslistuser_s" 1000 \* p | dc`
+cdsslisttime_ms=`echo "$cdsslistkernel_ms" "$cdsslistuser_ms" + p | dc`
+cdsslistmem_MiB=`echo "$cdsslistmem_KiB" 1024 / p | dc`
+echo "  cds slist: $cdsslisttime_ms ms  $cdsslistmem_MiB MiB"
+
+/usr/bin/time -o "$tmpfile" \
+    ./build/x64-linux/release/stlslistperf "$count" > /dev/null
+read stlslistkernel_s stlslistuser_s stlslistmem_KiB < "$tmpfile"
+stlslistkernel_ms=`echo "$stlslistkernel_s" 1000 \* p | dc`
+stlslistuser_ms=`echo "$stlslistuser_s" 1000 \* p | dc`
+stlslisttime_ms=`echo "$stlslistkernel_ms" "$stlslistuser_ms" + p | dc`
+stlslistmem_MiB=`echo "$stlslistmem_KiB" 1024 / p | dc`
+echo "  stl forward_list: $stlslisttime_ms ms  $stlslistmem_MiB MiB"
+
+tmp1=`echo "$cdsslisttime_ms" | cut -d. -f1`
+tmp2=`echo "$stlslisttime_ms" | cut -d. -f1`
+if [ "$tmp1" -lt "$tmp2" ]; then
+    tmp=`echo "$stlslisttime_ms" "$cdsslisttime_ms" - 100 \* "$cdsslisttime_ms" / p | dc`
+    echo "  stl took ${tmp}% more time than cds"
+else
+    tmp=`echo "$cdsslisttime_ms" "$stlslisttime_ms" - 100 \* "$stlslisttime_ms" / p | dc`
+    echo "  cds took ${tmp}% more time than stl"
+fi
+
+if [ "$cdsslistmem_MiB" -lt "$stlslistmem_MiB" ]; then
+    tmp=`echo "$stlslistmem_MiB" "$cdsslistmem_MiB" - 100 \* "$cdsslistmem_MiB" / p | dc`
+    echo "  stl used ${tmp}% more memory than cds"
+else
+    tmp=`echo "$cdsslistmem_MiB" "$stlslistmem_MiB" - 100 \* "$stlslistmem_MiB" / p | dc`
+    echo "  cds used ${tmp}% more memory than stl"
+fi
+
+
 count=500000
 printf "Testing maps: insert and delete %'d items\n" $count
 
@@ -75,6 +172,24 @@ cdsmaptime_ms=`echo "$cdsmapkernel_ms" "$cdsmapuser_ms" + p | dc`
 cdsmapmem_MiB=`echo "$cdsmapmem_KiB" 1024 / p | dc`
 echo "  cds map: $cdsmaptime_ms ms  $cdsmapmem_MiB MiB"
 
+/usr/bin/time -o "$tmpfile" \
+    ./build/x64-linux/release/cdsmapperf "$count" "$rndfile" wavl > /dev/null
+read wavlmapkernel_s wavlmapuser_s wavlmapmem_KiB < "$tmpfile"
+wavlmapkernel_ms=`echo "$wavlmapkernel_s" 1000 \* p | dc`
+wavlmapuser_ms=`echo "$wavlmapuser_s" 1000 \* p | dc`
+wavlmaptime_ms=`echo "$wavlmapkernel_ms" "$wavlmapuser_ms" + p | dc`
+wavlmapmem_MiB=`echo "$wavlmapmem_KiB" 1024 / p | dc`
+echo "  cds map (WAVL): $wavlmaptime_ms ms  $wavlmapmem_MiB MiB"
+
+/usr/bin/time -o "$tmpfile" \
+    ./build/x64-linux/release/cdsmapperf "$count" "$rndfile" pool > /dev/null
+read poolmapkernel_s poolmapuser_s poolmapmem_KiB < "$tmpfile"
+poolmapkernel_ms=`echo "$poolmapkernel_s" 1000 \* p | dc`
+poolmapuser_ms=`echo "$poolmapuser_s" 1000 \* p | dc`
+poolmaptime_ms=`echo "$poolmapkernel_ms" "$poolmapuser_ms" + p | dc`
+poolmapmem_MiB=`echo "$poolmapmem_KiB" 1024 / p | dc`
+echo "  cds map (pool): $poolmaptime_ms ms  $poolmapmem_MiB MiB"
+
 /usr/bin/time -o "$tmpfile" \
     ./build/x64-linux/release/stlmapperf "$count" "$rndfile" > /dev/null
 read stlmapkernel_s stlmapuser_s stlmapmem_KiB < "$tmpfile"
@@ -101,3 +216,38 @@ else
     tmp=`echo "$cdsmapmem_MiB" "$stlmapmem_MiB" - 100 \* "$stlmapmem_MiB" / p | dc`
     echo "  cds used ${tmp}% more memory than stl"
 fi
+
+
+printf "Testing map bursts: insert %'d items in bursts, with lookups in between\n" $count
+./build/x64-linux/release/cdsmapburstperf "$count" "$rndfile" | sed -e 's/^/  /'
+
+
+printf "Testing map searches: search %'d items, with and without huge pages\n" $count
+for mode in malloc pool huge; do
+    ./build/x64-linux/release/cdsmaphugeperf "$count" "$rndfile" "$mode" \
+        | sed -e 's/^/  /'
+done
+
+
+printf "Testing frozen maps: search %'d items, live and frozen\n" $count
+./build/x64-linux/release/cdsmapfrozenperf "$count" "$rndfile" \
+    | sed -e 's/^/  /'
+
+
+count=1000000
+printf "Testing queues: pass %'d items from producers to consumers\n" $count
+./build/x64-linux/release/cdsqueueperf "$count" | sed -e 's/^/  /'
+echo "  with spinning:"
+./build/x64-linux/release/cdsqueueperf "$count" 200 | sed -e 's/^/  /'
+
+
+count=4000000
+printf "Testing MPSC queues: pass %'d items from 1 to 64 producers\n" $count
+./build/x64-linux/release/cdsmpscperf "$count" | sed -e 's/^/  /'
+
+
+count=1000000
+printf "Testing allocators: insert and clear %'d items\n" $count
+./build/x64-linux/release/cdsallocperf "$count" | sed -e 's/^/  /'
+./build/x64-linux/release/cdsallocperf "$count" pool | sed -e 's/^/  /'
+./build/x64-linux/release/cdsallocperf "$count" arena | sed -e 's/^/  /'
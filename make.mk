@@ -21,11 +21,15 @@ DOXYGEN := $(shell which doxygen 2> /dev/null)
 DOT := $(shell which dot 2> /dev/null)
 
 MODULES = $(TOPDIR)/src/plf/$(PLF) $(TOPDIR)/src/list \
-			$(TOPDIR)/src/binarytree $(TOPDIR)/src/map
+			$(TOPDIR)/src/slist $(TOPDIR)/src/queue $(TOPDIR)/src/mpsc \
+			$(TOPDIR)/src/ring $(TOPDIR)/src/deque $(TOPDIR)/src/binarytree \
+			$(TOPDIR)/src/map
 
 # Path for make to search for source files
 VPATH = $(foreach i,$(MODULES),$(i)/src) $(foreach i,$(MODULES),$(i)/test) \
-		$(TOPDIR)/src/cds_vs_stl/list $(TOPDIR)/src/cds_vs_stl/map
+		$(TOPDIR)/src/cds_vs_stl/list $(TOPDIR)/src/cds_vs_stl/slist \
+		$(TOPDIR)/src/cds_vs_stl/queue $(TOPDIR)/src/cds_vs_stl/deque \
+		$(TOPDIR)/src/cds_vs_stl/map $(TOPDIR)/src/cds_vs_stl/alloc
 
 # Output libraries
 OUTPUT_LIBS = libcds.a
@@ -37,9 +41,13 @@ INCS = $(foreach i,$(MODULES),-I$(i)/include)
 HDRS = $(foreach i,$(MODULES),$(wildcard $(i)/include/*.h))
 
 # List of object files for various targets
-LIBCDS_OBJS = cdscommon.o cdslist.o cdsbinarytree.o cdsmap.o
+LIBCDS_OBJS = cdscommon.o cdspool.o cdsarena.o cdshugepage.o cdsthreadpool.o \
+		cdslist.o cdsleanlist.o cdsslist.o cdsqueue.o cdsmpsc.o cdsring.o \
+		cdsdeque.o cdsbinarytree.o cdsmap.o
 RTTEST_MAIN_OBJ = rttestmain.o
-CDS_TEST_OBJS = test-list.o test-binarytree.o test-map.o
+CDS_TEST_OBJS = test-common.o test-list.o test-leanlist.o test-slist.o \
+		test-queue.o test-mpsc.o test-ring.o \
+		test-deque.o test-binarytree.o test-map.o
 
 # Libraries to link against when building test programs
 LINKLIBS = -lcds -lrttest -lrtsys
@@ -48,7 +56,10 @@ LINKLIBS += -lflloc
 endif
 
 # CDS vs STL executables
-CDS_VS_STL = cdslistperf stllistperf cdsmapperf stlmapperf mkrnd
+CDS_VS_STL = cdslistperf stllistperf cdsslistperf stlslistperf cdsmapperf \
+		stlmapperf mkrnd cdsmapburstperf cdsqueueperf \
+		cdsmpscperf cdsdequeperf stldequeperf cdsallocperf \
+		cdsmaphugeperf cdsmapfrozenperf
 
 # CDS vs STL object files
 CDS_VS_STL_OBJS = $(foreach i,$(CDS_VS_STL),$(i).o)
@@ -118,6 +129,12 @@ cdslistperf: cdslistperf.o $(OUTPUT_LIBS)
 stllistperf: stllistperf.o $(OUTPUT_LIBS)
 	@$(call RUN_LINK,$@,$(filter %.o,$^),$(LINKLIBS) $(CXXLIB))
 
+cdsslistperf: cdsslistperf.o $(OUTPUT_LIBS)
+	@$(call RUN_LINK,$@,$(filter %.o,$^),$(LINKLIBS))
+
+stlslistperf: stlslistperf.o $(OUTPUT_LIBS)
+	@$(call RUN_LINK,$@,$(filter %.o,$^),$(LINKLIBS) $(CXXLIB))
+
 cdsmapperf: cdsmapperf.o $(OUTPUT_LIBS)
 	@$(call RUN_LINK,$@,$(filter %.o,$^),$(LINKLIBS))
 
@@ -127,6 +144,30 @@ stlmapperf: stlmapperf.o $(OUTPUT_LIBS)
 mkrnd: mkrnd.o $(OUTPUT_LIBS)
 	@$(call RUN_LINK,$@,$(filter %.o,$^),$(LINKLIBS) $(CXXLIB))
 
+cdsmapburstperf: cdsmapburstperf.o $(OUTPUT_LIBS)
+	@$(call RUN_LINK,$@,$(filter %.o,$^),$(LINKLIBS))
+
+cdsqueueperf: cdsqueueperf.o $(OUTPUT_LIBS)
+	@$(call RUN_LINK,$@,$(filter %.o,$^),$(LINKLIBS))
+
+cdsmpscperf: cdsmpscperf.o $(OUTPUT_LIBS)
+	@$(call RUN_LINK,$@,$(filter %.o,$^),$(LINKLIBS))
+
+cdsdequeperf: cdsdequeperf.o $(OUTPUT_LIBS)
+	@$(call RUN_LINK,$@,$(filter %.o,$^),$(LINKLIBS))
+
+stldequeperf: stldequeperf.o $(OUTPUT_LIBS)
+	@$(call RUN_LINK,$@,$(filter %.o,$^),$(LINKLIBS) $(CXXLIB))
+
+cdsallocperf: cdsallocperf.o $(OUTPUT_LIBS)
+	@$(call RUN_LINK,$@,$(filter %.o,$^),$(LINKLIBS))
+
+cdsmaphugeperf: cdsmaphugeperf.o $(OUTPUT_LIBS)
+	@$(call RUN_LINK,$@,$(filter %.o,$^),$(LINKLIBS))
+
+cdsmapfrozenperf: cdsmapfrozenperf.o $(OUTPUT_LIBS)
+	@$(call RUN_LINK,$@,$(filter %.o,$^),$(LINKLIBS))
+
 
 doc/html/index.html: $(filter-out %_private.h,$(HDRS))
 ifeq ($(DOXYGEN),)
@@ -27,6 +27,7 @@
 #define CDSBINARYTREE_h_
 
 #include "cdscommon.h"
+#include "cdsthreadpool.h"
 #include "cdsbinarytree_private.h"
 
 
@@ -77,6 +78,70 @@ typedef void (*CdsBinaryTreeNodeUnref)(CdsBinaryTreeNode* node);
 typedef bool (*CdsBinaryTreeNodeAction)(CdsBinaryTreeNode* node, void* cookie);
 
 
+/** Prototype of a function to update the aggregate of a node
+ *
+ * This is used to augment a tree with per-sub-tree aggregates (e.g. sums,
+ * counts, maximums) stored in the nodes. It is called when the sub-tree of
+ * `node` has changed, and should recompute the aggregate of `node` from its own
+ * value and the aggregates of its children, which are up to date.
+ *
+ * @param node   [in,out] Node to update
+ * @param cookie [in]     Cookie for this function
+ *
+ * @return `true` if the aggregate of `node` has changed, `false` otherwise; the
+ *         ancestors of `node` are not updated if it has not changed
+ */
+typedef bool (*CdsBinaryTreeNodeUpdate)(CdsBinaryTreeNode* node, void* cookie);
+
+
+/** Ordering of the actions of a parallel traversal
+ *
+ * With `CDS_BT_PARALLEL_UNORDERED`, the actions are called in no particular
+ * order.
+ *
+ * With `CDS_BT_PARALLEL_POST_ORDER`, the action on a node is only called once
+ * the actions on all the nodes of its sub-trees have returned, so a node can
+ * combine the results of its children.
+ */
+typedef enum {
+    CDS_BT_PARALLEL_UNORDERED,
+    CDS_BT_PARALLEL_POST_ORDER
+} CdsBinaryTreeParallelMode;
+
+
+/** Opaque type that represents the frontier of a level-order traversal
+ *
+ * This holds the nodes waiting to be visited. It can be reused from one
+ * traversal to the next, so the memory it needs is only allocated once.
+ */
+typedef struct CdsBinaryTreeFrontier CdsBinaryTreeFrontier;
+
+
+/** Prototype of a function to take action on a whole level of a tree
+ *
+ * @param nodes  [in,out] Nodes of the level, from left to right; this array is
+ *                        only valid until this function returns
+ * @param count  [in]     Number of nodes in `nodes`, which is > 0
+ * @param level  [in]     Level of the nodes; the top node of the traversal is
+ *                        at level 0
+ * @param cookie [in]     Cookie for this function
+ *
+ * @return `true` to continue traversing the tree, `false` to stop traversing
+ */
+typedef bool (*CdsBinaryTreeLevelAction)(CdsBinaryTreeNode* const* nodes,
+        int64_t count, int64_t level, void* cookie);
+
+
+/** Opaque type that represents a frozen sub-tree
+ *
+ * This is a read-only snapshot of the shape of a sub-tree, laid out as arrays
+ * in pre-order with no child pointers. A node is at index 0, its left child
+ * (if any) at the next index, and its right child right after the left
+ * sub-tree. See `CdsBinaryTreeFreeze()`.
+ */
+typedef struct CdsBinaryTreeFrozen CdsBinaryTreeFrozen;
+
+
 
 /*------------------------------+
  | Public function declarations |
@@ -96,6 +161,25 @@ CdsBinaryTree* CdsBinaryTreeCreate(const char* name, int64_t capacity,
         CdsBinaryTreeNodeUnref unref);
 
 
+/** Create a binary tree which allocates its memory from the given allocator
+ *
+ * Only the memory of the tree itself comes from `allocator`; the nodes are
+ * allocated by you.
+ *
+ * @param name      [in] Name for this binary tree; may be NULL
+ * @param capacity  [in] Max # of nodes the tree can store; 0 = no limit
+ * @param unref     [in] Function to remove a reference to a node; may be NULL
+ *                       if you don't need it
+ * @param allocator [in] Allocator to use; it must remain valid until the tree
+ *                       is destroyed; NULL to use the default allocator
+ *
+ * @return The newly-allocated binary tree, never NULL
+ */
+CdsBinaryTree* CdsBinaryTreeCreateWithAllocator(const char* name,
+        int64_t capacity, CdsBinaryTreeNodeUnref unref,
+        const CdsAllocator* allocator);
+
+
 /** Destroy a binary tree
  *
  * Any item in the binary tree will be unreferenced.
@@ -105,6 +189,17 @@ CdsBinaryTree* CdsBinaryTreeCreate(const char* name, int64_t capacity,
 void CdsBinaryTreeDestroy(CdsBinaryTree* tree);
 
 
+/** Destroy a binary tree without unreferencing its nodes
+ *
+ * This is O(1): the nodes are not walked at all. It is meant for trees whose
+ * nodes are owned by something else, typically an arena which is about to be
+ * reset or destroyed (see `CdsArena`). The nodes are left untouched.
+ *
+ * @param tree [in,out] Binary tree to destroy; must not be NULL
+ */
+void CdsBinaryTreeDestroyNoUnref(CdsBinaryTree* tree);
+
+
 /** Get the tree's name
  *
  * @param tree [in] Binary tree to query; must not be NULL
@@ -153,6 +248,38 @@ bool CdsBinaryTreeIsEmpty(const CdsBinaryTree* tree);
 bool CdsBinaryTreeIsFull(const CdsBinaryTree* tree);
 
 
+/** Augment a binary tree with per-sub-tree aggregates
+ *
+ * Once set, the `update` function is called by `CdsBinaryTreeSetRoot()`,
+ * `CdsBinaryTreeInsertLeft()`, `CdsBinaryTreeInsertRight()` and
+ * `CdsBinaryTreeRemoveNode()` on the nodes whose sub-tree has changed, from the
+ * bottom up. Only the path from the change to the root is visited, and it is
+ * cut short as soon as an aggregate does not change, so keeping the aggregates
+ * up to date costs O(depth) per change instead of a full traversal.
+ *
+ * If `tree` is not empty, the aggregates of all its nodes are computed once by
+ * this call.
+ *
+ * @param tree   [in,out] Binary tree to manipulate; must not be NULL
+ * @param update [in]     Function to update the aggregate of a node; NULL to
+ *                        stop updating aggregates
+ * @param cookie [in]     Cookie for the `update` function
+ */
+void CdsBinaryTreeSetAugmentation(CdsBinaryTree* tree,
+        CdsBinaryTreeNodeUpdate update, void* cookie);
+
+
+/** Update the aggregates after a node has been modified
+ *
+ * Call this after changing the value of `node` that its aggregate is computed
+ * from. This updates `node` and, as long as their aggregates change, its
+ * ancestors. This does nothing if the tree of `node` is not augmented.
+ *
+ * @param node [in,out] Node which has been modified; must not be NULL
+ */
+void CdsBinaryTreeUpdateNode(CdsBinaryTreeNode* node);
+
+
 /** Set the root of a binary tree
  *
  * This function should only be called on an empty tree.
@@ -269,7 +396,10 @@ bool CdsBinaryTreeIsLeaf(const CdsBinaryTreeNode* node);
  * `CdsBinaryTreeDestroy()` would have been called on them.
  *
  * The node `ref` and `unref` functions of the `left` tree will be reused for
- * the merged tree.
+ * the merged tree, as well as its augmentation (see
+ * `CdsBinaryTreeSetAugmentation()`). In that case, the aggregates of the nodes
+ * of `right` must have been computed the same way; only the aggregate of
+ * `root` is then computed.
  *
  * The capacity of the new binary tree will be the sum of `left` and `right`
  * capacities. If either `left` or `right` has unlimited capacity, the merged
@@ -293,10 +423,12 @@ CdsBinaryTree* CdsBinaryTreeMerge(const char* name, CdsBinaryTreeNode* root,
 
 /** Traverse a sub-tree in pre-order fashion
  *
- * This function will recursively traverse the sub-tree starting at `top`
- * following the pre-order method of traversal: root, left, right.
+ * This function will traverse the sub-tree starting at `node` following the
+ * pre-order method of traversal: root, left, right.
  *
- * The `action` function will be called on each traversed node.
+ * The `action` function will be called on each traversed node. The traversal
+ * does not write to the nodes, so many threads may traverse the same tree at
+ * the same time, as long as it is not modified.
  *
  * @param node   [in] Top node of sub-tree to traverse; must not be NULL
  * @param action [in] Action to apply to nodes; must not be NULL
@@ -308,10 +440,12 @@ void CdsBinaryTreeTraversePreOrder(CdsBinaryTreeNode* node,
 
 /** Traverse a sub-tree in in-order fashion
  *
- * This function will recursively traverse the sub-tree starting at `top`
- * following the in-order method of traversal: left, root, right.
+ * This function will traverse the sub-tree starting at `node` following the
+ * in-order method of traversal: left, root, right.
  *
- * The `action` function will be called on each traversed node.
+ * The `action` function will be called on each traversed node. The traversal
+ * does not write to the nodes, so many threads may traverse the same tree at
+ * the same time, as long as it is not modified.
  *
  * @param node   [in] Top node of sub-tree to traverse; must not be NULL
  * @param action [in] Action to apply to nodes; must not be NULL
@@ -323,10 +457,15 @@ void CdsBinaryTreeTraverseInOrder(CdsBinaryTreeNode* node,
 
 /** Traverse a sub-tree in post-order fashion
  *
- * This function will recursively traverse the sub-tree starting at `top`
- * following the post-order method of traversal: left, root, right.
+ * This function will traverse the sub-tree starting at `node` following the
+ * post-order method of traversal: left, right, root.
+ *
+ * The `action` function will be called on each traversed node. The traversal
+ * does not write to the nodes, so many threads may traverse the same tree at
+ * the same time, as long as it is not modified.
  *
- * The `action` function will be called on each traversed node.
+ * `action` may release the node it is called on, as the traversal does not
+ * access it afterwards.
  *
  * @param node   [in] Top node of sub-tree to traverse; must not be NULL
  * @param action [in] Action to apply to nodes; must not be NULL
@@ -336,6 +475,220 @@ void CdsBinaryTreeTraversePostOrder(CdsBinaryTreeNode* node,
         CdsBinaryTreeNodeAction action, void* cookie);
 
 
+/** Traverse a sub-tree using many threads
+ *
+ * The top of the sub-tree is split into as many sub-trees as needed to keep
+ * the threads of `pool` busy; each of these is then traversed by a single
+ * thread. The calling thread takes part in the traversal, and returns once it
+ * is complete.
+ *
+ * `action` is called from many threads at the same time, on different nodes.
+ * It must not modify the tree.
+ *
+ * If `action` returns `false`, no more actions are started; the actions
+ * already running in other threads complete normally. In post-order mode, the
+ * ancestors of a node whose action has not been called are not acted upon
+ * either.
+ *
+ * @param node   [in] Top node of sub-tree to traverse; must not be NULL
+ * @param action [in] Action to apply to nodes; must not be NULL
+ * @param cookie [in] Cookie for the action function
+ * @param pool   [in] Thread pool to run the traversal; must not be NULL
+ * @param mode   [in] Ordering of the actions
+ */
+void CdsBinaryTreeTraverseParallel(CdsBinaryTreeNode* node,
+        CdsBinaryTreeNodeAction action, void* cookie, CdsThreadPool* pool,
+        CdsBinaryTreeParallelMode mode);
+
+
+/** Create a frontier for level-order traversals
+ *
+ * The frontier grows as needed; its memory is only released when it is
+ * destroyed.
+ *
+ * @param capacity [in] Initial # of nodes the frontier can hold; 0 for the
+ *                      default
+ *
+ * @return The newly-allocated frontier, never NULL
+ */
+CdsBinaryTreeFrontier* CdsBinaryTreeFrontierCreate(int64_t capacity);
+
+
+/** Destroy a frontier
+ *
+ * @param frontier [in,out] Frontier to destroy; must not be NULL
+ */
+void CdsBinaryTreeFrontierDestroy(CdsBinaryTreeFrontier* frontier);
+
+
+/** Traverse a sub-tree in level-order fashion
+ *
+ * This function will traverse the sub-tree starting at `node` breadth-first:
+ * level by level from the top, and from left to right within a level.
+ *
+ * The `action` function will be called on each traversed node. Like the
+ * depth-first traversals, this does not write to the nodes.
+ *
+ * @param node     [in]     Top node of sub-tree to traverse; must not be NULL
+ * @param action   [in]     Action to apply to nodes; must not be NULL
+ * @param cookie   [in]     Cookie for the action function
+ * @param frontier [in,out] Frontier to use; may be NULL, in which case a
+ *                          temporary one is allocated; a frontier can't be
+ *                          used by two traversals at the same time
+ */
+void CdsBinaryTreeTraverseLevelOrder(CdsBinaryTreeNode* node,
+        CdsBinaryTreeNodeAction action, void* cookie,
+        CdsBinaryTreeFrontier* frontier);
+
+
+/** Traverse a sub-tree one level at a time
+ *
+ * This is like `CdsBinaryTreeTraverseLevelOrder()`, except that `action` is
+ * called once per level, with all the nodes of the level in an array.
+ *
+ * @param node     [in]     Top node of sub-tree to traverse; must not be NULL
+ * @param action   [in]     Action to apply to levels; must not be NULL
+ * @param cookie   [in]     Cookie for the action function
+ * @param frontier [in,out] Frontier to use; may be NULL, in which case a
+ *                          temporary one is allocated; a frontier can't be
+ *                          used by two traversals at the same time
+ */
+void CdsBinaryTreeTraverseLevels(CdsBinaryTreeNode* node,
+        CdsBinaryTreeLevelAction action, void* cookie,
+        CdsBinaryTreeFrontier* frontier);
+
+
+/** Freeze a sub-tree into a compact array layout
+ *
+ * The shape of the sub-tree is copied into arrays: the nodes in pre-order and
+ * the size of their sub-trees. Walking the frozen sub-tree does not touch the
+ * nodes themselves, and the traversals below are plain scans of the arrays.
+ *
+ * The nodes remain owned by their tree. The frozen sub-tree is not updated
+ * when the tree changes: don't insert or remove nodes while you use it.
+ *
+ * @param node [in] Top node of the sub-tree to freeze; must not be NULL
+ *
+ * @return The frozen sub-tree, never NULL; destroy it with
+ *         `CdsBinaryTreeFrozenDestroy()`
+ */
+CdsBinaryTreeFrozen* CdsBinaryTreeFreeze(CdsBinaryTreeNode* node);
+
+
+/** Destroy a frozen sub-tree
+ *
+ * The nodes are not affected.
+ *
+ * @param frozen [in,out] Frozen sub-tree to destroy; must not be NULL
+ */
+void CdsBinaryTreeFrozenDestroy(CdsBinaryTreeFrozen* frozen);
+
+
+/** Get the number of nodes in a frozen sub-tree
+ *
+ * @param frozen [in] Frozen sub-tree to query; must not be NULL
+ *
+ * @return The number of nodes, which is > 0
+ */
+int64_t CdsBinaryTreeFrozenSize(const CdsBinaryTreeFrozen* frozen);
+
+
+/** Get a node of a frozen sub-tree
+ *
+ * The top node of the sub-tree is at index 0.
+ *
+ * @param frozen [in] Frozen sub-tree to query; must not be NULL
+ * @param index  [in] Index of the node; must be in [0, size)
+ *
+ * @return The node
+ */
+CdsBinaryTreeNode* CdsBinaryTreeFrozenNode(const CdsBinaryTreeFrozen* frozen,
+        int64_t index);
+
+
+/** Get the index of the left child of a node in a frozen sub-tree
+ *
+ * @param frozen [in] Frozen sub-tree to query; must not be NULL
+ * @param index  [in] Index of the node; must be in [0, size)
+ *
+ * @return The index of the left child, or -1 if the node has no left child
+ */
+int64_t CdsBinaryTreeFrozenLeft(const CdsBinaryTreeFrozen* frozen,
+        int64_t index);
+
+
+/** Get the index of the right child of a node in a frozen sub-tree
+ *
+ * @param frozen [in] Frozen sub-tree to query; must not be NULL
+ * @param index  [in] Index of the node; must be in [0, size)
+ *
+ * @return The index of the right child, or -1 if the node has no right child
+ */
+int64_t CdsBinaryTreeFrozenRight(const CdsBinaryTreeFrozen* frozen,
+        int64_t index);
+
+
+/** Get the number of nodes under a node in a frozen sub-tree
+ *
+ * The sub-tree of the node at `index` spans the indices
+ * [index, index + returned value).
+ *
+ * @param frozen [in] Frozen sub-tree to query; must not be NULL
+ * @param index  [in] Index of the node; must be in [0, size)
+ *
+ * @return The size of the sub-tree of the node, including the node itself
+ */
+int64_t CdsBinaryTreeFrozenSubTreeSize(const CdsBinaryTreeFrozen* frozen,
+        int64_t index);
+
+
+/** Traverse a frozen sub-tree in pre-order fashion
+ *
+ * This is a forward scan of the frozen arrays.
+ *
+ * @param frozen [in] Frozen sub-tree to traverse; must not be NULL
+ * @param action [in] Action to apply to nodes; must not be NULL
+ * @param cookie [in] Cookie for the action function
+ */
+void CdsBinaryTreeFrozenTraversePreOrder(const CdsBinaryTreeFrozen* frozen,
+        CdsBinaryTreeNodeAction action, void* cookie);
+
+
+/** Traverse a frozen sub-tree from the bottom up
+ *
+ * This is a backward scan of the frozen arrays, which calls `action` on each
+ * node after all the nodes of its sub-tree. This is the reverse of the
+ * pre-order of the mirrored sub-tree: right sub-trees come before left ones.
+ *
+ * @param frozen [in] Frozen sub-tree to traverse; must not be NULL
+ * @param action [in] Action to apply to nodes; must not be NULL
+ * @param cookie [in] Cookie for the action function
+ */
+void CdsBinaryTreeFrozenTraverseBottomUp(const CdsBinaryTreeFrozen* frozen,
+        CdsBinaryTreeNodeAction action, void* cookie);
+
+
+
+/*--------------------+
+ | Header-inline mode |
+ +--------------------*/
+
+
+/* When `CDS_INLINE` is defined (`make INLINE=1`), calls to the functions below
+ * are compiled inline instead of going through the library; the library
+ * functions remain available.
+ */
+#ifdef CDS_INLINE
+#define CdsBinaryTreeSize(_tree)       cdsBinaryTreeSizeInline(_tree)
+#define CdsBinaryTreeIsEmpty(_tree)    cdsBinaryTreeIsEmptyInline(_tree)
+#define CdsBinaryTreeRoot(_tree)       cdsBinaryTreeRootInline(_tree)
+#define CdsBinaryTreeLeftNode(_node)   cdsBinaryTreeLeftNodeInline(_node)
+#define CdsBinaryTreeRightNode(_node)  cdsBinaryTreeRightNodeInline(_node)
+#define CdsBinaryTreeParentNode(_node) cdsBinaryTreeParentNodeInline(_node)
+#define CdsBinaryTreeIsLeaf(_node)     cdsBinaryTreeIsLeafInline(_node)
+#endif
+
+
 
 #endif /* CDSBINARYTREE_h_ */
 /* @} */
@@ -35,9 +35,93 @@ struct CdsBinaryTreeNode
     struct CdsBinaryTreeNode* parent;
     struct CdsBinaryTreeNode* left;
     struct CdsBinaryTreeNode* right;
-    uint8_t                   flags;
 };
 
 
+/* Binary tree
+ *
+ * This is only visible so the fast paths below can be inlined; do not access
+ * its fields directly.
+ */
+struct CdsBinaryTree
+{
+    char*                     name;
+    int64_t                   capacity;
+    int64_t                   size;
+    struct CdsBinaryTreeNode* root;
+    void                      (*unref)(struct CdsBinaryTreeNode* node);
+    const CdsAllocator*       allocator;
+    bool                      (*update)(struct CdsBinaryTreeNode* node,
+                                      void* cookie);
+    void*                     updateCookie;
+};
+
+
+
+/*-----------------------------+
+ | Inline function definitions |
+ +-----------------------------*/
+
+
+/* These are the implementations of the hot accessors. The library functions
+ * call them, and so does user code compiled with `CDS_INLINE` defined (see
+ * "cdsbinarytree.h").
+ */
+
+
+static inline int64_t cdsBinaryTreeSizeInline(const struct CdsBinaryTree* tree)
+{
+    CDSASSERT_FULL(tree != NULL);
+    return tree->size;
+}
+
+
+static inline bool cdsBinaryTreeIsEmptyInline(const struct CdsBinaryTree* tree)
+{
+    CDSASSERT_FULL(tree != NULL);
+    return tree->size <= 0;
+}
+
+
+static inline struct CdsBinaryTreeNode* cdsBinaryTreeRootInline(
+        const struct CdsBinaryTree* tree)
+{
+    CDSASSERT_FULL(tree != NULL);
+    return tree->root;
+}
+
+
+static inline struct CdsBinaryTreeNode* cdsBinaryTreeLeftNodeInline(
+        const struct CdsBinaryTreeNode* node)
+{
+    CDSASSERT_FULL(node != NULL);
+    return node->left;
+}
+
+
+static inline struct CdsBinaryTreeNode* cdsBinaryTreeRightNodeInline(
+        const struct CdsBinaryTreeNode* node)
+{
+    CDSASSERT_FULL(node != NULL);
+    return node->right;
+}
+
+
+static inline struct CdsBinaryTreeNode* cdsBinaryTreeParentNodeInline(
+        const struct CdsBinaryTreeNode* node)
+{
+    CDSASSERT_FULL(node != NULL);
+    return node->parent;
+}
+
+
+static inline bool cdsBinaryTreeIsLeafInline(
+        const struct CdsBinaryTreeNode* node)
+{
+    CDSASSERT_FULL(node != NULL);
+    return (node->left == NULL) && (node->right == NULL);
+}
+
+
 
 #endif /* CDSBINARYTREE_PRIVATE_h_ */
@@ -14,6 +14,9 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+/* Always build the out-of-line functions, whatever the inline build mode */
+#undef CDS_INLINE
+
 #include "cdsbinarytree.h"
 #include <stdlib.h>
 #include <string.h>
@@ -25,21 +28,233 @@
  +----------------*/
 
 
-#define CDS_BT_FLAG_VISITED 0x01
-#define CDS_BT_FLAG_LEFT    0x02
-#define CDS_BT_FLAG_RIGHT   0x04
+/** Order in which a traversal visits the nodes */
+typedef enum
+{
+    CDS_BT_ORDER_PRE,
+    CDS_BT_ORDER_IN,
+    CDS_BT_ORDER_POST
+} CdsBinaryTreeOrder;
+
+
+/** Number of sub-trees per thread a parallel traversal splits the tree into */
+#define CDS_BT_PARALLEL_SUBTREES_PER_THREAD 8
+
+
+/** State shared by all the tasks of a parallel traversal */
+typedef struct
+{
+    CdsBinaryTreeParallelMode mode;
+    CdsBinaryTreeNodeAction   action;
+    void*                     cookie;
+    CdsThreadPool*            pool;
+    CdsThreadPoolGroup        group;
+    int                       splitDepth; // Sub-trees below are not split
+    bool                      stopped;    // An action returned `false`
+} CdsBinaryTreeParallelJob;
+
+
+/** Node at the top of the tree, waiting for its sub-trees in post-order mode */
+typedef struct CdsBinaryTreeParallelSplit
+{
+    CdsBinaryTreeNode*                 node;
+    int64_t                            remaining; // # of sub-trees not done
+    struct CdsBinaryTreeParallelSplit* parent;
+} CdsBinaryTreeParallelSplit;
+
+
+/** Task which traverses a sub-tree */
+typedef struct
+{
+    CdsBinaryTreeParallelJob*   job;
+    CdsBinaryTreeNode*          node;
+    int                         depth;
+    CdsBinaryTreeParallelSplit* split; // Parent split node; may be NULL
+} CdsBinaryTreeParallelTask;
+
 
+/** Default capacity of a frontier */
+#define CDS_BT_FRONTIER_CAPACITY 64
 
-struct CdsBinaryTree
+
+/** Frontier of a level-order traversal
+ *
+ * This is a ring buffer of the nodes waiting to be visited; its capacity is a
+ * power of 2.
+ */
+struct CdsBinaryTreeFrontier
 {
-    char*                  name;
-    int64_t                capacity;
-    int64_t                size;
-    CdsBinaryTreeNode*     root;
-    CdsBinaryTreeNodeUnref unref;
+    CdsBinaryTreeNode** nodes;
+    int64_t             capacity;
+    int64_t             head;  // Index of the next node to visit
+    int64_t             count;
 };
 
 
+/** Frozen sub-tree, in pre-order */
+struct CdsBinaryTreeFrozen
+{
+    CdsBinaryTreeNode** nodes;
+    int64_t*            sizes;     // Size of the sub-tree of each node
+    int64_t*            leftSizes; // Size of the left sub-tree of each node
+    int64_t             size;
+};
+
+
+
+/*-------------------------------+
+ | Private function declarations |
+ +-------------------------------*/
+
+
+/** Traverse a sub-tree without recursion
+ *
+ * The nodes are not written to: the position in the traversal is derived from
+ * the previous node, so many traversals can run on the same tree at the same
+ * time.
+ *
+ * In post-order, `action` may release the node it is called on, as it is not
+ * accessed anymore afterwards.
+ *
+ * @param node   [in] Top node of the sub-tree to traverse
+ * @param order  [in] When to call `action` on a node
+ * @param action [in] Action to apply to the nodes
+ * @param cookie [in] Cookie for the action function
+ */
+static void cdsBinaryTreeTraverse(CdsBinaryTreeNode* node,
+        CdsBinaryTreeOrder order, CdsBinaryTreeNodeAction action,
+        void* cookie);
+
+
+/** Unreference a node being removed from its tree
+ *
+ * @param node   [in,out] Node to unreference
+ * @param cookie [in,out] The `CdsBinaryTree` the node belongs to
+ *
+ * @return Always `true`
+ */
+static bool cdsBinaryTreeUnrefNode(CdsBinaryTreeNode* node, void* cookie);
+
+
+/** Set the tree a node belongs to
+ *
+ * @param node   [in,out] Node to update
+ * @param cookie [in]     The new `CdsBinaryTree` of the node
+ *
+ * @return Always `true`
+ */
+static bool cdsBinaryTreeSetTree(CdsBinaryTreeNode* node, void* cookie);
+
+
+/** Action to update the aggregate of a node
+ *
+ * @param node   [in,out] Node to update
+ * @param cookie [in]     Tree the node belongs to, which must be augmented
+ *
+ * @return Always `true`
+ */
+static bool cdsBinaryTreeUpdateAction(CdsBinaryTreeNode* node, void* cookie);
+
+
+/** Update the aggregates from a node up to the root
+ *
+ * This stops at the first node whose aggregate does not change. It does
+ * nothing if `tree` is not augmented.
+ *
+ * @param tree [in]     Tree to update
+ * @param node [in,out] First node to update; may be NULL
+ */
+static void cdsBinaryTreeUpdatePath(const CdsBinaryTree* tree,
+        CdsBinaryTreeNode* node);
+
+
+/** Submit a task to traverse a sub-tree in parallel
+ *
+ * @param job   [in,out] Parallel traversal
+ * @param node  [in]     Top node of the sub-tree
+ * @param depth [in]     Depth of `node` relative to the top of the traversal
+ * @param split [in,out] Split node to complete once the sub-tree is done; may
+ *                       be NULL
+ */
+static void cdsBinaryTreeParallelSubmit(CdsBinaryTreeParallelJob* job,
+        CdsBinaryTreeNode* node, int depth, CdsBinaryTreeParallelSplit* split);
+
+
+/** Traverse a sub-tree, as part of a parallel traversal
+ *
+ * The top of the tree is split further; deeper sub-trees are traversed by the
+ * calling thread.
+ *
+ * @param pool [in,out] Thread pool running the traversal
+ * @param arg  [in,out] A `CdsBinaryTreeParallelTask`, released by this
+ *                      function
+ */
+static void cdsBinaryTreeParallelRun(CdsThreadPool* pool, void* arg);
+
+
+/** Mark a sub-tree as done, in post-order mode
+ *
+ * The action is called on the split nodes whose sub-trees are all done, going
+ * up as far as possible.
+ *
+ * @param job   [in,out] Parallel traversal
+ * @param split [in,out] Split node the sub-tree belongs to; may be NULL
+ */
+static void cdsBinaryTreeParallelDone(CdsBinaryTreeParallelJob* job,
+        CdsBinaryTreeParallelSplit* split);
+
+
+/** Call the action of a parallel traversal on a node
+ *
+ * @param node   [in,out] Node to take action on
+ * @param cookie [in,out] The `CdsBinaryTreeParallelJob`
+ *
+ * @return `false` if the traversal has been stopped, `true` otherwise
+ */
+static bool cdsBinaryTreeParallelAction(CdsBinaryTreeNode* node,
+        void* cookie);
+
+
+/** Re-arrange a frontier so its nodes start at index 0
+ *
+ * @param frontier [in,out] Frontier to re-arrange
+ * @param capacity [in]     New capacity; a power of 2 which must be at least
+ *                          the current capacity
+ */
+static void cdsBinaryTreeFrontierUnwrap(CdsBinaryTreeFrontier* frontier,
+        int64_t capacity);
+
+
+/** Add a node at the back of a frontier, growing it if necessary
+ *
+ * @param frontier [in,out] Frontier to update
+ * @param node     [in]     Node to add
+ */
+static void cdsBinaryTreeFrontierPush(CdsBinaryTreeFrontier* frontier,
+        CdsBinaryTreeNode* node);
+
+
+/** Take the node at the front of a frontier
+ *
+ * @param frontier [in,out] Frontier to update; must not be empty
+ *
+ * @return The node
+ */
+static CdsBinaryTreeNode* cdsBinaryTreeFrontierPop(
+        CdsBinaryTreeFrontier* frontier);
+
+
+/** Action to add a node to a frozen sub-tree being built
+ *
+ * @param node   [in]     Node to add
+ * @param cookie [in,out] Frozen sub-tree; only the nodes are counted if its
+ *                        `nodes` array is NULL
+ *
+ * @return Always `true`
+ */
+static bool cdsBinaryTreeFreezeAppend(CdsBinaryTreeNode* node, void* cookie);
+
+
 
 /*---------------------------------+
  | Public function implementations |
@@ -49,12 +264,21 @@ struct CdsBinaryTree
 CdsBinaryTree* CdsBinaryTreeCreate(const char* name, int64_t capacity,
         CdsBinaryTreeNodeUnref unref)
 {
-    CdsBinaryTree* tree = CdsMallocZ(sizeof(*tree));
+    return CdsBinaryTreeCreateWithAllocator(name, capacity, unref, NULL);
+}
 
-    if (name != NULL) {
-        tree->name = strdup(name);
-        CDSASSERT(tree->name != NULL);
+
+CdsBinaryTree* CdsBinaryTreeCreateWithAllocator(const char* name,
+        int64_t capacity, CdsBinaryTreeNodeUnref unref,
+        const CdsAllocator* allocator)
+{
+    if (allocator == NULL) {
+        allocator = CdsDefaultAllocator();
     }
+    CdsBinaryTree* tree = CdsAllocZ(allocator, sizeof(*tree));
+
+    tree->allocator = allocator;
+    tree->name = CdsStrdup(allocator, name);
     if (capacity > 0) {
         tree->capacity = capacity;
     }
@@ -66,47 +290,53 @@ CdsBinaryTree* CdsBinaryTreeCreate(const char* name, int64_t capacity,
 
 void CdsBinaryTreeDestroy(CdsBinaryTree* tree)
 {
-    CDSASSERT(tree != NULL);
+    CDSASSERT_FULL(tree != NULL);
 
     if (tree->root != NULL) {
         CdsBinaryTreeRemoveNode(tree->root);
     }
-    free(tree->name);
-    free(tree);
+    CdsFree(tree->allocator, tree->name);
+    CdsFree(tree->allocator, tree);
+}
+
+
+void CdsBinaryTreeDestroyNoUnref(CdsBinaryTree* tree)
+{
+    CDSASSERT_FULL(tree != NULL);
+    CdsFree(tree->allocator, tree->name);
+    CdsFree(tree->allocator, tree);
 }
 
 
 const char* CdsBinaryTreeName(const CdsBinaryTree* tree)
 {
-    CDSASSERT(tree != NULL);
+    CDSASSERT_FULL(tree != NULL);
     return tree->name;
 }
 
 
 int64_t CdsBinaryTreeCapacity(const CdsBinaryTree* tree)
 {
-    CDSASSERT(tree != NULL);
+    CDSASSERT_FULL(tree != NULL);
     return tree->capacity;
 }
 
 
 int64_t CdsBinaryTreeSize(const CdsBinaryTree* tree)
 {
-    CDSASSERT(tree != NULL);
-    return tree->size;
+    return cdsBinaryTreeSizeInline(tree);
 }
 
 
 bool CdsBinaryTreeIsEmpty(const CdsBinaryTree* tree)
 {
-    CDSASSERT(tree != NULL);
-    return (tree->size <= 0);
+    return cdsBinaryTreeIsEmptyInline(tree);
 }
 
 
 bool CdsBinaryTreeIsFull(const CdsBinaryTree* tree)
 {
-    CDSASSERT(tree != NULL);
+    CDSASSERT_FULL(tree != NULL);
     bool isFull = false;
     if ((tree->capacity > 0) && (tree->size >= tree->capacity)) {
         isFull = true;
@@ -115,10 +345,32 @@ bool CdsBinaryTreeIsFull(const CdsBinaryTree* tree)
 }
 
 
+void CdsBinaryTreeSetAugmentation(CdsBinaryTree* tree,
+        CdsBinaryTreeNodeUpdate update, void* cookie)
+{
+    CDSASSERT_FULL(tree != NULL);
+
+    tree->update = update;
+    tree->updateCookie = cookie;
+    if ((update != NULL) && (tree->root != NULL)) {
+        cdsBinaryTreeTraverse(tree->root, CDS_BT_ORDER_POST,
+                cdsBinaryTreeUpdateAction, tree);
+    }
+}
+
+
+void CdsBinaryTreeUpdateNode(CdsBinaryTreeNode* node)
+{
+    CDSASSERT_FULL(node != NULL);
+    CDSASSERT(node->tree != NULL);
+    cdsBinaryTreeUpdatePath(node->tree, node);
+}
+
+
 bool CdsBinaryTreeSetRoot(CdsBinaryTree* tree, CdsBinaryTreeNode* root)
 {
-    CDSASSERT(tree != NULL);
-    CDSASSERT(root != NULL);
+    CDSASSERT_FULL(tree != NULL);
+    CDSASSERT_FULL(root != NULL);
 
     bool ret = false;
     if (tree->root == NULL) {
@@ -128,6 +380,7 @@ bool CdsBinaryTreeSetRoot(CdsBinaryTree* tree, CdsBinaryTreeNode* root)
         root->right = NULL;
         tree->root = root;
         tree->size++;
+        cdsBinaryTreeUpdatePath(tree, root);
         ret = true;
     }
     return ret;
@@ -137,9 +390,9 @@ bool CdsBinaryTreeSetRoot(CdsBinaryTree* tree, CdsBinaryTreeNode* root)
 bool CdsBinaryTreeInsertLeft(CdsBinaryTreeNode* parent,
         CdsBinaryTreeNode* child)
 {
-    CDSASSERT(parent != NULL);
+    CDSASSERT_FULL(parent != NULL);
     CDSASSERT(parent->tree != NULL);
-    CDSASSERT(child != NULL);
+    CDSASSERT_FULL(child != NULL);
 
     CdsBinaryTree* tree = parent->tree;
     bool ret = false;
@@ -150,6 +403,12 @@ bool CdsBinaryTreeInsertLeft(CdsBinaryTreeNode* parent,
         child->right = NULL;
         parent->left = child;
         tree->size++;
+        if (tree->update != NULL) {
+            // NB: The aggregate of the new node was not computed before, so
+            // its parent must be updated whatever the result
+            tree->update(child, tree->updateCookie);
+            cdsBinaryTreeUpdatePath(tree, parent);
+        }
         ret = true;
     }
     return ret;
@@ -159,9 +418,9 @@ bool CdsBinaryTreeInsertLeft(CdsBinaryTreeNode* parent,
 bool CdsBinaryTreeInsertRight(CdsBinaryTreeNode* parent,
         CdsBinaryTreeNode* child)
 {
-    CDSASSERT(parent != NULL);
+    CDSASSERT_FULL(parent != NULL);
     CDSASSERT(parent->tree != NULL);
-    CDSASSERT(child != NULL);
+    CDSASSERT_FULL(child != NULL);
 
     CdsBinaryTree* tree = parent->tree;
     bool ret = false;
@@ -172,6 +431,12 @@ bool CdsBinaryTreeInsertRight(CdsBinaryTreeNode* parent,
         child->right = NULL;
         parent->right = child;
         tree->size++;
+        if (tree->update != NULL) {
+            // NB: The aggregate of the new node was not computed before, so
+            // its parent must be updated whatever the result
+            tree->update(child, tree->updateCookie);
+            cdsBinaryTreeUpdatePath(tree, parent);
+        }
         ret = true;
     }
     return ret;
@@ -180,34 +445,15 @@ bool CdsBinaryTreeInsertRight(CdsBinaryTreeNode* parent,
 
 void CdsBinaryTreeRemoveNode(CdsBinaryTreeNode* node)
 {
-    CDSASSERT(node != NULL);
+    CDSASSERT_FULL(node != NULL);
     CDSASSERT(node->tree != NULL);
 
     CdsBinaryTree* tree = node->tree;
     CdsBinaryTreeNode* parent = node->parent;
 
-    // NB: No recursion necessary!
-    node->flags = 0;
-    for (CdsBinaryTreeNode* curr = node; curr != node->parent; ) {
-        if (!(curr->flags & CDS_BT_FLAG_LEFT) && (curr->left != NULL)) {
-            curr->flags |= CDS_BT_FLAG_LEFT;
-            curr = curr->left;
-            curr->flags = 0;
-
-        } else if (!(curr->flags & CDS_BT_FLAG_RIGHT) && (curr->right != NULL)){
-            curr->flags |= CDS_BT_FLAG_RIGHT;
-            curr = curr->right;
-            curr->flags = 0;
-
-        } else {
-            CdsBinaryTreeNode* tmp = curr->parent;
-            if (tree->unref != NULL) {
-                tree->unref(curr);
-            }
-            tree->size--;
-            curr = tmp;
-        }
-    }
+    // NB: `node` might have been released once this returns
+    cdsBinaryTreeTraverse(node, CDS_BT_ORDER_POST, cdsBinaryTreeUnrefNode,
+            tree);
 
     if (parent == NULL) {
         // We removed the root node
@@ -220,54 +466,50 @@ void CdsBinaryTreeRemoveNode(CdsBinaryTreeNode* node)
         if (parent->left == node) {
             parent->left = NULL;
         } else {
-            CDSASSERT(parent->right == NULL);
+            CDSASSERT(parent->right == node);
             parent->right = NULL;
         }
+        cdsBinaryTreeUpdatePath(tree, parent);
     }
 }
 
 
 CdsBinaryTreeNode* CdsBinaryTreeRoot(const CdsBinaryTree* tree)
 {
-    CDSASSERT(tree != NULL);
-    return tree->root;
+    return cdsBinaryTreeRootInline(tree);
 }
 
 
 CdsBinaryTreeNode* CdsBinaryTreeLeftNode(const CdsBinaryTreeNode* node)
 {
-    CDSASSERT(node != NULL);
-    return node->left;
+    return cdsBinaryTreeLeftNodeInline(node);
 }
 
 
 CdsBinaryTreeNode* CdsBinaryTreeRightNode(const CdsBinaryTreeNode* node)
 {
-    CDSASSERT(node != NULL);
-    return node->right;
+    return cdsBinaryTreeRightNodeInline(node);
 }
 
 
 CdsBinaryTreeNode* CdsBinaryTreeParentNode(const CdsBinaryTreeNode* node)
 {
-	CDSASSERT(node !=NULL);
-	return node->parent;
+    return cdsBinaryTreeParentNodeInline(node);
 }
 
 
 bool CdsBinaryTreeIsLeaf(const CdsBinaryTreeNode* node)
 {
-    CDSASSERT(node != NULL);
-    return (node->left == NULL) && (node->right == NULL);
+    return cdsBinaryTreeIsLeafInline(node);
 }
 
 
 CdsBinaryTree* CdsBinaryTreeMerge(const char* name, CdsBinaryTreeNode* root,
         CdsBinaryTree* left, CdsBinaryTree* right)
 {
-    CDSASSERT(root != NULL);
-    CDSASSERT(left != NULL);
-    CDSASSERT(right != NULL);
+    CDSASSERT_FULL(root != NULL);
+    CDSASSERT_FULL(left != NULL);
+    CDSASSERT_FULL(right != NULL);
 
     int64_t capacity = 0;
     if ((left->capacity > 0) && (right->capacity > 0)) {
@@ -276,16 +518,35 @@ CdsBinaryTree* CdsBinaryTreeMerge(const char* name, CdsBinaryTreeNode* root,
         capacity = left->capacity + right->capacity;
     }
 
-    CdsBinaryTree* tree = CdsBinaryTreeCreate(name, capacity, left->unref);
+    CdsBinaryTree* tree = CdsBinaryTreeCreateWithAllocator(name, capacity,
+            left->unref, left->allocator);
     CdsBinaryTreeSetRoot(tree, root);
+    tree->update = left->update;
+    tree->updateCookie = left->updateCookie;
 
     tree->root->left = left->root;
     tree->root->right = right->root;
     tree->size += left->size + right->size;
 
-    free(left->name);
-    free(left);
-    free(right->name);
+    // Re-parent the two sub-trees; their nodes now belong to the merged tree
+    if (left->root != NULL) {
+        left->root->parent = tree->root;
+        cdsBinaryTreeTraverse(left->root, CDS_BT_ORDER_PRE,
+                cdsBinaryTreeSetTree, tree);
+    }
+    if (right->root != NULL) {
+        right->root->parent = tree->root;
+        cdsBinaryTreeTraverse(right->root, CDS_BT_ORDER_PRE,
+                cdsBinaryTreeSetTree, tree);
+    }
+    if (tree->update != NULL) {
+        tree->update(tree->root, tree->updateCookie);
+    }
+
+    CdsFree(left->allocator, left->name);
+    CdsFree(left->allocator, left);
+    CdsFree(right->allocator, right->name);
+    CdsFree(right->allocator, right);
     return tree;
 }
 
@@ -293,99 +554,512 @@ CdsBinaryTree* CdsBinaryTreeMerge(const char* name, CdsBinaryTreeNode* root,
 void CdsBinaryTreeTraversePreOrder(CdsBinaryTreeNode* node,
         CdsBinaryTreeNodeAction action, void* cookie)
 {
-    CDSASSERT(node != NULL);
-    CDSASSERT(action != NULL);
+    CDSASSERT_FULL(node != NULL);
+    CDSASSERT_FULL(action != NULL);
+    cdsBinaryTreeTraverse(node, CDS_BT_ORDER_PRE, action, cookie);
+}
+
+
+void CdsBinaryTreeTraverseInOrder(CdsBinaryTreeNode* node,
+        CdsBinaryTreeNodeAction action, void* cookie)
+{
+    CDSASSERT_FULL(node != NULL);
+    CDSASSERT_FULL(action != NULL);
+    cdsBinaryTreeTraverse(node, CDS_BT_ORDER_IN, action, cookie);
+}
+
 
-    // NB: No recursion necessary!
-    node->flags = 0;
-    for (CdsBinaryTreeNode* curr = node; curr != node->parent; ) {
-        if (!(curr->flags & CDS_BT_FLAG_VISITED)) {
-            if (!action(curr, cookie)) {
-                break;
+void CdsBinaryTreeTraversePostOrder(CdsBinaryTreeNode* node,
+        CdsBinaryTreeNodeAction action, void* cookie)
+{
+    CDSASSERT_FULL(node != NULL);
+    CDSASSERT_FULL(action != NULL);
+    cdsBinaryTreeTraverse(node, CDS_BT_ORDER_POST, action, cookie);
+}
+
+
+void CdsBinaryTreeTraverseParallel(CdsBinaryTreeNode* node,
+        CdsBinaryTreeNodeAction action, void* cookie, CdsThreadPool* pool,
+        CdsBinaryTreeParallelMode mode)
+{
+    CDSASSERT_FULL(node != NULL);
+    CDSASSERT_FULL(action != NULL);
+    CDSASSERT_FULL(pool != NULL);
+    CDSASSERT((mode == CDS_BT_PARALLEL_UNORDERED)
+            || (mode == CDS_BT_PARALLEL_POST_ORDER));
+
+    CdsBinaryTreeParallelJob job;
+    job.mode = mode;
+    job.action = action;
+    job.cookie = cookie;
+    job.pool = pool;
+    CdsThreadPoolGroupInit(&job.group);
+    job.stopped = false;
+
+    // NB: The calling thread helps too
+    int64_t subtrees = (int64_t)(CdsThreadPoolThreads(pool) + 1)
+        * CDS_BT_PARALLEL_SUBTREES_PER_THREAD;
+    job.splitDepth = 0;
+    while (((int64_t)1 << job.splitDepth) < subtrees) {
+        job.splitDepth++;
+    }
+
+    cdsBinaryTreeParallelSubmit(&job, node, 0, NULL);
+    CdsThreadPoolWait(pool, &job.group);
+}
+
+
+CdsBinaryTreeFrontier* CdsBinaryTreeFrontierCreate(int64_t capacity)
+{
+    CDSASSERT(capacity >= 0);
+    if (capacity == 0) {
+        capacity = CDS_BT_FRONTIER_CAPACITY;
+    }
+    int64_t pow2 = 1;
+    while (pow2 < capacity) {
+        pow2 *= 2;
+    }
+
+    CdsBinaryTreeFrontier* frontier = CdsMallocZ(sizeof(*frontier));
+    frontier->nodes = CdsMalloc(pow2 * sizeof(*frontier->nodes));
+    frontier->capacity = pow2;
+    return frontier;
+}
+
+
+void CdsBinaryTreeFrontierDestroy(CdsBinaryTreeFrontier* frontier)
+{
+    CDSASSERT_FULL(frontier != NULL);
+    free(frontier->nodes);
+    free(frontier);
+}
+
+
+void CdsBinaryTreeTraverseLevelOrder(CdsBinaryTreeNode* node,
+        CdsBinaryTreeNodeAction action, void* cookie,
+        CdsBinaryTreeFrontier* frontier)
+{
+    CDSASSERT_FULL(node != NULL);
+    CDSASSERT_FULL(action != NULL);
+
+    CdsBinaryTreeFrontier* tmp = NULL;
+    if (frontier == NULL) {
+        tmp = CdsBinaryTreeFrontierCreate(0);
+        frontier = tmp;
+    }
+    frontier->head = 0;
+    frontier->count = 0;
+
+    cdsBinaryTreeFrontierPush(frontier, node);
+    while (frontier->count > 0) {
+        CdsBinaryTreeNode* curr = cdsBinaryTreeFrontierPop(frontier);
+        if (!action(curr, cookie)) {
+            break;
+        }
+        if (curr->left != NULL) {
+            cdsBinaryTreeFrontierPush(frontier, curr->left);
+        }
+        if (curr->right != NULL) {
+            cdsBinaryTreeFrontierPush(frontier, curr->right);
+        }
+    }
+
+    frontier->count = 0;
+    if (tmp != NULL) {
+        CdsBinaryTreeFrontierDestroy(tmp);
+    }
+}
+
+
+void CdsBinaryTreeTraverseLevels(CdsBinaryTreeNode* node,
+        CdsBinaryTreeLevelAction action, void* cookie,
+        CdsBinaryTreeFrontier* frontier)
+{
+    CDSASSERT_FULL(node != NULL);
+    CDSASSERT_FULL(action != NULL);
+
+    CdsBinaryTreeFrontier* tmp = NULL;
+    if (frontier == NULL) {
+        tmp = CdsBinaryTreeFrontierCreate(0);
+        frontier = tmp;
+    }
+    frontier->head = 0;
+    frontier->count = 0;
+
+    cdsBinaryTreeFrontierPush(frontier, node);
+    for (int64_t level = 0; frontier->count > 0; level++) {
+        // The frontier holds exactly one level here; make it contiguous
+        int64_t count = frontier->count;
+        if (frontier->head + count > frontier->capacity) {
+            cdsBinaryTreeFrontierUnwrap(frontier, frontier->capacity);
+        }
+        if (!action(&frontier->nodes[frontier->head], count, level, cookie)) {
+            break;
+        }
+
+        for (int64_t i = 0; i < count; i++) {
+            CdsBinaryTreeNode* curr = cdsBinaryTreeFrontierPop(frontier);
+            if (curr->left != NULL) {
+                cdsBinaryTreeFrontierPush(frontier, curr->left);
+            }
+            if (curr->right != NULL) {
+                cdsBinaryTreeFrontierPush(frontier, curr->right);
             }
-            curr->flags |= CDS_BT_FLAG_VISITED;
         }
+    }
 
-        if (!(curr->flags & CDS_BT_FLAG_LEFT) && (curr->left != NULL)) {
-            curr->flags |= CDS_BT_FLAG_LEFT;
-            curr = curr->left;
-            curr->flags = 0;
+    frontier->count = 0;
+    if (tmp != NULL) {
+        CdsBinaryTreeFrontierDestroy(tmp);
+    }
+}
 
-        } else if (!(curr->flags & CDS_BT_FLAG_RIGHT) && (curr->right != NULL)){
-            curr->flags |= CDS_BT_FLAG_RIGHT;
-            curr = curr->right;
-            curr->flags = 0;
 
-        } else {
-            curr = curr->parent;
+CdsBinaryTreeFrozen* CdsBinaryTreeFreeze(CdsBinaryTreeNode* node)
+{
+    CDSASSERT_FULL(node != NULL);
+
+    CdsBinaryTreeFrozen* frozen = CdsMallocZ(sizeof(*frozen));
+    cdsBinaryTreeTraverse(node, CDS_BT_ORDER_PRE, cdsBinaryTreeFreezeAppend,
+            frozen);
+    int64_t size = frozen->size;
+    frozen->nodes = CdsMalloc(size * sizeof(*frozen->nodes));
+    frozen->sizes = CdsMalloc(size * sizeof(*frozen->sizes));
+    frozen->leftSizes = CdsMalloc(size * sizeof(*frozen->leftSizes));
+    frozen->size = 0;
+    cdsBinaryTreeTraverse(node, CDS_BT_ORDER_PRE, cdsBinaryTreeFreezeAppend,
+            frozen);
+    CDSASSERT(frozen->size == size);
+
+    // NB: Children come after their parent in pre-order, so a backward scan
+    // sees the sub-trees of a node before the node itself
+    for (int64_t i = size - 1; i >= 0; i--) {
+        int64_t leftSize = 0;
+        if (frozen->nodes[i]->left != NULL) {
+            leftSize = frozen->sizes[i + 1];
+        }
+        int64_t rightSize = 0;
+        if (frozen->nodes[i]->right != NULL) {
+            rightSize = frozen->sizes[i + 1 + leftSize];
         }
+        frozen->leftSizes[i] = leftSize;
+        frozen->sizes[i] = 1 + leftSize + rightSize;
     }
+    return frozen;
 }
 
 
-void CdsBinaryTreeTraverseInOrder(CdsBinaryTreeNode* node,
+void CdsBinaryTreeFrozenDestroy(CdsBinaryTreeFrozen* frozen)
+{
+    CDSASSERT_FULL(frozen != NULL);
+    free(frozen->nodes);
+    free(frozen->sizes);
+    free(frozen->leftSizes);
+    free(frozen);
+}
+
+
+int64_t CdsBinaryTreeFrozenSize(const CdsBinaryTreeFrozen* frozen)
+{
+    CDSASSERT_FULL(frozen != NULL);
+    return frozen->size;
+}
+
+
+CdsBinaryTreeNode* CdsBinaryTreeFrozenNode(const CdsBinaryTreeFrozen* frozen,
+        int64_t index)
+{
+    CDSASSERT_FULL(frozen != NULL);
+    CDSASSERT_FULL((index >= 0) && (index < frozen->size));
+    return frozen->nodes[index];
+}
+
+
+int64_t CdsBinaryTreeFrozenLeft(const CdsBinaryTreeFrozen* frozen,
+        int64_t index)
+{
+    CDSASSERT_FULL(frozen != NULL);
+    CDSASSERT_FULL((index >= 0) && (index < frozen->size));
+    return (frozen->leftSizes[index] > 0) ? (index + 1) : -1;
+}
+
+
+int64_t CdsBinaryTreeFrozenRight(const CdsBinaryTreeFrozen* frozen,
+        int64_t index)
+{
+    CDSASSERT_FULL(frozen != NULL);
+    CDSASSERT_FULL((index >= 0) && (index < frozen->size));
+    int64_t leftSize = frozen->leftSizes[index];
+    return (frozen->sizes[index] > 1 + leftSize) ? (index + 1 + leftSize) : -1;
+}
+
+
+int64_t CdsBinaryTreeFrozenSubTreeSize(const CdsBinaryTreeFrozen* frozen,
+        int64_t index)
+{
+    CDSASSERT_FULL(frozen != NULL);
+    CDSASSERT_FULL((index >= 0) && (index < frozen->size));
+    return frozen->sizes[index];
+}
+
+
+void CdsBinaryTreeFrozenTraversePreOrder(const CdsBinaryTreeFrozen* frozen,
         CdsBinaryTreeNodeAction action, void* cookie)
 {
-    CDSASSERT(node != NULL);
-    CDSASSERT(action != NULL);
-
-    // NB: No recursion necessary!
-    node->flags = 0;
-    for (CdsBinaryTreeNode* curr = node; curr != node->parent; ) {
-        if (!(curr->flags & CDS_BT_FLAG_LEFT) && (curr->left != NULL)) {
-            curr->flags |= CDS_BT_FLAG_LEFT;
-            curr = curr->left;
-            curr->flags = 0;
-
-        } else if (!(curr->flags & CDS_BT_FLAG_RIGHT) && (curr->right != NULL)){
-            if (!(curr->flags & CDS_BT_FLAG_VISITED)) {
-                if (!action(curr, cookie)) {
-                    break;
-                }
-                curr->flags |= CDS_BT_FLAG_VISITED;
+    CDSASSERT_FULL(frozen != NULL);
+    CDSASSERT_FULL(action != NULL);
+    for (int64_t i = 0; i < frozen->size; i++) {
+        if (!action(frozen->nodes[i], cookie)) {
+            break;
+        }
+    }
+}
+
+
+void CdsBinaryTreeFrozenTraverseBottomUp(const CdsBinaryTreeFrozen* frozen,
+        CdsBinaryTreeNodeAction action, void* cookie)
+{
+    CDSASSERT_FULL(frozen != NULL);
+    CDSASSERT_FULL(action != NULL);
+    for (int64_t i = frozen->size - 1; i >= 0; i--) {
+        if (!action(frozen->nodes[i], cookie)) {
+            break;
+        }
+    }
+}
+
+
+
+/*----------------------------------+
+ | Private function implementations |
+ +----------------------------------*/
+
+
+static void cdsBinaryTreeTraverse(CdsBinaryTreeNode* node,
+        CdsBinaryTreeOrder order, CdsBinaryTreeNodeAction action,
+        void* cookie)
+{
+    // NB: No recursion necessary, and no flags either! Where we come from
+    // tells what remains to be done with the current node: coming from the
+    // parent, the node is entered for the first time; coming from a child,
+    // that child's sub-tree is done.
+    CdsBinaryTreeNode* stop = node->parent;
+    CdsBinaryTreeNode* prev = stop;
+    CdsBinaryTreeNode* curr = node;
+    while (curr != stop) {
+        CdsBinaryTreeNode* next;
+        bool visit;
+        if (prev == curr->parent) {
+            if (curr->left != NULL) {
+                next = curr->left;
+            } else if (curr->right != NULL) {
+                next = curr->right;
+            } else {
+                next = curr->parent;
             }
-            curr->flags |= CDS_BT_FLAG_RIGHT;
-            curr = curr->right;
-            curr->flags = 0;
+            visit = (order == CDS_BT_ORDER_PRE)
+                || ((order == CDS_BT_ORDER_IN) && (curr->left == NULL))
+                || ((order == CDS_BT_ORDER_POST) && (next == curr->parent));
+
+        } else if (prev == curr->left) {
+            if (curr->right != NULL) {
+                next = curr->right;
+            } else {
+                next = curr->parent;
+            }
+            visit = (order == CDS_BT_ORDER_IN)
+                || ((order == CDS_BT_ORDER_POST) && (curr->right == NULL));
 
         } else {
-            if (!(curr->flags & CDS_BT_FLAG_VISITED)) {
-                if (!action(curr, cookie)) {
-                    break;
-                }
-                curr->flags |= CDS_BT_FLAG_VISITED;
-            }
+            next = curr->parent;
+            visit = (order == CDS_BT_ORDER_POST);
+        }
 
-            curr = curr->parent;
+        if (visit && !action(curr, cookie)) {
+            break;
         }
+        prev = curr;
+        curr = next;
     }
 }
 
 
-void CdsBinaryTreeTraversePostOrder(CdsBinaryTreeNode* node,
-        CdsBinaryTreeNodeAction action, void* cookie)
+static bool cdsBinaryTreeUnrefNode(CdsBinaryTreeNode* node, void* cookie)
 {
-    CDSASSERT(node != NULL);
-    CDSASSERT(action != NULL);
+    CdsBinaryTree* tree = cookie;
+    if (tree->unref != NULL) {
+        tree->unref(node);
+    }
+    tree->size--;
+    return true;
+}
 
-    // NB: No recursion necessary!
-    node->flags = 0;
-    for (CdsBinaryTreeNode* curr = node; curr != node->parent; ) {
-        if (!(curr->flags & CDS_BT_FLAG_LEFT) && (curr->left != NULL)) {
-            curr->flags |= CDS_BT_FLAG_LEFT;
-            curr = curr->left;
-            curr->flags = 0;
 
-        } else if (!(curr->flags & CDS_BT_FLAG_RIGHT) && (curr->right != NULL)){
-            curr->flags |= CDS_BT_FLAG_RIGHT;
-            curr = curr->right;
-            curr->flags = 0;
+static bool cdsBinaryTreeSetTree(CdsBinaryTreeNode* node, void* cookie)
+{
+    node->tree = cookie;
+    return true;
+}
 
-        } else {
-            if (!action(curr, cookie)) {
-                break;
+
+static void cdsBinaryTreeParallelSubmit(CdsBinaryTreeParallelJob* job,
+        CdsBinaryTreeNode* node, int depth, CdsBinaryTreeParallelSplit* split)
+{
+    // NB: The system allocator is used, as the tree's allocator might not be
+    // thread-safe
+    CdsBinaryTreeParallelTask* task = CdsMalloc(sizeof(*task));
+    task->job = job;
+    task->node = node;
+    task->depth = depth;
+    task->split = split;
+    CdsThreadPoolSubmit(job->pool, &job->group, cdsBinaryTreeParallelRun,
+            task);
+}
+
+
+static void cdsBinaryTreeParallelRun(CdsThreadPool* pool, void* arg)
+{
+    (void)pool;
+    CdsBinaryTreeParallelTask* task = arg;
+    CdsBinaryTreeParallelJob* job = task->job;
+    CdsBinaryTreeNode* node = task->node;
+
+    if ((task->depth >= job->splitDepth) || cdsBinaryTreeIsLeafInline(node)) {
+        CdsBinaryTreeOrder order = CDS_BT_ORDER_PRE;
+        if (job->mode == CDS_BT_PARALLEL_POST_ORDER) {
+            order = CDS_BT_ORDER_POST;
+        }
+        cdsBinaryTreeTraverse(node, order, cdsBinaryTreeParallelAction, job);
+        cdsBinaryTreeParallelDone(job, task->split);
+
+    } else if (job->mode == CDS_BT_PARALLEL_UNORDERED) {
+        if (cdsBinaryTreeParallelAction(node, job)) {
+            if (node->right != NULL) {
+                cdsBinaryTreeParallelSubmit(job, node->right,
+                        task->depth + 1, NULL);
+            }
+            if (node->left != NULL) {
+                cdsBinaryTreeParallelSubmit(job, node->left,
+                        task->depth + 1, NULL);
             }
-            curr = curr->parent;
+        }
+
+    } else {
+        // The action on this node will be called by whichever thread
+        // completes its last sub-tree
+        CdsBinaryTreeParallelSplit* split = CdsMalloc(sizeof(*split));
+        split->node = node;
+        split->remaining = ((node->left != NULL) ? 1 : 0)
+            + ((node->right != NULL) ? 1 : 0);
+        split->parent = task->split;
+        if (node->right != NULL) {
+            cdsBinaryTreeParallelSubmit(job, node->right, task->depth + 1,
+                    split);
+        }
+        if (node->left != NULL) {
+            cdsBinaryTreeParallelSubmit(job, node->left, task->depth + 1,
+                    split);
+        }
+    }
+
+    free(task);
+}
+
+
+static void cdsBinaryTreeParallelDone(CdsBinaryTreeParallelJob* job,
+        CdsBinaryTreeParallelSplit* split)
+{
+    while ((split != NULL)
+            && (__atomic_sub_fetch(&split->remaining, 1, __ATOMIC_ACQ_REL)
+                == 0)) {
+        cdsBinaryTreeParallelAction(split->node, job);
+        CdsBinaryTreeParallelSplit* parent = split->parent;
+        free(split);
+        split = parent;
+    }
+}
+
+
+static bool cdsBinaryTreeParallelAction(CdsBinaryTreeNode* node,
+        void* cookie)
+{
+    CdsBinaryTreeParallelJob* job = cookie;
+    if (__atomic_load_n(&job->stopped, __ATOMIC_RELAXED)) {
+        return false;
+    }
+    if (!job->action(node, job->cookie)) {
+        __atomic_store_n(&job->stopped, true, __ATOMIC_RELAXED);
+        return false;
+    }
+    return true;
+}
+
+
+static void cdsBinaryTreeFrontierUnwrap(CdsBinaryTreeFrontier* frontier,
+        int64_t capacity)
+{
+    CDSASSERT(capacity >= frontier->capacity);
+
+    CdsBinaryTreeNode** nodes = CdsMalloc(capacity * sizeof(*nodes));
+    int64_t mask = frontier->capacity - 1;
+    for (int64_t i = 0; i < frontier->count; i++) {
+        nodes[i] = frontier->nodes[(frontier->head + i) & mask];
+    }
+    free(frontier->nodes);
+    frontier->nodes = nodes;
+    frontier->capacity = capacity;
+    frontier->head = 0;
+}
+
+
+static void cdsBinaryTreeFrontierPush(CdsBinaryTreeFrontier* frontier,
+        CdsBinaryTreeNode* node)
+{
+    if (frontier->count >= frontier->capacity) {
+        cdsBinaryTreeFrontierUnwrap(frontier, 2 * frontier->capacity);
+    }
+    int64_t mask = frontier->capacity - 1;
+    frontier->nodes[(frontier->head + frontier->count) & mask] = node;
+    frontier->count++;
+}
+
+
+static CdsBinaryTreeNode* cdsBinaryTreeFrontierPop(
+        CdsBinaryTreeFrontier* frontier)
+{
+    CDSASSERT(frontier->count > 0);
+    CdsBinaryTreeNode* node = frontier->nodes[frontier->head];
+    frontier->head = (frontier->head + 1) & (frontier->capacity - 1);
+    frontier->count--;
+    return node;
+}
+
+
+static bool cdsBinaryTreeFreezeAppend(CdsBinaryTreeNode* node, void* cookie)
+{
+    CdsBinaryTreeFrozen* frozen = cookie;
+    if (frozen->nodes != NULL) {
+        frozen->nodes[frozen->size] = node;
+    }
+    frozen->size++;
+    return true;
+}
+
+
+static bool cdsBinaryTreeUpdateAction(CdsBinaryTreeNode* node, void* cookie)
+{
+    const CdsBinaryTree* tree = cookie;
+    tree->update(node, tree->updateCookie);
+    return true;
+}
+
+
+static void cdsBinaryTreeUpdatePath(const CdsBinaryTree* tree,
+        CdsBinaryTreeNode* node)
+{
+    if (tree->update != NULL) {
+        while ((node != NULL) && tree->update(node, tree->updateCookie)) {
+            node = node->parent;
         }
     }
 }
@@ -201,6 +201,84 @@ static bool testNodeActionPostOrder(CdsBinaryTreeNode* tnode, void* cookie)
 }
 
 
+static bool testNodeActionCount(CdsBinaryTreeNode* tnode, void* cookie)
+{
+    (void)tnode;
+    (*(int*)cookie)++;
+    return true;
+}
+
+static bool testNodeActionNested(CdsBinaryTreeNode* tnode, void* cookie)
+{
+    // NB: Traverse the whole tree again from within a traversal
+    CdsBinaryTreeNode* root = tnode;
+    while (CdsBinaryTreeParentNode(root) != NULL) {
+        root = CdsBinaryTreeParentNode(root);
+    }
+    CdsBinaryTreeTraversePreOrder(root, testNodeActionCount, cookie);
+    return true;
+}
+
+// Nodes of the test tree in level order, as (level, rank)
+static const int gLevelOrder[][2] = {
+    { 0, 0 }, { 1, 0 }, { 1, 1 }, { 2, 0 }, { 2, 1 }, { 2, 2 }, { 3, 5 }
+};
+
+typedef struct {
+    int index;
+    int stopAt;
+    bool ok;
+} LevelOrderData;
+
+static bool testNodeActionLevelOrder(CdsBinaryTreeNode* tnode, void* cookie)
+{
+    TestNode* node = (TestNode*)tnode;
+    LevelOrderData* d = (LevelOrderData*)cookie;
+    if ((d->index >= 7)
+            || (node->level != gLevelOrder[d->index][0])
+            || (node->rank != gLevelOrder[d->index][1])) {
+        d->ok = false;
+    }
+    d->index++;
+    return d->index != d->stopAt;
+}
+
+static bool testLevelActionBatch(CdsBinaryTreeNode* const* nodes,
+        int64_t count, int64_t level, void* cookie)
+{
+    LevelOrderData* d = (LevelOrderData*)cookie;
+    for (int64_t i = 0; i < count; i++) {
+        TestNode* node = (TestNode*)nodes[i];
+        if ((d->index >= 7)
+                || (node->level != level)
+                || (node->level != gLevelOrder[d->index][0])
+                || (node->rank != gLevelOrder[d->index][1])) {
+            d->ok = false;
+        }
+        d->index++;
+    }
+    return level + 1 != d->stopAt;
+}
+
+// Nodes of the test tree from the bottom up, as frozen
+static const int gBottomUp[][2] = {
+    { 3, 5 }, { 2, 2 }, { 1, 1 }, { 2, 1 }, { 2, 0 }, { 1, 0 }, { 0, 0 }
+};
+
+static bool testNodeActionBottomUp(CdsBinaryTreeNode* tnode, void* cookie)
+{
+    TestNode* node = (TestNode*)tnode;
+    LevelOrderData* d = (LevelOrderData*)cookie;
+    if ((d->index >= 7)
+            || (node->level != gBottomUp[d->index][0])
+            || (node->rank != gBottomUp[d->index][1])) {
+        d->ok = false;
+    }
+    d->index++;
+    return true;
+}
+
+
 RTT_GROUP_START(TestCdsBinaryTree, 0x00040001u, NULL, NULL)
 
 RTT_TEST_START(cds_should_create_binary_tree)
@@ -452,6 +530,139 @@ RTT_TEST_START(cds_binary_tree_traverse_post_order)
 }
 RTT_TEST_END
 
+RTT_TEST_START(cds_binary_tree_traverse_sub_tree)
+{
+    CdsBinaryTreeNode* node = CdsBinaryTreeRightNode(CdsBinaryTreeRoot(gTree));
+    RTT_ASSERT(node != NULL);
+
+    int count = 0;
+    CdsBinaryTreeTraverseInOrder(node, testNodeActionCount, &count);
+    RTT_ASSERT(count == 3);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_binary_tree_traverse_nested)
+{
+    CdsBinaryTreeNode* root = CdsBinaryTreeRoot(gTree);
+    RTT_ASSERT(root != NULL);
+
+    int count = 0;
+    CdsBinaryTreeTraverseInOrder(root, testNodeActionNested, &count);
+    RTT_ASSERT(count == 7 * 7);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_binary_tree_traverse_level_order)
+{
+    CdsBinaryTreeNode* root = CdsBinaryTreeRoot(gTree);
+    RTT_ASSERT(root != NULL);
+
+    LevelOrderData d = { 0, -1, true };
+    CdsBinaryTreeTraverseLevelOrder(root, testNodeActionLevelOrder, &d, NULL);
+    RTT_ASSERT(d.ok);
+    RTT_ASSERT(d.index == 7);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_binary_tree_traverse_level_order_should_stop)
+{
+    CdsBinaryTreeNode* root = CdsBinaryTreeRoot(gTree);
+    RTT_ASSERT(root != NULL);
+
+    LevelOrderData d = { 0, 4, true };
+    CdsBinaryTreeTraverseLevelOrder(root, testNodeActionLevelOrder, &d, NULL);
+    RTT_ASSERT(d.ok);
+    RTT_ASSERT(d.index == 4);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_binary_tree_traverse_levels)
+{
+    CdsBinaryTreeNode* root = CdsBinaryTreeRoot(gTree);
+    RTT_ASSERT(root != NULL);
+
+    LevelOrderData d = { 0, -1, true };
+    CdsBinaryTreeTraverseLevels(root, testLevelActionBatch, &d, NULL);
+    RTT_ASSERT(d.ok);
+    RTT_ASSERT(d.index == 7);
+
+    // Stop after the second level: 1 + 2 nodes
+    d.index = 0;
+    d.stopAt = 2;
+    CdsBinaryTreeTraverseLevels(root, testLevelActionBatch, &d, NULL);
+    RTT_ASSERT(d.ok);
+    RTT_ASSERT(d.index == 3);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_binary_tree_should_reuse_frontier)
+{
+    CdsBinaryTreeNode* root = CdsBinaryTreeRoot(gTree);
+    RTT_ASSERT(root != NULL);
+
+    // NB: A capacity of 1 forces the frontier to grow and wrap around
+    CdsBinaryTreeFrontier* frontier = CdsBinaryTreeFrontierCreate(1);
+    for (int i = 0; i < 3; i++) {
+        LevelOrderData d = { 0, -1, true };
+        CdsBinaryTreeTraverseLevelOrder(root, testNodeActionLevelOrder, &d,
+                frontier);
+        RTT_ASSERT(d.ok);
+        RTT_ASSERT(d.index == 7);
+
+        d.index = 0;
+        CdsBinaryTreeTraverseLevels(root, testLevelActionBatch, &d, frontier);
+        RTT_ASSERT(d.ok);
+        RTT_ASSERT(d.index == 7);
+    }
+    CdsBinaryTreeFrontierDestroy(frontier);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_binary_tree_should_freeze_tree)
+{
+    CdsBinaryTreeNode* root = CdsBinaryTreeRoot(gTree);
+    RTT_ASSERT(root != NULL);
+
+    CdsBinaryTreeFrozen* frozen = CdsBinaryTreeFreeze(root);
+    RTT_ASSERT(frozen != NULL);
+    RTT_ASSERT(CdsBinaryTreeFrozenSize(frozen) == 7);
+
+    // Pre-order: (0,0) (1,0) (2,0) (2,1) (1,1) (2,2) (3,5)
+    static const int64_t left[] = { 1, 2, -1, -1, 5, -1, -1 };
+    static const int64_t right[] = { 4, 3, -1, -1, -1, 6, -1 };
+    static const int64_t sizes[] = { 7, 3, 1, 1, 3, 2, 1 };
+    for (int64_t i = 0; i < 7; i++) {
+        RTT_EXPECT(CdsBinaryTreeFrozenLeft(frozen, i) == left[i]);
+        RTT_EXPECT(CdsBinaryTreeFrozenRight(frozen, i) == right[i]);
+        RTT_EXPECT(CdsBinaryTreeFrozenSubTreeSize(frozen, i) == sizes[i]);
+    }
+    RTT_EXPECT(CdsBinaryTreeFrozenNode(frozen, 0) == root);
+    RTT_EXPECT(CdsBinaryTreeFrozenNode(frozen, 4)
+            == CdsBinaryTreeRightNode(root));
+
+    TraverseData d;
+    d.nextLevel = 0;
+    d.nextRank = 0;
+    d.ok = true;
+    CdsBinaryTreeFrozenTraversePreOrder(frozen, testNodeActionPreOrder, &d);
+    RTT_EXPECT(d.ok);
+    RTT_EXPECT(d.nextLevel == MAGIC_LEVEL_DONE);
+    RTT_EXPECT(d.nextRank == MAGIC_RANK_DONE);
+
+    LevelOrderData b = { 0, -1, true };
+    CdsBinaryTreeFrozenTraverseBottomUp(frozen, testNodeActionBottomUp, &b);
+    RTT_EXPECT(b.ok);
+    RTT_EXPECT(b.index == 7);
+    CdsBinaryTreeFrozenDestroy(frozen);
+
+    // A frozen sub-tree starts at its own top node
+    frozen = CdsBinaryTreeFreeze(CdsBinaryTreeRightNode(root));
+    RTT_EXPECT(CdsBinaryTreeFrozenSize(frozen) == 3);
+    RTT_EXPECT(CdsBinaryTreeFrozenRight(frozen, 1) == 2);
+    CdsBinaryTreeFrozenDestroy(frozen);
+}
+RTT_TEST_END
+
 RTT_TEST_START(cds_binary_tree_should_remove_left_node)
 {
     CdsBinaryTreeNode* root = CdsBinaryTreeRoot(gTree);
@@ -476,6 +687,33 @@ RTT_TEST_START(cds_binary_tree_should_destroy_tree)
 }
 RTT_TEST_END
 
+RTT_TEST_START(cds_binary_tree_should_merge_trees)
+{
+    CdsBinaryTree* left = CdsBinaryTreeCreate(NULL, 0, testNodeUnref);
+    CdsBinaryTree* right = CdsBinaryTreeCreate(NULL, 0, testNodeUnref);
+    TestNode* root = testNodeAlloc(0, 0);
+    TestNode* leftRoot = testNodeAlloc(1, 0);
+    TestNode* rightRoot = testNodeAlloc(1, 1);
+    TestNode* leaf = testNodeAlloc(2, 0);
+    RTT_ASSERT(CdsBinaryTreeSetRoot(left, &leftRoot->node));
+    RTT_ASSERT(CdsBinaryTreeSetRoot(right, &rightRoot->node));
+    RTT_ASSERT(CdsBinaryTreeInsertLeft(&leftRoot->node, &leaf->node));
+
+    gTree = CdsBinaryTreeMerge("Merged", &root->node, left, right);
+    RTT_ASSERT(CdsBinaryTreeSize(gTree) == 4);
+    int count = 0;
+    CdsBinaryTreeTraversePostOrder(CdsBinaryTreeRoot(gTree),
+            testNodeActionCount, &count);
+    RTT_ASSERT(count == 4);
+
+    // NB: The nodes of the merged trees now belong to `gTree`
+    CdsBinaryTreeRemoveNode(&leaf->node);
+    RTT_ASSERT(CdsBinaryTreeSize(gTree) == 3);
+    CdsBinaryTreeDestroy(gTree);
+    RTT_ASSERT(gNumberOfNodesInExistence == 0);
+}
+RTT_TEST_END
+
 RTT_GROUP_END(TestCdsBinaryTree,
         cds_should_create_binary_tree,
         cds_should_get_binary_tree_name,
@@ -503,5 +741,303 @@ RTT_GROUP_END(TestCdsBinaryTree,
         cds_binary_tree_traverse_pre_order,
         cds_binary_tree_traverse_in_order,
         cds_binary_tree_traverse_post_order,
+        cds_binary_tree_traverse_sub_tree,
+        cds_binary_tree_traverse_nested,
+        cds_binary_tree_traverse_level_order,
+        cds_binary_tree_traverse_level_order_should_stop,
+        cds_binary_tree_traverse_levels,
+        cds_binary_tree_should_reuse_frontier,
+        cds_binary_tree_should_freeze_tree,
         cds_binary_tree_should_remove_left_node,
-        cds_binary_tree_should_destroy_tree);
+        cds_binary_tree_should_destroy_tree,
+        cds_binary_tree_should_merge_trees);
+
+
+
+#define TEST_PARALLEL_DEPTH 12
+#define TEST_PARALLEL_NODES ((1 << TEST_PARALLEL_DEPTH) - 1)
+
+typedef struct {
+    CdsBinaryTreeNode node;
+    int64_t sum;
+} TestSumNode;
+
+static CdsThreadPool* gThreadPool = NULL;
+static TestSumNode* gSumNodes = NULL;
+static int64_t gVisited = 0;
+
+static bool testParallelCount(CdsBinaryTreeNode* tnode, void* cookie)
+{
+    (void)tnode;
+    (void)cookie;
+    __atomic_add_fetch(&gVisited, 1, __ATOMIC_RELAXED);
+    return true;
+}
+
+static bool testParallelSum(CdsBinaryTreeNode* tnode, void* cookie)
+{
+    (void)cookie;
+    TestSumNode* node = (TestSumNode*)tnode;
+    TestSumNode* left = (TestSumNode*)CdsBinaryTreeLeftNode(tnode);
+    TestSumNode* right = (TestSumNode*)CdsBinaryTreeRightNode(tnode);
+    node->sum = 1;
+    if (left != NULL) {
+        CDSASSERT(left->sum > 0);
+        node->sum += left->sum;
+    }
+    if (right != NULL) {
+        CDSASSERT(right->sum > 0);
+        node->sum += right->sum;
+    }
+    return true;
+}
+
+static bool testParallelStop(CdsBinaryTreeNode* tnode, void* cookie)
+{
+    __atomic_add_fetch(&gVisited, 1, __ATOMIC_RELAXED);
+    return tnode != (CdsBinaryTreeNode*)cookie;
+}
+
+
+RTT_GROUP_START(TestCdsBinaryTreeParallel, 0x00040002u, NULL, NULL)
+
+RTT_TEST_START(cds_binary_tree_should_build_big_tree)
+{
+    gThreadPool = CdsThreadPoolCreate(NULL, 3);
+    gTree = CdsBinaryTreeCreate(NULL, 0, NULL);
+    gSumNodes = calloc(TEST_PARALLEL_NODES, sizeof(*gSumNodes));
+    RTT_ASSERT(gSumNodes != NULL);
+
+    // NB: Node `i` has nodes `2i+1` and `2i+2` as children
+    RTT_ASSERT(CdsBinaryTreeSetRoot(gTree, &gSumNodes[0].node));
+    for (int i = 1; i < TEST_PARALLEL_NODES; i++) {
+        CdsBinaryTreeNode* parent = &gSumNodes[(i - 1) / 2].node;
+        if (i & 1) {
+            RTT_ASSERT(CdsBinaryTreeInsertLeft(parent, &gSumNodes[i].node));
+        } else {
+            RTT_ASSERT(CdsBinaryTreeInsertRight(parent, &gSumNodes[i].node));
+        }
+    }
+    RTT_ASSERT(CdsBinaryTreeSize(gTree) == TEST_PARALLEL_NODES);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_binary_tree_traverse_parallel_unordered)
+{
+    gVisited = 0;
+    CdsBinaryTreeTraverseParallel(CdsBinaryTreeRoot(gTree), testParallelCount,
+            NULL, gThreadPool, CDS_BT_PARALLEL_UNORDERED);
+    RTT_EXPECT(gVisited == TEST_PARALLEL_NODES);
+
+    // Sub-tree only
+    gVisited = 0;
+    CdsBinaryTreeTraverseParallel(&gSumNodes[1].node, testParallelCount,
+            NULL, gThreadPool, CDS_BT_PARALLEL_UNORDERED);
+    RTT_EXPECT(gVisited == TEST_PARALLEL_NODES / 2);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_binary_tree_traverse_parallel_post_order)
+{
+    CdsBinaryTreeTraverseParallel(CdsBinaryTreeRoot(gTree), testParallelSum,
+            NULL, gThreadPool, CDS_BT_PARALLEL_POST_ORDER);
+    RTT_EXPECT(gSumNodes[0].sum == TEST_PARALLEL_NODES);
+    RTT_EXPECT(gSumNodes[1].sum == TEST_PARALLEL_NODES / 2);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_binary_tree_traverse_parallel_should_stop)
+{
+    // Stopping at the root, which is the first node acted upon
+    gVisited = 0;
+    CdsBinaryTreeTraverseParallel(CdsBinaryTreeRoot(gTree), testParallelStop,
+            CdsBinaryTreeRoot(gTree), gThreadPool, CDS_BT_PARALLEL_UNORDERED);
+    RTT_EXPECT(gVisited == 1);
+
+    // Stopping at a leaf; the root is then never acted upon
+    gVisited = 0;
+    CdsBinaryTreeTraverseParallel(CdsBinaryTreeRoot(gTree), testParallelStop,
+            &gSumNodes[TEST_PARALLEL_NODES / 2].node, gThreadPool,
+            CDS_BT_PARALLEL_POST_ORDER);
+    RTT_EXPECT(gVisited >= 1);
+    RTT_EXPECT(gVisited < TEST_PARALLEL_NODES);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_binary_tree_should_destroy_big_tree)
+{
+    CdsBinaryTreeDestroy(gTree);
+    gTree = NULL;
+    free(gSumNodes);
+    gSumNodes = NULL;
+    CdsThreadPoolDestroy(gThreadPool);
+    gThreadPool = NULL;
+}
+RTT_TEST_END
+
+RTT_GROUP_END(TestCdsBinaryTreeParallel,
+        cds_binary_tree_should_build_big_tree,
+        cds_binary_tree_traverse_parallel_unordered,
+        cds_binary_tree_traverse_parallel_post_order,
+        cds_binary_tree_traverse_parallel_should_stop,
+        cds_binary_tree_should_destroy_big_tree);
+
+
+
+#define TEST_AUGMENT_DEPTH 16
+
+typedef struct {
+    CdsBinaryTreeNode node;
+    int64_t value;
+    int64_t sum;
+    int64_t max;
+} TestAggNode;
+
+static TestAggNode* gAggNodes[TEST_AUGMENT_DEPTH];
+static int gNumberOfAggNodesInExistence = 0;
+static int gUpdates = 0;
+
+static void testAggNodeUnref(CdsBinaryTreeNode* tnode)
+{
+    free(tnode);
+    gNumberOfAggNodesInExistence--;
+}
+
+static TestAggNode* testAggNodeAlloc(int64_t value)
+{
+    TestAggNode* node = malloc(sizeof(*node));
+    memset(node, 0, sizeof(*node));
+    node->value = value;
+    gNumberOfAggNodesInExistence++;
+    return node;
+}
+
+static bool testAggNodeUpdate(CdsBinaryTreeNode* tnode, void* cookie)
+{
+    TestAggNode* node = (TestAggNode*)tnode;
+    (*(int*)cookie)++;
+
+    int64_t sum = node->value;
+    int64_t max = node->value;
+    TestAggNode* left = (TestAggNode*)CdsBinaryTreeLeftNode(tnode);
+    TestAggNode* right = (TestAggNode*)CdsBinaryTreeRightNode(tnode);
+    if (left != NULL) {
+        sum += left->sum;
+        max = (left->max > max) ? left->max : max;
+    }
+    if (right != NULL) {
+        sum += right->sum;
+        max = (right->max > max) ? right->max : max;
+    }
+    bool changed = (sum != node->sum) || (max != node->max);
+    node->sum = sum;
+    node->max = max;
+    return changed;
+}
+
+
+RTT_GROUP_START(TestCdsBinaryTreeAugment, 0x00040003u, NULL, NULL)
+
+RTT_TEST_START(cds_binary_tree_should_update_aggregates_on_insert)
+{
+    gTree = CdsBinaryTreeCreate(NULL, 0, testAggNodeUnref);
+    CdsBinaryTreeSetAugmentation(gTree, testAggNodeUpdate, &gUpdates);
+
+    // NB: A chain down the left, with values 1, 2, 3...
+    for (int i = 0; i < TEST_AUGMENT_DEPTH; i++) {
+        gAggNodes[i] = testAggNodeAlloc(i + 1);
+        gUpdates = 0;
+        if (i == 0) {
+            RTT_ASSERT(CdsBinaryTreeSetRoot(gTree, &gAggNodes[i]->node));
+        } else {
+            RTT_ASSERT(CdsBinaryTreeInsertLeft(&gAggNodes[i - 1]->node,
+                        &gAggNodes[i]->node));
+        }
+        // Only the new node and its ancestors are updated
+        RTT_EXPECT(gUpdates == i + 1);
+    }
+    int64_t n = TEST_AUGMENT_DEPTH;
+    RTT_EXPECT(gAggNodes[0]->sum == n * (n + 1) / 2);
+    RTT_EXPECT(gAggNodes[0]->max == n);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_binary_tree_should_update_aggregates_on_change)
+{
+    int64_t n = TEST_AUGMENT_DEPTH;
+    gAggNodes[n - 1]->value = n + 4;
+    gUpdates = 0;
+    CdsBinaryTreeUpdateNode(&gAggNodes[n - 1]->node);
+    RTT_EXPECT(gUpdates == n);
+    RTT_EXPECT(gAggNodes[0]->sum == n * (n + 1) / 2 + 4);
+    RTT_EXPECT(gAggNodes[0]->max == n + 4);
+
+    // Nothing changed: the update stops at the node itself
+    gUpdates = 0;
+    CdsBinaryTreeUpdateNode(&gAggNodes[n / 2]->node);
+    RTT_EXPECT(gUpdates == 1);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_binary_tree_should_update_aggregates_on_remove)
+{
+    int d = TEST_AUGMENT_DEPTH / 2;
+    gUpdates = 0;
+    CdsBinaryTreeRemoveNode(&gAggNodes[d]->node);
+    RTT_EXPECT(gNumberOfAggNodesInExistence == d);
+    RTT_EXPECT(gUpdates == d);
+    RTT_EXPECT(gAggNodes[0]->sum == d * (d + 1) / 2);
+    RTT_EXPECT(gAggNodes[0]->max == d);
+
+    // Insert on the right of the root
+    TestAggNode* node = testAggNodeAlloc(100);
+    gUpdates = 0;
+    RTT_ASSERT(CdsBinaryTreeInsertRight(&gAggNodes[0]->node, &node->node));
+    RTT_EXPECT(gUpdates == 2);
+    RTT_EXPECT(gAggNodes[0]->sum == d * (d + 1) / 2 + 100);
+    RTT_EXPECT(gAggNodes[0]->max == 100);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_binary_tree_should_compute_aggregates_when_augmented)
+{
+    CdsBinaryTree* tree = CdsBinaryTreeCreate(NULL, 0, testAggNodeUnref);
+    TestAggNode* root = testAggNodeAlloc(1);
+    TestAggNode* left = testAggNodeAlloc(2);
+    TestAggNode* right = testAggNodeAlloc(3);
+    RTT_ASSERT(CdsBinaryTreeSetRoot(tree, &root->node));
+    RTT_ASSERT(CdsBinaryTreeInsertLeft(&root->node, &left->node));
+    RTT_ASSERT(CdsBinaryTreeInsertRight(&root->node, &right->node));
+    RTT_EXPECT(root->sum == 0);
+
+    gUpdates = 0;
+    CdsBinaryTreeSetAugmentation(tree, testAggNodeUpdate, &gUpdates);
+    RTT_EXPECT(gUpdates == 3);
+    RTT_EXPECT(root->sum == 6);
+    RTT_EXPECT(root->max == 3);
+
+    // Merge the two trees under a new root
+    TestAggNode* top = testAggNodeAlloc(10);
+    gUpdates = 0;
+    gTree = CdsBinaryTreeMerge(NULL, &top->node, gTree, tree);
+    RTT_EXPECT(gUpdates == 1);
+    int64_t d = TEST_AUGMENT_DEPTH / 2;
+    RTT_EXPECT(top->sum == d * (d + 1) / 2 + 100 + 6 + 10);
+    RTT_EXPECT(top->max == 100);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_binary_tree_should_destroy_augmented_tree)
+{
+    CdsBinaryTreeDestroy(gTree);
+    gTree = NULL;
+    RTT_EXPECT(gNumberOfAggNodesInExistence == 0);
+}
+RTT_TEST_END
+
+RTT_GROUP_END(TestCdsBinaryTreeAugment,
+        cds_binary_tree_should_update_aggregates_on_insert,
+        cds_binary_tree_should_update_aggregates_on_change,
+        cds_binary_tree_should_update_aggregates_on_remove,
+        cds_binary_tree_should_compute_aggregates_when_augmented,
+        cds_binary_tree_should_destroy_augmented_tree);
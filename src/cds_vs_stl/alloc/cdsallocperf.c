@@ -0,0 +1,193 @@
+/* Copyright (c) 2016  Fabrice Triboix
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "cdslist.h"
+#include "cdsmap.h"
+#include "cdsarena.h"
+#include "cdspool.h"
+
+
+// A key is a string of 16 characters, plus the terminating null character
+#define KEYSIZE_B 17
+
+
+/*
+ * Items
+ *
+ * The items are allocated from `gAllocator`, and freed in batches when the
+ * containers are cleared. If `gArena` is set, the items are allocated from it
+ * and the containers are discarded as a whole instead.
+ */
+
+static const CdsAllocator* gAllocator = NULL;
+static CdsArena* gArena = NULL;
+
+typedef struct
+{
+    CdsListItem item;
+    long long value;
+} MyListItem;
+
+typedef struct
+{
+    CdsMapItem item;
+    long long value;
+    char key[KEYSIZE_B];
+} MyMapItem;
+
+static void unrefBatch(void** items, int64_t count)
+{
+    CdsFreeBatch(gAllocator, items, count);
+}
+
+static void listUnrefBatch(CdsListItem** items, int64_t count)
+{
+    unrefBatch((void**)items, count);
+}
+
+static void mapUnrefBatch(CdsMapItem** items, int64_t count)
+{
+    unrefBatch((void**)items, count);
+}
+
+static int keyCmp(void* leftKey, void* rightKey, void* cookie)
+{
+    (void)cookie;
+    return strcmp((const char*)leftKey, (const char*)rightKey);
+}
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec * 1000.0) + (ts.tv_nsec / 1000000.0);
+}
+
+
+static void runList(long long count)
+{
+    CdsList* list = CdsListCreate(NULL, 0, NULL);
+
+    double start = now_ms();
+    for (long long i = 0; i < count; i++) {
+        MyListItem* item = CdsAlloc(gAllocator, sizeof(*item));
+        item->value = i;
+        CdsListPushBack(list, &item->item);
+    }
+    double mid = now_ms();
+    if (gArena != NULL) {
+        CdsListDestroyNoUnref(list);
+        CdsArenaReset(gArena);
+    } else {
+        CdsListClearParallel(list, 1, listUnrefBatch);
+        CdsListDestroy(list);
+    }
+    double end = now_ms();
+    printf("    list: insert %.1f ms  clear %.1f ms\n", mid - start, end - mid);
+}
+
+
+static void runMap(long long count)
+{
+    CdsMap* map = CdsMapCreate(NULL, 0, keyCmp, NULL, NULL, NULL);
+    unsigned long long x = 88172645463325252ull;
+
+    double start = now_ms();
+    for (long long i = 0; i < count; i++) {
+        MyMapItem* item = CdsAlloc(gAllocator, sizeof(*item));
+        // NB: xorshift, so the keys are inserted in random order
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        snprintf(item->key, sizeof(item->key), "%016llx", x);
+        item->value = i;
+        CDSASSERT(CdsMapInsert(map, item->key, &item->item));
+    }
+    double mid = now_ms();
+    if (gArena != NULL) {
+        CdsMapDestroyNoUnref(map);
+        CdsArenaReset(gArena);
+    } else {
+        CdsMapClearParallel(map, 1, mapUnrefBatch);
+        CdsMapDestroy(map);
+    }
+    double end = now_ms();
+    printf("    map:  insert %.1f ms  clear %.1f ms\n", mid - start, end - mid);
+}
+
+
+int main(int argc, char** argv)
+{
+    if ((argc < 2) || (argc > 3)) {
+        fprintf(stderr, "Usage: ./cdsallocperf COUNT [pool|arena]\n");
+        exit(2);
+    }
+    long long count;
+    if (sscanf(argv[1], "%lld", &count) != 1) {
+        fprintf(stderr, "Invalid COUNT argument: '%s'\n", argv[1]);
+        exit(2);
+    }
+    if (count <= 0) {
+        fprintf(stderr, "Invalid COUNT: %lld\n", count);
+        exit(2);
+    }
+    bool pool = false;
+    bool arena = false;
+    if (argc == 3) {
+        if (strcmp(argv[2], "pool") == 0) {
+            pool = true;
+        } else if (strcmp(argv[2], "arena") == 0) {
+            arena = true;
+        } else {
+            fprintf(stderr, "Invalid argument: '%s'\n", argv[2]);
+            exit(2);
+        }
+    }
+
+    // NB: Each allocator should be measured in its own process, as the state
+    // the system allocator is left in affects whatever runs after it
+    if (arena) {
+        printf("arena:\n");
+        gArena = CdsArenaCreate(NULL, 0, false);
+        gAllocator = CdsArenaAllocator(gArena);
+        runList(count);
+        runMap(count);
+        CdsArenaDestroy(gArena);
+    } else if (!pool) {
+        printf("system malloc:\n");
+        gAllocator = CdsSystemAllocator();
+        runList(count);
+        runMap(count);
+    } else {
+        printf("pool:\n");
+        CdsPool* listPool = CdsPoolCreate(NULL, sizeof(MyListItem), 0, false);
+        gAllocator = CdsPoolAllocator(listPool);
+        runList(count);
+        CdsPoolDestroy(listPool);
+
+        CdsPool* mapPool = CdsPoolCreate(NULL, sizeof(MyMapItem), 0, false);
+        gAllocator = CdsPoolAllocator(mapPool);
+        runMap(count);
+        CdsPoolDestroy(mapPool);
+    }
+
+    return 0;
+}
@@ -0,0 +1,76 @@
+/* Copyright (c) 2016  Fabrice Triboix
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "cdsdeque.h"
+
+
+int main(int argc, char** argv)
+{
+    if (argc != 2) {
+        fprintf(stderr, "Usage: ./cdsdequeperf ITEMCOUNT\n");
+        exit(2);
+    }
+    long long count;
+    if (sscanf(argv[1], "%lld", &count) != 1) {
+        fprintf(stderr, "Invalid COUNT argument: '%s'\n", argv[1]);
+        exit(2);
+    }
+    if (count <= 0) {
+        fprintf(stderr, "Invalid COUNT: %lld\n", count);
+        exit(2);
+    }
+
+    CdsDeque* deque = CdsDequeCreate(NULL, 0, sizeof(long long));
+
+    printf("Inserting %lld items at the front\n", count / 2);
+    for (long long i = 0; i < (count / 2); i++) {
+        CDSASSERT(CdsDequePushFront(deque, &i));
+    }
+
+    printf("Inserting %lld items at the back\n", count / 2);
+    for (long long i = (count / 2); i < count; i++) {
+        CDSASSERT(CdsDequePushBack(deque, &i));
+    }
+
+    printf("Walking through the deque\n");
+    void* ptr;
+    int64_t n;
+    for (int64_t index = 0; (n = CdsDequeRun(deque, index, &ptr)) > 0;
+            index += n) {
+        const long long* values = ptr;
+        for (int64_t i = 0; i < n; i++) {
+            volatile long long x = values[i];
+            (void)x;
+        }
+    }
+
+    printf("Popping %lld items from the front\n", count / 2);
+    for (long long i = 0; i < (count / 2); i++) {
+        CDSASSERT(CdsDequePopFront(deque, NULL));
+    }
+
+    printf("Popping %lld items from the back\n", count / 2);
+    for (long long i = (count / 2); i < count; i++) {
+        CDSASSERT(CdsDequePopBack(deque, NULL));
+    }
+
+    CDSASSERT(CdsDequeSize(deque) == 0);
+    CdsDequeDestroy(deque);
+    return 0;
+}
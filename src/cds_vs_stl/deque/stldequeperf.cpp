@@ -0,0 +1,72 @@
+/* Copyright (c) 2016  Fabrice Triboix
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <deque>
+#include <cstdio>
+#include <cstdlib>
+
+
+int main(int argc, char** argv)
+{
+    if (argc != 2) {
+        fprintf(stderr, "Usage: ./stldequeperf ITEMCOUNT\n");
+        exit(2);
+    }
+    long long count;
+    if (sscanf(argv[1], "%lld", &count) != 1) {
+        fprintf(stderr, "Invalid COUNT argument: '%s'\n", argv[1]);
+        exit(2);
+    }
+    if (count <= 0) {
+        fprintf(stderr, "Invalid COUNT: %lld\n", count);
+        exit(2);
+    }
+
+    std::deque<long long> deque;
+
+    printf("Inserting %lld items at the front\n", count / 2);
+    for (long long i = 0; i < (count / 2); i++) {
+        deque.push_front(i);
+    }
+
+    printf("Inserting %lld items at the back\n", count / 2);
+    for (long long i = (count / 2); i < count; i++) {
+        deque.push_back(i);
+    }
+
+    printf("Walking through the deque\n");
+    for (auto& value : deque) {
+        volatile long long x = value;
+        (void)x;
+    }
+
+    printf("Popping %lld items from the front\n", count / 2);
+    for (long long i = 0; i < (count / 2); i++) {
+        deque.pop_front();
+    }
+
+    printf("Popping %lld items from the back\n", count / 2);
+    for (long long i = (count / 2); i < count; i++) {
+        deque.pop_back();
+    }
+
+    if (deque.size() != 0) {
+        fprintf(stderr, "ERROR: Deque size should be 0 after removing all "
+                "items (currently it is %lld)\n", (long long)deque.size());
+        exit(1);
+    }
+    return 0;
+}
@@ -16,8 +16,36 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <time.h>
 
 #include "cdslist.h"
+#include "cdsleanlist.h"
+#include "cdspool.h"
+
+
+// Pool to allocate the items from, or NULL to use the system allocator
+static CdsPool* gPool = NULL;
+
+static void* itemAlloc(size_t size_B)
+{
+    if (gPool == NULL) {
+        return CdsMallocZ(size_B);
+    }
+    void* ptr = CdsPoolAlloc(gPool);
+    CDSASSERT(ptr != NULL);
+    memset(ptr, 0, size_B);
+    return ptr;
+}
+
+static void itemFree(void* ptr)
+{
+    if (gPool == NULL) {
+        free(ptr);
+    } else {
+        CdsPoolFree(gPool, ptr);
+    }
+}
 
 
 typedef struct
@@ -29,7 +57,7 @@ typedef struct
 
 static MyItem* myItemCreate(long long value)
 {
-    MyItem* item = CdsMallocZ(sizeof(*item));
+    MyItem* item = itemAlloc(sizeof(*item));
     item->ref = 1;
     item->value = value;
     return item;
@@ -40,28 +68,102 @@ static void myItemUnref(CdsListItem* litem)
     MyItem* item = (MyItem*)litem;
     item->ref--;
     if (item->ref <= 0) {
-        free(item);
+        itemFree(item);
     }
 }
 
 
-int main(int argc, char** argv)
+static void visitBatch(CdsListItem** items, int64_t count, void* cookie)
 {
-    if (argc != 2) {
-        fprintf(stderr, "Usage: ./cdslistperf ITEMCOUNT\n");
-        exit(2);
+    (void)cookie;
+    for (int64_t i = 0; i < count; i++) {
+        volatile long long x = ((MyItem*)items[i])->value;
+        (void)x;
     }
-    long long count;
-    if (sscanf(argv[1], "%lld", &count) != 1) {
-        fprintf(stderr, "Invalid COUNT argument: '%s'\n", argv[1]);
-        exit(2);
+}
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec * 1000.0) + (ts.tv_nsec / 1000000.0);
+}
+
+
+// Same item, using the 16-byte lean list link
+typedef struct
+{
+    CdsLeanListItem item;
+    int ref;
+    long long value;
+} MyLeanItem;
+
+static MyLeanItem* myLeanItemCreate(long long value)
+{
+    MyLeanItem* item = itemAlloc(sizeof(*item));
+    item->ref = 1;
+    item->value = value;
+    return item;
+}
+
+static void myLeanItemUnref(CdsLeanListItem* litem)
+{
+    MyLeanItem* item = (MyLeanItem*)litem;
+    item->ref--;
+    if (item->ref <= 0) {
+        itemFree(item);
     }
-    if (count <= 0) {
-        fprintf(stderr, "Invalid COUNT: %lld\n", count);
-        exit(2);
+}
+
+
+static void runLean(long long count)
+{
+    CdsLeanList* list = CdsLeanListCreate(NULL, 0, myLeanItemUnref);
+    printf("Item size: %zu bytes (link: %zu bytes)\n",
+            sizeof(MyLeanItem), sizeof(CdsLeanListItem));
+
+    printf("Inserting %lld items at the front\n", count / 2);
+    for (long long i = 0; i < (count / 2); i++) {
+        CDSASSERT(CdsLeanListPushFront(list,
+                    (CdsLeanListItem*)myLeanItemCreate(i)));
     }
 
+    printf("Inserting %lld items at the back\n", count / 2);
+    for (long long i = (count / 2); i < count; i++) {
+        CDSASSERT(CdsLeanListPushBack(list,
+                    (CdsLeanListItem*)myLeanItemCreate(i)));
+    }
+
+    printf("Walking through the list\n");
+    CDSLEANLIST_FOREACH(list, MyLeanItem, item) {
+        volatile long long x = item->value;
+        (void)x;
+    }
+
+    printf("Popping %lld items from the front\n", count / 2);
+    for (long long i = 0; i < (count / 2); i++) {
+        MyLeanItem* item = (MyLeanItem*)CdsLeanListPopFront(list);
+        CDSASSERT(item != NULL);
+        myLeanItemUnref((CdsLeanListItem*)item);
+    }
+
+    printf("Popping %lld items from the back\n", count / 2);
+    for (long long i = (count / 2); i < count; i++) {
+        MyLeanItem* item = (MyLeanItem*)CdsLeanListPopBack(list);
+        CDSASSERT(item != NULL);
+        myLeanItemUnref((CdsLeanListItem*)item);
+    }
+
+    CDSASSERT(CdsLeanListSize(list) == 0);
+    CdsLeanListDestroy(list);
+}
+
+
+static void run(long long count)
+{
     CdsList* list = CdsListCreate(NULL, 0, myItemUnref);
+    printf("Item size: %zu bytes (link: %zu bytes)\n",
+            sizeof(MyItem), sizeof(CdsListItem));
 
     printf("Inserting %lld items at the front\n", count / 2);
     for (long long i = 0; i < (count / 2); i++) {
@@ -74,10 +176,23 @@ int main(int argc, char** argv)
     }
 
     printf("Walking through the list\n");
+    double start = now_ms();
     CDSLIST_FOREACH(list, MyItem, item) {
         volatile long long x = item->value;
         (void)x;
     }
+    printf("  CDSLIST_FOREACH: %.1f ms\n", now_ms() - start);
+
+    start = now_ms();
+    CDSLIST_FOREACH_FAST(list, MyItem, item) {
+        volatile long long x = item->value;
+        (void)x;
+    }
+    printf("  CDSLIST_FOREACH_FAST: %.1f ms\n", now_ms() - start);
+
+    start = now_ms();
+    CdsListForEachBatch(list, visitBatch, 64, NULL);
+    printf("  CdsListForEachBatch: %.1f ms\n", now_ms() - start);
 
     printf("Popping %lld items from the front\n", count / 2);
     for (long long i = 0; i < (count / 2); i++) {
@@ -95,5 +210,51 @@ int main(int argc, char** argv)
 
     CDSASSERT(CdsListSize(list) == 0);
     CdsListDestroy(list);
+}
+
+
+int main(int argc, char** argv)
+{
+    if ((argc < 2) || (argc > 4)) {
+        fprintf(stderr, "Usage: ./cdslistperf ITEMCOUNT [lean] [pool]\n");
+        exit(2);
+    }
+    long long count;
+    if (sscanf(argv[1], "%lld", &count) != 1) {
+        fprintf(stderr, "Invalid COUNT argument: '%s'\n", argv[1]);
+        exit(2);
+    }
+    if (count <= 0) {
+        fprintf(stderr, "Invalid COUNT: %lld\n", count);
+        exit(2);
+    }
+    bool lean = false;
+    bool pool = false;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "lean") == 0) {
+            lean = true;
+        } else if (strcmp(argv[i], "pool") == 0) {
+            pool = true;
+        } else {
+            fprintf(stderr, "Invalid argument: '%s'\n", argv[i]);
+            exit(2);
+        }
+    }
+    if (pool) {
+        gPool = CdsPoolCreate(NULL, lean ? sizeof(MyLeanItem) : sizeof(MyItem),
+                0, false);
+    }
+    if (lean) {
+        runLean(count);
+    } else {
+        run(count);
+    }
+    if (pool) {
+        CdsPoolStats stats;
+        CdsPoolGetStats(gPool, &stats);
+        printf("Pool: %lld slabs, %lld MiB\n", (long long)stats.slabs,
+                (long long)(stats.reserved_B / (1024 * 1024)));
+        CdsPoolDestroy(gPool);
+    }
     return 0;
 }
@@ -17,6 +17,7 @@
 #include <memory>
 #include <list>
 #include <cstdio>
+#include <cstdlib>
 
 
 class MyItem
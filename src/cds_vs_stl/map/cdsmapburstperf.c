@@ -0,0 +1,203 @@
+/* Copyright (c) 2016  Fabrice Triboix
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "cdsmap.h"
+
+
+// A key is a string of 16 characters, add terminating null char and ref counter
+#define KEYSIZE_B 18
+
+// Number of bursts the items are inserted in
+#define BURST_COUNT 50
+
+// Number of lookups performed during each idle phase, per inserted item
+#define LOOKUPS_PER_ITEM 4
+
+typedef struct
+{
+    CdsMapItem item;
+    int ref;
+    long long value;
+} MyItem;
+
+static void addItem(CdsMap* map, long long value)
+{
+    MyItem* item = CdsMallocZ(sizeof(*item));
+    item->ref = 1;
+    item->value = value;
+
+    // NB: The last character is used as a reference counter
+    char* key = CdsMallocZ(KEYSIZE_B);
+    snprintf(key, KEYSIZE_B - 1, "%016lx", (unsigned long)value);
+    key[KEYSIZE_B - 1] = 1;
+
+    CDSASSERT(CdsMapInsert(map, key, (CdsMapItem*)item));
+}
+
+static void keyUnref(void* lkey)
+{
+    char* key = (char*)lkey;
+    // NB: The last character is used as a reference counter
+    key[KEYSIZE_B - 1]--;
+    if (key[KEYSIZE_B - 1] <= 0) {
+        free(key);
+    }
+}
+
+static void myItemUnref(CdsMapItem* litem)
+{
+    MyItem* item = (MyItem*)litem;
+    item->ref--;
+    if (item->ref <= 0) {
+        free(item);
+    }
+}
+
+static int keyCmp(void* leftKey, void* rightKey, void* cookie)
+{
+    (void)cookie;
+    return strcmp((const char*)leftKey, (const char*)rightKey);
+}
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec * 1000.0) + (ts.tv_nsec / 1000000.0);
+}
+
+/** Run the burst/idle pattern
+ *
+ * Items are inserted in `BURST_COUNT` bursts. Each burst is followed by an
+ * idle phase where random items inserted so far are looked up.
+ *
+ * @param numbers  [in]  Random numbers to use as keys
+ * @param count    [in]  Number of items to insert
+ * @param deferred [in]  Whether to use the map burst mode
+ * @param pInsert  [out] Time spent inserting, in ms
+ * @param pRebal   [out] Time spent rebalancing at the end of bursts, in ms
+ * @param pLookup  [out] Time spent looking up items, in ms
+ */
+static void run(const unsigned long* numbers, long long count, bool deferred,
+        double* pInsert, double* pRebal, double* pLookup)
+{
+    CdsMap* map = CdsMapCreate(NULL, 0, keyCmp, NULL, keyUnref, myItemUnref);
+    long long burstSize = (count + BURST_COUNT - 1) / BURST_COUNT;
+    unsigned int seed = 1;
+    *pInsert = 0.0;
+    *pRebal = 0.0;
+    *pLookup = 0.0;
+
+    for (long long i = 0; i < count; ) {
+        double start = now_ms();
+        if (deferred) {
+            CdsMapBurstBegin(map);
+        }
+        for (long long j = 0; (j < burstSize) && (i < count); j++, i++) {
+            addItem(map, numbers[i]);
+        }
+        double end = now_ms();
+        *pInsert += end - start;
+        if (deferred) {
+            start = end;
+            CdsMapBurstEnd(map);
+            end = now_ms();
+            *pRebal += end - start;
+        }
+
+        start = end;
+        for (long long j = 0; j < (burstSize * LOOKUPS_PER_ITEM); j++) {
+            char key[KEYSIZE_B];
+            snprintf(key, sizeof(key), "%016lx",
+                    numbers[rand_r(&seed) % i]);
+            CDSASSERT(CdsMapSearch(map, key) != NULL);
+        }
+        *pLookup += now_ms() - start;
+    }
+
+    CDSASSERT(CdsMapSize(map) == count);
+    CdsMapDestroy(map);
+}
+
+
+int main(int argc, char** argv)
+{
+    if (argc != 3) {
+        fprintf(stderr, "Usage: ./cdsmapburstperf COUNT FILE\n");
+        exit(2);
+    }
+    long long count;
+    if (sscanf(argv[1], "%lld", &count) != 1) {
+        fprintf(stderr, "Invalid COUNT argument: '%s'\n", argv[1]);
+        exit(2);
+    }
+    if (count <= 0) {
+        fprintf(stderr, "Invalid COUNT: %lld\n", count);
+        exit(2);
+    }
+
+    int fd = open(argv[2], O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Failed to open file '%s'\n", argv[2]);
+        exit(1);
+    }
+    long long size_B = count * sizeof(unsigned long);
+    unsigned long* numbers = malloc(size_B);
+    if (numbers == NULL) {
+        fprintf(stderr, "Failed to allocate %lld bytes\n", size_B);
+        exit(1);
+    }
+    char* ptr = (char*)numbers;
+    long long remaining_B = size_B;
+    while (remaining_B > 0) {
+        ssize_t n = read(fd, ptr, remaining_B);
+        if (n < 0) {
+            fprintf(stderr, "Failed to read file '%s': %s\n",
+                    argv[2], strerror(errno));
+            exit(1);
+        }
+        if (n == 0) {
+            fprintf(stderr, "ERROR: Zero read from file '%s'\n", argv[2]);
+            exit(1);
+        }
+        ptr += n;
+        remaining_B -= n;
+    }
+    close(fd);
+
+    double insert_ms;
+    double rebal_ms;
+    double lookup_ms;
+    run(numbers, count, false, &insert_ms, &rebal_ms, &lookup_ms);
+    printf("immediate rebalancing: insert %.1f ms  lookup %.1f ms\n",
+            insert_ms, lookup_ms);
+    run(numbers, count, true, &insert_ms, &rebal_ms, &lookup_ms);
+    printf("deferred rebalancing:  insert %.1f ms  rebalance %.1f ms  "
+            "lookup %.1f ms\n", insert_ms, rebal_ms, lookup_ms);
+
+    free(numbers);
+    return 0;
+}
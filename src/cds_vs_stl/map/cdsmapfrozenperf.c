@@ -0,0 +1,179 @@
+/* Copyright (c) 2016  Fabrice Triboix
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "cdsmap.h"
+
+
+// A key is a string of 16 characters, add terminating null char and ref counter
+#define KEYSIZE_B 18
+
+// Number of lookups performed, per item
+#define LOOKUPS_PER_ITEM 4
+
+typedef struct
+{
+    CdsMapItem item;
+    int ref;
+    long long value;
+} MyItem;
+
+static void addItem(CdsMap* map, long long value)
+{
+    MyItem* item = CdsMallocZ(sizeof(*item));
+    item->ref = 1;
+    item->value = value;
+
+    // NB: The last character is used as a reference counter
+    char* key = CdsMallocZ(KEYSIZE_B);
+    snprintf(key, KEYSIZE_B - 1, "%016lx", (unsigned long)value);
+    key[KEYSIZE_B - 1] = 1;
+
+    CDSASSERT(CdsMapInsert(map, key, (CdsMapItem*)item));
+}
+
+static void keyUnref(void* lkey)
+{
+    char* key = (char*)lkey;
+    // NB: The last character is used as a reference counter
+    key[KEYSIZE_B - 1]--;
+    if (key[KEYSIZE_B - 1] <= 0) {
+        free(key);
+    }
+}
+
+static void myItemUnref(CdsMapItem* litem)
+{
+    MyItem* item = (MyItem*)litem;
+    item->ref--;
+    if (item->ref <= 0) {
+        free(item);
+    }
+}
+
+static int keyCmp(void* leftKey, void* rightKey, void* cookie)
+{
+    (void)cookie;
+    return strcmp((const char*)leftKey, (const char*)rightKey);
+}
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec * 1000.0) + (ts.tv_nsec / 1000000.0);
+}
+
+
+int main(int argc, char** argv)
+{
+    if (argc != 3) {
+        fprintf(stderr, "Usage: ./cdsmapfrozenperf COUNT FILE\n");
+        exit(2);
+    }
+    long long count;
+    if (sscanf(argv[1], "%lld", &count) != 1) {
+        fprintf(stderr, "Invalid COUNT argument: '%s'\n", argv[1]);
+        exit(2);
+    }
+    if (count <= 0) {
+        fprintf(stderr, "Invalid COUNT: %lld\n", count);
+        exit(2);
+    }
+
+    int fd = open(argv[2], O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Failed to open file '%s'\n", argv[2]);
+        exit(1);
+    }
+    long long size_B = count * sizeof(unsigned long);
+    unsigned long* numbers = malloc(size_B);
+    if (numbers == NULL) {
+        fprintf(stderr, "Failed to allocate %lld bytes\n", size_B);
+        exit(1);
+    }
+    char* ptr = (char*)numbers;
+    long long remaining_B = size_B;
+    while (remaining_B > 0) {
+        ssize_t n = read(fd, ptr, remaining_B);
+        if (n < 0) {
+            fprintf(stderr, "Failed to read file '%s': %s\n",
+                    argv[2], strerror(errno));
+            exit(1);
+        }
+        if (n == 0) {
+            fprintf(stderr, "ERROR: Zero read from file '%s'\n", argv[2]);
+            exit(1);
+        }
+        ptr += n;
+        remaining_B -= n;
+    }
+    close(fd);
+
+    CdsMap* map = CdsMapCreate(NULL, 0, keyCmp, NULL, keyUnref, myItemUnref);
+    for (long long i = 0; i < count; i++) {
+        addItem(map, numbers[i]);
+    }
+
+    // Format the keys to look up beforehand, so only the searches are timed
+    long long lookups = count * LOOKUPS_PER_ITEM;
+    char* keys = malloc(lookups * KEYSIZE_B);
+    if (keys == NULL) {
+        fprintf(stderr, "Failed to allocate %lld bytes\n",
+                lookups * KEYSIZE_B);
+        exit(1);
+    }
+    unsigned int seed = 1;
+    for (long long i = 0; i < lookups; i++) {
+        snprintf(&keys[i * KEYSIZE_B], KEYSIZE_B, "%016lx",
+                numbers[rand_r(&seed) % count]);
+    }
+
+    double start = now_ms();
+    for (long long i = 0; i < lookups; i++) {
+        CDSASSERT(CdsMapSearch(map, &keys[i * KEYSIZE_B]) != NULL);
+    }
+    double live_ms = now_ms() - start;
+
+    start = now_ms();
+    CdsMapFrozen* frozen = CdsMapFreeze(map);
+    double freeze_ms = now_ms() - start;
+
+    start = now_ms();
+    for (long long i = 0; i < lookups; i++) {
+        CDSASSERT(CdsMapFrozenSearch(frozen, &keys[i * KEYSIZE_B]) != NULL);
+    }
+    double frozen_ms = now_ms() - start;
+
+    printf("live map:   %lld searches in %.1f ms\n", lookups, live_ms);
+    printf("frozen map: %lld searches in %.1f ms  (freeze %.1f ms)\n",
+            lookups, frozen_ms, freeze_ms);
+
+    CdsMapFrozenDestroy(frozen);
+    CdsMapDestroy(map);
+    free(keys);
+    free(numbers);
+    return 0;
+}
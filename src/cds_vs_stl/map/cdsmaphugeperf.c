@@ -0,0 +1,245 @@
+/* Copyright (c) 2016  Fabrice Triboix
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "cdsmap.h"
+#include "cdspool.h"
+#include "cdshugepage.h"
+
+
+// A key is a string of 16 characters, plus the terminating null character
+#define KEYSIZE_B 17
+
+typedef struct
+{
+    CdsMapItem item;
+    long long value;
+    char key[KEYSIZE_B];
+} MyItem;
+
+static void myItemUnref(CdsMapItem* item)
+{
+    free(item);
+}
+
+static int keyCmp(void* leftKey, void* rightKey, void* cookie)
+{
+    (void)cookie;
+    return strcmp((const char*)leftKey, (const char*)rightKey);
+}
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec * 1000.0) + (ts.tv_nsec / 1000000.0);
+}
+
+
+/*
+ * dTLB miss counter
+ *
+ * The counter is only available if the kernel allows this process to use
+ * `perf_event_open()`, see `/proc/sys/kernel/perf_event_paranoid`.
+ */
+
+static int dtlbOpen(void)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.config = PERF_COUNT_HW_CACHE_DTLB
+        | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+        | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static void dtlbStart(int fd)
+{
+    if (fd >= 0) {
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+static long long dtlbStop(int fd)
+{
+    long long count = -1;
+    if (fd >= 0) {
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(fd, &count, sizeof(count)) != sizeof(count)) {
+            count = -1;
+        }
+    }
+    return count;
+}
+
+
+/** Get the amount of anonymous memory backed by huge pages, in KiB */
+static long long anonHugePages_KiB(void)
+{
+    FILE* f = fopen("/proc/self/smaps_rollup", "r");
+    if (f == NULL) {
+        return -1;
+    }
+    long long kib = -1;
+    char line[256];
+    while (fgets(line, sizeof(line), f) != NULL) {
+        if (sscanf(line, "AnonHugePages: %lld kB", &kib) == 1) {
+            break;
+        }
+    }
+    fclose(f);
+    return kib;
+}
+
+
+int main(int argc, char** argv)
+{
+    if ((argc != 3) && (argc != 4)) {
+        fprintf(stderr,
+                "Usage: ./cdsmaphugeperf COUNT FILE [malloc|pool|huge]\n");
+        exit(2);
+    }
+    long long count;
+    if (sscanf(argv[1], "%lld", &count) != 1) {
+        fprintf(stderr, "Invalid COUNT argument: '%s'\n", argv[1]);
+        exit(2);
+    }
+    if (count <= 0) {
+        fprintf(stderr, "Invalid COUNT: %lld\n", count);
+        exit(2);
+    }
+    const char* mode = (argc == 4) ? argv[3] : "malloc";
+    if ((strcmp(mode, "malloc") != 0) && (strcmp(mode, "pool") != 0)
+            && (strcmp(mode, "huge") != 0)) {
+        fprintf(stderr, "Invalid mode: '%s'\n", mode);
+        exit(2);
+    }
+
+    int fd = open(argv[2], O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Failed to open file '%s'\n", argv[2]);
+        exit(1);
+    }
+    long long size_B = count * sizeof(unsigned long);
+    unsigned long* numbers = malloc(size_B);
+    if (numbers == NULL) {
+        fprintf(stderr, "Failed to allocate %lld bytes\n", size_B);
+        exit(1);
+    }
+    char* ptr = (char*)numbers;
+    long long remaining_B = size_B;
+    while (remaining_B > 0) {
+        ssize_t n = read(fd, ptr, remaining_B);
+        if (n < 0) {
+            fprintf(stderr, "Failed to read file '%s': %s\n",
+                    argv[2], strerror(errno));
+            exit(1);
+        }
+        if (n == 0) {
+            fprintf(stderr, "ERROR: Zero read from file '%s'\n", argv[2]);
+            exit(1);
+        }
+        ptr += n;
+        remaining_B -= n;
+    }
+    close(fd);
+
+    // NB: Each mode should be measured in its own process, as the state the
+    // system allocator is left in affects whatever runs after it
+    CdsPool* pool = NULL;
+    if (strcmp(mode, "pool") == 0) {
+        pool = CdsPoolCreate(NULL, sizeof(MyItem), 0, false);
+    } else if (strcmp(mode, "huge") == 0) {
+        if (!CdsHugePagesAvailable()) {
+            printf("Transparent huge pages not available, "
+                    "falling back to normal pages\n");
+        }
+        pool = CdsPoolCreateWithAllocator(NULL, sizeof(MyItem), 0, false,
+                CDS_HUGEPAGE_B, CdsHugePageAllocator());
+    }
+
+    CdsMap* map = CdsMapCreate(NULL, 0, keyCmp, NULL, NULL,
+            (pool != NULL) ? NULL : myItemUnref);
+    for (long long i = 0; i < count; i++) {
+        MyItem* item;
+        if (pool != NULL) {
+            item = CdsPoolAlloc(pool);
+            CDSASSERT(item != NULL);
+        } else {
+            item = CdsMalloc(sizeof(*item));
+        }
+        item->value = i;
+        snprintf(item->key, sizeof(item->key), "%016lx", numbers[i]);
+        CDSASSERT(CdsMapInsert(map, item->key, &item->item));
+    }
+
+    // Search for the items in a different order than they were inserted in
+    char (*keys)[KEYSIZE_B] = CdsMalloc(count * KEYSIZE_B);
+    for (long long i = 0; i < count; i++) {
+        snprintf(keys[i], KEYSIZE_B, "%016lx", numbers[(i * 7919) % count]);
+    }
+
+    int perfFd = dtlbOpen();
+    int perfErr = errno;
+    dtlbStart(perfFd);
+    double start = now_ms();
+    for (long long i = 0; i < count; i++) {
+        CDSASSERT(CdsMapSearch(map, keys[i]) != NULL);
+    }
+    double search_ms = now_ms() - start;
+    long long misses = dtlbStop(perfFd);
+
+    printf("%s: search %.1f ms", mode, search_ms);
+    if (misses >= 0) {
+        printf("  dTLB misses %lld (%.2f/search)", misses,
+                (double)misses / count);
+    } else {
+        printf("  dTLB misses n/a (%s)", strerror(perfErr));
+    }
+    printf("  AnonHugePages %lld KiB\n", anonHugePages_KiB());
+    if (perfFd >= 0) {
+        close(perfFd);
+    }
+
+    // NB: If there is a pool, it owns the items
+    if (pool != NULL) {
+        CdsMapDestroyNoUnref(map);
+        CdsPoolDestroy(pool);
+    } else {
+        CdsMapDestroy(map);
+    }
+    free(keys);
+    free(numbers);
+    return 0;
+}
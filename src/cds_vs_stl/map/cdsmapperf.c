@@ -24,6 +24,7 @@
 #include <unistd.h>
 
 #include "cdsmap.h"
+#include "cdspool.h"
 
 
 // A key is a string of 16 characters, add terminating null char and ref counter
@@ -36,14 +37,39 @@ typedef struct
     long long value;
 } MyItem;
 
+// Pools to allocate the items and keys from, or NULL to use the system
+// allocator
+static CdsPool* gItemPool = NULL;
+static CdsPool* gKeyPool = NULL;
+
+static void* poolAlloc(CdsPool* pool, size_t size_B)
+{
+    if (pool == NULL) {
+        return CdsMallocZ(size_B);
+    }
+    void* ptr = CdsPoolAlloc(pool);
+    CDSASSERT(ptr != NULL);
+    memset(ptr, 0, size_B);
+    return ptr;
+}
+
+static void poolFree(CdsPool* pool, void* ptr)
+{
+    if (pool == NULL) {
+        free(ptr);
+    } else {
+        CdsPoolFree(pool, ptr);
+    }
+}
+
 static void addItem(CdsMap* map, long long value)
 {
-    MyItem* item = CdsMallocZ(sizeof(*item));
+    MyItem* item = poolAlloc(gItemPool, sizeof(*item));
     item->ref = 1;
     item->value = value;
 
     // NB: The last character is used as a reference counter
-    char* key = CdsMallocZ(KEYSIZE_B);
+    char* key = poolAlloc(gKeyPool, KEYSIZE_B);
     snprintf(key, KEYSIZE_B - 1, "%016lx", (unsigned long)value);
     key[KEYSIZE_B - 1] = 1;
 
@@ -56,7 +82,7 @@ static void keyUnref(void* lkey)
     // NB: The last character is used as a reference counter
     key[KEYSIZE_B - 1]--;
     if (key[KEYSIZE_B - 1] <= 0) {
-        free(key);
+        poolFree(gKeyPool, key);
     }
 }
 
@@ -65,7 +91,7 @@ static void myItemUnref(CdsMapItem* litem)
     MyItem* item = (MyItem*)litem;
     item->ref--;
     if (item->ref <= 0) {
-        free(item);
+        poolFree(gItemPool, item);
     }
 }
 
@@ -78,10 +104,24 @@ static int keyCmp(void* leftKey, void* rightKey, void* cookie)
 
 int main(int argc, char** argv)
 {
-    if (argc != 3) {
-        fprintf(stderr, "Usage: ./cdsmapperf COUNT FILE\n");
+    if ((argc < 3) || (argc > 5)) {
+        fprintf(stderr, "Usage: ./cdsmapperf COUNT FILE [avl|wavl] [pool]\n");
         exit(2);
     }
+    CdsMapBalancing balancing = CDSMAP_BALANCING_AVL;
+    bool pool = false;
+    for (int i = 3; i < argc; i++) {
+        if (strcmp(argv[i], "wavl") == 0) {
+            balancing = CDSMAP_BALANCING_WAVL;
+        } else if (strcmp(argv[i], "avl") == 0) {
+            balancing = CDSMAP_BALANCING_AVL;
+        } else if (strcmp(argv[i], "pool") == 0) {
+            pool = true;
+        } else {
+            fprintf(stderr, "Invalid argument: '%s'\n", argv[i]);
+            exit(2);
+        }
+    }
     long long count;
     if (sscanf(argv[1], "%lld", &count) != 1) {
         fprintf(stderr, "Invalid COUNT argument: '%s'\n", argv[1]);
@@ -121,13 +161,32 @@ int main(int argc, char** argv)
     }
     close(fd);
 
-    CdsMap* map = CdsMapCreate(NULL, 0, keyCmp, NULL, keyUnref, myItemUnref);
+    if (pool) {
+        gItemPool = CdsPoolCreate("items", sizeof(MyItem), 0, false);
+        gKeyPool = CdsPoolCreate("keys", KEYSIZE_B, 0, false);
+    }
+
+    CdsMap* map = CdsMapCreateWithBalancing(NULL, 0, balancing, keyCmp, NULL,
+            keyUnref, myItemUnref);
 
     printf("Inserting %lld items\n", count);
     for (long long i = 0; i < count; i++) {
         addItem(map, numbers[i]);
     }
 
+    // NB: Statistics are only available if the library has been compiled with
+    // `STATS=1`
+    CdsMapStats stats;
+    if (CdsMapGetStats(map, &stats)) {
+        printf("Height: %lld, max depth: %lld, avg depth: %.2f, "
+                "comparisons/op: %.2f\n", (long long)stats.height,
+                (long long)stats.maxDepth, stats.avgDepth,
+                stats.comparisonsPerOp);
+        printf("Rotations: LL %lld, RR %lld, LR %lld, RL %lld\n",
+                (long long)stats.rotationsLL, (long long)stats.rotationsRR,
+                (long long)stats.rotationsLR, (long long)stats.rotationsRL);
+    }
+
     printf("Removing %lld items\n", count);
     for (long long i = count - 1; i >= 0; i--) {
         char key[KEYSIZE_B];
@@ -137,5 +196,10 @@ int main(int argc, char** argv)
 
     CDSASSERT(CdsMapSize(map) == 0);
     CdsMapDestroy(map);
+    if (pool) {
+        CdsPoolDestroy(gKeyPool);
+        CdsPoolDestroy(gItemPool);
+    }
+    free(numbers);
     return 0;
 }
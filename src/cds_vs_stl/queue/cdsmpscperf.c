@@ -0,0 +1,151 @@
+/* Copyright (c) 2016  Fabrice Triboix
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+
+#include "cdsmpsc.h"
+#include "cdsqueue.h"
+
+
+// Max # of items the consumer pops in one go
+#define POP_BATCH 64
+
+// Max # of producers
+#define MAX_PRODUCERS 64
+
+typedef union
+{
+    CdsMpscItem mpsc;
+    CdsListItem list;
+} MyItem;
+
+typedef struct
+{
+    CdsMpscQueue* mpsc;
+    CdsQueue* queue;
+    MyItem* items;
+    long long count;
+} Producer;
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + (ts.tv_nsec / 1e9);
+}
+
+static void* mpscProducer(void* arg)
+{
+    Producer* p = arg;
+    for (long long i = 0; i < p->count; i++) {
+        CdsMpscQueuePush(p->mpsc, &p->items[i].mpsc);
+    }
+    return NULL;
+}
+
+static void* queueProducer(void* arg)
+{
+    Producer* p = arg;
+    for (long long i = 0; i < p->count; i++) {
+        CDSASSERT(CdsQueuePush(p->queue, &p->items[i].list));
+    }
+    return NULL;
+}
+
+/** Push `count` items from `nproducers` threads and pop them from this thread
+ *
+ * @param items      [in,out] Items to push
+ * @param count      [in]     Number of items to push
+ * @param nproducers [in]     Number of producer threads
+ * @param lockFree   [in]     `true` to use a `CdsMpscQueue`, `false` to use a
+ *                            `CdsQueue`
+ *
+ * @return Throughput, in items per second
+ */
+static double run(MyItem* items, long long count, int nproducers,
+        bool lockFree)
+{
+    CdsMpscQueue* mpsc = CdsMpscQueueCreate(NULL, NULL);
+    CdsQueue* queue = CdsQueueCreate(NULL, 0, NULL);
+    Producer producers[MAX_PRODUCERS];
+    pthread_t threads[MAX_PRODUCERS];
+    long long perThread = count / nproducers;
+    long long total = perThread * nproducers;
+
+    double start = now_s();
+    for (int i = 0; i < nproducers; i++) {
+        producers[i].mpsc = mpsc;
+        producers[i].queue = queue;
+        producers[i].items = items + (i * perThread);
+        producers[i].count = perThread;
+        CDSASSERT_ALWAYS(pthread_create(&threads[i], NULL,
+                    lockFree ? mpscProducer : queueProducer,
+                    &producers[i]) == 0);
+    }
+    for (long long popped = 0; popped < total; ) {
+        if (lockFree) {
+            CdsMpscItem* batch[POP_BATCH];
+            int64_t n = CdsMpscQueuePopMany(mpsc, batch, POP_BATCH);
+            if (n == 0) {
+                sched_yield();
+            }
+            popped += n;
+        } else {
+            CdsListItem* batch[POP_BATCH];
+            popped += CdsQueuePopMany(queue, batch, POP_BATCH);
+        }
+    }
+    double elapsed_s = now_s() - start;
+    for (int i = 0; i < nproducers; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    CdsQueueDestroy(queue);
+    CdsMpscQueueDestroy(mpsc);
+    return total / elapsed_s;
+}
+
+
+int main(int argc, char** argv)
+{
+    if (argc != 2) {
+        fprintf(stderr, "Usage: ./cdsmpscperf ITEMCOUNT\n");
+        exit(2);
+    }
+    long long count;
+    if (sscanf(argv[1], "%lld", &count) != 1) {
+        fprintf(stderr, "Invalid COUNT argument: '%s'\n", argv[1]);
+        exit(2);
+    }
+    if (count < MAX_PRODUCERS) {
+        fprintf(stderr, "Invalid COUNT: %lld\n", count);
+        exit(2);
+    }
+
+    MyItem* items = CdsMallocZ(count * sizeof(*items));
+    for (int n = 1; n <= MAX_PRODUCERS; n *= 2) {
+        double lockFree = run(items, count, n, true);
+        double locked = run(items, count, n, false);
+        printf("%2d producers: lock-free %6.2f Mitems/s  "
+                "mutex %6.2f Mitems/s\n", n, lockFree / 1e6, locked / 1e6);
+    }
+    free(items);
+    return 0;
+}
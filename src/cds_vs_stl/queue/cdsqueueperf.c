@@ -0,0 +1,168 @@
+/* Copyright (c) 2016  Fabrice Triboix
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "cdsqueue.h"
+
+
+// Capacity of the queue
+#define CAPACITY 1024
+
+// Max # of items a consumer pops in one go
+#define POP_BATCH 64
+
+typedef struct
+{
+    CdsListItem item;
+    int64_t pushed_ns;
+} MyItem;
+
+typedef struct
+{
+    CdsQueue* queue;
+    MyItem* items;
+    long long count;
+    long long popped;
+    double latencySum_ns;
+    int64_t latencyMax_ns;
+} Worker;
+
+static int64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec * 1000000000LL) + ts.tv_nsec;
+}
+
+static void* producer(void* arg)
+{
+    Worker* w = arg;
+    for (long long i = 0; i < w->count; i++) {
+        w->items[i].pushed_ns = now_ns();
+        CDSASSERT(CdsQueuePush(w->queue, (CdsListItem*)&w->items[i]));
+    }
+    return NULL;
+}
+
+static void* consumer(void* arg)
+{
+    Worker* w = arg;
+    CdsListItem* items[POP_BATCH];
+    int64_t n;
+    while ((n = CdsQueuePopMany(w->queue, items, POP_BATCH)) > 0) {
+        int64_t t = now_ns();
+        for (int64_t i = 0; i < n; i++) {
+            int64_t latency_ns = t - ((MyItem*)items[i])->pushed_ns;
+            w->latencySum_ns += latency_ns;
+            if (latency_ns > w->latencyMax_ns) {
+                w->latencyMax_ns = latency_ns;
+            }
+        }
+        w->popped += n;
+    }
+    return NULL;
+}
+
+/** Run `nthreads` producers and `nthreads` consumers
+ *
+ * @param items    [in,out] Items to push
+ * @param count    [in]     Number of items to push
+ * @param nthreads [in]     Number of producers, and of consumers
+ * @param spins    [in]     Spin count of the queue
+ */
+static void run(MyItem* items, long long count, int nthreads, int spins)
+{
+    CdsQueue* queue = CdsQueueCreate(NULL, CAPACITY, NULL);
+    CdsQueueSetSpin(queue, spins);
+
+    Worker* producers = CdsMallocZ(nthreads * sizeof(*producers));
+    Worker* consumers = CdsMallocZ(nthreads * sizeof(*consumers));
+    pthread_t* threads = CdsMalloc(2 * nthreads * sizeof(*threads));
+    long long perThread = count / nthreads;
+
+    int64_t start = now_ns();
+    for (int i = 0; i < nthreads; i++) {
+        consumers[i].queue = queue;
+        CDSASSERT_ALWAYS(pthread_create(&threads[nthreads + i], NULL,
+                    consumer, &consumers[i]) == 0);
+        producers[i].queue = queue;
+        producers[i].items = items + (i * perThread);
+        producers[i].count = perThread;
+        CDSASSERT_ALWAYS(pthread_create(&threads[i], NULL, producer,
+                    &producers[i]) == 0);
+    }
+    for (int i = 0; i < nthreads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    CdsQueueClose(queue);
+    double latencySum_ns = 0.0;
+    int64_t latencyMax_ns = 0;
+    long long popped = 0;
+    for (int i = 0; i < nthreads; i++) {
+        pthread_join(threads[nthreads + i], NULL);
+        popped += consumers[i].popped;
+        latencySum_ns += consumers[i].latencySum_ns;
+        if (consumers[i].latencyMax_ns > latencyMax_ns) {
+            latencyMax_ns = consumers[i].latencyMax_ns;
+        }
+    }
+    double elapsed_s = (now_ns() - start) / 1e9;
+    CDSASSERT(popped == perThread * nthreads);
+
+    printf("%2d producers/consumers: %6.2f Mitems/s  latency avg %8.1f us  "
+            "max %8.1f us\n", nthreads, (popped / elapsed_s) / 1e6,
+            (latencySum_ns / popped) / 1e3, latencyMax_ns / 1e3);
+
+    free(threads);
+    free(consumers);
+    free(producers);
+    CdsQueueDestroy(queue);
+}
+
+
+int main(int argc, char** argv)
+{
+    if ((argc != 2) && (argc != 3)) {
+        fprintf(stderr, "Usage: ./cdsqueueperf ITEMCOUNT [SPINS]\n");
+        exit(2);
+    }
+    long long count;
+    if (sscanf(argv[1], "%lld", &count) != 1) {
+        fprintf(stderr, "Invalid COUNT argument: '%s'\n", argv[1]);
+        exit(2);
+    }
+    if (count <= 0) {
+        fprintf(stderr, "Invalid COUNT: %lld\n", count);
+        exit(2);
+    }
+    int spins = 0;
+    if ((argc == 3) && ((sscanf(argv[2], "%d", &spins) != 1) || (spins < 0))) {
+        fprintf(stderr, "Invalid SPINS argument: '%s'\n", argv[2]);
+        exit(2);
+    }
+
+    MyItem* items = CdsMallocZ(count * sizeof(*items));
+    for (int nthreads = 1; nthreads <= 8; nthreads *= 2) {
+        run(items, count, nthreads, spins);
+    }
+    free(items);
+    return 0;
+}
@@ -0,0 +1,273 @@
+/* Copyright (c) 2016  Fabrice Triboix
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** Double-ended queues
+ *
+ * @defgroup cdsdeque Deques
+ * @addtogroup cdsdeque
+ * @{
+ *
+ * A sequence of fixed-size elements stored by value in fixed-size chunks,
+ * allowing O(1) insertion and removal at both ends and O(1) random access.
+ *
+ * Unlike a `CdsList`, elements are not allocated one by one, so walking
+ * through a deque reads memory sequentially, one cache-aligned chunk at a
+ * time. To walk through a deque, use `CdsDequeRun()` or `CdsDequeRunBackward()`
+ * which give direct access to all the elements of a chunk. For example:
+ *
+ *     void* ptr;
+ *     int64_t n;
+ *     for (int64_t i = 0; (n = CdsDequeRun(deque, i, &ptr)) > 0; i += n) {
+ *         MyElement* elements = ptr;
+ *         for (int64_t j = 0; j < n; j++) {
+ *             // Do something with `elements[j]`
+ *         }
+ *     }
+ *
+ * Pointers to elements remain valid until the element is removed.
+ */
+
+#ifndef CDSDEQUE_h_
+#define CDSDEQUE_h_
+
+#include "cdscommon.h"
+
+
+
+/*----------------+
+ | Types & Macros |
+ +----------------*/
+
+
+/** Opaque type that represents a deque */
+typedef struct CdsDeque CdsDeque;
+
+
+
+/*------------------------------+
+ | Public function declarations |
+ +------------------------------*/
+
+
+/** Create a deque
+ *
+ * @param name     [in] Name for this deque; may be NULL
+ * @param capacity [in] Max # of elements the deque can store, or 0 for no
+ *                      limit
+ * @param size_B   [in] Size of an element, in bytes; must be > 0
+ *
+ * @return The newly-allocated deque, never NULL
+ */
+CdsDeque* CdsDequeCreate(const char* name, int64_t capacity, size_t size_B);
+
+
+/** Create a deque which allocates its memory from the given allocator
+ *
+ * The chunks are only aligned on a cache line when using the system
+ * allocator.
+ *
+ * @param name      [in] Name for this deque; may be NULL
+ * @param capacity  [in] Max # of elements the deque can store, or 0 for no
+ *                       limit
+ * @param size_B    [in] Size of an element, in bytes; must be > 0
+ * @param allocator [in] Allocator to use; it must remain valid until the deque
+ *                       is destroyed; NULL to use the default allocator
+ *
+ * @return The newly-allocated deque, never NULL
+ */
+CdsDeque* CdsDequeCreateWithAllocator(const char* name, int64_t capacity,
+        size_t size_B, const CdsAllocator* allocator);
+
+
+/** Destroy a deque
+ *
+ * @param deque [in,out] The deque to destroy; must not be NULL
+ */
+void CdsDequeDestroy(CdsDeque* deque);
+
+
+/** Get the deque's name
+ *
+ * @param deque [in] The deque to query; must not be NULL
+ *
+ * @return The deque's name, which may be NULL
+ */
+const char* CdsDequeName(const CdsDeque* deque);
+
+
+/** Get the number of elements currently in the deque
+ *
+ * @param deque [in] The deque to query; must not be NULL
+ */
+int64_t CdsDequeSize(const CdsDeque* deque);
+
+
+/** Get the deque's capacity
+ *
+ * @param deque [in] The deque to query; must not be NULL
+ *
+ * @return The deque capacity, or 0 if no limit
+ */
+int64_t CdsDequeCapacity(const CdsDeque* deque);
+
+
+/** Get the size of the elements stored in the deque
+ *
+ * @param deque [in] The deque to query; must not be NULL
+ *
+ * @return The size of an element, in bytes
+ */
+size_t CdsDequeElementSize(const CdsDeque* deque);
+
+
+/** Test if a deque is empty
+ *
+ * @param deque [in] The deque to query; must not be NULL
+ *
+ * @return `true` if the deque is empty, `false` otherwise
+ */
+bool CdsDequeIsEmpty(const CdsDeque* deque);
+
+
+/** Test is a deque is full
+ *
+ * This function will always return `false` if no limit has been set on the
+ * deque capacity when `CdsDequeCreate()` has been called.
+ *
+ * @param deque [in] The deque to query; must not be NULL
+ *
+ * @return `true` if the deque is full, `false` otherwise
+ */
+bool CdsDequeIsFull(const CdsDeque* deque);
+
+
+/** Copy an element at the front of the deque
+ *
+ * @param deque   [in,out] The deque where to insert the element; must not be
+ *                         NULL
+ * @param element [in]     The element to copy; must not be NULL
+ *
+ * @return `true` if success, `false` if the deque is full
+ */
+bool CdsDequePushFront(CdsDeque* deque, const void* element);
+
+
+/** Copy an element at the back of the deque
+ *
+ * @param deque   [in,out] The deque where to insert the element; must not be
+ *                         NULL
+ * @param element [in]     The element to copy; must not be NULL
+ *
+ * @return `true` if success, `false` if the deque is full
+ */
+bool CdsDequePushBack(CdsDeque* deque, const void* element);
+
+
+/** Remove the element at the front of the deque
+ *
+ * @param deque   [in,out] The deque from where to pop an element; must not be
+ *                         NULL
+ * @param element [out]    Where to copy the removed element; may be NULL
+ *
+ * @return `true` if success, `false` if the deque is empty
+ */
+bool CdsDequePopFront(CdsDeque* deque, void* element);
+
+
+/** Remove the element at the back of the deque
+ *
+ * @param deque   [in,out] The deque from where to pop an element; must not be
+ *                         NULL
+ * @param element [out]    Where to copy the removed element; may be NULL
+ *
+ * @return `true` if success, `false` if the deque is empty
+ */
+bool CdsDequePopBack(CdsDeque* deque, void* element);
+
+
+/** Get the element at the given index
+ *
+ * @param deque [in] The deque to query; must not be NULL
+ * @param index [in] Index of the element, 0 being the front of the deque
+ *
+ * @return A pointer to the element, or NULL if `index` is out of range
+ */
+void* CdsDequeAt(const CdsDeque* deque, int64_t index);
+
+
+/** Get the element at the front of the deque
+ *
+ * @param deque [in] The deque to query; must not be NULL
+ *
+ * @return A pointer to the element, or NULL if the deque is empty
+ */
+void* CdsDequeFront(const CdsDeque* deque);
+
+
+/** Get the element at the back of the deque
+ *
+ * @param deque [in] The deque to query; must not be NULL
+ *
+ * @return A pointer to the element, or NULL if the deque is empty
+ */
+void* CdsDequeBack(const CdsDeque* deque);
+
+
+/** Get the elements stored contiguously from the given index
+ *
+ * To walk through the deque forwards, call this function with `index` 0, then
+ * with `index` incremented by the returned value, and so on.
+ *
+ * @param deque    [in]  The deque to query; must not be NULL
+ * @param index    [in]  Index of the first element
+ * @param elements [out] Where to write the address of the element at `index`;
+ *                       must not be NULL
+ *
+ * @return The number of contiguous elements from `index`, which is at least 1
+ *         unless `index` is out of range, in which case 0 is returned
+ */
+int64_t CdsDequeRun(const CdsDeque* deque, int64_t index, void** elements);
+
+
+/** Get the elements stored contiguously up to the given index
+ *
+ * To walk through the deque backwards, call this function with `index` being
+ * the index of the back element, then with `index` decremented by the returned
+ * value, and so on.
+ *
+ * @param deque    [in]  The deque to query; must not be NULL
+ * @param index    [in]  Index of the last element
+ * @param elements [out] Where to write the address of the first contiguous
+ *                       element, i.e. the element at `index` is at
+ *                       `elements + (n - 1) * size_B`
+ *
+ * @return The number of contiguous elements `n` up to `index`, which is at
+ *         least 1 unless `index` is out of range, in which case 0 is returned
+ */
+int64_t CdsDequeRunBackward(const CdsDeque* deque, int64_t index,
+        void** elements);
+
+
+/** Remove all elements from the deque
+ *
+ * @param deque [in,out] The deque to clear; must not be NULL
+ */
+void CdsDequeClear(CdsDeque* deque);
+
+
+
+#endif /* CDSDEQUE_h_ */
+/* @} */
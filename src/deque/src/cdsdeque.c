@@ -0,0 +1,427 @@
+/* Copyright (c) 2016  Fabrice Triboix
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cdsdeque.h"
+#include <stdlib.h>
+#include <string.h>
+
+
+
+/*----------------+
+ | Macros & Types |
+ +----------------*/
+
+
+/** Minimum size of a chunk, in bytes */
+#define CDSDEQUE_CHUNK_MIN_B 1024
+
+/** Minimum number of elements in a chunk */
+#define CDSDEQUE_CHUNK_MIN_ELEMENTS 8
+
+/** Alignment of the chunks */
+#define CDSDEQUE_CACHE_LINE 64
+
+/** Initial number of entries in the map of chunks */
+#define CDSDEQUE_MAP_MIN 8
+
+
+struct CdsDeque
+{
+    char*               name;
+    int64_t             size;
+    int64_t             capacity;
+    size_t              size_B;
+    int                 shift; // log2 of the # of elements in a chunk
+    int64_t             mask;  // # of elements in a chunk - 1
+    char**              map;   // Chunks, in order; unused entries are NULL
+    int64_t             nmap;  // # of entries in `map`
+    int64_t             first; // Position of the front element in the map
+    char*               spare; // A free chunk kept for later, or NULL
+    const CdsAllocator* allocator;
+};
+
+
+
+/*-------------------------------+
+ | Private function declarations |
+ +-------------------------------*/
+
+
+/** Get the address of the element at the given position
+ *
+ * @param deque [in] The deque
+ * @param pos   [in] Position of the element in the map, i.e. the index of the
+ *                   chunk times the number of elements per chunk, plus the
+ *                   index of the element within the chunk
+ *
+ * @return The address of the element
+ */
+static inline char* cdsDequeElement(const CdsDeque* deque, int64_t pos)
+{
+    return deque->map[pos >> deque->shift]
+        + ((pos & deque->mask) * deque->size_B);
+}
+
+
+/** Make sure there is a chunk at the given map entry
+ *
+ * @param deque [in,out] The deque
+ * @param index [in]     Index of the map entry
+ */
+static void cdsDequeAddChunk(CdsDeque* deque, int64_t index);
+
+
+/** Free the chunk at the given map entry
+ *
+ * @param deque [in,out] The deque
+ * @param index [in]     Index of the map entry
+ */
+static void cdsDequeRemoveChunk(CdsDeque* deque, int64_t index);
+
+
+/** Grow the map and center the chunks in use
+ *
+ * @param deque [in,out] The deque
+ */
+static void cdsDequeGrowMap(CdsDeque* deque);
+
+
+
+/*---------------------------------+
+ | Public function implementations |
+ +---------------------------------*/
+
+
+CdsDeque* CdsDequeCreate(const char* name, int64_t capacity, size_t size_B)
+{
+    return CdsDequeCreateWithAllocator(name, capacity, size_B, NULL);
+}
+
+
+CdsDeque* CdsDequeCreateWithAllocator(const char* name, int64_t capacity,
+        size_t size_B, const CdsAllocator* allocator)
+{
+    CDSASSERT(size_B > 0);
+
+    if (allocator == NULL) {
+        allocator = CdsDefaultAllocator();
+    }
+    CdsDeque* deque = CdsAllocZ(allocator, sizeof(*deque));
+
+    deque->allocator = allocator;
+    deque->name = CdsStrdup(allocator, name);
+    if (capacity > 0) {
+        deque->capacity = capacity;
+    }
+    deque->size_B = size_B;
+
+    // NB: The number of elements in a chunk is a power of 2, so the position
+    // of an element can be found with a shift and a mask
+    deque->shift = 0;
+    while (    ((1 << deque->shift) < CDSDEQUE_CHUNK_MIN_ELEMENTS)
+            || (((size_t)1 << deque->shift) * size_B < CDSDEQUE_CHUNK_MIN_B)) {
+        deque->shift++;
+    }
+    deque->mask = ((int64_t)1 << deque->shift) - 1;
+    deque->nmap = CDSDEQUE_MAP_MIN;
+    deque->map = CdsAllocZ(allocator, deque->nmap * sizeof(*deque->map));
+    deque->first = (deque->nmap / 2) << deque->shift;
+
+    return deque;
+}
+
+
+void CdsDequeDestroy(CdsDeque* deque)
+{
+    CDSASSERT_FULL(deque != NULL);
+    CdsDequeClear(deque);
+    CdsFree(deque->allocator, deque->spare);
+    CdsFree(deque->allocator, deque->map);
+    CdsFree(deque->allocator, deque->name);
+    CdsFree(deque->allocator, deque);
+}
+
+
+const char* CdsDequeName(const CdsDeque* deque)
+{
+    CDSASSERT_FULL(deque != NULL);
+    return deque->name;
+}
+
+
+int64_t CdsDequeSize(const CdsDeque* deque)
+{
+    CDSASSERT_FULL(deque != NULL);
+    return deque->size;
+}
+
+
+int64_t CdsDequeCapacity(const CdsDeque* deque)
+{
+    CDSASSERT_FULL(deque != NULL);
+    return deque->capacity;
+}
+
+
+size_t CdsDequeElementSize(const CdsDeque* deque)
+{
+    CDSASSERT_FULL(deque != NULL);
+    return deque->size_B;
+}
+
+
+bool CdsDequeIsEmpty(const CdsDeque* deque)
+{
+    CDSASSERT_FULL(deque != NULL);
+    return deque->size <= 0;
+}
+
+
+bool CdsDequeIsFull(const CdsDeque* deque)
+{
+    CDSASSERT_FULL(deque != NULL);
+    return (deque->capacity > 0) && (deque->size >= deque->capacity);
+}
+
+
+bool CdsDequePushFront(CdsDeque* deque, const void* element)
+{
+    CDSASSERT_FULL(element != NULL);
+
+    if (CdsDequeIsFull(deque)) {
+        return false;
+    }
+    if (deque->first == 0) {
+        cdsDequeGrowMap(deque);
+    }
+    int64_t pos = deque->first - 1;
+    if ((pos & deque->mask) == deque->mask) {
+        cdsDequeAddChunk(deque, pos >> deque->shift);
+    }
+    memcpy(cdsDequeElement(deque, pos), element, deque->size_B);
+    deque->first = pos;
+    deque->size++;
+    return true;
+}
+
+
+bool CdsDequePushBack(CdsDeque* deque, const void* element)
+{
+    CDSASSERT_FULL(element != NULL);
+
+    if (CdsDequeIsFull(deque)) {
+        return false;
+    }
+    if ((deque->first + deque->size) >= (deque->nmap << deque->shift)) {
+        cdsDequeGrowMap(deque);
+    }
+    int64_t pos = deque->first + deque->size;
+    if ((pos & deque->mask) == 0) {
+        cdsDequeAddChunk(deque, pos >> deque->shift);
+    }
+    memcpy(cdsDequeElement(deque, pos), element, deque->size_B);
+    deque->size++;
+    return true;
+}
+
+
+bool CdsDequePopFront(CdsDeque* deque, void* element)
+{
+    if (CdsDequeIsEmpty(deque)) {
+        return false;
+    }
+    int64_t pos = deque->first;
+    if (element != NULL) {
+        memcpy(element, cdsDequeElement(deque, pos), deque->size_B);
+    }
+    deque->first++;
+    deque->size--;
+    if ((deque->size == 0) || ((deque->first & deque->mask) == 0)) {
+        cdsDequeRemoveChunk(deque, pos >> deque->shift);
+    }
+    return true;
+}
+
+
+bool CdsDequePopBack(CdsDeque* deque, void* element)
+{
+    if (CdsDequeIsEmpty(deque)) {
+        return false;
+    }
+    int64_t pos = deque->first + deque->size - 1;
+    if (element != NULL) {
+        memcpy(element, cdsDequeElement(deque, pos), deque->size_B);
+    }
+    deque->size--;
+    if ((deque->size == 0) || ((pos & deque->mask) == 0)) {
+        cdsDequeRemoveChunk(deque, pos >> deque->shift);
+    }
+    return true;
+}
+
+
+void* CdsDequeAt(const CdsDeque* deque, int64_t index)
+{
+    CDSASSERT_FULL(deque != NULL);
+    if ((index < 0) || (index >= deque->size)) {
+        return NULL;
+    }
+    return cdsDequeElement(deque, deque->first + index);
+}
+
+
+void* CdsDequeFront(const CdsDeque* deque)
+{
+    return CdsDequeAt(deque, 0);
+}
+
+
+void* CdsDequeBack(const CdsDeque* deque)
+{
+    CDSASSERT_FULL(deque != NULL);
+    return CdsDequeAt(deque, deque->size - 1);
+}
+
+
+int64_t CdsDequeRun(const CdsDeque* deque, int64_t index, void** elements)
+{
+    CDSASSERT_FULL(deque != NULL);
+    CDSASSERT_FULL(elements != NULL);
+
+    if ((index < 0) || (index >= deque->size)) {
+        return 0;
+    }
+    int64_t pos = deque->first + index;
+    int64_t n = (deque->mask + 1) - (pos & deque->mask);
+    if (n > (deque->size - index)) {
+        n = deque->size - index;
+    }
+    *elements = cdsDequeElement(deque, pos);
+    return n;
+}
+
+
+int64_t CdsDequeRunBackward(const CdsDeque* deque, int64_t index,
+        void** elements)
+{
+    CDSASSERT_FULL(deque != NULL);
+    CDSASSERT_FULL(elements != NULL);
+
+    if ((index < 0) || (index >= deque->size)) {
+        return 0;
+    }
+    int64_t pos = deque->first + index;
+    int64_t n = (pos & deque->mask) + 1;
+    if (n > (index + 1)) {
+        n = index + 1;
+    }
+    *elements = cdsDequeElement(deque, pos - n + 1);
+    return n;
+}
+
+
+void CdsDequeClear(CdsDeque* deque)
+{
+    CDSASSERT_FULL(deque != NULL);
+
+    for (int64_t i = 0; i < deque->nmap; i++) {
+        if (deque->map[i] != NULL) {
+            if (deque->spare == NULL) {
+                deque->spare = deque->map[i];
+            } else {
+                CdsFree(deque->allocator, deque->map[i]);
+            }
+            deque->map[i] = NULL;
+        }
+    }
+    deque->size = 0;
+    deque->first = (deque->nmap / 2) << deque->shift;
+}
+
+
+
+/*----------------------------------+
+ | Private function implementations |
+ +----------------------------------*/
+
+
+static void cdsDequeAddChunk(CdsDeque* deque, int64_t index)
+{
+    CDSASSERT((index >= 0) && (index < deque->nmap));
+    CDSASSERT(deque->map[index] == NULL);
+
+    char* chunk = deque->spare;
+    deque->spare = NULL;
+    if (chunk == NULL) {
+        size_t chunk_B = (size_t)(deque->mask + 1) * deque->size_B;
+        if (deque->allocator == CdsSystemAllocator()) {
+            // NB: Align the chunks ourselves, the allocator interface does
+            // not allow it
+            void* ptr = NULL;
+            if (posix_memalign(&ptr, CDSDEQUE_CACHE_LINE, chunk_B) != 0) {
+                CDSPANIC_MSG("Failed to allocate a chunk of %zu bytes",
+                        chunk_B);
+            }
+            chunk = ptr;
+        } else {
+            chunk = CdsAlloc(deque->allocator, chunk_B);
+        }
+    }
+    deque->map[index] = chunk;
+}
+
+
+static void cdsDequeRemoveChunk(CdsDeque* deque, int64_t index)
+{
+    char* chunk = deque->map[index];
+    CDSASSERT_FULL(chunk != NULL);
+
+    deque->map[index] = NULL;
+    if (deque->spare == NULL) {
+        deque->spare = chunk;
+    } else {
+        CdsFree(deque->allocator, chunk);
+    }
+
+    if (deque->size == 0) {
+        deque->first = (deque->nmap / 2) << deque->shift;
+    }
+}
+
+
+static void cdsDequeGrowMap(CdsDeque* deque)
+{
+    int64_t firstChunk = deque->first >> deque->shift;
+    int64_t nchunks = 0;
+    if (deque->size > 0) {
+        int64_t lastChunk = (deque->first + deque->size - 1) >> deque->shift;
+        nchunks = lastChunk - firstChunk + 1;
+    }
+
+    // NB: Leave room for at least as many chunks on each side
+    int64_t nmap = deque->nmap * 2;
+    while (nmap < (3 * (nchunks + 1))) {
+        nmap *= 2;
+    }
+    char** map = CdsAllocZ(deque->allocator, nmap * sizeof(*map));
+    int64_t start = (nmap - nchunks) / 2;
+    memcpy(map + start, deque->map + firstChunk, nchunks * sizeof(*map));
+
+    CdsFree(deque->allocator, deque->map);
+    deque->map = map;
+    deque->nmap = nmap;
+    deque->first = (start << deque->shift) + (deque->first & deque->mask);
+}
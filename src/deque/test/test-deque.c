@@ -0,0 +1,193 @@
+/* Copyright (c) 2016  Fabrice Triboix
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cdsdeque.h"
+#include "rttest.h"
+
+#include <string.h>
+
+
+typedef struct {
+    int  x;
+    char tag[4];
+} TestElement;
+
+static CdsDeque* gDeque = NULL;
+
+// Check the elements of a deque, with all the ways to access them
+static bool testCheckDeque(CdsDeque* deque, int first, int count)
+{
+    if (CdsDequeSize(deque) != count) {
+        return false;
+    }
+    for (int i = 0; i < count; i++) {
+        if (((TestElement*)CdsDequeAt(deque, i))->x != first + i) {
+            return false;
+        }
+    }
+    if (count > 0) {
+        if (    (CdsDequeFront(deque) != CdsDequeAt(deque, 0))
+             || (CdsDequeBack(deque) != CdsDequeAt(deque, count - 1))) {
+            return false;
+        }
+    }
+
+    int64_t n;
+    int64_t total = 0;
+    void* ptr;
+    for (int64_t index = 0; (n = CdsDequeRun(deque, index, &ptr)) > 0;
+            index += n) {
+        for (int64_t j = 0; j < n; j++) {
+            if (((TestElement*)ptr)[j].x != first + index + j) {
+                return false;
+            }
+        }
+        total += n;
+    }
+    if (total != count) {
+        return false;
+    }
+    for (int64_t index = count - 1;
+            (n = CdsDequeRunBackward(deque, index, &ptr)) > 0; index -= n) {
+        for (int64_t j = 0; j < n; j++) {
+            if (((TestElement*)ptr)[j].x != first + index - n + 1 + j) {
+                return false;
+            }
+        }
+        total -= n;
+    }
+    return total == 0;
+}
+
+
+RTT_GROUP_START(TestCdsDeque, 0x000a0001u, NULL, NULL)
+
+RTT_TEST_START(cds_should_create_deque)
+{
+    gDeque = CdsDequeCreate("Deque", 0, sizeof(TestElement));
+    RTT_ASSERT(gDeque != NULL);
+    RTT_EXPECT(strcmp(CdsDequeName(gDeque), "Deque") == 0);
+    RTT_EXPECT(CdsDequeCapacity(gDeque) == 0);
+    RTT_EXPECT(CdsDequeElementSize(gDeque) == sizeof(TestElement));
+    RTT_EXPECT(CdsDequeIsEmpty(gDeque));
+    RTT_EXPECT(!CdsDequeIsFull(gDeque));
+    RTT_EXPECT(CdsDequeFront(gDeque) == NULL);
+    RTT_EXPECT(CdsDequeBack(gDeque) == NULL);
+    RTT_EXPECT(CdsDequeAt(gDeque, 0) == NULL);
+    RTT_EXPECT(!CdsDequePopFront(gDeque, NULL));
+    RTT_EXPECT(!CdsDequePopBack(gDeque, NULL));
+    RTT_EXPECT(testCheckDeque(gDeque, 0, 0));
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_push_elements_at_both_ends)
+{
+    // Enough elements to span many chunks and to grow the map
+    TestElement element;
+    memset(&element, 0, sizeof(element));
+    for (int i = 0; i < 5000; i++) {
+        element.x = 5000 + i;
+        RTT_ASSERT(CdsDequePushBack(gDeque, &element));
+        element.x = 4999 - i;
+        RTT_ASSERT(CdsDequePushFront(gDeque, &element));
+    }
+    RTT_EXPECT(testCheckDeque(gDeque, 0, 10000));
+    RTT_EXPECT(((TestElement*)CdsDequeAt(gDeque, 1234))->x == 1234);
+    RTT_EXPECT(CdsDequeAt(gDeque, 10000) == NULL);
+    RTT_EXPECT(CdsDequeAt(gDeque, -1) == NULL);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_pop_elements_at_both_ends)
+{
+    TestElement element;
+    for (int i = 0; i < 3000; i++) {
+        RTT_ASSERT(CdsDequePopFront(gDeque, &element));
+        RTT_EXPECT(element.x == i);
+        RTT_ASSERT(CdsDequePopBack(gDeque, &element));
+        RTT_EXPECT(element.x == 9999 - i);
+    }
+    RTT_EXPECT(testCheckDeque(gDeque, 3000, 4000));
+
+    // Use the deque as a FIFO, so it moves through the map
+    for (int i = 0; i < 20000; i++) {
+        element.x = 7000 + i;
+        RTT_ASSERT(CdsDequePushBack(gDeque, &element));
+        RTT_ASSERT(CdsDequePopFront(gDeque, NULL));
+    }
+    RTT_EXPECT(testCheckDeque(gDeque, 23000, 4000));
+
+    while (CdsDequePopBack(gDeque, NULL)) {
+    }
+    RTT_EXPECT(testCheckDeque(gDeque, 0, 0));
+
+    element.x = 1;
+    RTT_ASSERT(CdsDequePushFront(gDeque, &element));
+    element.x = 2;
+    RTT_ASSERT(CdsDequePushBack(gDeque, &element));
+    RTT_EXPECT(testCheckDeque(gDeque, 1, 2));
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_not_push_into_full_deque)
+{
+    CdsDeque* deque = CdsDequeCreate(NULL, 3, sizeof(TestElement));
+    TestElement element;
+    memset(&element, 0, sizeof(element));
+    for (int i = 0; i < 3; i++) {
+        element.x = i;
+        RTT_ASSERT(CdsDequePushBack(deque, &element));
+    }
+    RTT_EXPECT(CdsDequeIsFull(deque));
+    RTT_EXPECT(!CdsDequePushBack(deque, &element));
+    RTT_EXPECT(!CdsDequePushFront(deque, &element));
+    RTT_EXPECT(testCheckDeque(deque, 0, 3));
+    CdsDequeDestroy(deque);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_store_large_elements)
+{
+    char buffer[3000];
+    CdsDeque* deque = CdsDequeCreate(NULL, 0, sizeof(buffer));
+    for (int i = 0; i < 20; i++) {
+        memset(buffer, i, sizeof(buffer));
+        RTT_ASSERT(CdsDequePushFront(deque, buffer));
+    }
+    for (int i = 0; i < 20; i++) {
+        char* element = CdsDequeAt(deque, i);
+        RTT_EXPECT((element[0] == 19 - i) && (element[2999] == 19 - i));
+    }
+    CdsDequeDestroy(deque);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_destroy_deque)
+{
+    CdsDequeClear(gDeque);
+    RTT_EXPECT(CdsDequeIsEmpty(gDeque));
+    CdsDequeDestroy(gDeque);
+    gDeque = NULL;
+}
+RTT_TEST_END
+
+RTT_GROUP_END(TestCdsDeque,
+        cds_should_create_deque,
+        cds_should_push_elements_at_both_ends,
+        cds_should_pop_elements_at_both_ends,
+        cds_should_not_push_into_full_deque,
+        cds_should_store_large_elements,
+        cds_should_destroy_deque)
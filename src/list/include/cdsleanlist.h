@@ -0,0 +1,355 @@
+/* Copyright (c) 2016  Fabrice Triboix
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** Lean double-linked lists
+ *
+ * @defgroup cdsleanlist Lean lists
+ * @addtogroup cdsleanlist
+ * @{
+ *
+ * Double-linked lists with a 16-byte item. Unlike `CdsListItem`, a
+ * `CdsLeanListItem` has no pointer back to its list, so all the functions that
+ * take an item also take the list the item belongs to. Passing the wrong list
+ * results in undefined behaviour.
+ *
+ * Not having a back-pointer saves 8 bytes and one store per item, and allows
+ * to move any number of items from one list to another in O(1).
+ */
+
+#ifndef CDSLEANLIST_h_
+#define CDSLEANLIST_h_
+
+#include "cdscommon.h"
+#include "cdsleanlist_private.h"
+
+
+
+/*----------------+
+ | Types & Macros |
+ +----------------*/
+
+
+/** Opaque type that represents a lean list */
+typedef struct CdsLeanList CdsLeanList;
+
+
+/** Lean list item
+ *
+ * You can "derive" from this structure, as long as it remains at the top of
+ * your own structure definition. For example:
+ *
+ *     typedef struct {
+ *         CdsLeanListItem cdsLeanListItem;
+ *         int x;
+ *         float y;
+ *         char* z;
+ *     } MyItem;
+ */
+typedef struct CdsLeanListItem CdsLeanListItem;
+
+
+/** Prototype of a function to remove a reference to an item
+ *
+ * This function should decrement the internal reference counter of the item by
+ * one. If the reference counter of the item drops to 0, the item is not
+ * referenced anymore and must be freed.
+ */
+typedef void (*CdsLeanListItemUnref)(CdsLeanListItem* item);
+
+
+/** Macro to walk through a lean list */
+#define CDSLEANLIST_FOREACH(_list, _type, _iter) \
+    for (   _type* _iter = (_type*)CdsLeanListFront(_list); \
+            _iter != NULL; \
+            _iter = (_type*)CdsLeanListNext((_list), (CdsLeanListItem*)_iter) )
+
+
+/** Macro to walk through a lean list backwards */
+#define CDSLEANLIST_FOREACH_REVERSE(_list, _type, _iter) \
+    for (   _type* _iter = (_type*)CdsLeanListBack(_list); \
+            _iter != NULL; \
+            _iter = (_type*)CdsLeanListPrev((_list), (CdsLeanListItem*)_iter) )
+
+
+
+/*------------------------------+
+ | Public function declarations |
+ +------------------------------*/
+
+
+/** Create a lean list
+ *
+ * @param name     [in] Name for this list; may be NULL
+ * @param capacity [in] Max # of items the list can store, or 0 for no limit
+ * @param unref    [in] Function to remove a reference to a list item; may be
+ *                      NULL if you don't need it
+ *
+ * @return The newly-allocated list, never NULL
+ */
+CdsLeanList* CdsLeanListCreate(const char* name, int64_t capacity,
+        CdsLeanListItemUnref unref);
+
+
+/** Create a lean list which allocates its memory from the given allocator
+ *
+ * Only the memory of the list itself comes from `allocator`; the items are
+ * allocated by you.
+ *
+ * @param name      [in] Name for this list; may be NULL
+ * @param capacity  [in] Max # of items the list can store, or 0 for no limit
+ * @param unref     [in] Function to remove a reference to a list item; may be
+ *                       NULL if you don't need it
+ * @param allocator [in] Allocator to use; it must remain valid until the list
+ *                       is destroyed; NULL to use the default allocator
+ *
+ * @return The newly-allocated list, never NULL
+ */
+CdsLeanList* CdsLeanListCreateWithAllocator(const char* name, int64_t capacity,
+        CdsLeanListItemUnref unref, const CdsAllocator* allocator);
+
+
+/** Destroy a lean list
+ *
+ * Any item in the list will be unreferenced.
+ *
+ * @param list [in,out] The list to destroy; must not be NULL.
+ */
+void CdsLeanListDestroy(CdsLeanList* list);
+
+
+/** Get the list's name
+ *
+ * @param list [in] The list to query; must not be NULL
+ *
+ * @return The list's name, which may be NULL
+ */
+const char* CdsLeanListName(const CdsLeanList* list);
+
+
+/** Get the number of items currently in the list
+ *
+ * @param list [in] The list to query; must not be NULL
+ */
+int64_t CdsLeanListSize(const CdsLeanList* list);
+
+
+/** Get the list's capacity
+ *
+ * @param list [in] The list to query; must not be NULL
+ *
+ * @return The list capacity, or 0 if no limit
+ */
+int64_t CdsLeanListCapacity(const CdsLeanList* list);
+
+
+/** Test if a list is empty
+ *
+ * @param list [in] The list to query; must not be NULL
+ *
+ * @return `true` if the list is empty, `false` otherwise
+ */
+bool CdsLeanListIsEmpty(const CdsLeanList* list);
+
+
+/** Test is a list is full
+ *
+ * This function will always return `false` if no limit has been set on the list
+ * capacity when `CdsLeanListCreate()` has been called.
+ *
+ * @param list [in] The list to query; must not be NULL
+ *
+ * @return `true` if the list is full, `false` otherwise
+ */
+bool CdsLeanListIsFull(const CdsLeanList* list);
+
+
+/** Insert an item at the front of the list
+ *
+ * The ownership of `item` will be transferred to `list`.
+ *
+ * @param list [in,out] The list where to insert the item; must not be NULL
+ * @param item [in,out] The item to insert; must not be NULL
+ *
+ * @return `true` if success, `false` if the list is full
+ */
+bool CdsLeanListPushFront(CdsLeanList* list, CdsLeanListItem* item);
+
+
+/** Insert an item at the back of the list
+ *
+ * The ownership of `item` will be transferred to `list`.
+ *
+ * @param list [in,out] The list where to insert the item; must not be NULL
+ * @param item [in,out] The item to insert; must not be NULL
+ *
+ * @return `true` if success, `false` if the list is full
+ */
+bool CdsLeanListPushBack(CdsLeanList* list, CdsLeanListItem* item);
+
+
+/** Insert an item after the given item
+ *
+ * The ownership of `item` will be transferred to `list`.
+ *
+ * @param list [in,out] The list `pos` belongs to; must not be NULL
+ * @param pos  [in,out] Item after which to insert new item; must not be NULL
+ * @param item [in,out] The item to insert; must not be NULL
+ *
+ * @return `true` if success, `false` if the list is full
+ */
+bool CdsLeanListInsertAfter(CdsLeanList* list, CdsLeanListItem* pos,
+        CdsLeanListItem* item);
+
+
+/** Insert an item before the given item
+ *
+ * The ownership of `item` will be transferred to `list`.
+ *
+ * @param list [in,out] The list `pos` belongs to; must not be NULL
+ * @param pos  [in,out] Item before which to insert new item; must not be NULL
+ * @param item [in,out] The item to insert; must not be NULL
+ *
+ * @return `true` if success, `false` if the list is full
+ */
+bool CdsLeanListInsertBefore(CdsLeanList* list, CdsLeanListItem* pos,
+        CdsLeanListItem* item);
+
+
+/** Get the item at the front of the list
+ *
+ * The item is not removed from the list.
+ *
+ * @param list [in] The list to query; must not be NULL
+ *
+ * @return The item at the front of the list, or NULL if the list is empty
+ */
+CdsLeanListItem* CdsLeanListFront(const CdsLeanList* list);
+
+
+/** Get the item at the back of the list
+ *
+ * The item is not removed from the list.
+ *
+ * @param list [in] The list to query; must not be NULL
+ *
+ * @return The item at the back of the list, or NULL if the list is empty
+ */
+CdsLeanListItem* CdsLeanListBack(const CdsLeanList* list);
+
+
+/** Get the next item in the list
+ *
+ * @param list [in] The list `pos` belongs to; must not be NULL
+ * @param pos  [in] Position item; must not be NULL
+ *
+ * @return The item after `pos`, or NULL if no more items
+ */
+CdsLeanListItem* CdsLeanListNext(const CdsLeanList* list,
+        const CdsLeanListItem* pos);
+
+
+/** Get the previous item in the list
+ *
+ * @param list [in] The list `pos` belongs to; must not be NULL
+ * @param pos  [in] Position item; must not be NULL
+ *
+ * @return The item before `pos`, or NULL if no more items
+ */
+CdsLeanListItem* CdsLeanListPrev(const CdsLeanList* list,
+        const CdsLeanListItem* pos);
+
+
+/** Remove the given item from the list
+ *
+ * The ownership of the `item` will be transferred to you.
+ *
+ * @param list [in,out] The list `item` belongs to; must not be NULL
+ * @param item [in,out] The item to remove from the list; must not be NULL
+ */
+void CdsLeanListRemove(CdsLeanList* list, CdsLeanListItem* item);
+
+
+/** Pop an item at the front of the list
+ *
+ * @param list [in,out] The list from where to pop an item; must not be NULL
+ *
+ * @return The popped item, or NULL if list is empty
+ */
+CdsLeanListItem* CdsLeanListPopFront(CdsLeanList* list);
+
+
+/** Pop an item at the back of the list
+ *
+ * @param list [in,out] The list from where to pop an item; must not be NULL
+ *
+ * @return The popped item, or NULL if list is empty
+ */
+CdsLeanListItem* CdsLeanListPopBack(CdsLeanList* list);
+
+
+/** Remove all items from the list
+ *
+ * All items in the list will be unreferenced.
+ *
+ * @param list [in,out] The list to clear of all its items; must not be NULL
+ */
+void CdsLeanListClear(CdsLeanList* list);
+
+
+/** Move all the items of a list into another list, in O(1)
+ *
+ * The items of `src` are inserted after `pos` in `dst`, in the same order, and
+ * `src` is left empty. Nothing is unreferenced.
+ *
+ * @param dst [in,out] List where to move the items; must not be NULL
+ * @param pos [in,out] Item of `dst` after which to insert the items; NULL to
+ *                     insert them at the front of `dst`
+ * @param src [in,out] List to move the items from; must not be NULL and must
+ *                     not be `dst`
+ *
+ * @return `true` if success, `false` if `dst` does not have enough capacity, in
+ *         which case nothing is moved
+ */
+bool CdsLeanListSplice(CdsLeanList* dst, CdsLeanListItem* pos,
+        CdsLeanList* src);
+
+
+/** Move a range of items into another list, in O(1)
+ *
+ * The items from `first` to `last` (both included) are removed from `src` and
+ * inserted after `pos` in `dst`, in the same order. `dst` may be `src`, as
+ * long as `pos` is not in the range.
+ *
+ * @param dst   [in,out] List where to move the items; must not be NULL
+ * @param pos   [in,out] Item of `dst` after which to insert the items; NULL to
+ *                       insert them at the front of `dst`
+ * @param src   [in,out] List `first` and `last` belong to; must not be NULL
+ * @param first [in,out] First item to move; must not be NULL
+ * @param last  [in,out] Last item to move; must not be NULL and must be
+ *                       `first` or come after `first`
+ * @param count [in]     Number of items from `first` to `last`
+ *
+ * @return `true` if success, `false` if `dst` does not have enough capacity, in
+ *         which case nothing is moved
+ */
+bool CdsLeanListSpliceRange(CdsLeanList* dst, CdsLeanListItem* pos,
+        CdsLeanList* src, CdsLeanListItem* first, CdsLeanListItem* last,
+        int64_t count);
+
+
+
+#endif /* CDSLEANLIST_h_ */
+/* @} */
@@ -66,6 +66,44 @@ typedef struct CdsListItem CdsListItem;
 typedef void (*CdsListItemUnref)(CdsListItem* item);
 
 
+/** Prototype of a function to remove a reference to many items in one go
+ *
+ * This is the same as calling a `CdsListItemUnref` function on each item, but
+ * allows an allocator to release memory in bulk.
+ *
+ * @param items [in,out] Items to unreference
+ * @param count [in]     Number of items in `items`
+ */
+typedef void (*CdsListItemUnrefBatch)(CdsListItem** items, int64_t count);
+
+
+/** Prototype of a function to compare two list items
+ *
+ * @param left   [in] Left-hand side of the comparison
+ * @param right  [in] Right-hand side of the comparison
+ * @param cookie [in] Cookie for this function
+ *
+ * @return A negative value if `left` < `right`, 0 if `left` == `right` or a
+ *         positive value if `left` > `right`
+ */
+typedef int (*CdsListCompare)(const CdsListItem* left,
+        const CdsListItem* right, void* cookie);
+
+
+/** Prototype of a function to visit a batch of list items
+ *
+ * @param items  [in,out] Items to visit, in order
+ * @param count  [in]     Number of items in `items`
+ * @param cookie [in]     Cookie for this function
+ */
+typedef void (*CdsListVisitBatch)(CdsListItem** items, int64_t count,
+        void* cookie);
+
+
+/** Max # of items in a batch for `CdsListForEachBatch()` */
+#define CDSLIST_VISIT_BATCH_MAX 256
+
+
 /** Macro to walk through a list */
 #define CDSLIST_FOREACH(_list, _type, _iter) \
     for (   _type* _iter = (_type*)CdsListFront(_list); \
@@ -73,6 +111,18 @@ typedef void (*CdsListItemUnref)(CdsListItem* item);
             _iter = (_type*)CdsListNext((CdsListItem*)_iter) )
 
 
+/** Macro to walk through a list, faster
+ *
+ * This is the same as `CDSLIST_FOREACH()`, except that the links are followed
+ * inline, without any function call or assert at each step.
+ */
+#define CDSLIST_FOREACH_FAST(_list, _type, _iter) \
+    for (   _type *_iter = (_type*)CdsListEnd(_list)->next, \
+                *_iter##End_ = (_type*)CdsListEnd(_list); \
+            _iter != _iter##End_; \
+            _iter = (_type*)((CdsListItem*)_iter)->next )
+
+
 /** Macro to walk through a list backwards */
 #define CDSLIST_FOREACH_REVERSE(_list, _type, _iter) \
     for (   _type* _iter = (_type*)CdsListBack(_list); \
@@ -99,6 +149,24 @@ CdsList* CdsListCreate(const char* name, int64_t capacity,
         CdsListItemUnref unref);
 
 
+/** Create a list which allocates its memory from the given allocator
+ *
+ * Only the memory of the list itself comes from `allocator`; the items are
+ * allocated by you.
+ *
+ * @param name      [in] Name for this list; may be NULL
+ * @param capacity  [in] Max # of items the list can store, or 0 for no limit
+ * @param unref     [in] Function to remove a reference to a list item; may be
+ *                       NULL if you don't need it
+ * @param allocator [in] Allocator to use; it must remain valid until the list
+ *                       is destroyed; NULL to use the default allocator
+ *
+ * @return The newly-allocated list, never NULL
+ */
+CdsList* CdsListCreateWithAllocator(const char* name, int64_t capacity,
+        CdsListItemUnref unref, const CdsAllocator* allocator);
+
+
 /** Destroy a list
  *
  * Any item in the list will be unreferrenced.
@@ -108,6 +176,17 @@ CdsList* CdsListCreate(const char* name, int64_t capacity,
 void CdsListDestroy(CdsList* list);
 
 
+/** Destroy a list without unreferencing its items
+ *
+ * This is O(1): the items are not walked at all. It is meant for lists whose
+ * items are owned by something else, typically an arena which is about to be
+ * reset or destroyed (see `CdsArena`). The items are left untouched.
+ *
+ * @param list [in,out] The list to destroy; must not be NULL.
+ */
+void CdsListDestroyNoUnref(CdsList* list);
+
+
 /** Get the list's name
  *
  * @param list [in] The list to query; must not be NULL
@@ -257,6 +336,18 @@ CdsListItem* CdsListBack(const CdsList* list);
 CdsListItem* CdsListNext(const CdsListItem* pos);
 
 
+/** Get the end marker of the list
+ *
+ * The end marker is not an item: it comes after the back item and before the
+ * front item. This is meant to be used by `CDSLIST_FOREACH_FAST()`.
+ *
+ * @param list [in] List to query; must not be NULL
+ *
+ * @return The end marker of the list, never NULL
+ */
+CdsListItem* CdsListEnd(const CdsList* list);
+
+
 /** Get the previous item in the list
  *
  * @param pos [in] Position item
@@ -302,6 +393,175 @@ CdsListItem* CdsListPopBack(CdsList* list);
 void CdsListClear(CdsList* list);
 
 
+/** Move all the items of a list into another list
+ *
+ * The items of `src` are inserted after `pos` in `dst`, in the same order, and
+ * `src` is left empty. Nothing is unreferenced.
+ *
+ * This runs in O(n), where n is the number of items in `src`. The chain of
+ * items is relinked in O(1), but the back-pointer of each moved item is
+ * updated, so that every item always leads directly to its list and walking
+ * the list stays O(1) per item.
+ *
+ * @param dst [in,out] List where to move the items; must not be NULL
+ * @param pos [in,out] Item of `dst` after which to insert the items; NULL to
+ *                     insert them at the front of `dst`
+ * @param src [in,out] List to move the items from; must not be NULL and must
+ *                     not be `dst`
+ *
+ * @return `true` if success, `false` if `dst` does not have enough capacity, in
+ *         which case nothing is moved
+ */
+bool CdsListSplice(CdsList* dst, CdsListItem* pos, CdsList* src);
+
+
+/** Move a range of items into another list
+ *
+ * The items from `first` to `last` (both included) are removed from their
+ * list and inserted after `pos` in `dst`, in the same order. `dst` may be the
+ * list `first` and `last` belong to, as long as `pos` is not in the range.
+ *
+ * Within the same list, this runs in O(1). Otherwise, this runs in O(count),
+ * as the back-pointer of each moved item is updated; the sizes of the lists
+ * are updated using `count`.
+ *
+ * @param dst   [in,out] List where to move the items; must not be NULL
+ * @param pos   [in,out] Item of `dst` after which to insert the items; NULL to
+ *                       insert them at the front of `dst`
+ * @param first [in,out] First item to move; must not be NULL
+ * @param last  [in,out] Last item to move; must not be NULL and must be
+ *                       `first` or come after `first` in the same list
+ * @param count [in]     Number of items from `first` to `last`
+ *
+ * @return `true` if success, `false` if `dst` does not have enough capacity, in
+ *         which case nothing is moved
+ */
+bool CdsListSpliceRange(CdsList* dst, CdsListItem* pos,
+        CdsListItem* first, CdsListItem* last, int64_t count);
+
+
+/** Move all the items after the given item into another list
+ *
+ * The items after `pos` are removed from `list` and appended at the back of
+ * `newList`, in the same order.
+ *
+ * This runs in O(k), where k is the number of items moved. Unless `pos` is
+ * NULL, they are counted first, so nothing is modified if `newList` is too
+ * small; then the back-pointer of each of them is updated.
+ *
+ * @param list    [in,out] List to cut; must not be NULL
+ * @param pos     [in]     Item of `list` after which to cut; NULL to move all
+ *                         the items of `list`
+ * @param newList [in,out] List where to move the items; must not be NULL and
+ *                         must not be `list`
+ *
+ * @return `true` if success, `false` if `newList` does not have enough
+ *         capacity, in which case nothing is moved
+ */
+bool CdsListCutAfter(CdsList* list, CdsListItem* pos, CdsList* newList);
+
+
+/** Sort a list
+ *
+ * This is a stable merge sort, i.e. items that compare equal keep their
+ * relative order. It runs in O(n*log(n)) and does not allocate any memory.
+ *
+ * @param list    [in,out] List to sort; must not be NULL
+ * @param compare [in]     Function to compare items; must not be NULL
+ * @param cookie  [in]     Cookie for the `compare` function
+ */
+void CdsListSort(CdsList* list, CdsListCompare compare, void* cookie);
+
+
+/** Merge a sorted list into another sorted list
+ *
+ * The items of `src` are moved into `dst` so that `dst` remains sorted, and
+ * `src` is left empty. If an item of `dst` and an item of `src` compare equal,
+ * the item of `dst` comes first. This runs in O(n+m).
+ *
+ * @param dst     [in,out] Sorted list where to move the items; must not be NULL
+ * @param src     [in,out] Sorted list to move the items from; must not be NULL
+ *                         and must not be `dst`
+ * @param compare [in]     Function to compare items; must not be NULL
+ * @param cookie  [in]     Cookie for the `compare` function
+ *
+ * @return `true` if success, `false` if `dst` does not have enough capacity, in
+ *         which case nothing is moved
+ */
+bool CdsListMergeSorted(CdsList* dst, CdsList* src, CdsListCompare compare,
+        void* cookie);
+
+
+/** Visit all the items of a list, in batches
+ *
+ * The list is walked from front to back and `visit` is called with up to
+ * `batchSize` consecutive items at a time, so the cost of the call is paid
+ * once per batch instead of once per item. `visit` may remove from the list,
+ * and even free, the items it is given, but not any other item.
+ *
+ * @param list      [in,out] List to walk; must not be NULL
+ * @param visit     [in]     Function to call for each batch; must not be NULL
+ * @param batchSize [in]     Max # of items in a batch; must be between 1 and
+ *                           `CDSLIST_VISIT_BATCH_MAX`
+ * @param cookie    [in]     Cookie for the `visit` function
+ */
+void CdsListForEachBatch(CdsList* list, CdsListVisitBatch visit,
+        int batchSize, void* cookie);
+
+
+/** Remove all items from the list, using many threads
+ *
+ * The list is cut into segments which are unreferenced by `threads` threads
+ * (including the calling thread) as soon as they have been walked. This is
+ * useful to quickly release a very large list.
+ *
+ * A linked list can't be split without walking it, so only 2 threads walk the
+ * list: the calling thread from the front and, if `threads` > 1, another
+ * thread from the back. The unref phase uses all the threads.
+ *
+ * The unref function (either `unrefBatch` or the one given to
+ * `CdsListCreate()`) will be called from multiple threads at the same time, so
+ * it must be thread-safe.
+ *
+ * @param list       [in,out] The list to clear of all its items
+ * @param threads    [in]     Number of threads to use; must be >= 1
+ * @param unrefBatch [in]     Function to unreference many items in one go;
+ *                            set to NULL to use the list unref function
+ */
+void CdsListClearParallel(CdsList* list, int threads,
+        CdsListItemUnrefBatch unrefBatch);
+
+
+
+/*--------------------+
+ | Header-inline mode |
+ +--------------------*/
+
+
+/* When `CDS_INLINE` is defined (`make INLINE=1`), calls to the functions below
+ * are compiled inline instead of going through the library. The library
+ * functions remain available, so code built either way can be linked
+ * together, and taking the address of these functions still works.
+ */
+#ifdef CDS_INLINE
+#define CdsListSize(_list)              cdsListSizeInline(_list)
+#define CdsListIsEmpty(_list)           cdsListIsEmptyInline(_list)
+#define CdsListPushFront(_list, _item)  cdsListPushFrontInline(_list, _item)
+#define CdsListPushBack(_list, _item)   cdsListPushBackInline(_list, _item)
+#define CdsListInsertAfter(_pos, _item) cdsListInsertAfterInline(_pos, _item)
+#define CdsListInsertBefore(_pos, _item) \
+    cdsListInsertBeforeInline(_pos, _item)
+#define CdsListFront(_list)             cdsListFrontInline(_list)
+#define CdsListBack(_list)              cdsListBackInline(_list)
+#define CdsListEnd(_list)               cdsListEndInline(_list)
+#define CdsListNext(_item)              cdsListNextInline(_item)
+#define CdsListPrev(_item)              cdsListPrevInline(_item)
+#define CdsListRemove(_item)            cdsListRemoveInline(_item)
+#define CdsListPopFront(_list)          cdsListPopFrontInline(_list)
+#define CdsListPopBack(_list)           cdsListPopBackInline(_list)
+#endif
+
+
 
 #endif /* CDSLIST_h_ */
 /* @} */
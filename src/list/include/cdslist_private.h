@@ -37,4 +37,198 @@ struct CdsListItem
 };
 
 
+/* List
+ *
+ * This is only visible so the fast paths below can be inlined; do not access
+ * its fields directly.
+ */
+struct CdsList
+{
+    char*               name;
+    int64_t             size;
+    int64_t             capacity;
+    struct CdsListItem  head;
+    void                (*unref)(struct CdsListItem* item);
+    const CdsAllocator* allocator;
+};
+
+
+
+/*-----------------------------+
+ | Inline function definitions |
+ +-----------------------------*/
+
+
+/* These are the implementations of the hot accessors and of the link
+ * manipulation functions. The library functions call them, and so does user
+ * code compiled with `CDS_INLINE` defined (see "cdslist.h").
+ */
+
+
+static inline int64_t cdsListSizeInline(const struct CdsList* list)
+{
+    CDSASSERT_FULL(list != NULL);
+    return list->size;
+}
+
+
+static inline bool cdsListIsEmptyInline(const struct CdsList* list)
+{
+    CDSASSERT_FULL(list != NULL);
+    return list->size <= 0;
+}
+
+
+static inline bool cdsListInsertAfterInline(struct CdsListItem* pos,
+        struct CdsListItem* item)
+{
+    CDSASSERT_FULL(pos != NULL);
+    struct CdsList* list = pos->list;
+    CDSASSERT_FULL(list != NULL);
+    CDSASSERT_FULL(item != NULL);
+
+    bool inserted = false;
+    if ((list->capacity <= 0) || (list->size < list->capacity)) {
+        item->list = list;
+        item->next = pos->next;
+        item->prev = pos;
+        pos->next->prev = item;
+        pos->next = item;
+        list->size++;
+        inserted = true;
+    }
+    return inserted;
+}
+
+
+static inline bool cdsListInsertBeforeInline(struct CdsListItem* pos,
+        struct CdsListItem* item)
+{
+    CDSASSERT_FULL(pos != NULL);
+    struct CdsList* list = pos->list;
+    CDSASSERT_FULL(list != NULL);
+    CDSASSERT_FULL(item != NULL);
+
+    bool inserted = false;
+    if ((list->capacity <= 0) || (list->size < list->capacity)) {
+        item->list = list;
+        item->next = pos;
+        item->prev = pos->prev;
+        pos->prev->next = item;
+        pos->prev = item;
+        list->size++;
+        inserted = true;
+    }
+    return inserted;
+}
+
+
+static inline bool cdsListPushFrontInline(struct CdsList* list,
+        struct CdsListItem* item)
+{
+    CDSASSERT_FULL(list != NULL);
+    return cdsListInsertAfterInline(&(list->head), item);
+}
+
+
+static inline bool cdsListPushBackInline(struct CdsList* list,
+        struct CdsListItem* item)
+{
+    CDSASSERT_FULL(list != NULL);
+    return cdsListInsertBeforeInline(&(list->head), item);
+}
+
+
+static inline struct CdsListItem* cdsListFrontInline(
+        const struct CdsList* list)
+{
+    CDSASSERT_FULL(list != NULL);
+    if (list->size <= 0) {
+        return NULL;
+    }
+    return list->head.next;
+}
+
+
+static inline struct CdsListItem* cdsListBackInline(const struct CdsList* list)
+{
+    CDSASSERT_FULL(list != NULL);
+    if (list->size <= 0) {
+        return NULL;
+    }
+    return list->head.prev;
+}
+
+
+static inline struct CdsListItem* cdsListEndInline(const struct CdsList* list)
+{
+    CDSASSERT_FULL(list != NULL);
+    return (struct CdsListItem*)&(list->head);
+}
+
+
+static inline struct CdsListItem* cdsListNextInline(
+        const struct CdsListItem* item)
+{
+    CDSASSERT_FULL(item != NULL);
+    struct CdsList* list = item->list;
+    CDSASSERT_FULL(list != NULL);
+    struct CdsListItem* next = item->next;
+    if (next == &(list->head)) {
+        next = NULL;
+    }
+    return next;
+}
+
+
+static inline struct CdsListItem* cdsListPrevInline(
+        const struct CdsListItem* item)
+{
+    CDSASSERT_FULL(item != NULL);
+    struct CdsList* list = item->list;
+    CDSASSERT_FULL(list != NULL);
+    struct CdsListItem* prev = item->prev;
+    if (prev == &(list->head)) {
+        prev = NULL;
+    }
+    return prev;
+}
+
+
+static inline void cdsListRemoveInline(struct CdsListItem* item)
+{
+    CDSASSERT_FULL(item != NULL);
+    struct CdsList* list = item->list;
+    CDSASSERT_FULL(list != NULL);
+
+    item->next->prev = item->prev;
+    item->prev->next = item->next;
+    list->size--;
+
+    item->next = NULL;
+    item->prev = NULL;
+    item->list = NULL;
+}
+
+
+static inline struct CdsListItem* cdsListPopFrontInline(struct CdsList* list)
+{
+    struct CdsListItem* front = cdsListFrontInline(list);
+    if (front != NULL) {
+        cdsListRemoveInline(front);
+    }
+    return front;
+}
+
+
+static inline struct CdsListItem* cdsListPopBackInline(struct CdsList* list)
+{
+    struct CdsListItem* back = cdsListBackInline(list);
+    if (back != NULL) {
+        cdsListRemoveInline(back);
+    }
+    return back;
+}
+
+
 #endif /* CDSLIST_PRIVATE_h_ */
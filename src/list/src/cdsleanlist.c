@@ -0,0 +1,322 @@
+/* Copyright (c) 2016  Fabrice Triboix
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cdsleanlist.h"
+#include <stdlib.h>
+#include <string.h>
+
+
+
+/*-------+
+ | Types |
+ +-------*/
+
+
+struct CdsLeanList
+{
+    char*                name;
+    int64_t              size;
+    int64_t              capacity;
+    CdsLeanListItem      head;
+    CdsLeanListItemUnref unref;
+    const CdsAllocator*  allocator;
+};
+
+
+
+/*-------------------------------+
+ | Private function declarations |
+ +-------------------------------*/
+
+
+/** Link a chain of items after the given item
+ *
+ * @param pos   [in,out] Item after which to link the chain; may be the head
+ *                       of a list; must not be NULL
+ * @param first [in,out] First item of the chain; must not be NULL
+ * @param last  [in,out] Last item of the chain; must not be NULL
+ */
+static inline void cdsLeanListLinkAfter(CdsLeanListItem* pos,
+        CdsLeanListItem* first, CdsLeanListItem* last)
+{
+    last->next = pos->next;
+    first->prev = pos;
+    pos->next->prev = last;
+    pos->next = first;
+}
+
+
+/** Check whether `count` more items can be inserted into the given list
+ *
+ * @param list  [in] List to query; must not be NULL
+ * @param count [in] Number of items to insert
+ *
+ * @return `true` if there is enough room, `false` otherwise
+ */
+static inline bool cdsLeanListHasRoom(const CdsLeanList* list, int64_t count)
+{
+    return (list->capacity <= 0) || (list->size + count <= list->capacity);
+}
+
+
+
+/*---------------------------------+
+ | Public function implementations |
+ +---------------------------------*/
+
+
+CdsLeanList* CdsLeanListCreate(const char* name, int64_t capacity,
+        CdsLeanListItemUnref unref)
+{
+    return CdsLeanListCreateWithAllocator(name, capacity, unref, NULL);
+}
+
+
+CdsLeanList* CdsLeanListCreateWithAllocator(const char* name, int64_t capacity,
+        CdsLeanListItemUnref unref, const CdsAllocator* allocator)
+{
+    if (allocator == NULL) {
+        allocator = CdsDefaultAllocator();
+    }
+    CdsLeanList* list = CdsAllocZ(allocator, sizeof(*list));
+
+    list->allocator = allocator;
+    list->name = CdsStrdup(allocator, name);
+    if (capacity > 0) {
+        list->capacity = capacity;
+    }
+    list->head.next = &(list->head);
+    list->head.prev = &(list->head);
+    list->unref = unref;
+
+    return list;
+}
+
+
+void CdsLeanListDestroy(CdsLeanList* list)
+{
+    CDSASSERT_FULL(list != NULL);
+    CdsLeanListClear(list);
+    CdsFree(list->allocator, list->name);
+    CdsFree(list->allocator, list);
+}
+
+
+const char* CdsLeanListName(const CdsLeanList* list)
+{
+    CDSASSERT_FULL(list != NULL);
+    return list->name;
+}
+
+
+int64_t CdsLeanListSize(const CdsLeanList* list)
+{
+    CDSASSERT_FULL(list != NULL);
+    return list->size;
+}
+
+
+int64_t CdsLeanListCapacity(const CdsLeanList* list)
+{
+    CDSASSERT_FULL(list != NULL);
+    return list->capacity;
+}
+
+
+bool CdsLeanListIsEmpty(const CdsLeanList* list)
+{
+    CDSASSERT_FULL(list != NULL);
+    return list->size <= 0;
+}
+
+
+bool CdsLeanListIsFull(const CdsLeanList* list)
+{
+    CDSASSERT_FULL(list != NULL);
+    return !cdsLeanListHasRoom(list, 1);
+}
+
+
+bool CdsLeanListPushFront(CdsLeanList* list, CdsLeanListItem* item)
+{
+    CDSASSERT_FULL(list != NULL);
+    return CdsLeanListInsertAfter(list, &(list->head), item);
+}
+
+
+bool CdsLeanListPushBack(CdsLeanList* list, CdsLeanListItem* item)
+{
+    CDSASSERT_FULL(list != NULL);
+    return CdsLeanListInsertAfter(list, list->head.prev, item);
+}
+
+
+bool CdsLeanListInsertAfter(CdsLeanList* list, CdsLeanListItem* pos,
+        CdsLeanListItem* item)
+{
+    CDSASSERT_FULL(list != NULL);
+    CDSASSERT_FULL(pos != NULL);
+    CDSASSERT_FULL(item != NULL);
+
+    if (!cdsLeanListHasRoom(list, 1)) {
+        return false;
+    }
+    cdsLeanListLinkAfter(pos, item, item);
+    list->size++;
+    return true;
+}
+
+
+bool CdsLeanListInsertBefore(CdsLeanList* list, CdsLeanListItem* pos,
+        CdsLeanListItem* item)
+{
+    CDSASSERT_FULL(pos != NULL);
+    return CdsLeanListInsertAfter(list, pos->prev, item);
+}
+
+
+CdsLeanListItem* CdsLeanListFront(const CdsLeanList* list)
+{
+    CDSASSERT_FULL(list != NULL);
+    if (list->size <= 0) {
+        return NULL;
+    }
+    return list->head.next;
+}
+
+
+CdsLeanListItem* CdsLeanListBack(const CdsLeanList* list)
+{
+    CDSASSERT_FULL(list != NULL);
+    if (list->size <= 0) {
+        return NULL;
+    }
+    return list->head.prev;
+}
+
+
+CdsLeanListItem* CdsLeanListNext(const CdsLeanList* list,
+        const CdsLeanListItem* pos)
+{
+    CDSASSERT_FULL(list != NULL);
+    CDSASSERT_FULL(pos != NULL);
+    CdsLeanListItem* next = pos->next;
+    if (next == &(list->head)) {
+        next = NULL;
+    }
+    return next;
+}
+
+
+CdsLeanListItem* CdsLeanListPrev(const CdsLeanList* list,
+        const CdsLeanListItem* pos)
+{
+    CDSASSERT_FULL(list != NULL);
+    CDSASSERT_FULL(pos != NULL);
+    CdsLeanListItem* prev = pos->prev;
+    if (prev == &(list->head)) {
+        prev = NULL;
+    }
+    return prev;
+}
+
+
+void CdsLeanListRemove(CdsLeanList* list, CdsLeanListItem* item)
+{
+    CDSASSERT_FULL(list != NULL);
+    CDSASSERT_FULL(item != NULL);
+    CDSASSERT(item != &(list->head));
+
+    item->next->prev = item->prev;
+    item->prev->next = item->next;
+    list->size--;
+
+    item->next = NULL;
+    item->prev = NULL;
+}
+
+
+CdsLeanListItem* CdsLeanListPopFront(CdsLeanList* list)
+{
+    CdsLeanListItem* front = CdsLeanListFront(list);
+    if (front != NULL) {
+        CdsLeanListRemove(list, front);
+    }
+    return front;
+}
+
+
+CdsLeanListItem* CdsLeanListPopBack(CdsLeanList* list)
+{
+    CdsLeanListItem* back = CdsLeanListBack(list);
+    if (back != NULL) {
+        CdsLeanListRemove(list, back);
+    }
+    return back;
+}
+
+
+void CdsLeanListClear(CdsLeanList* list)
+{
+    CDSASSERT_FULL(list != NULL);
+
+    while (!CdsLeanListIsEmpty(list)) {
+        CdsLeanListItem* tmp = CdsLeanListPopFront(list);
+        CDSASSERT_FULL(tmp != NULL);
+        if (list->unref != NULL) {
+            list->unref(tmp);
+        }
+    }
+}
+
+
+bool CdsLeanListSplice(CdsLeanList* dst, CdsLeanListItem* pos,
+        CdsLeanList* src)
+{
+    CDSASSERT_FULL(dst != NULL);
+    CDSASSERT_FULL(src != NULL);
+    CDSASSERT(dst != src);
+
+    if (CdsLeanListIsEmpty(src)) {
+        return true;
+    }
+    return CdsLeanListSpliceRange(dst, pos, src, src->head.next,
+            src->head.prev, src->size);
+}
+
+
+bool CdsLeanListSpliceRange(CdsLeanList* dst, CdsLeanListItem* pos,
+        CdsLeanList* src, CdsLeanListItem* first, CdsLeanListItem* last,
+        int64_t count)
+{
+    CDSASSERT_FULL(dst != NULL);
+    CDSASSERT_FULL(src != NULL);
+    CDSASSERT_FULL(first != NULL);
+    CDSASSERT_FULL(last != NULL);
+    CDSASSERT(count > 0);
+    CDSASSERT(count <= src->size);
+
+    if ((dst != src) && !cdsLeanListHasRoom(dst, count)) {
+        return false;
+    }
+
+    first->prev->next = last->next;
+    last->next->prev = first->prev;
+    cdsLeanListLinkAfter((pos != NULL) ? pos : &(dst->head), first, last);
+    src->size -= count;
+    dst->size += count;
+    return true;
+}
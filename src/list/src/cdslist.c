@@ -14,25 +14,164 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+/* Always build the out-of-line functions, whatever the inline build mode */
+#undef CDS_INLINE
+
 #include "cdslist.h"
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
+#include <sched.h>
+
+
+
+/*----------------+
+ | Macros & Types |
+ +----------------*/
+
+
+/** Max # of items passed to a batch unref function in one go */
+#define CDSLIST_CLEAR_BATCH 256
+
+/** # of items in a segment when clearing a list in parallel */
+#define CDSLIST_CLEAR_SEGMENT 4096
 
+/** # of bins used by `CdsListSort()`; bin `i` holds up to 2^i items */
+#define CDSLIST_SORT_BINS 64
 
 
-/*-------+
- | Types |
- +-------*/
+/** Segment of a list being cleared in parallel */
+typedef struct
+{
+    CdsListItem* first;   // First item; set by the walker which claimed it
+    int          claimed; // Whether a walker has taken the segment
+    int          ready;   // Whether the segment can be unreferenced
+} CdsListClearSegment;
 
 
-struct CdsList
+/** Shared state of the threads clearing a list in parallel
+ *
+ * The list is walked from both ends at the same time. Each segment is claimed
+ * by exactly one walker, which only reads the pointers of the items of that
+ * segment, so the segment can be unreferenced as soon as it has been walked.
+ */
+typedef struct
 {
-    char*            name;
-    int64_t          size;
-    int64_t          capacity;
-    CdsListItem      head;
-    CdsListItemUnref unref;
-};
+    CdsListClearSegment*  segments;
+    CdsListItem*          last;      // Last item of the list
+    int64_t               count;     // Number of items to clear
+    int64_t               nsegments; // Number of segments
+    int64_t               next;      // # of segments taken to be cleared
+    CdsListItemUnref      unref;
+    CdsListItemUnrefBatch unrefBatch;
+} CdsListClearJob;
+
+
+
+/*-------------------------------+
+ | Private function declarations |
+ +-------------------------------*/
+
+
+/** Unreference the segments of a list being cleared in parallel
+ *
+ * @param arg [in,out] The `CdsListClearJob`
+ *
+ * @return Always NULL
+ */
+static void* cdsListClearWorker(void* arg);
+
+
+/** Walk a list being cleared from the back, then unreference its segments
+ *
+ * @param arg [in,out] The `CdsListClearJob`
+ *
+ * @return Always NULL
+ */
+static void* cdsListClearBackWorker(void* arg);
+
+
+/** Walk a list being cleared from the front
+ *
+ * This stops at the first segment already claimed by the other walker.
+ *
+ * @param job [in,out] Job to work on
+ */
+static void cdsListClearWalkForward(CdsListClearJob* job);
+
+
+/** Walk a list being cleared from the back
+ *
+ * This stops at the first segment already claimed by the other walker.
+ *
+ * @param job [in,out] Job to work on
+ */
+static void cdsListClearWalkBackward(CdsListClearJob* job);
+
+
+/** Get the number of items in a segment of a list being cleared
+ *
+ * @param job   [in] Job to query
+ * @param index [in] Index of the segment
+ *
+ * @return The number of items in the segment
+ */
+static int64_t cdsListClearSegmentSize(const CdsListClearJob* job,
+        int64_t index);
+
+
+/** Link a chain of items after the given item
+ *
+ * The back-pointers of the items in the chain must have been updated already.
+ *
+ * @param pos   [in,out] Item after which to link the chain; may be the head
+ *                       of a list; must not be NULL
+ * @param first [in,out] First item of the chain; must not be NULL
+ * @param last  [in,out] Last item of the chain; must not be NULL
+ */
+static void cdsListLinkAfter(CdsListItem* pos, CdsListItem* first,
+        CdsListItem* last);
+
+
+/** Point the back-pointers of a chain of items to the given list
+ *
+ * @param first [in,out] First item of the chain; must not be NULL
+ * @param last  [in,out] Last item of the chain; must not be NULL
+ * @param list  [in]     List the items now belong to
+ *
+ * @return The number of items in the chain
+ */
+static int64_t cdsListSetList(CdsListItem* first, CdsListItem* last,
+        CdsList* list);
+
+
+/** Merge two sorted chains of items
+ *
+ * Only the `next` pointers are used and updated; both chains and the result
+ * are NULL-terminated. Items of `left` come first when comparing equal.
+ *
+ * @param left    [in,out] First chain to merge; may be NULL
+ * @param right   [in,out] Second chain to merge; may be NULL
+ * @param compare [in]     Function to compare items
+ * @param cookie  [in]     Cookie for the `compare` function
+ *
+ * @return The merged chain
+ */
+static CdsListItem* cdsListMergeChains(CdsListItem* left, CdsListItem* right,
+        CdsListCompare compare, void* cookie);
+
+
+/** Check whether `count` more items can be inserted into the given list
+ *
+ * @param list  [in] List to query; must not be NULL
+ * @param count [in] Number of items to insert
+ *
+ * @return `true` if there is enough room, `false` otherwise
+ */
+static inline bool cdsListHasRoom(const CdsList* list, int64_t count)
+{
+    return (list->capacity <= 0) || (list->size + count <= list->capacity);
+}
 
 
 
@@ -44,11 +183,20 @@ struct CdsList
 CdsList* CdsListCreate(const char* name, int64_t capacity,
         CdsListItemUnref unref)
 {
-    CdsList* list = CdsMallocZ(sizeof(*list));
+    return CdsListCreateWithAllocator(name, capacity, unref, NULL);
+}
+
 
-    if (name != NULL) {
-        list->name = strdup(name);
+CdsList* CdsListCreateWithAllocator(const char* name, int64_t capacity,
+        CdsListItemUnref unref, const CdsAllocator* allocator)
+{
+    if (allocator == NULL) {
+        allocator = CdsDefaultAllocator();
     }
+    CdsList* list = CdsAllocZ(allocator, sizeof(*list));
+
+    list->allocator = allocator;
+    list->name = CdsStrdup(allocator, name);
     if (capacity > 0) {
         list->capacity = capacity;
     }
@@ -63,44 +211,50 @@ CdsList* CdsListCreate(const char* name, int64_t capacity,
 
 void CdsListDestroy(CdsList* list)
 {
-    CDSASSERT(list != NULL);
+    CDSASSERT_FULL(list != NULL);
     CdsListClear(list);
-    free(list->name);
-    free(list);
+    CdsFree(list->allocator, list->name);
+    CdsFree(list->allocator, list);
+}
+
+
+void CdsListDestroyNoUnref(CdsList* list)
+{
+    CDSASSERT_FULL(list != NULL);
+    CdsFree(list->allocator, list->name);
+    CdsFree(list->allocator, list);
 }
 
 
 const char* CdsListName(const CdsList* list)
 {
-    CDSASSERT(list != NULL);
+    CDSASSERT_FULL(list != NULL);
     return list->name;
 }
 
 
 int64_t CdsListSize(const CdsList* list)
 {
-    CDSASSERT(list != NULL);
-    return list->size;
+    return cdsListSizeInline(list);
 }
 
 
 int64_t CdsListCapacity(const CdsList* list)
 {
-    CDSASSERT(list != NULL);
+    CDSASSERT_FULL(list != NULL);
     return list->capacity;
 }
 
 
 bool CdsListIsEmpty(const CdsList* list)
 {
-    CDSASSERT(list != NULL);
-    return list->size <= 0;
+    return cdsListIsEmptyInline(list);
 }
 
 
 bool CdsListIsFull(const CdsList* list)
 {
-    CDSASSERT(list != NULL);
+    CDSASSERT_FULL(list != NULL);
     bool isFull = false;
     if ((list->capacity > 0) && (list->size >= list->capacity)) {
         isFull = true;
@@ -111,151 +265,499 @@ bool CdsListIsFull(const CdsList* list)
 
 bool CdsListPushFront(CdsList* list, CdsListItem* item)
 {
-    CDSASSERT(list != NULL);
-    return CdsListInsertAfter(&(list->head), item);
+    return cdsListPushFrontInline(list, item);
 }
 
 
 bool CdsListPushBack(CdsList* list, CdsListItem* item)
 {
-    CDSASSERT(list != NULL);
-    return CdsListInsertBefore(&(list->head), item);
+    return cdsListPushBackInline(list, item);
 }
 
 
 bool CdsListInsertAfter(CdsListItem* pos, CdsListItem* item)
 {
-    CDSASSERT(pos != NULL);
-    CdsList* list = pos->list;
-    CDSASSERT(list != NULL);
-    CDSASSERT(item != NULL);
-
-    bool inserted = false;
-    if ((list->capacity <= 0) || (list->size < list->capacity)) {
-        item->list = list;
-        item->next = pos->next;
-        item->prev = pos;
-        pos->next->prev = item;
-        pos->next = item;
-        list->size++;
-        inserted = true;
-    }
-    return inserted;
+    return cdsListInsertAfterInline(pos, item);
 }
 
 
 bool CdsListInsertBefore(CdsListItem* pos, CdsListItem* item)
 {
-    CDSASSERT(pos != NULL);
-    CdsList* list = pos->list;
-    CDSASSERT(list != NULL);
-    CDSASSERT(item != NULL);
-
-    bool inserted = false;
-    if ((list->capacity <= 0) || (list->size < list->capacity)) {
-        item->list = list;
-        item->next = pos;
-        item->prev = pos->prev;
-        pos->prev->next = item;
-        pos->prev = item;
-        list->size++;
-        inserted = true;
-    }
-    return inserted;
+    return cdsListInsertBeforeInline(pos, item);
 }
 
 
 CdsListItem* CdsListFront(const CdsList* list)
 {
-    CDSASSERT(list != NULL);
-    if (list->size <= 0) {
-        return NULL;
-    }
-    return list->head.next;
+    return cdsListFrontInline(list);
 }
 
 
 CdsListItem* CdsListBack(const CdsList* list)
 {
-    CDSASSERT(list != NULL);
-    if (list->size <= 0) {
-        return NULL;
-    }
-    return list->head.prev;
+    return cdsListBackInline(list);
+}
+
+
+CdsListItem* CdsListEnd(const CdsList* list)
+{
+    return cdsListEndInline(list);
 }
 
 
 CdsListItem* CdsListNext(const CdsListItem* item)
 {
-    CDSASSERT(item != NULL);
-    CdsList* list = item->list;
-    CDSASSERT(list != NULL);
-    CdsListItem* next = item->next;
-    if (next == &(list->head)) {
-        next = NULL;
-    }
-    return next;
+    return cdsListNextInline(item);
 }
 
 
 CdsListItem* CdsListPrev(const CdsListItem* item)
 {
-    CDSASSERT(item != NULL);
-    CdsList* list = item->list;
-    CDSASSERT(list != NULL);
-    CdsListItem* prev = item->prev;
-    if (prev == &(list->head)) {
-        prev = NULL;
-    }
-    return prev;
+    return cdsListPrevInline(item);
 }
 
 
 void CdsListRemove(CdsListItem* item)
 {
-    CDSASSERT(item != NULL);
-    CdsList* list = item->list;
-    CDSASSERT(list != NULL);
-
-    item->next->prev = item->prev;
-    item->prev->next = item->next;
-    list->size--;
-
-    item->next = NULL;
-    item->prev = NULL;
-    item->list = NULL;
+    cdsListRemoveInline(item);
 }
 
 
 CdsListItem* CdsListPopFront(CdsList* list)
 {
-    CdsListItem* front = CdsListFront(list);
-    if (front != NULL) {
-        CdsListRemove(front);
-    }
-    return front;
+    return cdsListPopFrontInline(list);
 }
 
 
 CdsListItem* CdsListPopBack(CdsList* list)
 {
-    CdsListItem* back = CdsListBack(list);
-    if (back != NULL) {
-        CdsListRemove(back);
-    }
-    return back;
+    return cdsListPopBackInline(list);
 }
 
 
 void CdsListClear(CdsList* list)
 {
-    CDSASSERT(list != NULL);
+    CDSASSERT_FULL(list != NULL);
 
     while (!CdsListIsEmpty(list)) {
         CdsListItem* tmp = CdsListPopFront(list);
-        CDSASSERT(tmp != NULL);
+        CDSASSERT_FULL(tmp != NULL);
         if (list->unref != NULL) {
             list->unref(tmp);
         }
     }
 }
+
+
+bool CdsListSplice(CdsList* dst, CdsListItem* pos, CdsList* src)
+{
+    CDSASSERT_FULL(dst != NULL);
+    CDSASSERT_FULL(src != NULL);
+    CDSASSERT(dst != src);
+    CDSASSERT((pos == NULL) || (pos->list == dst));
+
+    if (CdsListIsEmpty(src)) {
+        return true;
+    }
+    if (!cdsListHasRoom(dst, src->size)) {
+        return false;
+    }
+
+    CdsListItem* first = src->head.next;
+    CdsListItem* last = src->head.prev;
+    cdsListSetList(first, last, dst);
+    src->head.next = &(src->head);
+    src->head.prev = &(src->head);
+
+    cdsListLinkAfter((pos != NULL) ? pos : &(dst->head), first, last);
+    dst->size += src->size;
+    src->size = 0;
+    return true;
+}
+
+
+bool CdsListSpliceRange(CdsList* dst, CdsListItem* pos,
+        CdsListItem* first, CdsListItem* last, int64_t count)
+{
+    CDSASSERT_FULL(dst != NULL);
+    CDSASSERT_FULL(first != NULL);
+    CDSASSERT_FULL(last != NULL);
+    CDSASSERT(count > 0);
+    CdsList* src = first->list;
+    CDSASSERT_FULL(src != NULL);
+    CDSASSERT(last->list == src);
+    CDSASSERT((pos == NULL) || (pos->list == dst));
+
+    if ((dst != src) && !cdsListHasRoom(dst, count)) {
+        return false;
+    }
+
+    // Unlink the range from its list
+    first->prev->next = last->next;
+    last->next->prev = first->prev;
+
+    if (dst != src) {
+        int64_t n = cdsListSetList(first, last, dst);
+        CDSASSERT(n == count);
+        (void)n;
+        src->size -= count;
+        dst->size += count;
+    }
+    cdsListLinkAfter((pos != NULL) ? pos : &(dst->head), first, last);
+    return true;
+}
+
+
+bool CdsListCutAfter(CdsList* list, CdsListItem* pos, CdsList* newList)
+{
+    CDSASSERT_FULL(list != NULL);
+    CDSASSERT_FULL(newList != NULL);
+    CDSASSERT(list != newList);
+    CDSASSERT((pos == NULL) || (pos->list == list));
+
+    if (pos == NULL) {
+        pos = &(list->head);
+    }
+    CdsListItem* first = pos->next;
+    CdsListItem* last = list->head.prev;
+    if (first == &(list->head)) {
+        return true; // Nothing after `pos`
+    }
+
+    // NB: Unless all the items move, count them before touching anything, so
+    // nothing changes if `newList` turns out to be too small
+    int64_t count = list->size;
+    if (pos != &(list->head)) {
+        count = 0;
+        for (CdsListItem* i = first; i != &(list->head); i = i->next) {
+            count++;
+        }
+    }
+    if (!cdsListHasRoom(newList, count)) {
+        return false;
+    }
+    cdsListSetList(first, last, newList);
+
+    pos->next = &(list->head);
+    list->head.prev = pos;
+    list->size -= count;
+    cdsListLinkAfter(newList->head.prev, first, last);
+    newList->size += count;
+    return true;
+}
+
+
+void CdsListClearParallel(CdsList* list, int threads,
+        CdsListItemUnrefBatch unrefBatch)
+{
+    CDSASSERT_FULL(list != NULL);
+    CDSASSERT(threads >= 1);
+
+    if (CdsListIsEmpty(list)) {
+        return;
+    }
+
+    // Detach all the items from the list
+    CdsListClearJob job;
+    memset(&job, 0, sizeof(job));
+    job.count = list->size;
+    job.nsegments = (job.count + CDSLIST_CLEAR_SEGMENT - 1)
+        / CDSLIST_CLEAR_SEGMENT;
+    job.segments = CdsAllocZ(list->allocator,
+            job.nsegments * sizeof(*job.segments));
+    job.unref = list->unref;
+    job.unrefBatch = unrefBatch;
+    job.segments[0].first = list->head.next;
+    job.last = list->head.prev;
+    list->head.next = &(list->head);
+    list->head.prev = &(list->head);
+    list->size = 0;
+
+    // NB: The first thread also walks the list from the back. If we can't
+    // create a thread, we just do more work ourselves.
+    int nworkers = 0;
+    pthread_t* workers = CdsAlloc(list->allocator,
+            threads * sizeof(*workers));
+    for (int i = 1; i < threads; i++) {
+        void* (*worker)(void*) = cdsListClearWorker;
+        if (nworkers == 0) {
+            worker = cdsListClearBackWorker;
+        }
+        if (pthread_create(&workers[nworkers], NULL, worker, &job) == 0) {
+            nworkers++;
+        }
+    }
+
+    cdsListClearWalkForward(&job);
+    cdsListClearWorker(&job);
+    for (int i = 0; i < nworkers; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    CdsFree(list->allocator, workers);
+    CdsFree(list->allocator, job.segments);
+}
+
+
+void CdsListSort(CdsList* list, CdsListCompare compare, void* cookie)
+{
+    CDSASSERT_FULL(list != NULL);
+    CDSASSERT_FULL(compare != NULL);
+
+    if (list->size < 2) {
+        return;
+    }
+
+    // Bottom-up merge sort on the `next` pointers only; bins work like the
+    // digits of a binary counter, and a bin always holds items that were
+    // before those of the lower bins, which keeps the sort stable
+    CdsListItem* bins[CDSLIST_SORT_BINS];
+    int nbins = 0;
+    list->head.prev->next = NULL;
+    CdsListItem* item = list->head.next;
+    while (item != NULL) {
+        CdsListItem* run = item;
+        item = item->next;
+        run->next = NULL;
+        int i;
+        for (i = 0; (i < nbins) && (bins[i] != NULL); i++) {
+            run = cdsListMergeChains(bins[i], run, compare, cookie);
+            bins[i] = NULL;
+        }
+        CDSASSERT(i < CDSLIST_SORT_BINS);
+        if (i == nbins) {
+            nbins++;
+        }
+        bins[i] = run;
+    }
+    CdsListItem* sorted = NULL;
+    for (int i = 0; i < nbins; i++) {
+        if (bins[i] != NULL) {
+            sorted = cdsListMergeChains(bins[i], sorted, compare, cookie);
+        }
+    }
+
+    // Fix up the `prev` pointers
+    CdsListItem* prev = &(list->head);
+    for (item = sorted; item != NULL; item = item->next) {
+        prev->next = item;
+        item->prev = prev;
+        prev = item;
+    }
+    prev->next = &(list->head);
+    list->head.prev = prev;
+}
+
+
+bool CdsListMergeSorted(CdsList* dst, CdsList* src, CdsListCompare compare,
+        void* cookie)
+{
+    CDSASSERT_FULL(dst != NULL);
+    CDSASSERT_FULL(src != NULL);
+    CDSASSERT(dst != src);
+    CDSASSERT_FULL(compare != NULL);
+
+    if (!cdsListHasRoom(dst, src->size)) {
+        return false;
+    }
+
+    CdsListItem* pos = dst->head.next;
+    CdsListItem* item = src->head.next;
+    while (item != &(src->head)) {
+        CdsListItem* next = item->next;
+        while ((pos != &(dst->head)) && (compare(item, pos, cookie) >= 0)) {
+            pos = pos->next;
+        }
+        item->list = dst;
+        cdsListLinkAfter(pos->prev, item, item);
+        item = next;
+    }
+    dst->size += src->size;
+
+    src->head.next = &(src->head);
+    src->head.prev = &(src->head);
+    src->size = 0;
+    return true;
+}
+
+
+void CdsListForEachBatch(CdsList* list, CdsListVisitBatch visit,
+        int batchSize, void* cookie)
+{
+    CDSASSERT_FULL(list != NULL);
+    CDSASSERT_FULL(visit != NULL);
+    CDSASSERT((batchSize > 0) && (batchSize <= CDSLIST_VISIT_BATCH_MAX));
+
+    CdsListItem* batch[CDSLIST_VISIT_BATCH_MAX];
+    CdsListItem* item = list->head.next;
+    while (item != &(list->head)) {
+        int n = 0;
+        while ((n < batchSize) && (item != &(list->head))) {
+            batch[n++] = item;
+            item = item->next;
+        }
+        visit(batch, n, cookie);
+    }
+}
+
+
+
+/*----------------------------------+
+ | Private function implementations |
+ +----------------------------------*/
+
+
+static void cdsListLinkAfter(CdsListItem* pos, CdsListItem* first,
+        CdsListItem* last)
+{
+    CDSASSERT_FULL(pos != NULL);
+    CDSASSERT_FULL(first != NULL);
+    CDSASSERT_FULL(last != NULL);
+
+    last->next = pos->next;
+    first->prev = pos;
+    pos->next->prev = last;
+    pos->next = first;
+}
+
+
+static int64_t cdsListSetList(CdsListItem* first, CdsListItem* last,
+        CdsList* list)
+{
+    int64_t count = 1;
+    for (CdsListItem* item = first; item != last; item = item->next) {
+        item->list = list;
+        count++;
+    }
+    last->list = list;
+    return count;
+}
+
+
+static CdsListItem* cdsListMergeChains(CdsListItem* left, CdsListItem* right,
+        CdsListCompare compare, void* cookie)
+{
+    CdsListItem head;
+    CdsListItem* tail = &head;
+
+    while ((left != NULL) && (right != NULL)) {
+        if (compare(right, left, cookie) < 0) {
+            tail->next = right;
+            right = right->next;
+        } else {
+            tail->next = left;
+            left = left->next;
+        }
+        tail = tail->next;
+    }
+    tail->next = (left != NULL) ? left : right;
+    return head.next;
+}
+
+
+static void* cdsListClearWorker(void* arg)
+{
+    CdsListClearJob* job = arg;
+    CdsListItem* batch[CDSLIST_CLEAR_BATCH];
+
+    for (;;) {
+        // NB: Take the segments alternately from the front and the back,
+        // which is the order in which the walkers make them ready
+        int64_t k = __atomic_fetch_add(&job->next, 1, __ATOMIC_RELAXED);
+        if (k >= job->nsegments) {
+            break;
+        }
+        int64_t i = k / 2;
+        if (k & 1) {
+            i = job->nsegments - 1 - (k / 2);
+        }
+        CdsListClearSegment* segment = &(job->segments[i]);
+        while (!__atomic_load_n(&segment->ready, __ATOMIC_ACQUIRE)) {
+            sched_yield();
+        }
+
+        int64_t count = cdsListClearSegmentSize(job, i);
+        int64_t n = 0;
+        CdsListItem* item = segment->first;
+        for (int64_t j = 0; j < count; j++) {
+            CdsListItem* next = item->next;
+            item->list = NULL;
+            item->next = NULL;
+            item->prev = NULL;
+            if (job->unrefBatch != NULL) {
+                batch[n++] = item;
+                if (n == CDSLIST_CLEAR_BATCH) {
+                    job->unrefBatch(batch, n);
+                    n = 0;
+                }
+            } else if (job->unref != NULL) {
+                job->unref(item);
+            }
+            item = next;
+        }
+        if (n > 0) {
+            job->unrefBatch(batch, n);
+        }
+    }
+    return NULL;
+}
+
+
+static void* cdsListClearBackWorker(void* arg)
+{
+    cdsListClearWalkBackward(arg);
+    return cdsListClearWorker(arg);
+}
+
+
+static void cdsListClearWalkForward(CdsListClearJob* job)
+{
+    CdsListItem* item = job->segments[0].first;
+    for (int64_t i = 0; i < job->nsegments; i++) {
+        CdsListClearSegment* segment = &(job->segments[i]);
+        if (__atomic_exchange_n(&segment->claimed, 1, __ATOMIC_ACQ_REL)) {
+            break;
+        }
+        segment->first = item;
+
+        // NB: The `next` pointer of the last item of the segment gives the
+        // first item of the next segment, which is not accessed
+        int64_t count = cdsListClearSegmentSize(job, i);
+        for (int64_t j = 0; j < count; j++) {
+            item = item->next;
+        }
+        __atomic_store_n(&segment->ready, 1, __ATOMIC_RELEASE);
+    }
+}
+
+
+static void cdsListClearWalkBackward(CdsListClearJob* job)
+{
+    CdsListItem* item = job->last;
+    for (int64_t i = job->nsegments - 1; i > 0; i--) {
+        CdsListClearSegment* segment = &(job->segments[i]);
+        if (__atomic_exchange_n(&segment->claimed, 1, __ATOMIC_ACQ_REL)) {
+            break;
+        }
+
+        // NB: `item` is the last item of the segment; read the `prev` pointer
+        // of its first item before the segment may be unreferenced
+        int64_t count = cdsListClearSegmentSize(job, i);
+        for (int64_t j = 1; j < count; j++) {
+            item = item->prev;
+        }
+        segment->first = item;
+        item = item->prev;
+        __atomic_store_n(&segment->ready, 1, __ATOMIC_RELEASE);
+    }
+}
+
+
+static int64_t cdsListClearSegmentSize(const CdsListClearJob* job,
+        int64_t index)
+{
+    int64_t count = job->count - (index * CDSLIST_CLEAR_SEGMENT);
+    if (count > CDSLIST_CLEAR_SEGMENT) {
+        count = CDSLIST_CLEAR_SEGMENT;
+    }
+    return count;
+}
@@ -0,0 +1,205 @@
+/* Copyright (c) 2016  Fabrice Triboix
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cdsleanlist.h"
+#include "rttest.h"
+
+#include <string.h>
+
+
+typedef struct {
+    CdsLeanListItem cdsLeanListItem;
+    int             ref;
+    int             x;
+} TestItem;
+
+static int gNumberOfItemsInExistence = 0;
+
+static void testItemUnref(CdsLeanListItem* cdsLeanListItem)
+{
+    TestItem* item = (TestItem*)cdsLeanListItem;
+    item->ref--;
+    if (item->ref <= 0) {
+        free(item);
+        gNumberOfItemsInExistence--;
+    }
+}
+
+static TestItem* testItemAlloc(int x)
+{
+    TestItem* item = malloc(sizeof(*item));
+    memset(item, 0, sizeof(*item));
+    item->ref = 1;
+    item->x = x;
+    gNumberOfItemsInExistence++;
+    return item;
+}
+
+// Check the links and values of a list, forwards and backwards
+static bool testCheckList(CdsLeanList* list, const int* values, int count)
+{
+    if (CdsLeanListSize(list) != count) {
+        return false;
+    }
+    int i = 0;
+    CDSLEANLIST_FOREACH(list, TestItem, item) {
+        if ((i >= count) || (item->x != values[i])) {
+            return false;
+        }
+        i++;
+    }
+    if (i != count) {
+        return false;
+    }
+    CDSLEANLIST_FOREACH_REVERSE(list, TestItem, item) {
+        i--;
+        if ((i < 0) || (item->x != values[i])) {
+            return false;
+        }
+    }
+    return (0 == i);
+}
+
+static CdsLeanList* gList = NULL;
+static CdsLeanList* gList2 = NULL;
+
+
+RTT_GROUP_START(TestCdsLeanList, 0x00030004u, NULL, NULL)
+
+RTT_TEST_START(cds_lean_list_item_should_be_16_bytes)
+{
+    RTT_EXPECT(sizeof(CdsLeanListItem) == 2 * sizeof(void*));
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_create_lean_list)
+{
+    gList = CdsLeanListCreate("LeanList", 8, testItemUnref);
+    RTT_ASSERT(gList != NULL);
+    RTT_EXPECT(strcmp(CdsLeanListName(gList), "LeanList") == 0);
+    RTT_EXPECT(CdsLeanListCapacity(gList) == 8);
+    RTT_EXPECT(CdsLeanListIsEmpty(gList));
+    RTT_EXPECT(!CdsLeanListIsFull(gList));
+    RTT_EXPECT(CdsLeanListFront(gList) == NULL);
+    RTT_EXPECT(CdsLeanListBack(gList) == NULL);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_push_items_to_lean_list)
+{
+    for (int i = 3; i < 6; i++) {
+        RTT_ASSERT(CdsLeanListPushBack(gList,
+                    (CdsLeanListItem*)testItemAlloc(i)));
+    }
+    for (int i = 2; i >= 0; i--) {
+        RTT_ASSERT(CdsLeanListPushFront(gList,
+                    (CdsLeanListItem*)testItemAlloc(i)));
+    }
+    int expected[] = { 0, 1, 2, 3, 4, 5 };
+    RTT_EXPECT(testCheckList(gList, expected, 6));
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_insert_items_into_lean_list)
+{
+    CdsLeanListItem* pos = CdsLeanListNext(gList, CdsLeanListFront(gList));
+    RTT_ASSERT(CdsLeanListInsertAfter(gList, pos,
+                (CdsLeanListItem*)testItemAlloc(10)));
+    RTT_ASSERT(CdsLeanListInsertBefore(gList, pos,
+                (CdsLeanListItem*)testItemAlloc(11)));
+    int expected[] = { 0, 11, 1, 10, 2, 3, 4, 5 };
+    RTT_EXPECT(testCheckList(gList, expected, 8));
+    RTT_EXPECT(CdsLeanListIsFull(gList));
+
+    TestItem* item = testItemAlloc(12);
+    RTT_EXPECT(!CdsLeanListPushBack(gList, (CdsLeanListItem*)item));
+    testItemUnref((CdsLeanListItem*)item);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_remove_items_from_lean_list)
+{
+    CdsLeanListItem* item = CdsLeanListNext(gList, CdsLeanListFront(gList));
+    CdsLeanListRemove(gList, item);
+    testItemUnref(item);
+    item = CdsLeanListPopFront(gList);
+    RTT_ASSERT(((TestItem*)item)->x == 0);
+    testItemUnref(item);
+    item = CdsLeanListPopBack(gList);
+    RTT_ASSERT(((TestItem*)item)->x == 5);
+    testItemUnref(item);
+    int expected[] = { 1, 10, 2, 3, 4 };
+    RTT_EXPECT(testCheckList(gList, expected, 5));
+    RTT_EXPECT(5 == gNumberOfItemsInExistence);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_splice_lean_lists)
+{
+    gList2 = CdsLeanListCreate(NULL, 0, testItemUnref);
+    RTT_ASSERT(gList2 != NULL);
+    for (int i = 20; i < 24; i++) {
+        RTT_ASSERT(CdsLeanListPushBack(gList2,
+                    (CdsLeanListItem*)testItemAlloc(i)));
+    }
+
+    // Not enough room in the first list
+    RTT_EXPECT(!CdsLeanListSplice(gList, NULL, gList2));
+
+    // Move [21, 22] after 10
+    CdsLeanListItem* first = CdsLeanListNext(gList2,
+            CdsLeanListFront(gList2));
+    CdsLeanListItem* last = CdsLeanListNext(gList2, first);
+    CdsLeanListItem* pos = CdsLeanListNext(gList, CdsLeanListFront(gList));
+    RTT_ASSERT(CdsLeanListSpliceRange(gList, pos, gList2, first, last, 2));
+    int expected1[] = { 1, 10, 21, 22, 2, 3, 4 };
+    RTT_EXPECT(testCheckList(gList, expected1, 7));
+    int expected2[] = { 20, 23 };
+    RTT_EXPECT(testCheckList(gList2, expected2, 2));
+
+    // Move everything to the second list
+    RTT_ASSERT(CdsLeanListSplice(gList2, CdsLeanListFront(gList2), gList));
+    int expected3[] = { 20, 1, 10, 21, 22, 2, 3, 4, 23 };
+    RTT_EXPECT(testCheckList(gList2, expected3, 9));
+    RTT_EXPECT(testCheckList(gList, NULL, 0));
+
+    // Move a range within the same list
+    first = CdsLeanListFront(gList2);
+    RTT_ASSERT(CdsLeanListSpliceRange(gList2, CdsLeanListBack(gList2),
+                gList2, first, first, 1));
+    int expected4[] = { 1, 10, 21, 22, 2, 3, 4, 23, 20 };
+    RTT_EXPECT(testCheckList(gList2, expected4, 9));
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_destroy_lean_lists)
+{
+    CdsLeanListDestroy(gList);
+    gList = NULL;
+    CdsLeanListDestroy(gList2);
+    gList2 = NULL;
+    RTT_ASSERT(0 == gNumberOfItemsInExistence);
+}
+RTT_TEST_END
+
+RTT_GROUP_END(TestCdsLeanList,
+        cds_lean_list_item_should_be_16_bytes,
+        cds_should_create_lean_list,
+        cds_should_push_items_to_lean_list,
+        cds_should_insert_items_into_lean_list,
+        cds_should_remove_items_from_lean_list,
+        cds_should_splice_lean_lists,
+        cds_should_destroy_lean_lists)
@@ -382,3 +382,505 @@ RTT_GROUP_END(TestCdsListSmall,
         cds_small_list_should_be_as_expected_after_removing_items,
         cds_small_list_should_clear_list,
         cds_should_destroy_small_list)
+
+
+// Thread-safe unref function for parallel clearing
+static void testItemUnrefBatch(CdsListItem** items, int64_t count)
+{
+    for (int64_t i = 0; i < count; i++) {
+        TestItem* item = (TestItem*)items[i];
+        item->ref--;
+        if (item->ref <= 0) {
+            free(item);
+            __atomic_sub_fetch(&gNumberOfItemsInExistence, 1,
+                    __ATOMIC_RELAXED);
+        }
+    }
+}
+
+
+RTT_GROUP_START(TestCdsListClearParallel, 0x00030002u, NULL, NULL)
+
+RTT_TEST_START(cds_should_create_list_to_clear_in_parallel)
+{
+    RTT_ASSERT(0 == gNumberOfItemsInExistence);
+    gList = CdsListCreate(NULL, 0, testItemUnref);
+    RTT_ASSERT(gList != NULL);
+    for (int i = 0; i < 100000; i++) {
+        TestItem* item = testItemAlloc();
+        item->x = i;
+        RTT_ASSERT(CdsListPushBack(gList, (CdsListItem*)item));
+    }
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_clear_list_in_parallel)
+{
+    CdsListClearParallel(gList, 4, testItemUnrefBatch);
+    RTT_EXPECT(CdsListIsEmpty(gList));
+    RTT_EXPECT(CdsListFront(gList) == NULL);
+    RTT_EXPECT(0 == gNumberOfItemsInExistence);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_clear_small_list_with_one_thread)
+{
+    for (int i = 0; i < 10; i++) {
+        RTT_ASSERT(CdsListPushBack(gList, (CdsListItem*)testItemAlloc()));
+    }
+    CdsListClearParallel(gList, 1, NULL);
+    RTT_EXPECT(CdsListIsEmpty(gList));
+    RTT_EXPECT(0 == gNumberOfItemsInExistence);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_clear_list_with_partial_segment_in_parallel)
+{
+    for (int i = 0; i < 4097; i++) {
+        RTT_ASSERT(CdsListPushBack(gList, (CdsListItem*)testItemAlloc()));
+    }
+    CdsListClearParallel(gList, 3, testItemUnrefBatch);
+    RTT_EXPECT(CdsListIsEmpty(gList));
+    RTT_EXPECT(0 == gNumberOfItemsInExistence);
+
+    // The list should still be usable
+    RTT_ASSERT(CdsListPushBack(gList, (CdsListItem*)testItemAlloc()));
+    RTT_EXPECT(CdsListSize(gList) == 1);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_destroy_list_cleared_in_parallel)
+{
+    CdsListDestroy(gList);
+    gList = NULL;
+    RTT_ASSERT(0 == gNumberOfItemsInExistence);
+}
+RTT_TEST_END
+
+RTT_GROUP_END(TestCdsListClearParallel,
+        cds_should_create_list_to_clear_in_parallel,
+        cds_should_clear_list_in_parallel,
+        cds_should_clear_small_list_with_one_thread,
+        cds_should_clear_list_with_partial_segment_in_parallel,
+        cds_should_destroy_list_cleared_in_parallel);
+
+
+// Check the links, back-pointers and values of a list; `values` may be NULL
+static bool testCheckList(CdsList* list, const int* values, int count)
+{
+    if (CdsListSize(list) != count) {
+        return false;
+    }
+    int i = 0;
+    CdsListItem* prev = NULL;
+    for (   CdsListItem* item = CdsListFront(list);
+            item != NULL;
+            item = CdsListNext(item), i++) {
+        if (       (i >= count)
+                || (item->list != list)
+                || (CdsListPrev(item) != prev)) {
+            return false;
+        }
+        if ((values != NULL) && (((TestItem*)item)->x != values[i])) {
+            return false;
+        }
+        prev = item;
+    }
+    return (i == count) && (CdsListBack(list) == prev);
+}
+
+static CdsList* gList2 = NULL;
+
+static CdsListItem* testListItemAt(CdsList* list, int index)
+{
+    CdsListItem* item = CdsListFront(list);
+    for (int i = 0; i < index; i++) {
+        item = CdsListNext(item);
+    }
+    return item;
+}
+
+
+RTT_GROUP_START(TestCdsListSplice, 0x00030003u, NULL, NULL)
+
+RTT_TEST_START(cds_should_create_lists_to_splice)
+{
+    RTT_ASSERT(0 == gNumberOfItemsInExistence);
+    gList = CdsListCreate(NULL, 0, testItemUnref);
+    RTT_ASSERT(gList != NULL);
+    gList2 = CdsListCreate(NULL, 12, testItemUnref);
+    RTT_ASSERT(gList2 != NULL);
+    for (int i = 0; i < 5; i++) {
+        TestItem* item = testItemAlloc();
+        item->x = i;
+        RTT_ASSERT(CdsListPushBack(gList, (CdsListItem*)item));
+        item = testItemAlloc();
+        item->x = 10 + i;
+        RTT_ASSERT(CdsListPushBack(gList2, (CdsListItem*)item));
+    }
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_splice_whole_list)
+{
+    // Insert [10..14] after item 1 of the first list
+    RTT_ASSERT(CdsListSplice(gList, testListItemAt(gList, 1), gList2));
+    int expected[] = { 0, 1, 10, 11, 12, 13, 14, 2, 3, 4 };
+    RTT_EXPECT(testCheckList(gList, expected, 10));
+    RTT_EXPECT(testCheckList(gList2, NULL, 0));
+
+    // Splicing an empty list does nothing
+    RTT_ASSERT(CdsListSplice(gList, NULL, gList2));
+    RTT_EXPECT(testCheckList(gList, expected, 10));
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_splice_range_to_other_list)
+{
+    // Move [10..13] to the front of the second list
+    CdsListItem* first = testListItemAt(gList, 2);
+    CdsListItem* last = testListItemAt(gList, 5);
+    RTT_ASSERT(CdsListSpliceRange(gList2, NULL, first, last, 4));
+    int expected1[] = { 0, 1, 14, 2, 3, 4 };
+    RTT_EXPECT(testCheckList(gList, expected1, 6));
+    int expected2[] = { 10, 11, 12, 13 };
+    RTT_EXPECT(testCheckList(gList2, expected2, 4));
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_splice_range_within_list)
+{
+    // Move [0, 1] after 4
+    CdsListItem* first = testListItemAt(gList, 0);
+    CdsListItem* last = testListItemAt(gList, 1);
+    RTT_ASSERT(CdsListSpliceRange(gList, CdsListBack(gList), first, last, 2));
+    int expected[] = { 14, 2, 3, 4, 0, 1 };
+    RTT_EXPECT(testCheckList(gList, expected, 6));
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_not_splice_beyond_capacity)
+{
+    // The second list can hold 12 items and has 4
+    RTT_ASSERT(CdsListSplice(gList2, CdsListBack(gList2), gList));
+    RTT_EXPECT(testCheckList(gList2, NULL, 10));
+    RTT_EXPECT(testCheckList(gList, NULL, 0));
+    RTT_ASSERT(CdsListCutAfter(gList2, NULL, gList));
+    RTT_EXPECT(testCheckList(gList, NULL, 10));
+    RTT_EXPECT(testCheckList(gList2, NULL, 0));
+    for (int i = 0; i < 3; i++) {
+        RTT_ASSERT(CdsListPushBack(gList2, (CdsListItem*)testItemAlloc()));
+    }
+    RTT_EXPECT(!CdsListSplice(gList2, NULL, gList));
+    RTT_EXPECT(!CdsListSpliceRange(gList2, NULL, CdsListFront(gList),
+                testListItemAt(gList, 9), 10));
+    RTT_EXPECT(!CdsListCutAfter(gList, NULL, gList2));
+    RTT_EXPECT(testCheckList(gList, NULL, 10));
+    RTT_EXPECT(testCheckList(gList2, NULL, 3));
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_cut_list_after_item)
+{
+    CdsListClear(gList2);
+    int expected[] = { 10, 11, 12, 13, 14, 2, 3, 4, 0, 1 };
+    RTT_ASSERT(testCheckList(gList, expected, 10));
+    RTT_ASSERT(CdsListCutAfter(gList, testListItemAt(gList, 6), gList2));
+    RTT_EXPECT(testCheckList(gList, expected, 7));
+    RTT_EXPECT(testCheckList(gList2, expected + 7, 3));
+
+    // Cutting after the last item does nothing
+    RTT_ASSERT(CdsListCutAfter(gList, CdsListBack(gList), gList2));
+    RTT_EXPECT(testCheckList(gList, expected, 7));
+    RTT_EXPECT(testCheckList(gList2, expected + 7, 3));
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_remove_spliced_items)
+{
+    CdsListItem* item = testListItemAt(gList2, 1);
+    CdsListRemove(item);
+    testItemUnref(item);
+    int expected[] = { 4, 1 };
+    RTT_EXPECT(testCheckList(gList2, expected, 2));
+    RTT_EXPECT(9 == gNumberOfItemsInExistence);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_keep_items_linked_to_their_list_after_many_splices)
+{
+    // gList = { 10, 11, 12, 13, 14, 2, 3 }
+    CdsList* list3 = CdsListCreate(NULL, 0, testItemUnref);
+    RTT_ASSERT(list3 != NULL);
+    for (int i = 0; i < 1000; i++) {
+        RTT_ASSERT(CdsListSplice(list3, NULL, gList));
+        RTT_ASSERT(CdsListCutAfter(list3, NULL, gList));
+    }
+
+    // Every item must still lead directly to its list, so walking the list
+    // does not depend on how many times the items have been moved
+    int expected[] = { 10, 11, 12, 13, 14, 2, 3 };
+    RTT_EXPECT(testCheckList(gList, expected, 7));
+    RTT_EXPECT(testCheckList(list3, NULL, 0));
+    CdsListDestroy(list3);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_destroy_spliced_lists)
+{
+    CdsListDestroy(gList);
+    gList = NULL;
+    CdsListDestroy(gList2);
+    gList2 = NULL;
+    RTT_ASSERT(0 == gNumberOfItemsInExistence);
+}
+RTT_TEST_END
+
+RTT_GROUP_END(TestCdsListSplice,
+        cds_should_create_lists_to_splice,
+        cds_should_splice_whole_list,
+        cds_should_splice_range_to_other_list,
+        cds_should_splice_range_within_list,
+        cds_should_not_splice_beyond_capacity,
+        cds_should_cut_list_after_item,
+        cds_should_remove_spliced_items,
+        cds_should_keep_items_linked_to_their_list_after_many_splices,
+        cds_should_destroy_spliced_lists);
+
+
+// Compare items on `x / 10`, so items with the same tens compare equal
+static int testCompareTens(const CdsListItem* left, const CdsListItem* right,
+        void* cookie)
+{
+    int* ncalls = cookie;
+    (*ncalls)++;
+    return (((const TestItem*)left)->x / 10) - (((const TestItem*)right)->x / 10);
+}
+
+static bool testAddItems(CdsList* list, const int* values, int count)
+{
+    for (int i = 0; i < count; i++) {
+        TestItem* item = testItemAlloc();
+        item->x = values[i];
+        if (!CdsListPushBack(list, (CdsListItem*)item)) {
+            testItemUnref((CdsListItem*)item);
+            return false;
+        }
+    }
+    return true;
+}
+
+
+RTT_GROUP_START(TestCdsListSort, 0x00030005u, NULL, NULL)
+
+RTT_TEST_START(cds_should_sort_empty_and_single_item_lists)
+{
+    RTT_ASSERT(0 == gNumberOfItemsInExistence);
+    gList = CdsListCreate(NULL, 0, testItemUnref);
+    RTT_ASSERT(gList != NULL);
+    int ncalls = 0;
+    CdsListSort(gList, testCompareTens, &ncalls);
+    RTT_EXPECT(testCheckList(gList, NULL, 0));
+
+    int values[] = { 42 };
+    RTT_ASSERT(testAddItems(gList, values, 1));
+    CdsListSort(gList, testCompareTens, &ncalls);
+    RTT_EXPECT(testCheckList(gList, values, 1));
+    RTT_EXPECT(0 == ncalls);
+    CdsListClear(gList);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_sort_list_stably)
+{
+    // Units give the original order of items with the same tens
+    int values[] = { 50, 20, 90, 21, 51, 0, 70, 22, 1, 91, 52, 30, 2, 71 };
+    int expected[] = { 0, 1, 2, 20, 21, 22, 30, 50, 51, 52, 70, 71, 90, 91 };
+    int count = sizeof(values) / sizeof(values[0]);
+    RTT_ASSERT(testAddItems(gList, values, count));
+    int ncalls = 0;
+    CdsListSort(gList, testCompareTens, &ncalls);
+    RTT_EXPECT(testCheckList(gList, expected, count));
+
+    // Sorting a sorted list should keep it as is
+    CdsListSort(gList, testCompareTens, &ncalls);
+    RTT_EXPECT(testCheckList(gList, expected, count));
+    CdsListClear(gList);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_sort_large_list)
+{
+    unsigned int seed = 1;
+    int count = 10007;
+    for (int i = 0; i < count; i++) {
+        TestItem* item = testItemAlloc();
+        item->x = rand_r(&seed) % 1000000;
+        RTT_ASSERT(CdsListPushBack(gList, (CdsListItem*)item));
+    }
+    int ncalls = 0;
+    CdsListSort(gList, testCompareTens, &ncalls);
+    RTT_EXPECT(testCheckList(gList, NULL, count));
+    int prev = -1;
+    CDSLIST_FOREACH(gList, TestItem, item) {
+        RTT_ASSERT((item->x / 10) >= (prev / 10));
+        prev = item->x;
+    }
+    CdsListClear(gList);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_merge_sorted_lists)
+{
+    gList2 = CdsListCreate(NULL, 0, testItemUnref);
+    RTT_ASSERT(gList2 != NULL);
+    int values1[] = { 10, 30, 31, 50 };
+    int values2[] = { 0, 32, 33, 60, 61 };
+    RTT_ASSERT(testAddItems(gList, values1, 4));
+    RTT_ASSERT(testAddItems(gList2, values2, 5));
+    int ncalls = 0;
+    RTT_ASSERT(CdsListMergeSorted(gList, gList2, testCompareTens, &ncalls));
+    int expected[] = { 0, 10, 30, 31, 32, 33, 50, 60, 61 };
+    RTT_EXPECT(testCheckList(gList, expected, 9));
+    RTT_EXPECT(testCheckList(gList2, NULL, 0));
+
+    // Merging into an empty list moves all the items
+    RTT_ASSERT(CdsListMergeSorted(gList2, gList, testCompareTens, &ncalls));
+    RTT_EXPECT(testCheckList(gList2, expected, 9));
+    RTT_EXPECT(testCheckList(gList, NULL, 0));
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_not_merge_beyond_capacity)
+{
+    CdsList* small = CdsListCreate(NULL, 10, testItemUnref);
+    int values[] = { 5, 15 };
+    RTT_ASSERT(testAddItems(small, values, 2));
+    int ncalls = 0;
+    RTT_EXPECT(!CdsListMergeSorted(small, gList2, testCompareTens, &ncalls));
+    RTT_EXPECT(testCheckList(small, values, 2));
+    RTT_EXPECT(testCheckList(gList2, NULL, 9));
+    RTT_EXPECT(0 == ncalls);
+    CdsListDestroy(small);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_destroy_sorted_lists)
+{
+    CdsListDestroy(gList);
+    gList = NULL;
+    CdsListDestroy(gList2);
+    gList2 = NULL;
+    RTT_ASSERT(0 == gNumberOfItemsInExistence);
+}
+RTT_TEST_END
+
+RTT_GROUP_END(TestCdsListSort,
+        cds_should_sort_empty_and_single_item_lists,
+        cds_should_sort_list_stably,
+        cds_should_sort_large_list,
+        cds_should_merge_sorted_lists,
+        cds_should_not_merge_beyond_capacity,
+        cds_should_destroy_sorted_lists);
+
+
+typedef struct {
+    int  next;       // Value expected for the next item
+    int  batches;    // Number of batches visited
+    bool ok;         // Whether all the items came in order
+    bool remove;     // Whether to remove and free the visited items
+} TestVisit;
+
+static void testVisitBatch(CdsListItem** items, int64_t count, void* cookie)
+{
+    TestVisit* visit = cookie;
+    visit->batches++;
+    for (int64_t i = 0; i < count; i++) {
+        if (((TestItem*)items[i])->x != visit->next) {
+            visit->ok = false;
+        }
+        visit->next++;
+        if (visit->remove) {
+            CdsListRemove(items[i]);
+            testItemUnref(items[i]);
+        }
+    }
+}
+
+
+RTT_GROUP_START(TestCdsListIterate, 0x00030006u, NULL, NULL)
+
+RTT_TEST_START(cds_should_walk_empty_list_fast)
+{
+    RTT_ASSERT(0 == gNumberOfItemsInExistence);
+    gList = CdsListCreate(NULL, 0, testItemUnref);
+    RTT_ASSERT(gList != NULL);
+    int n = 0;
+    CDSLIST_FOREACH_FAST(gList, TestItem, item) {
+        (void)item;
+        n++;
+    }
+    RTT_EXPECT(0 == n);
+
+    TestVisit visit = { 0, 0, true, false };
+    CdsListForEachBatch(gList, testVisitBatch, 4, &visit);
+    RTT_EXPECT(0 == visit.batches);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_walk_list_fast)
+{
+    for (int i = 0; i < 10; i++) {
+        TestItem* item = testItemAlloc();
+        item->x = i;
+        RTT_ASSERT(CdsListPushBack(gList, (CdsListItem*)item));
+    }
+    int n = 0;
+    CDSLIST_FOREACH_FAST(gList, TestItem, item) {
+        RTT_ASSERT(item->x == n);
+        n++;
+    }
+    RTT_EXPECT(10 == n);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_visit_list_in_batches)
+{
+    TestVisit visit = { 0, 0, true, false };
+    CdsListForEachBatch(gList, testVisitBatch, 3, &visit);
+    RTT_EXPECT(visit.ok);
+    RTT_EXPECT(10 == visit.next);
+    RTT_EXPECT(4 == visit.batches);
+
+    visit.next = 0;
+    visit.batches = 0;
+    CdsListForEachBatch(gList, testVisitBatch, CDSLIST_VISIT_BATCH_MAX, &visit);
+    RTT_EXPECT(visit.ok);
+    RTT_EXPECT(1 == visit.batches);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_remove_items_while_visiting)
+{
+    TestVisit visit = { 0, 0, true, true };
+    CdsListForEachBatch(gList, testVisitBatch, 4, &visit);
+    RTT_EXPECT(visit.ok);
+    RTT_EXPECT(10 == visit.next);
+    RTT_EXPECT(CdsListIsEmpty(gList));
+    RTT_EXPECT(0 == gNumberOfItemsInExistence);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_destroy_walked_list)
+{
+    CdsListDestroy(gList);
+    gList = NULL;
+}
+RTT_TEST_END
+
+RTT_GROUP_END(TestCdsListIterate,
+        cds_should_walk_empty_list_fast,
+        cds_should_walk_list_fast,
+        cds_should_visit_list_in_batches,
+        cds_should_remove_items_while_visiting,
+        cds_should_destroy_walked_list);
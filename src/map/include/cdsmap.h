@@ -27,7 +27,6 @@
 #define CDSMAP_h_
 
 #include "cdscommon.h"
-#include "cdsmap_private.h"
 
 
 
@@ -73,6 +72,17 @@ typedef void (*CdsMapKeyUnref)(void* key);
 typedef void (*CdsMapItemUnref)(CdsMapItem* item);
 
 
+/** Prototype of a function to remove a reference to many items in one go
+ *
+ * This is the same as calling a `CdsMapItemUnref` function on each item, but
+ * allows an allocator to release memory in bulk.
+ *
+ * @param items [in,out] Items to unreference
+ * @param count [in]     Number of items in `items`
+ */
+typedef void (*CdsMapItemUnrefBatch)(CdsMapItem** items, int64_t count);
+
+
 /** Prototype of a function to compare two keys
  *
  * @param leftKey  [in] Left-hand side of the comparison
@@ -85,6 +95,80 @@ typedef void (*CdsMapItemUnref)(CdsMapItem* item);
 typedef int (*CdsMapCompare)(void* leftKey, void* rightKey, void* cookie);
 
 
+/** Balancing policy of a map
+ *
+ * Both policies guarantee O(log(n)) searches, insertions and removals, and
+ * perform at most 2 rotations per insertion.
+ *
+ * An AVL tree is more strictly balanced, so searches are marginally faster.
+ * However, a removal can trigger a rotation at every level of the tree.
+ *
+ * A weak AVL (aka "rank-balanced") tree performs at most 2 rotations per
+ * removal, and O(1) amortised rank updates per insertion or removal. Its
+ * height is at most 2*log2(n), but it is the same as an AVL tree if no removal
+ * is ever performed. Prefer this policy for removal-heavy workloads.
+ */
+typedef enum {
+    CDSMAP_BALANCING_AVL,
+    CDSMAP_BALANCING_WAVL
+} CdsMapBalancing;
+
+
+/** Map statistics
+ *
+ * Statistics are only collected if the library has been compiled with the
+ * `CDSMAP_WITH_STATS` macro defined (use `make STATS=1`, or a debug build).
+ * Otherwise, collecting them costs nothing and `CdsMapGetStats()` returns
+ * `false`.
+ *
+ * A descent is a walk from the root of the tree down to the searched item or
+ * to the insertion point. Its depth is the number of items visited, which is
+ * also the number of calls to the compare function.
+ */
+typedef struct {
+    int64_t searches;         /**< # of calls to `CdsMapSearch()` */
+    int64_t insertions;       /**< # of successful calls to `CdsMapInsert()` */
+    int64_t replacements;     /**< # of insertions that replaced an item */
+    int64_t removals;         /**< # of items removed */
+    int64_t comparisons;      /**< # of calls to the compare function */
+    double  comparisonsPerOp; /**< Avg # of comparisons per search/insert */
+    int64_t descents;         /**< # of descents from the root */
+    int64_t maxDepth;         /**< Deepest descent so far */
+    double  avgDepth;         /**< Average descent depth */
+    int64_t rotationsLL;      /**< # of single rotations to the right */
+    int64_t rotationsRR;      /**< # of single rotations to the left */
+    int64_t rotationsLR;      /**< # of double left-right rotations */
+    int64_t rotationsRL;      /**< # of double right-left rotations */
+    int64_t height;           /**< Current height of the tree */
+} CdsMapStats;
+
+
+/** Opaque type that represents a frozen map
+ *
+ * This is a read-only snapshot of a map, where the keys are laid out in a
+ * single array in the Eytzinger (aka "BFS") order of a complete binary tree:
+ * the children of the key at index `k` are at `2k` and `2k+1`. There are no
+ * child pointers, and searches walk down the array in a way that can be
+ * prefetched. See `CdsMapFreeze()`.
+ */
+typedef struct CdsMapFrozen CdsMapFrozen;
+
+
+/** Prototype of a function to take action on an item of a frozen map
+ *
+ * @param key    [in] Key of the item
+ * @param item   [in] Item
+ * @param cookie [in] Cookie for this function
+ *
+ * @return `true` to continue traversing the map, `false` to stop
+ */
+typedef bool (*CdsMapFrozenAction)(void* key, CdsMapItem* item, void* cookie);
+
+
+/* NB: The private definitions use the types above */
+#include "cdsmap_private.h"
+
+
 
 /*------------------------------+
  | Public function declarations |
@@ -109,6 +193,52 @@ CdsMap* CdsMapCreate(const char* name, int64_t capacity,
         CdsMapKeyUnref keyUnref, CdsMapItemUnref itemUnref);
 
 
+/** Create a map with the given balancing policy
+ *
+ * This is the same as `CdsMapCreate()`, which uses `CDSMAP_BALANCING_AVL`.
+ *
+ * @param name      [in] Name for this map; may be NULL
+ * @param capacity  [in] Max # of items the map can store; 0 = no limit
+ * @param balancing [in] Balancing policy to use for this map
+ * @param compare   [in] Function to compare two keys; must not be NULL
+ * @param cookie    [in] Cookie for the previous function
+ * @param keyUnref  [in] Function to remove a reference to a key; may be NULL
+ *                       if you don't need it
+ * @param itemUnref [in] Function to remove a reference to a item; may be NULL
+ *                       if you don't need it
+ *
+ * @return The newly-allocated map, never NULL
+ */
+CdsMap* CdsMapCreateWithBalancing(const char* name, int64_t capacity,
+        CdsMapBalancing balancing, CdsMapCompare compare, void* cookie,
+        CdsMapKeyUnref keyUnref, CdsMapItemUnref itemUnref);
+
+
+/** Create a map which allocates its memory from the given allocator
+ *
+ * Only the memory of the map itself comes from `allocator`; the keys and
+ * items are allocated by you.
+ *
+ * @param name      [in] Name for this map; may be NULL
+ * @param capacity  [in] Max # of items the map can store; 0 = no limit
+ * @param balancing [in] Balancing policy to use for this map
+ * @param compare   [in] Function to compare two keys; must not be NULL
+ * @param cookie    [in] Cookie for the previous function
+ * @param keyUnref  [in] Function to remove a reference to a key; may be NULL
+ *                       if you don't need it
+ * @param itemUnref [in] Function to remove a reference to a item; may be NULL
+ *                       if you don't need it
+ * @param allocator [in] Allocator to use; it must remain valid until the map is
+ *                       destroyed; NULL to use the default allocator
+ *
+ * @return The newly-allocated map, never NULL
+ */
+CdsMap* CdsMapCreateWithAllocator(const char* name, int64_t capacity,
+        CdsMapBalancing balancing, CdsMapCompare compare, void* cookie,
+        CdsMapKeyUnref keyUnref, CdsMapItemUnref itemUnref,
+        const CdsAllocator* allocator);
+
+
 /** Destroy a map
  *
  * Any key and item remaining in the map will be unreferenced.
@@ -118,6 +248,18 @@ CdsMap* CdsMapCreate(const char* name, int64_t capacity,
 void CdsMapDestroy(CdsMap* map);
 
 
+/** Destroy a map without unreferencing its keys and items
+ *
+ * This is O(1): the items are not walked at all. It is meant for maps whose
+ * keys and items are owned by something else, typically an arena which is
+ * about to be reset or destroyed (see `CdsArena`). The keys and items are
+ * left untouched.
+ *
+ * @param map [in,out] Map to destroy; must not be NULL
+ */
+void CdsMapDestroyNoUnref(CdsMap* map);
+
+
 /** Clear a map
  *
  * This will remove all items in the map.
@@ -127,6 +269,62 @@ void CdsMapDestroy(CdsMap* map);
 void CdsMapClear(CdsMap* map);
 
 
+/** Clear a map incrementally
+ *
+ * This removes at most `budget` items from the map, and then returns. Call
+ * this function again to resume clearing the map where it stopped. This is
+ * useful to clear a large map without blocking an event loop for a long time.
+ *
+ * Once you started clearing a map that way, you must not insert, remove or
+ * iterate over items until the map is empty. You may still search for items
+ * (those which have not been removed yet will be found), or call
+ * `CdsMapClear()` or `CdsMapDestroy()` to finish the job in one go.
+ *
+ * @param map    [in,out] Map to clear; must not be NULL
+ * @param budget [in]     Max # of items to remove; 0 = no limit
+ *
+ * @return `true` if the map is now empty, `false` if there are items left
+ */
+bool CdsMapClearStep(CdsMap* map, int64_t budget);
+
+
+/** Clear a map using many threads
+ *
+ * The tree is cut into sub-trees which are cleared by `threads` threads
+ * (including the calling thread). This is useful to quickly release a very
+ * large map.
+ *
+ * The key unref function and the item unref function (either `unrefBatch` or
+ * the one given to `CdsMapCreate()`) will be called from multiple threads at
+ * the same time, so they must be thread-safe.
+ *
+ * @param map        [in,out] Map to clear; must not be NULL
+ * @param threads    [in]     Number of threads to use; must be >= 1
+ * @param unrefBatch [in]     Function to unreference many items in one go;
+ *                            set to NULL to use the map item unref function
+ */
+void CdsMapClearParallel(CdsMap* map, int threads,
+        CdsMapItemUnrefBatch unrefBatch);
+
+
+/** Detach all the items of a map, in O(1)
+ *
+ * All the items of `map` are moved into a newly-allocated map, which has the
+ * same name, capacity, balancing policy and callbacks as `map`. `map` is
+ * left empty.
+ *
+ * This allows to hand over the items to another thread, which can then
+ * release them by calling `CdsMapDestroy()` or `CdsMapClearStep()` on the
+ * returned map. Please note the callbacks will then be called from that
+ * thread.
+ *
+ * @param map [in,out] Map to empty; must not be NULL
+ *
+ * @return A map holding the detached items, never NULL
+ */
+CdsMap* CdsMapDetach(CdsMap* map);
+
+
 /** Get the map's name
  *
  * @param map [in] Map to query; must not be NULL
@@ -269,6 +467,162 @@ CdsMapItem* CdsMapIteratorStart(CdsMap* map, bool ascending, void** pKey);
 CdsMapItem* CdsMapIteratorNext(CdsMap* map, void** pKey);
 
 
+/** Get the map statistics
+ *
+ * Computing the current height of the tree takes O(log(n)) for a balanced AVL
+ * map, and O(n) otherwise.
+ *
+ * @param map    [in]  Map to query; must not be NULL
+ * @param pStats [out] Where to write the statistics; must not be NULL; it is
+ *                     zeroed if statistics are not available
+ *
+ * @return `true` if OK, `false` if the library has been compiled without
+ *         statistics support
+ */
+bool CdsMapGetStats(const CdsMap* map, CdsMapStats* pStats);
+
+
+/** Reset the map statistics
+ *
+ * This does nothing if the library has been compiled without statistics
+ * support.
+ *
+ * @param map [in,out] Map to manipulate; must not be NULL
+ */
+void CdsMapResetStats(CdsMap* map);
+
+
+/** Enter burst mode
+ *
+ * In burst mode, the map is not rebalanced when items are inserted or removed.
+ * Items are inserted as in a plain binary search tree, and the sub-trees that
+ * have been modified are marked as dirty. This is useful when inserting a lot
+ * of items in one go, because most of the rotations would be undone or
+ * superseded within the same burst anyway.
+ *
+ * Searching, iterating and removing items remain correct in burst mode, but
+ * may be slower because the tree can be unbalanced. Call `CdsMapRebalance()`
+ * or `CdsMapBurstEnd()` to restore a balanced tree.
+ *
+ * Burst mode is only available for maps using `CDSMAP_BALANCING_AVL`.
+ *
+ * @param map [in,out] Map to manipulate; must not be NULL
+ */
+void CdsMapBurstBegin(CdsMap* map);
+
+
+/** Leave burst mode
+ *
+ * This rebalances the map, see `CdsMapRebalance()`.
+ *
+ * @param map [in,out] Map to manipulate; must not be NULL
+ */
+void CdsMapBurstEnd(CdsMap* map);
+
+
+/** Test if the map is in burst mode
+ *
+ * @param map [in] Map to query; must not be NULL
+ *
+ * @return `true` if `map` is in burst mode, `false` otherwise
+ */
+bool CdsMapIsBursting(const CdsMap* map);
+
+
+/** Rebalance the dirty sub-trees of the map in one pass
+ *
+ * Only the sub-trees that have been modified since the last rebalance are
+ * visited. Calling this function does not make the map leave burst mode. It
+ * does nothing if the map is not dirty.
+ *
+ * You must not call this function while iterating over the map.
+ *
+ * @param map [in,out] Map to rebalance; must not be NULL
+ */
+void CdsMapRebalance(CdsMap* map);
+
+
+/** Freeze a map into a compact array layout
+ *
+ * This is meant for read-mostly phases: searching a frozen map does not chase
+ * pointers from item to item, and the key of the next comparison does not
+ * depend on the result of the previous one (i.e. there is no unpredictable
+ * branch), so the cache lines of the next levels can be prefetched.
+ *
+ * The keys and items remain owned by `map`. The frozen map is not updated when
+ * `map` changes: don't insert or remove items, or destroy `map`, while you use
+ * the frozen map. Destroy it and freeze `map` again after an update phase.
+ *
+ * This takes O(n) time and 2 pointers of memory per item, allocated from the
+ * allocator of `map`, which must remain valid until the frozen map is
+ * destroyed.
+ *
+ * @param map [in] Map to freeze; must not be NULL
+ *
+ * @return The frozen map, never NULL; destroy it with `CdsMapFrozenDestroy()`
+ */
+CdsMapFrozen* CdsMapFreeze(const CdsMap* map);
+
+
+/** Destroy a frozen map
+ *
+ * The keys and items are not unreferenced.
+ *
+ * @param frozen [in,out] Frozen map to destroy; must not be NULL
+ */
+void CdsMapFrozenDestroy(CdsMapFrozen* frozen);
+
+
+/** Get the number of items in a frozen map
+ *
+ * @param frozen [in] Frozen map to query; must not be NULL
+ *
+ * @return The number of items
+ */
+int64_t CdsMapFrozenSize(const CdsMapFrozen* frozen);
+
+
+/** Search for an item in a frozen map
+ *
+ * This calls the compare function ceil(log2(n+1)) times, plus one for the
+ * final equality check.
+ *
+ * @param frozen [in] Frozen map to search; must not be NULL
+ * @param key    [in] Key to search for
+ *
+ * @return The found item, or NULL if not found
+ */
+CdsMapItem* CdsMapFrozenSearch(const CdsMapFrozen* frozen, void* key);
+
+
+/** Traverse a frozen map in ascending order of keys
+ *
+ * @param frozen [in] Frozen map to traverse; must not be NULL
+ * @param action [in] Action to apply to the items; must not be NULL
+ * @param cookie [in] Cookie for the action function
+ */
+void CdsMapFrozenTraverse(const CdsMapFrozen* frozen, CdsMapFrozenAction action,
+        void* cookie);
+
+
+
+/*--------------------+
+ | Header-inline mode |
+ +--------------------*/
+
+
+/* When `CDS_INLINE` is defined (`make INLINE=1`), calls to the functions below
+ * are compiled inline instead of going through the library; the library
+ * functions remain available.
+ */
+#ifdef CDS_INLINE
+#define CdsMapCapacity(_map) cdsMapCapacityInline(_map)
+#define CdsMapSize(_map)     cdsMapSizeInline(_map)
+#define CdsMapIsEmpty(_map)  cdsMapIsEmptyInline(_map)
+#define CdsMapIsFull(_map)   cdsMapIsFullInline(_map)
+#endif
+
+
 
 #endif /* CDSMAP_h_ */
 /* @} */
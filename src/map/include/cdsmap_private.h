@@ -35,10 +35,80 @@ struct CdsMapItem
     struct CdsMapItem* left;
     struct CdsMapItem* right;
     void*              key;
-    int8_t             factor;
+    int8_t             factor; // AVL balance factor, or rank for WAVL trees
     uint8_t            flags;
 };
 
 
+/* Map
+ *
+ * This is only visible so the fast paths below can be inlined; do not access
+ * its fields directly.
+ *
+ * NB: The statistics must stay last, so the other fields are at the same
+ * place whether or not `CDSMAP_WITH_STATS` is defined when this is included.
+ */
+struct CdsMap
+{
+    struct CdsMapItem*  root; // Must stay first, the unit tests rely on it
+    char*               name;
+    int64_t             capacity;
+    int64_t             size;
+    CdsMapCompare       compare;
+    void*               cookie;
+    CdsMapKeyUnref      keyUnref;
+    CdsMapItemUnref     itemUnref;
+    bool                iterAscending;
+    struct CdsMapItem*  iterNext;
+    bool                burst;
+    CdsMapBalancing     balancing;
+    struct CdsMapItem*  clearNext; // Where to resume `CdsMapClearStep()`
+    const CdsAllocator* allocator;
+#ifdef CDSMAP_WITH_STATS
+    CdsMapStats         stats;
+    int64_t             statsDepthSum;
+#endif
+};
+
+
+
+/*-----------------------------+
+ | Inline function definitions |
+ +-----------------------------*/
+
+
+/* These are the implementations of the hot accessors. The library functions
+ * call them, and so does user code compiled with `CDS_INLINE` defined (see
+ * "cdsmap.h").
+ */
+
+
+static inline int64_t cdsMapCapacityInline(const struct CdsMap* map)
+{
+    CDSASSERT_FULL(map != NULL);
+    return map->capacity;
+}
+
+
+static inline int64_t cdsMapSizeInline(const struct CdsMap* map)
+{
+    CDSASSERT_FULL(map != NULL);
+    return map->size;
+}
+
+
+static inline bool cdsMapIsEmptyInline(const struct CdsMap* map)
+{
+    CDSASSERT_FULL(map != NULL);
+    return map->size <= 0;
+}
+
+
+static inline bool cdsMapIsFullInline(const struct CdsMap* map)
+{
+    CDSASSERT_FULL(map != NULL);
+    return (map->capacity > 0) && (map->size >= map->capacity);
+}
+
 
 #endif /* CDSMAP_PRIVATE_h_ */
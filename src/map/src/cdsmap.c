@@ -14,9 +14,13 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+/* Always build the out-of-line functions, whatever the inline build mode */
+#undef CDS_INLINE
+
 #include "cdsmap.h"
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
 
 
 
@@ -30,19 +34,51 @@
 #define CDSMAP_FLAG_ITER_LEFT  0x10
 #define CDSMAP_FLAG_ITER_RIGHT 0x20
 #define CDSMAP_FLAG_ITER_SELF  0x04
+#define CDSMAP_FLAG_DIRTY      0x40
+
+
+/** Max # of items passed to a batch unref function in one go */
+#define CDSMAP_CLEAR_BATCH 256
+
+/** # of sub-trees per thread when clearing a map in parallel */
+#define CDSMAP_CLEAR_SUBTREES_PER_THREAD 8
+
+/** Alignment of the key array of a frozen map */
+#define CDSMAP_CACHE_LINE 64
+
+/** # of keys in a cache line of a frozen map */
+#define CDSMAP_KEYS_PER_LINE (CDSMAP_CACHE_LINE / (int64_t)sizeof(void*))
+
+
+/** Increment a statistics counter; compiles to nothing without statistics */
+#ifdef CDSMAP_WITH_STATS
+#define CDSMAP_STAT_INC(_map, _field) ((_map)->stats._field++)
+#else
+#define CDSMAP_STAT_INC(_map, _field) do { } while (0)
+#endif
 
 
-struct CdsMap {
-    CdsMapItem*     root; // Keep this at the top, it's necessary for unit tests
-    char*           name;
-    int64_t         capacity;
-    int64_t         size;
-    CdsMapCompare   compare;
-    void*           cookie;
-    CdsMapKeyUnref  keyUnref;
-    CdsMapItemUnref itemUnref;
-    bool            iterAscending;
-    CdsMapItem*     iterNext;
+/** Shared state of the threads clearing a map in parallel */
+typedef struct {
+    CdsMap*              map;
+    CdsMapItem**         subtrees; // Roots of the sub-trees to clear
+    int64_t              count;    // Number of sub-trees
+    int64_t              next;     // Next sub-tree to clear
+    CdsMapItemUnrefBatch unrefBatch;
+} CdsMapClearJob;
+
+
+/** Frozen map
+ *
+ * Both arrays are indexed from 1 in Eytzinger order; index 0 is not used.
+ */
+struct CdsMapFrozen {
+    void**              keys;  // Aligned on a cache line
+    CdsMapItem**        items;
+    int64_t             size;
+    CdsMapCompare       compare;
+    void*               cookie;
+    const CdsAllocator* allocator;
 };
 
 
@@ -58,7 +94,7 @@ struct CdsMap {
  */
 static inline void cdsMapClearDigFlags(CdsMapItem* item)
 {
-    CDSASSERT(item != NULL);
+    CDSASSERT_FULL(item != NULL);
     item->flags &= ~(CDSMAP_FLAG_DIG_LEFT | CDSMAP_FLAG_DIG_RIGHT);
 }
 
@@ -72,7 +108,7 @@ static inline void cdsMapClearDigFlags(CdsMapItem* item)
  */
 static inline bool cdsMapIsLeftChild(const CdsMapItem* item)
 {
-    CDSASSERT(item != NULL);
+    CDSASSERT_FULL(item != NULL);
     return (item->parent != NULL) && (item->parent->left == item);
 }
 
@@ -86,7 +122,7 @@ static inline bool cdsMapIsLeftChild(const CdsMapItem* item)
  */
 static bool cdsMapIsRightChild(const CdsMapItem* item)
 {
-    CDSASSERT(item != NULL);
+    CDSASSERT_FULL(item != NULL);
     return (item->parent != NULL) && (item->parent->right == item);
 }
 
@@ -99,11 +135,34 @@ static bool cdsMapIsRightChild(const CdsMapItem* item)
  */
 static bool cdsMapIsLeaf(const CdsMapItem* item)
 {
-    CDSASSERT(item != NULL);
+    CDSASSERT_FULL(item != NULL);
     return (item->left == NULL) && (item->right == NULL);
 }
 
 
+/** Record a descent from the root of the tree
+ *
+ * This compiles to nothing without statistics.
+ *
+ * @param map   [in,out] Map to manipulate; must not be NULL
+ * @param depth [in]     Number of items visited during the descent
+ */
+static inline void cdsMapStatDescent(CdsMap* map, int64_t depth)
+{
+#ifdef CDSMAP_WITH_STATS
+    map->stats.descents++;
+    map->stats.comparisons += depth;
+    map->statsDepthSum += depth;
+    if (depth > map->stats.maxDepth) {
+        map->stats.maxDepth = depth;
+    }
+#else
+    (void)map;
+    (void)depth;
+#endif
+}
+
+
 /** Go down a sub-tree as far as possible on the left
  *
  * @param item [in] The sub-tree root; must not be NULL
@@ -140,6 +199,32 @@ static CdsMapItem* cdsMapDigRight(CdsMapItem* item);
 static CdsMapItem* cdsMapDigRightIter(CdsMapItem* item);
 
 
+/** Rotate the sub-tree rooted at `subroot` to the left
+ *
+ * The right child of `subroot` becomes the root of the sub-tree. Balance
+ * factors and ranks are not updated.
+ *
+ * @param map     [in,out] Map to manipulate; must not be NULL
+ * @param subroot [in,out] Root of the sub-tree to rotate; must not be NULL
+ *
+ * @return The root of the rotated sub-tree
+ */
+static CdsMapItem* cdsMapRotateLeft(CdsMap* map, CdsMapItem* subroot);
+
+
+/** Rotate the sub-tree rooted at `subroot` to the right
+ *
+ * The left child of `subroot` becomes the root of the sub-tree. Balance
+ * factors and ranks are not updated.
+ *
+ * @param map     [in,out] Map to manipulate; must not be NULL
+ * @param subroot [in,out] Root of the sub-tree to rotate; must not be NULL
+ *
+ * @return The root of the rotated sub-tree
+ */
+static CdsMapItem* cdsMapRotateRight(CdsMap* map, CdsMapItem* subroot);
+
+
 /** Perform a single RR rotation of the sub-tree rooted at `subroot`
  *
  * @param map     [in,out] Map to manipulate; must not be NULL
@@ -180,6 +265,36 @@ static CdsMapItem* cdsMapRotateRightLeft(CdsMap* map, CdsMapItem* subroot);
 static CdsMapItem* cdsMapRotateLeftRight(CdsMap* map, CdsMapItem* subroot);
 
 
+/** Get the rank of an item in a WAVL tree
+ *
+ * @param item [in] Item to query; may be NULL
+ *
+ * @return The rank of `item`, or -1 if `item` is NULL
+ */
+static inline int cdsMapRank(const CdsMapItem* item)
+{
+    return (item != NULL) ? item->factor : -1;
+}
+
+
+/** Restore the WAVL rank rule after `newitem` has been inserted as a leaf
+ *
+ * @param map     [in,out] Map to manipulate; must not be NULL
+ * @param newitem [in,out] Item that has just been inserted; must not be NULL
+ */
+static void cdsMapWavlInsertFixup(CdsMap* map, CdsMapItem* newitem);
+
+
+/** Restore the WAVL rank rule after an item has been removed
+ *
+ * @param map    [in,out] Map to manipulate; must not be NULL
+ * @param parent [in,out] Parent of the removed item; may be NULL
+ * @param isLeft [in]     Whether the removed item was the left child of
+ *                        `parent`
+ */
+static void cdsMapWavlRemoveFixup(CdsMap* map, CdsMapItem* parent, bool isLeft);
+
+
 /** Insert a new item left or right of the given `item`
  *
  * This function takes care of rebalancing the whole tree.
@@ -194,6 +309,85 @@ static void cdsMapInsertOne(CdsMap* map, CdsMapItem* item,
         CdsMapItem* newitem, void* key, bool insertLeft);
 
 
+/** Retrace the tree after the sub-tree rooted at `item` grew by 1
+ *
+ * This function updates the balance factors of the ancestors of `item` and
+ * performs rotations as necessary. It stops when the height of the current
+ * sub-tree does not change anymore, or when `stop` is reached.
+ *
+ * @param map  [in,out] Map to manipulate; must not be NULL
+ * @param item [in,out] Root of the sub-tree that grew; must not be NULL
+ * @param stop [in]     Ancestor where to stop retracing; NULL to go as far as
+ *                      the root of the tree
+ *
+ * @return `true` if the sub-tree right under `stop` grew, `false` if the
+ *         retracing stopped before reaching `stop`
+ */
+static bool cdsMapRetraceGrow(CdsMap* map, CdsMapItem* item, CdsMapItem* stop);
+
+
+/** Mark an item and its ancestors as dirty
+ *
+ * This is used in burst mode to remember which sub-trees need to be
+ * rebalanced. Marking stops at the first ancestor which is already dirty,
+ * because all its own ancestors are dirty as well.
+ *
+ * @param item [in,out] Item to mark; may be NULL
+ */
+static void cdsMapMarkDirty(CdsMapItem* item);
+
+
+/** Compute the height of a sub-tree
+ *
+ * The balance factors of the sub-tree must be valid, i.e. it must not contain
+ * any dirty item.
+ *
+ * @param item [in] Root of the sub-tree; may be NULL
+ *
+ * @return The height of the sub-tree, 0 if `item` is NULL
+ */
+static int cdsMapHeight(const CdsMapItem* item);
+
+
+/** Rebalance the sub-tree rooted at a dirty item
+ *
+ * Both sub-trees under `item` must already be balanced. If their heights
+ * differ by more than 1, `item` is re-inserted along the inner spine of the
+ * taller sub-tree (this is known as an AVL "join").
+ *
+ * @param map         [in,out] Map to manipulate; must not be NULL
+ * @param item        [in,out] Dirty item to fix; must not be NULL
+ * @param leftHeight  [in]     Height of the sub-tree left of `item`
+ * @param rightHeight [in]     Height of the sub-tree right of `item`
+ *
+ * @return The height of the rebalanced sub-tree
+ */
+static int cdsMapJoin(CdsMap* map, CdsMapItem* item,
+        int leftHeight, int rightHeight);
+
+
+/** Unreference an item and its key, batching the item unref calls
+ *
+ * @param map        [in]     Map being cleared; must not be NULL
+ * @param unrefBatch [in]     Batch unref function; may be NULL
+ * @param batch      [in,out] Items waiting to be unreferenced
+ * @param pCount     [in,out] Number of items in `batch`
+ * @param item       [in,out] Item to unreference; NULL to flush `batch`
+ */
+static void cdsMapClearUnref(const CdsMap* map,
+        CdsMapItemUnrefBatch unrefBatch, CdsMapItem** batch, int64_t* pCount,
+        CdsMapItem* item);
+
+
+/** Clear the sub-trees of a map being cleared in parallel
+ *
+ * @param arg [in,out] The `CdsMapClearJob`
+ *
+ * @return Always NULL
+ */
+static void* cdsMapClearWorker(void* arg);
+
+
 /** Move `map->iterNext` to the next item in the iteration
  *
  * @param map [in,out] Map to manipulate; must not be NULL
@@ -201,6 +395,36 @@ static void cdsMapInsertOne(CdsMap* map, CdsMapItem* item,
 static void cdsMapIterNext(CdsMap* map);
 
 
+/** Get the next item in ascending order
+ *
+ * Unlike `cdsMapIterNext()`, this does not write to the items.
+ *
+ * @param item [in] Current item; must not be NULL
+ *
+ * @return The next item, or NULL if `item` is the last one
+ */
+static CdsMapItem* cdsMapSuccessor(const CdsMapItem* item);
+
+
+/** Get the first index of a frozen map in ascending order
+ *
+ * @param size [in] Number of items in the frozen map
+ *
+ * @return The index of the smallest key, or 0 if `size` is 0
+ */
+static int64_t cdsMapFrozenFirst(int64_t size);
+
+
+/** Get the next index of a frozen map in ascending order
+ *
+ * @param k    [in] Current index
+ * @param size [in] Number of items in the frozen map
+ *
+ * @return The index of the next key, or 0 if `k` is the last one
+ */
+static int64_t cdsMapFrozenNext(int64_t k, int64_t size);
+
+
 
 /*---------------------------------+
  | Public function implementations |
@@ -210,14 +434,36 @@ static void cdsMapIterNext(CdsMap* map);
 CdsMap* CdsMapCreate(const char* name, int64_t capacity, CdsMapCompare compare,
         void* cookie, CdsMapKeyUnref keyUnref, CdsMapItemUnref itemUnref)
 {
-    CDSASSERT(compare != NULL);
+    return CdsMapCreateWithBalancing(name, capacity, CDSMAP_BALANCING_AVL,
+            compare, cookie, keyUnref, itemUnref);
+}
 
-    CdsMap* map = CdsMallocZ(sizeof(*map));
 
-    if (name != NULL) {
-        map->name = strdup(name);
-        CDSASSERT(map->name != NULL);
+CdsMap* CdsMapCreateWithBalancing(const char* name, int64_t capacity,
+        CdsMapBalancing balancing, CdsMapCompare compare, void* cookie,
+        CdsMapKeyUnref keyUnref, CdsMapItemUnref itemUnref)
+{
+    return CdsMapCreateWithAllocator(name, capacity, balancing, compare,
+            cookie, keyUnref, itemUnref, NULL);
+}
+
+
+CdsMap* CdsMapCreateWithAllocator(const char* name, int64_t capacity,
+        CdsMapBalancing balancing, CdsMapCompare compare, void* cookie,
+        CdsMapKeyUnref keyUnref, CdsMapItemUnref itemUnref,
+        const CdsAllocator* allocator)
+{
+    CDSASSERT_FULL(compare != NULL);
+    CDSASSERT(   (balancing == CDSMAP_BALANCING_AVL)
+              || (balancing == CDSMAP_BALANCING_WAVL));
+
+    if (allocator == NULL) {
+        allocator = CdsDefaultAllocator();
     }
+    CdsMap* map = CdsAllocZ(allocator, sizeof(*map));
+
+    map->allocator = allocator;
+    map->name = CdsStrdup(allocator, name);
     if (capacity > 0) {
         map->capacity = capacity;
     }
@@ -225,6 +471,7 @@ CdsMap* CdsMapCreate(const char* name, int64_t capacity, CdsMapCompare compare,
     map->cookie = cookie;
     map->keyUnref = keyUnref;
     map->itemUnref = itemUnref;
+    map->balancing = balancing;
 
     return map;
 }
@@ -232,98 +479,226 @@ CdsMap* CdsMapCreate(const char* name, int64_t capacity, CdsMapCompare compare,
 
 void CdsMapDestroy(CdsMap* map)
 {
-    CDSASSERT(map != NULL);
+    CDSASSERT_FULL(map != NULL);
     CdsMapClear(map);
-    free(map->name);
-    free(map);
+    CdsFree(map->allocator, map->name);
+    CdsFree(map->allocator, map);
+}
+
+
+void CdsMapDestroyNoUnref(CdsMap* map)
+{
+    CDSASSERT_FULL(map != NULL);
+    CdsFree(map->allocator, map->name);
+    CdsFree(map->allocator, map);
 }
 
 
 void CdsMapClear(CdsMap* map)
 {
-    CDSASSERT(map != NULL);
+    CDSASSERT_FULL(map != NULL);
+    CdsMapClearStep(map, 0);
+}
 
-    if (map->root != NULL) {
-        // Traverse the tree in post-order fashion
-        cdsMapClearDigFlags(map->root);
-        for (CdsMapItem* curr = map->root; curr != NULL; ) {
-            if (!(curr->flags & CDSMAP_FLAG_DIG_LEFT) && (curr->left != NULL)) {
-                curr->flags |= CDSMAP_FLAG_DIG_LEFT;
-                curr = curr->left;
-                cdsMapClearDigFlags(curr);
 
-            } else if (   !(curr->flags & CDSMAP_FLAG_DIG_RIGHT)
-                        && (curr->right != NULL)) {
-                curr->flags |= CDSMAP_FLAG_DIG_RIGHT;
-                curr = curr->right;
-                cdsMapClearDigFlags(curr);
+bool CdsMapClearStep(CdsMap* map, int64_t budget)
+{
+    CDSASSERT_FULL(map != NULL);
+    CDSASSERT(budget >= 0);
 
+    // Traverse the tree in post-order fashion
+    //
+    // NB: Each item is unlinked from its parent before being unreferenced, so
+    // the items which are still in the tree always form a valid binary search
+    // tree and we can resume from any of them. We do not use the "dig" flags
+    // for the same reason.
+    CdsMapItem* curr = map->clearNext;
+    if (curr == NULL) {
+        curr = map->root;
+    }
+    int64_t count = 0;
+    while ((curr != NULL) && ((budget == 0) || (count < budget))) {
+        if (curr->left != NULL) {
+            curr = curr->left;
+        } else if (curr->right != NULL) {
+            curr = curr->right;
+        } else {
+            CdsMapItem* parent = curr->parent;
+            if (parent == NULL) {
+                map->root = NULL;
+            } else if (parent->left == curr) {
+                parent->left = NULL;
             } else {
-                CdsMapItem* tmp = curr->parent;
-                if (map->keyUnref != NULL) {
-                    map->keyUnref(curr->key);
-                }
-                if (map->itemUnref != NULL) {
-                    map->itemUnref(curr);
-                }
-                curr = tmp;
+                parent->right = NULL;
+            }
+            if (map->keyUnref != NULL) {
+                map->keyUnref(curr->key);
+            }
+            if (map->itemUnref != NULL) {
+                map->itemUnref(curr);
+            }
+            map->size--;
+            count++;
+            curr = parent;
+        }
+    }
+    map->clearNext = curr;
+
+    if (map->root != NULL) {
+        return false;
+    }
+    CDSASSERT(map->size == 0);
+    map->iterNext = NULL;
+    return true;
+}
+
+
+void CdsMapClearParallel(CdsMap* map, int threads,
+        CdsMapItemUnrefBatch unrefBatch)
+{
+    CDSASSERT_FULL(map != NULL);
+    CDSASSERT(threads >= 1);
+
+    if (map->root == NULL) {
+        return;
+    }
+
+    // Cut the top of the tree, level by level, until we have enough sub-trees
+    // to keep all threads busy; the items at the top are cleared by this
+    // thread once the sub-trees are done
+    int64_t max = 1;
+    while (max < (int64_t)threads * CDSMAP_CLEAR_SUBTREES_PER_THREAD) {
+        max *= 2;
+    }
+    CdsMapItem** top = CdsAlloc(map->allocator, max * sizeof(*top));
+    CdsMapItem** subtrees = CdsAlloc(map->allocator,
+            max * sizeof(*subtrees));
+    CdsMapItem** children = CdsAlloc(map->allocator,
+            max * sizeof(*children));
+    int64_t ntop = 0;
+    int64_t count = 1;
+    subtrees[0] = map->root;
+    map->root->parent = NULL;
+    while ((count > 0) && (ntop + (count * 2) <= max)) {
+        int64_t n = 0;
+        for (int64_t i = 0; i < count; i++) {
+            CdsMapItem* item = subtrees[i];
+            top[ntop++] = item;
+            if (item->left != NULL) {
+                item->left->parent = NULL;
+                children[n++] = item->left;
+            }
+            if (item->right != NULL) {
+                item->right->parent = NULL;
+                children[n++] = item->right;
             }
+            item->left = NULL;
+            item->right = NULL;
         }
+        CdsMapItem** tmp = subtrees;
+        subtrees = children;
+        children = tmp;
+        count = n;
     }
 
+    CdsMapClearJob job;
+    job.map = map;
+    job.subtrees = subtrees;
+    job.count = count;
+    job.next = 0;
+    job.unrefBatch = unrefBatch;
+    int nworkers = 0;
+    pthread_t* workers = CdsAlloc(map->allocator, threads * sizeof(*workers));
+    for (int i = 1; (i < threads) && (nworkers < count); i++) {
+        // NB: If we can't create a thread, we just do more work ourselves
+        if (pthread_create(&workers[nworkers], NULL,
+                    cdsMapClearWorker, &job) == 0) {
+            nworkers++;
+        }
+    }
+    cdsMapClearWorker(&job);
+    for (int i = 0; i < nworkers; i++) {
+        pthread_join(workers[i], NULL);
+    }
+
+    CdsMapItem* batch[CDSMAP_CLEAR_BATCH];
+    int64_t n = 0;
+    for (int64_t i = 0; i < ntop; i++) {
+        cdsMapClearUnref(map, unrefBatch, batch, &n, top[i]);
+    }
+    cdsMapClearUnref(map, unrefBatch, batch, &n, NULL);
+
+    CdsFree(map->allocator, workers);
+    CdsFree(map->allocator, children);
+    CdsFree(map->allocator, subtrees);
+    CdsFree(map->allocator, top);
     map->root = NULL;
     map->size = 0;
+    map->iterNext = NULL;
+    map->clearNext = NULL;
+}
+
+
+CdsMap* CdsMapDetach(CdsMap* map)
+{
+    CDSASSERT_FULL(map != NULL);
+
+    CdsMap* detached = CdsAlloc(map->allocator, sizeof(*detached));
+    *detached = *map;
+    detached->name = CdsStrdup(map->allocator, map->name);
+    detached->iterNext = NULL;
+
+    map->root = NULL;
+    map->size = 0;
+    map->iterNext = NULL;
+    map->clearNext = NULL;
+    return detached;
 }
 
 
 const char* CdsMapName(const CdsMap* map)
 {
-    CDSASSERT(map != NULL);
+    CDSASSERT_FULL(map != NULL);
     return map->name;
 }
 
 
 int64_t CdsMapCapacity(const CdsMap* map)
 {
-    CDSASSERT(map != NULL);
-    return map->capacity;
+    return cdsMapCapacityInline(map);
 }
 
 
 int64_t CdsMapSize(const CdsMap* map)
 {
-    CDSASSERT(map != NULL);
-    return map->size;
+    return cdsMapSizeInline(map);
 }
 
 
 bool CdsMapIsEmpty(const CdsMap* map)
 {
-    CDSASSERT(map != NULL);
-    return (map->size <= 0);
+    return cdsMapIsEmptyInline(map);
 }
 
 
 bool CdsMapIsFull(const CdsMap* map)
 {
-    CDSASSERT(map != NULL);
-    bool isFull = false;
-    if ((map->capacity > 0) && (map->size >= map->capacity)) {
-        isFull = true;
-    }
-    return isFull;
+    return cdsMapIsFullInline(map);
 }
 
 
 bool CdsMapInsert(CdsMap* map, void* key, CdsMapItem* item)
 {
-    CDSASSERT(map != NULL);
+    CDSASSERT_FULL(map != NULL);
     CDSASSERT(map->compare != NULL);
-    CDSASSERT(item != NULL);
+    CDSASSERT_FULL(item != NULL);
+
+    CDSASSERT(map->clearNext == NULL);
 
     if (CdsMapIsFull(map)) {
         return false;
     }
+    CDSMAP_STAT_INC(map, insertions);
 
     if (map->root == NULL) {
         item->parent = NULL;
@@ -331,14 +706,18 @@ bool CdsMapInsert(CdsMap* map, void* key, CdsMapItem* item)
         item->right = NULL;
         item->key = key;
         item->factor = 0;
+        item->flags = 0;
         map->root = item;
         map->size = 1;
+        cdsMapStatDescent(map, 0);
         return true;
     }
 
     bool inserted = false;
+    int64_t depth = 0;
     CdsMapItem* curr = map->root;
     while (!inserted && (curr != NULL)) {
+        depth++;
         int cmp = map->compare(key, curr->key, map->cookie);
         if (cmp < 0) {
             // Insert new item left of `curr`
@@ -358,11 +737,13 @@ bool CdsMapInsert(CdsMap* map, void* key, CdsMapItem* item)
             }
         } else {
             // Replace `curr` by `item`
+            CDSMAP_STAT_INC(map, replacements);
             item->parent = curr->parent;
             item->left = curr->left;
             item->right = curr->right;
             item->key = key;
             item->factor = curr->factor;
+            item->flags = curr->flags & CDSMAP_FLAG_DIRTY;
             if (cdsMapIsLeftChild(curr)) {
                 curr->parent->left = item;
             } else if (cdsMapIsRightChild(curr)) {
@@ -386,17 +767,21 @@ bool CdsMapInsert(CdsMap* map, void* key, CdsMapItem* item)
         }
     }
     CDSASSERT(inserted);
+    cdsMapStatDescent(map, depth);
     return true;
 }
 
 
 CdsMapItem* CdsMapSearch(CdsMap* map, void* key)
 {
-    CDSASSERT(map != NULL);
+    CDSASSERT_FULL(map != NULL);
+    CDSMAP_STAT_INC(map, searches);
 
     bool found = false;
+    int64_t depth = 0;
     CdsMapItem* item = map->root;
     while ((item != NULL) && !found) {
+        depth++;
         int cmp = map->compare(key, item->key, map->cookie);
         if (cmp < 0) {
             item = item->left;
@@ -406,13 +791,14 @@ CdsMapItem* CdsMapSearch(CdsMap* map, void* key)
             found = true;
         }
     }
+    cdsMapStatDescent(map, depth);
     return item;
 }
 
 
 bool CdsMapRemove(CdsMap* map, void* key)
 {
-    CDSASSERT(map != NULL);
+    CDSASSERT_FULL(map != NULL);
     CdsMapItem* item = CdsMapSearch(map, key);
     if (item != NULL) {
         CdsMapItemRemove(map, item);
@@ -423,26 +809,35 @@ bool CdsMapRemove(CdsMap* map, void* key)
 
 void CdsMapItemRemove(CdsMap* map, CdsMapItem* item)
 {
-    CDSASSERT(map != NULL);
+    CDSASSERT_FULL(map != NULL);
     CDSASSERT(map->root != NULL);
-    CDSASSERT(item != NULL);
+    CDSASSERT_FULL(item != NULL);
+    CDSASSERT(map->clearNext == NULL);
 
     CDSASSERT(map->size > 0);
     map->size--;
+    CDSMAP_STAT_INC(map, removals);
 
     CdsMapItem* tmp;
     if ((item->left != NULL) && (item->right != NULL)) {
         // Find the previous (or next) in-order item
         // NB: The choice to take the previous or next in-order item is based on
         // the item's factor, in an attempt to minimise the chances of a
-        // rotation being required.
+        // rotation being required. For WAVL trees, the factor is the rank of
+        // the item, so we compare the ranks of its children instead.
         tmp = NULL;
-        if (item->factor <= 0) {
+        bool usePrev;
+        if (map->balancing == CDSMAP_BALANCING_WAVL) {
+            usePrev = (cdsMapRank(item->left) >= cdsMapRank(item->right));
+        } else {
+            usePrev = (item->factor <= 0);
+        }
+        if (usePrev) {
             tmp = cdsMapDigRight(item->left); // use previous in-order item
         } else {
             tmp = cdsMapDigLeft(item->right); // use next in-order item
         }
-        CDSASSERT(tmp != NULL);
+        CDSASSERT_FULL(tmp != NULL);
         CDSASSERT((tmp->left == NULL) || (tmp->right == NULL));
 
         // Exchange `item` and `tmp`
@@ -452,17 +847,19 @@ void CdsMapItemRemove(CdsMap* map, CdsMapItem* item)
         CdsMapItem* itemParent = item->parent;
         bool itemIsLeftChild = cdsMapIsLeftChild(item);
         CdsMapItem* itemLeft = item->left;
-        CDSASSERT(itemLeft != NULL);
+        CDSASSERT_FULL(itemLeft != NULL);
         CdsMapItem* itemRight = item->right;
-        CDSASSERT(itemRight != NULL);
+        CDSASSERT_FULL(itemRight != NULL);
 
         CdsMapItem* tmpParent = tmp->parent;
-        CDSASSERT(tmpParent != NULL);
+        CDSASSERT_FULL(tmpParent != NULL);
         bool tmpIsLeftChild = cdsMapIsLeftChild(tmp);
         CdsMapItem* tmpLeft = tmp->left;
         CdsMapItem* tmpRight = tmp->right;
 
         tmp->factor = item->factor;
+        tmp->flags = (tmp->flags & ~CDSMAP_FLAG_DIRTY)
+                | (item->flags & CDSMAP_FLAG_DIRTY);
         tmp->parent = itemParent;
         if (itemParent == NULL) {
             map->root = tmp;
@@ -537,8 +934,19 @@ void CdsMapItemRemove(CdsMap* map, CdsMapItem* item)
     // tree.
     //
     // For each node going up, we check if the left or right subtree decreased.
+    //
+    // In burst mode, we do not retrace at all; we just remember which
+    // sub-trees will have to be rebalanced later on. WAVL trees have their own
+    // retracing procedure.
 
     bool balanced = false;
+    if (map->burst) {
+        cdsMapMarkDirty(item->parent);
+        balanced = true;
+    } else if (map->balancing == CDSMAP_BALANCING_WAVL) {
+        cdsMapWavlRemoveFixup(map, item->parent, leftDecrease);
+        balanced = true;
+    }
     for (   CdsMapItem* subroot = item->parent;
             (subroot != NULL) && !balanced;
             subroot = subroot->parent) {
@@ -554,7 +962,7 @@ void CdsMapItemRemove(CdsMap* map, CdsMapItem* item)
                 break;
             case 1 :
                 tmp = subroot->right;
-                CDSASSERT(tmp != NULL);
+                CDSASSERT_FULL(tmp != NULL);
                 if (tmp->factor >= 0) {
                     subroot = cdsMapRotateRightRight(map, subroot);
                 } else {
@@ -573,7 +981,7 @@ void CdsMapItemRemove(CdsMap* map, CdsMapItem* item)
             switch (subroot->factor) {
             case -1 :
                 tmp = subroot->left;
-                CDSASSERT(tmp != NULL);
+                CDSASSERT_FULL(tmp != NULL);
                 if (tmp->factor <= 0) {
                     subroot = cdsMapRotateLeftLeft(map, subroot);
                 } else {
@@ -610,7 +1018,7 @@ void CdsMapItemRemove(CdsMap* map, CdsMapItem* item)
 
 CdsMapItem* CdsMapIteratorStart(CdsMap* map, bool ascending, void** pKey)
 {
-    CDSASSERT(map != NULL);
+    CDSASSERT_FULL(map != NULL);
     CdsMapItem* curr = NULL;
     if (NULL == map->root) {
         map->iterNext = false;
@@ -634,7 +1042,7 @@ CdsMapItem* CdsMapIteratorStart(CdsMap* map, bool ascending, void** pKey)
 
 CdsMapItem* CdsMapIteratorNext(CdsMap* map, void** pKey)
 {
-    CDSASSERT(map != NULL);
+    CDSASSERT_FULL(map != NULL);
     CdsMapItem* curr = map->iterNext;
     if (curr != NULL) {
         if (pKey != NULL) {
@@ -646,6 +1054,283 @@ CdsMapItem* CdsMapIteratorNext(CdsMap* map, void** pKey)
 }
 
 
+void CdsMapBurstBegin(CdsMap* map)
+{
+    CDSASSERT_FULL(map != NULL);
+    CDSASSERT(map->balancing == CDSMAP_BALANCING_AVL);
+    map->burst = true;
+}
+
+
+void CdsMapBurstEnd(CdsMap* map)
+{
+    CDSASSERT_FULL(map != NULL);
+    map->burst = false;
+    CdsMapRebalance(map);
+}
+
+
+bool CdsMapIsBursting(const CdsMap* map)
+{
+    CDSASSERT_FULL(map != NULL);
+    return map->burst;
+}
+
+
+void CdsMapRebalance(CdsMap* map)
+{
+    CDSASSERT_FULL(map != NULL);
+
+    // Traverse the dirty items of the tree in post-order fashion, so that the
+    // sub-trees under an item are always balanced by the time we fix that item
+    //
+    // NB: All the ancestors of a dirty item are dirty as well, so there is
+    // nothing to do if the root is clean. We use `prev` to know where we come
+    // from rather than the "dig" flags, because `cdsMapJoin()` moves items
+    // around.
+    //
+    // NB: The balance factor of a dirty item is meaningless, so we use it to
+    // remember the height of its left sub-tree once it has been fixed, or -1 if
+    // not known yet. Balanced sub-trees are never higher than 127 items.
+    CdsMapItem* prev = NULL;
+    CdsMapItem* curr = map->root;
+    if ((curr == NULL) || !(curr->flags & CDSMAP_FLAG_DIRTY)) {
+        return;
+    }
+    int height = 0; // Height of the sub-tree we just fixed
+    while (curr != NULL) {
+        bool fromRight = false;
+        if (prev == curr->parent) {
+            curr->factor = -1;
+            if ((curr->left != NULL) && (curr->left->flags & CDSMAP_FLAG_DIRTY)) {
+                prev = curr;
+                curr = curr->left;
+                continue;
+            }
+        } else if (prev == curr->left) {
+            CDSASSERT(height <= INT8_MAX);
+            curr->factor = height;
+        } else {
+            CDSASSERT(prev == curr->right);
+            fromRight = true;
+        }
+        if (   !fromRight
+            && (curr->right != NULL)
+            && (curr->right->flags & CDSMAP_FLAG_DIRTY)) {
+            prev = curr;
+            curr = curr->right;
+            continue;
+        }
+
+        // Both sub-trees under `curr` are balanced, fix `curr` itself
+        int leftHeight = curr->factor;
+        if (leftHeight < 0) {
+            leftHeight = cdsMapHeight(curr->left);
+        }
+        int rightHeight = height;
+        if (!fromRight) {
+            rightHeight = cdsMapHeight(curr->right);
+        }
+        CdsMapItem* parent = curr->parent;
+        bool isLeftChild = cdsMapIsLeftChild(curr);
+        height = cdsMapJoin(map, curr, leftHeight, rightHeight);
+        if (parent == NULL) {
+            prev = map->root;
+        } else if (isLeftChild) {
+            prev = parent->left;
+        } else {
+            prev = parent->right;
+        }
+        curr = parent;
+    }
+}
+
+
+bool CdsMapGetStats(const CdsMap* map, CdsMapStats* pStats)
+{
+    CDSASSERT_FULL(map != NULL);
+    CDSASSERT_FULL(pStats != NULL);
+
+#ifdef CDSMAP_WITH_STATS
+    *pStats = map->stats;
+    int64_t ops = pStats->searches + pStats->insertions;
+    if (ops > 0) {
+        pStats->comparisonsPerOp = (double)pStats->comparisons / ops;
+    }
+    if (pStats->descents > 0) {
+        pStats->avgDepth = (double)map->statsDepthSum / pStats->descents;
+    }
+
+    // Compute the height of the tree
+    //
+    // NB: The balance factors of an AVL tree give its height directly, unless
+    // it has dirty items. Otherwise, we have to visit all the items. We use
+    // `prev` to know where we come from, so we do not touch the flags.
+    if (   (map->balancing == CDSMAP_BALANCING_AVL)
+        && ((map->root == NULL) || !(map->root->flags & CDSMAP_FLAG_DIRTY))) {
+        pStats->height = cdsMapHeight(map->root);
+    } else {
+        int64_t depth = 0;
+        const CdsMapItem* prev = NULL;
+        const CdsMapItem* curr = map->root;
+        while (curr != NULL) {
+            const CdsMapItem* next = curr->parent;
+            if (prev == curr->parent) {
+                depth++;
+                if (depth > pStats->height) {
+                    pStats->height = depth;
+                }
+                if (curr->left != NULL) {
+                    next = curr->left;
+                } else if (curr->right != NULL) {
+                    next = curr->right;
+                }
+            } else if ((prev == curr->left) && (curr->right != NULL)) {
+                next = curr->right;
+            }
+            if (next == curr->parent) {
+                depth--;
+            }
+            prev = curr;
+            curr = next;
+        }
+    }
+    return true;
+
+#else
+    memset(pStats, 0, sizeof(*pStats));
+    return false;
+#endif
+}
+
+
+void CdsMapResetStats(CdsMap* map)
+{
+    CDSASSERT_FULL(map != NULL);
+#ifdef CDSMAP_WITH_STATS
+    memset(&map->stats, 0, sizeof(map->stats));
+    map->statsDepthSum = 0;
+#endif
+}
+
+
+CdsMapFrozen* CdsMapFreeze(const CdsMap* map)
+{
+    CDSASSERT_FULL(map != NULL);
+
+    CdsMapFrozen* frozen = CdsAllocZ(map->allocator, sizeof(*frozen));
+    frozen->size = map->size;
+    frozen->compare = map->compare;
+    frozen->cookie = map->cookie;
+    frozen->allocator = map->allocator;
+
+    // NB: Align the keys so the `CDSMAP_KEYS_PER_LINE` descendants of a key
+    // a few levels down all sit in the same cache line. The allocator
+    // interface does not allow it, so do it ourselves for the system
+    // allocator; other allocators get no alignment guarantee.
+    size_t keys_B = (map->size + 1) * sizeof(*frozen->keys);
+    if (map->allocator == CdsSystemAllocator()) {
+        void* ptr = NULL;
+        if (posix_memalign(&ptr, CDSMAP_CACHE_LINE, keys_B) != 0) {
+            CDSPANIC_MSG("Failed to allocate %zu bytes", keys_B);
+        }
+        frozen->keys = ptr;
+    } else {
+        frozen->keys = CdsAlloc(map->allocator, keys_B);
+    }
+    frozen->items = CdsAlloc(map->allocator,
+            (map->size + 1) * sizeof(*frozen->items));
+    frozen->keys[0] = NULL;
+    frozen->items[0] = NULL;
+
+    // Walk the map and the implicit tree in ascending order together
+    CdsMapItem* item = map->root;
+    if (item != NULL) {
+        while (item->left != NULL) {
+            item = item->left;
+        }
+    }
+    int64_t k = cdsMapFrozenFirst(frozen->size);
+    while (item != NULL) {
+        CDSASSERT(k != 0);
+        frozen->keys[k] = item->key;
+        frozen->items[k] = item;
+        item = cdsMapSuccessor(item);
+        k = cdsMapFrozenNext(k, frozen->size);
+    }
+    CDSASSERT(k == 0);
+    return frozen;
+}
+
+
+void CdsMapFrozenDestroy(CdsMapFrozen* frozen)
+{
+    CDSASSERT_FULL(frozen != NULL);
+    CdsFree(frozen->allocator, frozen->keys);
+    CdsFree(frozen->allocator, frozen->items);
+    CdsFree(frozen->allocator, frozen);
+}
+
+
+int64_t CdsMapFrozenSize(const CdsMapFrozen* frozen)
+{
+    CDSASSERT_FULL(frozen != NULL);
+    return frozen->size;
+}
+
+
+CdsMapItem* CdsMapFrozenSearch(const CdsMapFrozen* frozen, void* key)
+{
+    CDSASSERT_FULL(frozen != NULL);
+
+    // Look for the smallest key >= `key`: go left if the key at `k` is >=
+    // `key`, right otherwise. The direction is used as a number, not as a
+    // branch, so the next levels can be prefetched: the key pointers 3 levels
+    // down (they share a cache line), and the keys themselves 2 levels down,
+    // whose pointers were prefetched by the parent.
+    void* const* keys = frozen->keys;
+    uint64_t size = frozen->size;
+    uint64_t k = 1;
+    while (k <= size) {
+        // NB: Don't even form a pointer past the end of the array
+        if (CDSMAP_KEYS_PER_LINE * k <= size) {
+            CDSPREFETCH(&keys[CDSMAP_KEYS_PER_LINE * k]);
+        }
+        if (4 * k + 3 <= size) {
+            CDSPREFETCH(keys[4 * k]);
+            CDSPREFETCH(keys[4 * k + 1]);
+            CDSPREFETCH(keys[4 * k + 2]);
+            CDSPREFETCH(keys[4 * k + 3]);
+        }
+        k = 2 * k + (frozen->compare(keys[k], key, frozen->cookie) < 0);
+    }
+
+    // NB: The trailing 1 bits of `k` are the right turns taken after the last
+    // left turn; strip them and that left turn to get the lower bound
+    k >>= __builtin_ctzll(~k) + 1;
+    if ((k == 0) || (frozen->compare(keys[k], key, frozen->cookie) != 0)) {
+        return NULL;
+    }
+    return frozen->items[k];
+}
+
+
+void CdsMapFrozenTraverse(const CdsMapFrozen* frozen, CdsMapFrozenAction action,
+        void* cookie)
+{
+    CDSASSERT_FULL(frozen != NULL);
+    CDSASSERT_FULL(action != NULL);
+
+    int64_t k = cdsMapFrozenFirst(frozen->size);
+    while (k != 0) {
+        if (!action(frozen->keys[k], frozen->items[k], cookie)) {
+            break;
+        }
+        k = cdsMapFrozenNext(k, frozen->size);
+    }
+}
+
+
 
 /*----------------------------------+
  | Private function implementations |
@@ -654,7 +1339,7 @@ CdsMapItem* CdsMapIteratorNext(CdsMap* map, void** pKey)
 
 static CdsMapItem* cdsMapDigLeft(CdsMapItem* item)
 {
-    CDSASSERT(item != NULL);
+    CDSASSERT_FULL(item != NULL);
 
     // Do not touch the "iter" flags, as we might be in the middle of iterating
     // over the map.
@@ -670,14 +1355,14 @@ static CdsMapItem* cdsMapDigLeft(CdsMapItem* item)
 
 static CdsMapItem* cdsMapDigLeftIter(CdsMapItem* item)
 {
-    CDSASSERT(item != NULL);
+    CDSASSERT_FULL(item != NULL);
 
     // Clear both "dig" and "iter" flags when iterating over the map.
-    item->flags = 0;
+    item->flags &= CDSMAP_FLAG_DIRTY;
     while ((item->left != NULL) && !(item->flags & CDSMAP_FLAG_DIG_LEFT)) {
         item->flags |= CDSMAP_FLAG_DIG_LEFT;
         item = item->left;
-        item->flags = 0;
+        item->flags &= CDSMAP_FLAG_DIRTY;
     }
     return item;
 }
@@ -685,7 +1370,7 @@ static CdsMapItem* cdsMapDigLeftIter(CdsMapItem* item)
 
 static CdsMapItem* cdsMapDigRight(CdsMapItem* item)
 {
-    CDSASSERT(item != NULL);
+    CDSASSERT_FULL(item != NULL);
 
     // Do not touch the "iter" flags, as we might be in the middle of iterating
     // over the map.
@@ -701,27 +1386,26 @@ static CdsMapItem* cdsMapDigRight(CdsMapItem* item)
 
 static CdsMapItem* cdsMapDigRightIter(CdsMapItem* item)
 {
-    CDSASSERT(item != NULL);
+    CDSASSERT_FULL(item != NULL);
 
     // Clear both "dig" and "iter" flags when iterating over the map.
-    item->flags = 0;
+    item->flags &= CDSMAP_FLAG_DIRTY;
     while ((item->right != NULL) && !(item->flags & CDSMAP_FLAG_DIG_RIGHT)) {
         item->flags |= CDSMAP_FLAG_DIG_RIGHT;
         item = item->right;
-        item->flags = 0;
+        item->flags &= CDSMAP_FLAG_DIRTY;
     }
     return item;
 }
 
 
-static CdsMapItem* cdsMapRotateRightRight(CdsMap* map, CdsMapItem* subroot)
+static CdsMapItem* cdsMapRotateLeft(CdsMap* map, CdsMapItem* subroot)
 {
-    CDSASSERT(map != NULL);
-    CDSASSERT(subroot != NULL);
+    CDSASSERT_FULL(map != NULL);
+    CDSASSERT_FULL(subroot != NULL);
 
     CdsMapItem* item = subroot->right;
-    CDSASSERT(item != NULL);
-    CDSASSERT(item->factor >= 0);
+    CDSASSERT_FULL(item != NULL);
 
     // Make `item` the root of the sub-tree
     if (cdsMapIsLeftChild(subroot)) {
@@ -745,28 +1429,17 @@ static CdsMapItem* cdsMapRotateRightRight(CdsMap* map, CdsMapItem* subroot)
     item->left = subroot;
     subroot->parent = item;
 
-    // Update balance factors
-    if (item->factor == 0) {
-        subroot->factor = 1;
-        item->factor = -1;
-    } else {
-        CDSASSERT(item->factor == 1);
-        subroot->factor = 0;
-        item->factor = 0;
-    }
-
     return item;
 }
 
 
-static CdsMapItem* cdsMapRotateLeftLeft(CdsMap* map, CdsMapItem* subroot)
+static CdsMapItem* cdsMapRotateRight(CdsMap* map, CdsMapItem* subroot)
 {
-    CDSASSERT(map != NULL);
-    CDSASSERT(subroot != NULL);
+    CDSASSERT_FULL(map != NULL);
+    CDSASSERT_FULL(subroot != NULL);
 
     CdsMapItem* item = subroot->left;
-    CDSASSERT(item != NULL);
-    CDSASSERT(item->factor <= 0);
+    CDSASSERT_FULL(item != NULL);
 
     // Make `item` the root of the sub-tree
     if (cdsMapIsLeftChild(subroot)) {
@@ -790,6 +1463,44 @@ static CdsMapItem* cdsMapRotateLeftLeft(CdsMap* map, CdsMapItem* subroot)
     item->right = subroot;
     subroot->parent = item;
 
+    return item;
+}
+
+
+static CdsMapItem* cdsMapRotateRightRight(CdsMap* map, CdsMapItem* subroot)
+{
+    CDSASSERT_FULL(map != NULL);
+    CDSASSERT_FULL(subroot != NULL);
+    CDSASSERT(subroot->right != NULL);
+    CDSASSERT(subroot->right->factor >= 0);
+
+    CdsMapItem* item = cdsMapRotateLeft(map, subroot);
+    CDSMAP_STAT_INC(map, rotationsRR);
+
+    // Update balance factors
+    if (item->factor == 0) {
+        subroot->factor = 1;
+        item->factor = -1;
+    } else {
+        CDSASSERT(item->factor == 1);
+        subroot->factor = 0;
+        item->factor = 0;
+    }
+
+    return item;
+}
+
+
+static CdsMapItem* cdsMapRotateLeftLeft(CdsMap* map, CdsMapItem* subroot)
+{
+    CDSASSERT_FULL(map != NULL);
+    CDSASSERT_FULL(subroot != NULL);
+    CDSASSERT(subroot->left != NULL);
+    CDSASSERT(subroot->left->factor <= 0);
+
+    CdsMapItem* item = cdsMapRotateRight(map, subroot);
+    CDSMAP_STAT_INC(map, rotationsLL);
+
     // Update balance factors
     if (item->factor == 0) {
         subroot->factor = -1;
@@ -806,47 +1517,21 @@ static CdsMapItem* cdsMapRotateLeftLeft(CdsMap* map, CdsMapItem* subroot)
 
 static CdsMapItem* cdsMapRotateRightLeft(CdsMap* map, CdsMapItem* subroot)
 {
-    CDSASSERT(map != NULL);
-    CDSASSERT(subroot != NULL);
+    CDSASSERT_FULL(map != NULL);
+    CDSASSERT_FULL(subroot != NULL);
 
     CdsMapItem* item = subroot->right;
-    CDSASSERT(item != NULL);
+    CDSASSERT_FULL(item != NULL);
     CDSASSERT(item->factor < 0);
 
     CdsMapItem* grandchild = item->left;
-    CDSASSERT(grandchild != NULL);
-
-    // Make `grandchild` the root of the subtree
-    if (cdsMapIsLeftChild(subroot)) {
-        subroot->parent->left = grandchild;
-    } else if (cdsMapIsRightChild(subroot)) {
-        subroot->parent->right = grandchild;
-    } else {
-        map->root = grandchild;
-    }
-    grandchild->parent = subroot->parent;
-
-    // Make the right child of `grandchild` the left child of `item`
-    CdsMapItem* tmp = grandchild->right;
-    item->left = tmp;
-    if (tmp != NULL) {
-        tmp->parent = item;
-    }
-
-    // Make `item` the right child of `grandchild`
-    grandchild->right = item;
-    item->parent = grandchild;
-
-    // Make the left child of `grandchild` the right child of `subroot`
-    tmp = grandchild->left;
-    subroot->right = tmp;
-    if (tmp != NULL) {
-        tmp->parent = subroot;
-    }
+    CDSASSERT_FULL(grandchild != NULL);
 
-    // Make `subroot` the left child of `grandchild`
-    grandchild->left = subroot;
-    subroot->parent = grandchild;
+    // Make `grandchild` the root of the subtree, with `subroot` on its left and
+    // `item` on its right
+    cdsMapRotateRight(map, item);
+    cdsMapRotateLeft(map, subroot);
+    CDSMAP_STAT_INC(map, rotationsRL);
 
     // Update balance factors
     switch (grandchild->factor) {
@@ -873,47 +1558,21 @@ static CdsMapItem* cdsMapRotateRightLeft(CdsMap* map, CdsMapItem* subroot)
 
 static CdsMapItem* cdsMapRotateLeftRight(CdsMap* map, CdsMapItem* subroot)
 {
-    CDSASSERT(map != NULL);
-    CDSASSERT(subroot != NULL);
+    CDSASSERT_FULL(map != NULL);
+    CDSASSERT_FULL(subroot != NULL);
 
     CdsMapItem* item = subroot->left;
-    CDSASSERT(item != NULL);
+    CDSASSERT_FULL(item != NULL);
     CDSASSERT(item->factor > 0);
 
     CdsMapItem* grandchild = item->right;
-    CDSASSERT(grandchild != NULL);
+    CDSASSERT_FULL(grandchild != NULL);
 
-    // Make `grandchild` the root of the subtree
-    if (cdsMapIsLeftChild(subroot)) {
-        subroot->parent->left = grandchild;
-    } else if (cdsMapIsRightChild(subroot)) {
-        subroot->parent->right = grandchild;
-    } else {
-        map->root = grandchild;
-    }
-    grandchild->parent = subroot->parent;
-
-    // Make the left child of `grandchild` the right child of `item`
-    CdsMapItem* tmp = grandchild->left;
-    item->right = tmp;
-    if (tmp != NULL) {
-        tmp->parent = item;
-    }
-
-    // Make `item` the left child of `grandchild`
-    grandchild->left = item;
-    item->parent = grandchild;
-
-    // Make the right child of `grandchild` the left child of `subroot`
-    tmp = grandchild->right;
-    subroot->left = tmp;
-    if (tmp != NULL) {
-        tmp->parent = subroot;
-    }
-
-    // Make `subroot` the right child of `grandchild`
-    grandchild->right = subroot;
-    subroot->parent = grandchild;
+    // Make `grandchild` the root of the subtree, with `item` on its left and
+    // `subroot` on its right
+    cdsMapRotateLeft(map, item);
+    cdsMapRotateRight(map, subroot);
+    CDSMAP_STAT_INC(map, rotationsLR);
 
     // Update balance factors
     switch (grandchild->factor) {
@@ -941,9 +1600,9 @@ static CdsMapItem* cdsMapRotateLeftRight(CdsMap* map, CdsMapItem* subroot)
 static void cdsMapInsertOne(CdsMap* map, CdsMapItem* item,
         CdsMapItem* newitem, void* key, bool insertLeft)
 {
-    CDSASSERT(map != NULL);
-    CDSASSERT(item != NULL);
-    CDSASSERT(newitem != NULL);
+    CDSASSERT_FULL(map != NULL);
+    CDSASSERT_FULL(item != NULL);
+    CDSASSERT_FULL(newitem != NULL);
 
     // Initialise the new item
     newitem->parent = item;
@@ -951,12 +1610,28 @@ static void cdsMapInsertOne(CdsMap* map, CdsMapItem* item,
     newitem->right = NULL;
     newitem->key = key;
     newitem->factor = 0;
+    newitem->flags = 0;
 
     // Make `newitem` the child of `item`
     map->size++;
     if (insertLeft) {
         CDSASSERT(item->left == NULL);
         item->left = newitem;
+    } else {
+        CDSASSERT(item->right == NULL);
+        item->right = newitem;
+    }
+    if (map->burst) {
+        // Do not rebalance now, just remember where to do it later
+        cdsMapMarkDirty(item);
+        return;
+    }
+    if (map->balancing == CDSMAP_BALANCING_WAVL) {
+        cdsMapWavlInsertFixup(map, newitem);
+        return;
+    }
+
+    if (insertLeft) {
         if (item->right != NULL) {
             CDSASSERT(cdsMapIsLeaf(item->right));
             item->factor = 0;
@@ -964,8 +1639,6 @@ static void cdsMapInsertOne(CdsMap* map, CdsMapItem* item,
         }
         item->factor = -1;
     } else {
-        CDSASSERT(item->right == NULL);
-        item->right = newitem;
         if (item->left != NULL) {
             CDSASSERT(cdsMapIsLeaf(item->left));
             item->factor = 0;
@@ -974,29 +1647,40 @@ static void cdsMapInsertOne(CdsMap* map, CdsMapItem* item,
         item->factor = 1;
     }
 
-
-    // Retrace the tree
-    //
     // If we are here, the insertion changes the balance factor of
     // `item->parent`, so we need to update the balance factors of all ancestors
     // and perform rotations as necessary.
+    cdsMapRetraceGrow(map, item, NULL);
+}
+
+
+static bool cdsMapRetraceGrow(CdsMap* map, CdsMapItem* item, CdsMapItem* stop)
+{
+    CDSASSERT_FULL(map != NULL);
+    CDSASSERT_FULL(item != NULL);
+
+    // Retrace the tree
     //
     // This is done by going up the tree, starting from `item` and finishing
-    // when the current node's factor does not change, or if we reach the root
-    // of the tree.
+    // when the current node's height does not change, or if we reach `stop`.
     //
     // For each node going up, we check if the left or right subtree grew.
+    //
+    // NB: After a rotation, the height of the rotated sub-tree is usually the
+    // same as before `item` grew, except if the child of `subroot` was
+    // balanced. This never happens for a simple insertion, but it does when
+    // joining two sub-trees in `cdsMapJoin()`.
 
-    bool balanced = false;
+    bool grown = true;
     for (   CdsMapItem* subroot = item->parent;
-            (subroot != NULL) && !balanced;
+            (subroot != stop) && grown;
             subroot = subroot->parent) {
         if (item == subroot->right) {
             // The sub-tree on the right of `subroot` increased its height by 1
             switch (subroot->factor) {
             case -1 :
                 subroot->factor = 0;
-                balanced = true;
+                grown = false;
                 break;
             case 0 :
                 subroot->factor = 1;
@@ -1007,7 +1691,7 @@ static void cdsMapInsertOne(CdsMap* map, CdsMapItem* item,
                 } else {
                     subroot = cdsMapRotateRightLeft(map, subroot);
                 }
-                balanced = true;
+                grown = (subroot->factor != 0);
                 break;
             default :
                 CDSPANIC_MSG("Impossible balance factor: %d",
@@ -1023,14 +1707,14 @@ static void cdsMapInsertOne(CdsMap* map, CdsMapItem* item,
                 } else {
                     subroot = cdsMapRotateLeftRight(map, subroot);
                 }
-                balanced = true;
+                grown = (subroot->factor != 0);
                 break;
             case 0 :
                 subroot->factor = -1;
                 break;
             case 1 :
                 subroot->factor = 0;
-                balanced = true;
+                grown = false;
                 break;
             default :
                 CDSPANIC_MSG("Impossible balance factor: %d",
@@ -1039,6 +1723,299 @@ static void cdsMapInsertOne(CdsMap* map, CdsMapItem* item,
         }
         item = subroot;
     }
+    return grown;
+}
+
+
+static void cdsMapWavlInsertFixup(CdsMap* map, CdsMapItem* newitem)
+{
+    CDSASSERT_FULL(map != NULL);
+    CDSASSERT_FULL(newitem != NULL);
+
+    // Go up the tree as long as `item` is a 0-child, i.e. it has the same rank
+    // as its parent.
+    //
+    // If the sibling of `item` is a 1-child, the parent is promoted, which
+    // may make it a 0-child in turn. Otherwise, one or two rotations restore
+    // the rank rule and we are done.
+    CdsMapItem* item = newitem;
+    CdsMapItem* parent = item->parent;
+    while ((parent != NULL) && (parent->factor == item->factor)) {
+        bool isLeft = (item == parent->left);
+        CdsMapItem* sibling = isLeft ? parent->right : parent->left;
+        if (parent->factor - cdsMapRank(sibling) == 1) {
+            parent->factor++;
+            item = parent;
+            parent = parent->parent;
+            continue;
+        }
+
+        // `parent` is a 0,2 item
+        CdsMapItem* inner = isLeft ? item->right : item->left;
+        if (item->factor - cdsMapRank(inner) == 2) {
+            if (isLeft) {
+                cdsMapRotateRight(map, parent);
+                CDSMAP_STAT_INC(map, rotationsLL);
+            } else {
+                cdsMapRotateLeft(map, parent);
+                CDSMAP_STAT_INC(map, rotationsRR);
+            }
+            parent->factor--;
+        } else {
+            CDSASSERT_FULL(inner != NULL);
+            if (isLeft) {
+                cdsMapRotateLeft(map, item);
+                cdsMapRotateRight(map, parent);
+                CDSMAP_STAT_INC(map, rotationsLR);
+            } else {
+                cdsMapRotateRight(map, item);
+                cdsMapRotateLeft(map, parent);
+                CDSMAP_STAT_INC(map, rotationsRL);
+            }
+            inner->factor++;
+            item->factor--;
+            parent->factor--;
+        }
+        break;
+    }
+}
+
+
+static void cdsMapWavlRemoveFixup(CdsMap* map, CdsMapItem* parent, bool isLeft)
+{
+    CDSASSERT_FULL(map != NULL);
+
+    if (parent == NULL) {
+        return;
+    }
+
+    // A leaf must have rank 0, so demote `parent` if it became a 2,2 leaf
+    if (cdsMapIsLeaf(parent) && (parent->factor == 1)) {
+        parent->factor = 0;
+        isLeft = cdsMapIsLeftChild(parent);
+        parent = parent->parent;
+    }
+
+    // Go up the tree as long as there is a 3-child
+    //
+    // If the sibling of the 3-child is a 2-child, or a 1-child whose own
+    // children are both 2-children, demoting is enough, but this may create a
+    // 3-child one level up. Otherwise, one or two rotations restore the rank
+    // rule and we are done.
+    while (parent != NULL) {
+        CdsMapItem* item = isLeft ? parent->left : parent->right;
+        if (parent->factor - cdsMapRank(item) <= 2) {
+            break;
+        }
+        CdsMapItem* sibling = isLeft ? parent->right : parent->left;
+        CDSASSERT_FULL(sibling != NULL);
+        CdsMapItem* outer = isLeft ? sibling->right : sibling->left;
+        CdsMapItem* inner = isLeft ? sibling->left : sibling->right;
+
+        if (parent->factor - sibling->factor == 2) {
+            parent->factor--;
+        } else if (   (sibling->factor - cdsMapRank(outer) == 2)
+                   && (sibling->factor - cdsMapRank(inner) == 2)) {
+            sibling->factor--;
+            parent->factor--;
+        } else if (sibling->factor - cdsMapRank(outer) == 1) {
+            if (isLeft) {
+                cdsMapRotateLeft(map, parent);
+                CDSMAP_STAT_INC(map, rotationsRR);
+            } else {
+                cdsMapRotateRight(map, parent);
+                CDSMAP_STAT_INC(map, rotationsLL);
+            }
+            sibling->factor++;
+            parent->factor--;
+            if (cdsMapIsLeaf(parent)) {
+                parent->factor--;
+            }
+            break;
+        } else {
+            CDSASSERT_FULL(inner != NULL);
+            if (isLeft) {
+                cdsMapRotateRight(map, sibling);
+                cdsMapRotateLeft(map, parent);
+                CDSMAP_STAT_INC(map, rotationsRL);
+            } else {
+                cdsMapRotateLeft(map, sibling);
+                cdsMapRotateRight(map, parent);
+                CDSMAP_STAT_INC(map, rotationsLR);
+            }
+            inner->factor += 2;
+            sibling->factor--;
+            parent->factor -= 2;
+            break;
+        }
+        isLeft = cdsMapIsLeftChild(parent);
+        parent = parent->parent;
+    }
+}
+
+
+static void cdsMapMarkDirty(CdsMapItem* item)
+{
+    while ((item != NULL) && !(item->flags & CDSMAP_FLAG_DIRTY)) {
+        item->flags |= CDSMAP_FLAG_DIRTY;
+        item = item->parent;
+    }
+}
+
+
+static int cdsMapHeight(const CdsMapItem* item)
+{
+    // NB: Following the taller child at each level gives the height of an AVL
+    // sub-tree in O(log(n))
+    int height = 0;
+    while (item != NULL) {
+        CDSASSERT(!(item->flags & CDSMAP_FLAG_DIRTY));
+        height++;
+        if (item->factor < 0) {
+            item = item->left;
+        } else {
+            item = item->right;
+        }
+    }
+    return height;
+}
+
+
+static int cdsMapJoin(CdsMap* map, CdsMapItem* item,
+        int leftHeight, int rightHeight)
+{
+    CDSASSERT_FULL(map != NULL);
+    CDSASSERT_FULL(item != NULL);
+
+    CdsMapItem* left = item->left;
+    CdsMapItem* right = item->right;
+    int height = (leftHeight > rightHeight) ? leftHeight : rightHeight;
+    item->flags &= ~CDSMAP_FLAG_DIRTY;
+
+    if ((leftHeight - rightHeight <= 1) && (rightHeight - leftHeight <= 1)) {
+        // Already balanced, just update the balance factor
+        item->factor = rightHeight - leftHeight;
+        return height + 1;
+    }
+
+    // Make the taller sub-tree take the place of `item`
+    CdsMapItem* parent = item->parent;
+    CdsMapItem* top = (leftHeight > rightHeight) ? left : right;
+    CDSASSERT_FULL(top != NULL);
+    if (cdsMapIsLeftChild(item)) {
+        parent->left = top;
+    } else if (cdsMapIsRightChild(item)) {
+        parent->right = top;
+    } else {
+        map->root = top;
+    }
+    top->parent = parent;
+
+    // Walk down the inner spine of the taller sub-tree until we find a
+    // sub-tree that has about the same height as the shorter sub-tree, and
+    // replace it with `item`
+    CdsMapItem* spine = NULL;
+    CdsMapItem* curr = top;
+    if (leftHeight > rightHeight) {
+        int spineHeight = leftHeight;
+        while (spineHeight > rightHeight + 1) {
+            spineHeight -= (curr->factor >= 0) ? 1 : 2;
+            spine = curr;
+            curr = curr->right;
+        }
+        CDSASSERT_FULL(spine != NULL);
+        spine->right = item;
+        item->left = curr;
+        item->factor = rightHeight - spineHeight;
+    } else {
+        int spineHeight = rightHeight;
+        while (spineHeight > leftHeight + 1) {
+            spineHeight -= (curr->factor <= 0) ? 1 : 2;
+            spine = curr;
+            curr = curr->left;
+        }
+        CDSASSERT_FULL(spine != NULL);
+        spine->left = item;
+        item->right = curr;
+        item->factor = spineHeight - leftHeight;
+    }
+    item->parent = spine;
+    if (curr != NULL) {
+        curr->parent = item;
+    }
+
+    // The sub-tree where `item` now is grew by 1
+    if (cdsMapRetraceGrow(map, item, parent)) {
+        height++;
+    }
+    return height;
+}
+
+
+static void cdsMapClearUnref(const CdsMap* map,
+        CdsMapItemUnrefBatch unrefBatch, CdsMapItem** batch, int64_t* pCount,
+        CdsMapItem* item)
+{
+    CDSASSERT_FULL(map != NULL);
+    CDSASSERT_FULL(pCount != NULL);
+
+    if (item != NULL) {
+        if (map->keyUnref != NULL) {
+            map->keyUnref(item->key);
+        }
+        if (unrefBatch == NULL) {
+            if (map->itemUnref != NULL) {
+                map->itemUnref(item);
+            }
+            return;
+        }
+        batch[(*pCount)++] = item;
+    }
+    if ((unrefBatch != NULL) && (*pCount > 0)
+            && ((item == NULL) || (*pCount == CDSMAP_CLEAR_BATCH))) {
+        unrefBatch(batch, *pCount);
+        *pCount = 0;
+    }
+}
+
+
+static void* cdsMapClearWorker(void* arg)
+{
+    CdsMapClearJob* job = arg;
+    const CdsMap* map = job->map;
+    CdsMapItem* batch[CDSMAP_CLEAR_BATCH];
+    int64_t n = 0;
+
+    for (;;) {
+        int64_t i = __atomic_fetch_add(&job->next, 1, __ATOMIC_RELAXED);
+        if (i >= job->count) {
+            break;
+        }
+
+        // Clear the sub-tree in post-order fashion, as in `CdsMapClearStep()`
+        // NB: The root of the sub-tree has no parent
+        CdsMapItem* curr = job->subtrees[i];
+        while (curr != NULL) {
+            if (curr->left != NULL) {
+                curr = curr->left;
+            } else if (curr->right != NULL) {
+                curr = curr->right;
+            } else {
+                CdsMapItem* parent = curr->parent;
+                if (parent != NULL) {
+                    if (parent->left == curr) {
+                        parent->left = NULL;
+                    } else {
+                        parent->right = NULL;
+                    }
+                }
+                cdsMapClearUnref(map, job->unrefBatch, batch, &n, curr);
+                curr = parent;
+            }
+        }
+    }
+    cdsMapClearUnref(map, job->unrefBatch, batch, &n, NULL);
+    return NULL;
 }
 
 
@@ -1081,3 +2058,51 @@ static void cdsMapIterNext(CdsMap* map)
         map->iterNext->flags |= CDSMAP_FLAG_ITER_SELF;
     }
 }
+
+
+static CdsMapItem* cdsMapSuccessor(const CdsMapItem* item)
+{
+    if (item->right != NULL) {
+        item = item->right;
+        while (item->left != NULL) {
+            item = item->left;
+        }
+        return (CdsMapItem*)item;
+    }
+    while ((item->parent != NULL) && (item == item->parent->right)) {
+        item = item->parent;
+    }
+    return item->parent;
+}
+
+
+static int64_t cdsMapFrozenFirst(int64_t size)
+{
+    if (size == 0) {
+        return 0;
+    }
+    int64_t k = 1;
+    while (2 * k <= size) {
+        k = 2 * k;
+    }
+    return k;
+}
+
+
+static int64_t cdsMapFrozenNext(int64_t k, int64_t size)
+{
+    if (2 * k + 1 <= size) {
+        // Smallest key of the right sub-tree
+        k = 2 * k + 1;
+        while (2 * k <= size) {
+            k = 2 * k;
+        }
+    } else {
+        // First ancestor of which we are in the left sub-tree
+        while (k & 1) {
+            k >>= 1;
+        }
+        k >>= 1;
+    }
+    return k;
+}
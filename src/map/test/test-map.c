@@ -1397,10 +1397,10 @@ RTT_TEST_START(cds_should_iterate_through_map_and_remove_some_items)
         }
         RTT_EXPECT(strcmp(buffer, (const char*)key) == 0);
         RTT_EXPECT(it->value > lastValue);
+        lastValue = it->value;
         if (it->value % 2) {
             CdsMapItemRemove(gMap, item); // Remove items with odd values
         }
-        lastValue = it->value;
         count--;
     }
     RTT_EXPECT(0 == count);
@@ -3201,3 +3201,781 @@ RTT_GROUP_END(TestCdsDeepMap,
 
 
 // TODO: top and deep removal with rotation
+
+
+// Check that the sub-tree rooted at `item` is a valid AVL tree; returns height
+static int testCheckBalanced(const CdsMapItem* item, const CdsMapItem* parent,
+        bool* ok)
+{
+    if (item == NULL) {
+        return 0;
+    }
+    if (item->parent != parent) {
+        *ok = false;
+    }
+    if ((item->left != NULL) && (strcmp(item->left->key, item->key) >= 0)) {
+        *ok = false;
+    }
+    if ((item->right != NULL) && (strcmp(item->right->key, item->key) <= 0)) {
+        *ok = false;
+    }
+    int leftHeight = testCheckBalanced(item->left, item, ok);
+    int rightHeight = testCheckBalanced(item->right, item, ok);
+    if (item->factor != rightHeight - leftHeight) {
+        *ok = false;
+    }
+    if ((item->factor < -1) || (item->factor > 1)) {
+        *ok = false;
+    }
+    return (leftHeight > rightHeight ? leftHeight : rightHeight) + 1;
+}
+
+
+RTT_GROUP_START(TestBurstMap, 0x00050006u, NULL, NULL)
+
+RTT_TEST_START(cds_should_create_burst_map)
+{
+    RTT_ASSERT(gNumberOfItemsInExistence == 0);
+    RTT_ASSERT(gNumberOfKeysInExistence == 0);
+    gMap = CdsMapCreate(NULL, 0, testKeyCompare, NULL,
+            testKeyUnref, testItemUnref);
+    RTT_ASSERT(gMap != NULL);
+    RTT_ASSERT(!CdsMapIsBursting(gMap));
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_insert_sorted_items_in_burst_mode)
+{
+    CdsMapBurstBegin(gMap);
+    RTT_ASSERT(CdsMapIsBursting(gMap));
+    for (int i = 0; i < 1000; i++) {
+        TestItem* item = testItemAlloc(i);
+        char* key = testKeyCreate(i);
+        RTT_ASSERT(CdsMapInsert(gMap, key, (CdsMapItem*)item));
+    }
+    RTT_ASSERT(CdsMapSize(gMap) == 1000);
+
+    // Sorted insertions without rebalancing make a degenerate tree
+    TestItem* root = *((TestItem**)gMap);
+    RTT_ASSERT(root != NULL);
+    RTT_EXPECT(root->value == 0);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_find_items_in_burst_mode)
+{
+    for (int i = 0; i < 1000; i++) {
+        char key[KEYSIZE];
+        snprintf(key, sizeof(key), "%08d", i);
+        TestItem* item = (TestItem*)CdsMapSearch(gMap, key);
+        RTT_ASSERT(item != NULL);
+        RTT_EXPECT(item->value == i);
+    }
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_remove_and_replace_items_in_burst_mode)
+{
+    for (int i = 0; i < 1000; i += 3) {
+        char key[KEYSIZE];
+        snprintf(key, sizeof(key), "%08d", i);
+        RTT_ASSERT(CdsMapRemove(gMap, key));
+    }
+    for (int i = 1; i < 1000; i += 3) {
+        TestItem* item = testItemAlloc(i);
+        char* key = testKeyCreate(i);
+        RTT_ASSERT(CdsMapInsert(gMap, key, (CdsMapItem*)item));
+    }
+    RTT_EXPECT(CdsMapSize(gMap) == 666);
+    RTT_EXPECT(gNumberOfItemsInExistence == 666);
+    RTT_EXPECT(gNumberOfKeysInExistence == 666);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_iterate_in_burst_mode)
+{
+    int count = 0;
+    int lastValue = INT_MIN;
+    for (   TestItem* item = (TestItem*)CdsMapIteratorStart(gMap, true, NULL);
+            item != NULL;
+            item = (TestItem*)CdsMapIteratorNext(gMap, NULL) ) {
+        RTT_EXPECT(item->value > lastValue);
+        RTT_EXPECT((item->value % 3) != 0);
+        lastValue = item->value;
+        count++;
+    }
+    RTT_EXPECT(666 == count);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_rebalance_map_at_end_of_burst)
+{
+    CdsMapBurstEnd(gMap);
+    RTT_ASSERT(!CdsMapIsBursting(gMap));
+    bool ok = true;
+    int height = testCheckBalanced(*((CdsMapItem**)gMap), NULL, &ok);
+    RTT_ASSERT(ok);
+    RTT_EXPECT(height <= 14); // AVL worst case for 666 items
+    RTT_EXPECT(CdsMapSize(gMap) == 666);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_rebalance_partially_dirty_map)
+{
+    // Insert a second burst in the middle of a balanced tree
+    CdsMapBurstBegin(gMap);
+    for (int i = 5000; i > 2000; i--) {
+        TestItem* item = testItemAlloc(i);
+        char* key = testKeyCreate(i);
+        RTT_ASSERT(CdsMapInsert(gMap, key, (CdsMapItem*)item));
+    }
+    CdsMapRebalance(gMap);
+    RTT_ASSERT(CdsMapIsBursting(gMap));
+    CdsMapBurstEnd(gMap);
+
+    bool ok = true;
+    testCheckBalanced(*((CdsMapItem**)gMap), NULL, &ok);
+    RTT_ASSERT(ok);
+    RTT_EXPECT(CdsMapSize(gMap) == 3666);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_remove_items_after_burst)
+{
+    for (int i = 2001; i <= 5000; i++) {
+        char key[KEYSIZE];
+        snprintf(key, sizeof(key), "%08d", i);
+        RTT_ASSERT(CdsMapRemove(gMap, key));
+    }
+    bool ok = true;
+    testCheckBalanced(*((CdsMapItem**)gMap), NULL, &ok);
+    RTT_ASSERT(ok);
+    RTT_EXPECT(CdsMapSize(gMap) == 666);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_destroy_burst_map)
+{
+    CdsMapDestroy(gMap);
+    gMap = NULL;
+    RTT_ASSERT(gNumberOfItemsInExistence == 0);
+    RTT_ASSERT(gNumberOfKeysInExistence == 0);
+}
+RTT_TEST_END
+
+RTT_GROUP_END(TestBurstMap,
+        cds_should_create_burst_map,
+        cds_should_insert_sorted_items_in_burst_mode,
+        cds_should_find_items_in_burst_mode,
+        cds_should_remove_and_replace_items_in_burst_mode,
+        cds_should_iterate_in_burst_mode,
+        cds_should_rebalance_map_at_end_of_burst,
+        cds_should_rebalance_partially_dirty_map,
+        cds_should_remove_items_after_burst,
+        cds_should_destroy_burst_map);
+
+
+// Check that the sub-tree rooted at `item` is a valid WAVL tree; returns rank
+static int testCheckRanks(const CdsMapItem* item, const CdsMapItem* parent,
+        int* height, bool* ok)
+{
+    if (item == NULL) {
+        *height = 0;
+        return -1;
+    }
+    if (item->parent != parent) {
+        *ok = false;
+    }
+    if ((item->left != NULL) && (strcmp(item->left->key, item->key) >= 0)) {
+        *ok = false;
+    }
+    if ((item->right != NULL) && (strcmp(item->right->key, item->key) <= 0)) {
+        *ok = false;
+    }
+    int leftHeight;
+    int rightHeight;
+    int leftDiff = item->factor - testCheckRanks(item->left, item,
+            &leftHeight, ok);
+    int rightDiff = item->factor - testCheckRanks(item->right, item,
+            &rightHeight, ok);
+    if ((leftDiff < 1) || (leftDiff > 2) || (rightDiff < 1) || (rightDiff > 2)) {
+        *ok = false;
+    }
+    if ((item->left == NULL) && (item->right == NULL) && (item->factor != 0)) {
+        *ok = false;
+    }
+    *height = (leftHeight > rightHeight ? leftHeight : rightHeight) + 1;
+    return item->factor;
+}
+
+
+RTT_GROUP_START(TestWavlMap, 0x00050007u, NULL, NULL)
+
+RTT_TEST_START(cds_should_create_wavl_map)
+{
+    RTT_ASSERT(gNumberOfItemsInExistence == 0);
+    RTT_ASSERT(gNumberOfKeysInExistence == 0);
+    gMap = CdsMapCreateWithBalancing(NULL, 0, CDSMAP_BALANCING_WAVL,
+            testKeyCompare, NULL, testKeyUnref, testItemUnref);
+    RTT_ASSERT(gMap != NULL);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_insert_sorted_items_in_wavl_map)
+{
+    for (int i = 0; i < 1000; i++) {
+        TestItem* item = testItemAlloc(i);
+        char* key = testKeyCreate(i);
+        RTT_ASSERT(CdsMapInsert(gMap, key, (CdsMapItem*)item));
+    }
+    RTT_ASSERT(CdsMapSize(gMap) == 1000);
+
+    // Without removals, a WAVL tree is an AVL tree
+    bool ok = true;
+    int height;
+    testCheckRanks(*((CdsMapItem**)gMap), NULL, &height, &ok);
+    RTT_ASSERT(ok);
+    RTT_EXPECT(height <= 14);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_replace_items_in_wavl_map)
+{
+    for (int i = 0; i < 1000; i += 7) {
+        TestItem* item = testItemAlloc(i);
+        char* key = testKeyCreate(i);
+        RTT_ASSERT(CdsMapInsert(gMap, key, (CdsMapItem*)item));
+    }
+    bool ok = true;
+    int height;
+    testCheckRanks(*((CdsMapItem**)gMap), NULL, &height, &ok);
+    RTT_ASSERT(ok);
+    RTT_EXPECT(CdsMapSize(gMap) == 1000);
+    RTT_EXPECT(gNumberOfItemsInExistence == 1000);
+    RTT_EXPECT(gNumberOfKeysInExistence == 1000);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_remove_scattered_items_from_wavl_map)
+{
+    for (int i = 0; i < 1000; i += 3) {
+        char key[KEYSIZE];
+        snprintf(key, sizeof(key), "%08d", i);
+        RTT_ASSERT(CdsMapRemove(gMap, key));
+        bool ok = true;
+        int height;
+        testCheckRanks(*((CdsMapItem**)gMap), NULL, &height, &ok);
+        RTT_ASSERT(ok);
+    }
+    RTT_EXPECT(CdsMapSize(gMap) == 666);
+    RTT_EXPECT(gNumberOfItemsInExistence == 666);
+    RTT_EXPECT(gNumberOfKeysInExistence == 666);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_iterate_over_wavl_map)
+{
+    int count = 0;
+    int lastValue = INT_MIN;
+    for (   TestItem* item = (TestItem*)CdsMapIteratorStart(gMap, true, NULL);
+            item != NULL;
+            item = (TestItem*)CdsMapIteratorNext(gMap, NULL) ) {
+        RTT_EXPECT(item->value > lastValue);
+        RTT_EXPECT((item->value % 3) != 0);
+        lastValue = item->value;
+        count++;
+    }
+    RTT_EXPECT(666 == count);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_mix_insertions_and_removals_in_wavl_map)
+{
+    unsigned int x = 12345;
+    for (int i = 0; i < 20000; i++) {
+        x = (x * 1103515245u) + 12345u;
+        int value = (int)((x >> 8) % 2000);
+        char key[KEYSIZE];
+        snprintf(key, sizeof(key), "%08d", value);
+        if ((x >> 4) & 1) {
+            CdsMapRemove(gMap, key);
+        } else {
+            TestItem* item = testItemAlloc(value);
+            RTT_ASSERT(CdsMapInsert(gMap, testKeyCreate(value),
+                        (CdsMapItem*)item));
+        }
+        if ((i % 100) == 0) {
+            bool ok = true;
+            int height;
+            testCheckRanks(*((CdsMapItem**)gMap), NULL, &height, &ok);
+            RTT_ASSERT(ok);
+        }
+    }
+    bool ok = true;
+    int height;
+    testCheckRanks(*((CdsMapItem**)gMap), NULL, &height, &ok);
+    RTT_ASSERT(ok);
+    RTT_EXPECT(gNumberOfItemsInExistence == CdsMapSize(gMap));
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_remove_all_items_from_wavl_map)
+{
+    while (!CdsMapIsEmpty(gMap)) {
+        CdsMapItemRemove(gMap, *((CdsMapItem**)gMap));
+        bool ok = true;
+        int height;
+        testCheckRanks(*((CdsMapItem**)gMap), NULL, &height, &ok);
+        RTT_ASSERT(ok);
+    }
+    RTT_EXPECT(gNumberOfItemsInExistence == 0);
+    RTT_EXPECT(gNumberOfKeysInExistence == 0);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_destroy_wavl_map)
+{
+    CdsMapDestroy(gMap);
+    gMap = NULL;
+    RTT_ASSERT(gNumberOfItemsInExistence == 0);
+    RTT_ASSERT(gNumberOfKeysInExistence == 0);
+}
+RTT_TEST_END
+
+RTT_GROUP_END(TestWavlMap,
+        cds_should_create_wavl_map,
+        cds_should_insert_sorted_items_in_wavl_map,
+        cds_should_replace_items_in_wavl_map,
+        cds_should_remove_scattered_items_from_wavl_map,
+        cds_should_iterate_over_wavl_map,
+        cds_should_mix_insertions_and_removals_in_wavl_map,
+        cds_should_remove_all_items_from_wavl_map,
+        cds_should_destroy_wavl_map);
+
+
+RTT_GROUP_START(TestMapStats, 0x00050008u, NULL, NULL)
+
+RTT_TEST_START(cds_should_create_map_with_empty_stats)
+{
+    RTT_ASSERT(gNumberOfItemsInExistence == 0);
+    RTT_ASSERT(gNumberOfKeysInExistence == 0);
+    gMap = CdsMapCreate(NULL, 0, testKeyCompare, NULL,
+            testKeyUnref, testItemUnref);
+    RTT_ASSERT(gMap != NULL);
+
+    CdsMapStats stats;
+    memset(&stats, 0xff, sizeof(stats));
+#ifdef CDSMAP_WITH_STATS
+    RTT_ASSERT(CdsMapGetStats(gMap, &stats));
+#else
+    RTT_ASSERT(!CdsMapGetStats(gMap, &stats));
+#endif
+    RTT_EXPECT(stats.searches == 0);
+    RTT_EXPECT(stats.insertions == 0);
+    RTT_EXPECT(stats.comparisons == 0);
+    RTT_EXPECT(stats.height == 0);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_count_map_operations)
+{
+    for (int i = 0; i < 3; i++) {
+        TestItem* item = testItemAlloc(i);
+        char* key = testKeyCreate(i);
+        RTT_ASSERT(CdsMapInsert(gMap, key, (CdsMapItem*)item));
+    }
+    TestItem* item = testItemAlloc(1);
+    char* key = testKeyCreate(1);
+    RTT_ASSERT(CdsMapInsert(gMap, key, (CdsMapItem*)item));
+    char tmp[KEYSIZE];
+    snprintf(tmp, sizeof(tmp), "%08d", 2);
+    RTT_ASSERT(CdsMapRemove(gMap, tmp));
+
+    CdsMapStats stats;
+    bool ok = CdsMapGetStats(gMap, &stats);
+#ifdef CDSMAP_WITH_STATS
+    RTT_ASSERT(ok);
+    RTT_EXPECT(stats.insertions == 4);
+    RTT_EXPECT(stats.replacements == 1);
+    RTT_EXPECT(stats.searches == 1);
+    RTT_EXPECT(stats.removals == 1);
+    RTT_EXPECT(stats.rotationsRR == 1);
+    RTT_EXPECT(stats.rotationsLL == 0);
+    RTT_EXPECT(stats.descents == 5);
+    RTT_EXPECT(stats.comparisons == 0 + 1 + 2 + 1 + 2);
+    RTT_EXPECT(stats.maxDepth == 2);
+    RTT_EXPECT(stats.height == 2);
+#else
+    RTT_ASSERT(!ok);
+#endif
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_reset_map_stats)
+{
+    CdsMapResetStats(gMap);
+    CdsMapStats stats;
+    CdsMapGetStats(gMap, &stats);
+    RTT_EXPECT(stats.insertions == 0);
+    RTT_EXPECT(stats.rotationsRR == 0);
+    RTT_EXPECT(stats.maxDepth == 0);
+#ifdef CDSMAP_WITH_STATS
+    RTT_EXPECT(stats.height == 2);
+#endif
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_compute_height_of_wavl_map)
+{
+    CdsMapDestroy(gMap);
+    gMap = CdsMapCreateWithBalancing(NULL, 0, CDSMAP_BALANCING_WAVL,
+            testKeyCompare, NULL, testKeyUnref, testItemUnref);
+    RTT_ASSERT(gMap != NULL);
+    for (int i = 0; i < 100; i++) {
+        TestItem* item = testItemAlloc(i);
+        char* key = testKeyCreate(i);
+        RTT_ASSERT(CdsMapInsert(gMap, key, (CdsMapItem*)item));
+    }
+    for (int i = 0; i < 100; i += 2) {
+        char key[KEYSIZE];
+        snprintf(key, sizeof(key), "%08d", i);
+        RTT_ASSERT(CdsMapRemove(gMap, key));
+    }
+
+    CdsMapStats stats;
+    bool ok = CdsMapGetStats(gMap, &stats);
+#ifdef CDSMAP_WITH_STATS
+    RTT_ASSERT(ok);
+    bool valid = true;
+    int height;
+    testCheckRanks(*((CdsMapItem**)gMap), NULL, &height, &valid);
+    RTT_ASSERT(valid);
+    RTT_EXPECT(stats.height == height);
+    RTT_EXPECT(stats.removals == 50);
+    RTT_EXPECT(stats.avgDepth > 1.0);
+    RTT_EXPECT(stats.maxDepth <= 7);
+#else
+    RTT_ASSERT(!ok);
+#endif
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_destroy_map_with_stats)
+{
+    CdsMapDestroy(gMap);
+    gMap = NULL;
+    RTT_ASSERT(gNumberOfItemsInExistence == 0);
+    RTT_ASSERT(gNumberOfKeysInExistence == 0);
+}
+RTT_TEST_END
+
+RTT_GROUP_END(TestMapStats,
+        cds_should_create_map_with_empty_stats,
+        cds_should_count_map_operations,
+        cds_should_reset_map_stats,
+        cds_should_compute_height_of_wavl_map,
+        cds_should_destroy_map_with_stats);
+
+
+RTT_GROUP_START(TestMapClearStep, 0x00050009u, NULL, NULL)
+
+RTT_TEST_START(cds_should_create_map_to_clear_incrementally)
+{
+    RTT_ASSERT(gNumberOfItemsInExistence == 0);
+    RTT_ASSERT(gNumberOfKeysInExistence == 0);
+    gMap = CdsMapCreate(NULL, 0, testKeyCompare, NULL,
+            testKeyUnref, testItemUnref);
+    RTT_ASSERT(gMap != NULL);
+    for (int i = 0; i < 1000; i++) {
+        TestItem* item = testItemAlloc(i);
+        char* key = testKeyCreate(i);
+        RTT_ASSERT(CdsMapInsert(gMap, key, (CdsMapItem*)item));
+    }
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_clear_map_partially)
+{
+    RTT_ASSERT(!CdsMapClearStep(gMap, 100));
+    RTT_EXPECT(CdsMapSize(gMap) == 900);
+    RTT_EXPECT(gNumberOfItemsInExistence == 900);
+    RTT_EXPECT(gNumberOfKeysInExistence == 900);
+
+    // Remaining items can still be found
+    int found = 0;
+    for (int i = 0; i < 1000; i++) {
+        char key[KEYSIZE];
+        snprintf(key, sizeof(key), "%08d", i);
+        TestItem* item = (TestItem*)CdsMapSearch(gMap, key);
+        if (item != NULL) {
+            RTT_EXPECT(item->value == i);
+            found++;
+        }
+    }
+    RTT_EXPECT(900 == found);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_resume_clearing_map)
+{
+    int steps = 0;
+    while (!CdsMapClearStep(gMap, 100)) {
+        steps++;
+        RTT_ASSERT(CdsMapSize(gMap) == 900 - (steps * 100));
+    }
+    RTT_EXPECT(8 == steps);
+    RTT_EXPECT(CdsMapIsEmpty(gMap));
+    RTT_EXPECT(gNumberOfItemsInExistence == 0);
+    RTT_EXPECT(gNumberOfKeysInExistence == 0);
+    RTT_EXPECT(CdsMapClearStep(gMap, 100));
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_detach_map_items)
+{
+    for (int i = 0; i < 500; i++) {
+        TestItem* item = testItemAlloc(i);
+        char* key = testKeyCreate(i);
+        RTT_ASSERT(CdsMapInsert(gMap, key, (CdsMapItem*)item));
+    }
+    CdsMap* detached = CdsMapDetach(gMap);
+    RTT_ASSERT(detached != NULL);
+    RTT_EXPECT(CdsMapIsEmpty(gMap));
+    RTT_EXPECT(CdsMapSize(detached) == 500);
+    RTT_EXPECT(gNumberOfItemsInExistence == 500);
+
+    // Both maps can be used independently
+    TestItem* item = testItemAlloc(1000);
+    char* key = testKeyCreate(1000);
+    RTT_ASSERT(CdsMapInsert(gMap, key, (CdsMapItem*)item));
+    RTT_EXPECT(CdsMapSize(gMap) == 1);
+    RTT_EXPECT(!CdsMapClearStep(detached, 250));
+    RTT_EXPECT(CdsMapSize(detached) == 250);
+    CdsMapDestroy(detached);
+    RTT_EXPECT(gNumberOfItemsInExistence == 1);
+    RTT_EXPECT(gNumberOfKeysInExistence == 1);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_destroy_incrementally_cleared_map)
+{
+    CdsMapDestroy(gMap);
+    gMap = NULL;
+    RTT_ASSERT(gNumberOfItemsInExistence == 0);
+    RTT_ASSERT(gNumberOfKeysInExistence == 0);
+}
+RTT_TEST_END
+
+RTT_GROUP_END(TestMapClearStep,
+        cds_should_create_map_to_clear_incrementally,
+        cds_should_clear_map_partially,
+        cds_should_resume_clearing_map,
+        cds_should_detach_map_items,
+        cds_should_destroy_incrementally_cleared_map);
+
+
+// Thread-safe unref functions for parallel clearing
+static void testKeyUnrefAtomic(void* tkey)
+{
+    char* key = (char*)tkey;
+    key[KEYSIZE-1]--;
+    if (key[KEYSIZE-1] <= 0) {
+        free(key);
+        __atomic_sub_fetch(&gNumberOfKeysInExistence, 1, __ATOMIC_RELAXED);
+    }
+}
+
+static void testItemUnrefBatch(CdsMapItem** items, int64_t count)
+{
+    for (int64_t i = 0; i < count; i++) {
+        TestItem* item = (TestItem*)items[i];
+        item->ref--;
+        if (item->ref <= 0) {
+            free(item);
+            __atomic_sub_fetch(&gNumberOfItemsInExistence, 1,
+                    __ATOMIC_RELAXED);
+        }
+    }
+}
+
+
+RTT_GROUP_START(TestMapClearParallel, 0x0005000au, NULL, NULL)
+
+RTT_TEST_START(cds_should_create_map_to_clear_in_parallel)
+{
+    RTT_ASSERT(gNumberOfItemsInExistence == 0);
+    RTT_ASSERT(gNumberOfKeysInExistence == 0);
+    gMap = CdsMapCreate(NULL, 0, testKeyCompare, NULL,
+            testKeyUnrefAtomic, testItemUnref);
+    RTT_ASSERT(gMap != NULL);
+    for (int i = 0; i < 100000; i++) {
+        TestItem* item = testItemAlloc(i);
+        char* key = testKeyCreate(i);
+        RTT_ASSERT(CdsMapInsert(gMap, key, (CdsMapItem*)item));
+    }
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_clear_map_in_parallel)
+{
+    CdsMapClearParallel(gMap, 4, testItemUnrefBatch);
+    RTT_EXPECT(CdsMapIsEmpty(gMap));
+    RTT_EXPECT(gNumberOfItemsInExistence == 0);
+    RTT_EXPECT(gNumberOfKeysInExistence == 0);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_clear_small_map_with_one_thread)
+{
+    for (int i = 0; i < 10; i++) {
+        TestItem* item = testItemAlloc(i);
+        char* key = testKeyCreate(i);
+        RTT_ASSERT(CdsMapInsert(gMap, key, (CdsMapItem*)item));
+    }
+    CdsMapClearParallel(gMap, 1, NULL);
+    RTT_EXPECT(CdsMapIsEmpty(gMap));
+    RTT_EXPECT(gNumberOfItemsInExistence == 0);
+    RTT_EXPECT(gNumberOfKeysInExistence == 0);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_clear_unbalanced_map_in_parallel)
+{
+    CdsMapBurstBegin(gMap);
+    for (int i = 0; i < 5000; i++) {
+        TestItem* item = testItemAlloc(i);
+        char* key = testKeyCreate(i);
+        RTT_ASSERT(CdsMapInsert(gMap, key, (CdsMapItem*)item));
+    }
+    CdsMapClearParallel(gMap, 8, testItemUnrefBatch);
+    CdsMapBurstEnd(gMap);
+    RTT_EXPECT(CdsMapIsEmpty(gMap));
+    RTT_EXPECT(gNumberOfItemsInExistence == 0);
+    RTT_EXPECT(gNumberOfKeysInExistence == 0);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_destroy_map_cleared_in_parallel)
+{
+    CdsMapDestroy(gMap);
+    gMap = NULL;
+    RTT_ASSERT(gNumberOfItemsInExistence == 0);
+    RTT_ASSERT(gNumberOfKeysInExistence == 0);
+}
+RTT_TEST_END
+
+RTT_GROUP_END(TestMapClearParallel,
+        cds_should_create_map_to_clear_in_parallel,
+        cds_should_clear_map_in_parallel,
+        cds_should_clear_small_map_with_one_thread,
+        cds_should_clear_unbalanced_map_in_parallel,
+        cds_should_destroy_map_cleared_in_parallel);
+
+
+
+typedef struct {
+    int count;
+    int prev;
+    bool ok;
+} FrozenTraverseData;
+
+static bool testFrozenTraverse(void* key, CdsMapItem* titem, void* cookie)
+{
+    TestItem* item = (TestItem*)titem;
+    FrozenTraverseData* d = (FrozenTraverseData*)cookie;
+    char expected[KEYSIZE];
+    snprintf(expected, sizeof(expected), "%08d", item->value);
+    if ((item->value <= d->prev) || (strcmp((char*)key, expected) != 0)) {
+        d->ok = false;
+    }
+    d->prev = item->value;
+    d->count++;
+    return true;
+}
+
+/** Check a frozen map holding the even values in [0, 2*count) */
+static bool testFrozenCheck(const CdsMapFrozen* frozen, int count)
+{
+    if (CdsMapFrozenSize(frozen) != count) {
+        return false;
+    }
+    for (int i = -1; i <= 2 * count; i++) {
+        char key[KEYSIZE];
+        snprintf(key, sizeof(key), "%08d", i);
+        TestItem* item = (TestItem*)CdsMapFrozenSearch(frozen, key);
+        if ((i >= 0) && ((i % 2) == 0) && (i < 2 * count)) {
+            if ((item == NULL) || (item->value != i)) {
+                return false;
+            }
+        } else if (item != NULL) {
+            return false;
+        }
+    }
+    FrozenTraverseData d = { 0, -1, true };
+    CdsMapFrozenTraverse(frozen, testFrozenTraverse, &d);
+    return d.ok && (d.count == count);
+}
+
+
+RTT_GROUP_START(TestMapFrozen, 0x0005000bu, NULL, NULL)
+
+RTT_TEST_START(cds_should_freeze_empty_map)
+{
+    gMap = CdsMapCreate(NULL, 0, testKeyCompare, NULL, testKeyUnref,
+            testItemUnref);
+    CdsMapFrozen* frozen = CdsMapFreeze(gMap);
+    RTT_ASSERT(frozen != NULL);
+    RTT_EXPECT(testFrozenCheck(frozen, 0));
+    CdsMapFrozenDestroy(frozen);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_freeze_maps_of_all_small_sizes)
+{
+    // NB: This covers perfect and partially filled implicit trees
+    for (int count = 1; count <= 100; count++) {
+        TestItem* item = testItemAlloc(2 * (count - 1));
+        char* key = testKeyCreate(2 * (count - 1));
+        RTT_ASSERT(CdsMapInsert(gMap, key, (CdsMapItem*)item));
+
+        CdsMapFrozen* frozen = CdsMapFreeze(gMap);
+        RTT_EXPECT(testFrozenCheck(frozen, count));
+        CdsMapFrozenDestroy(frozen);
+    }
+    CdsMapClear(gMap);
+    RTT_ASSERT(gNumberOfItemsInExistence == 0);
+    RTT_ASSERT(gNumberOfKeysInExistence == 0);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_freeze_unbalanced_map)
+{
+    // NB: Items inserted in burst mode with shuffled keys
+    CdsMapBurstBegin(gMap);
+    for (int i = 0; i < 10000; i++) {
+        int value = 2 * ((i * 7919) % 10000);
+        TestItem* item = testItemAlloc(value);
+        char* key = testKeyCreate(value);
+        RTT_ASSERT(CdsMapInsert(gMap, key, (CdsMapItem*)item));
+    }
+    CdsMapFrozen* frozen = CdsMapFreeze(gMap);
+    RTT_EXPECT(testFrozenCheck(frozen, 10000));
+    CdsMapFrozenDestroy(frozen);
+    CdsMapBurstEnd(gMap);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_destroy_frozen_map)
+{
+    CdsMapDestroy(gMap);
+    gMap = NULL;
+    RTT_ASSERT(gNumberOfItemsInExistence == 0);
+    RTT_ASSERT(gNumberOfKeysInExistence == 0);
+}
+RTT_TEST_END
+
+RTT_GROUP_END(TestMapFrozen,
+        cds_should_freeze_empty_map,
+        cds_should_freeze_maps_of_all_small_sizes,
+        cds_should_freeze_unbalanced_map,
+        cds_should_destroy_frozen_map);
@@ -0,0 +1,163 @@
+/* Copyright (c) 2016  Fabrice Triboix
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** Lock-free multi-producer single-consumer queues
+ *
+ * @defgroup cdsmpsc MPSC queues
+ * @addtogroup cdsmpsc
+ * @{
+ *
+ * An unbounded FIFO queue of intrusive items, where any number of threads can
+ * push items concurrently, but only one thread at a time can pop them. Pushing
+ * is wait-free: it is a single atomic exchange plus a store, whatever the
+ * number of producers. Popping is lock-free and never blocks: if the queue is
+ * empty, or if the next item is being pushed by a producer that has not
+ * finished yet, popping returns NULL and the consumer should try again later.
+ *
+ * This is Dmitry Vyukov's intrusive MPSC queue.
+ */
+
+#ifndef CDSMPSC_h_
+#define CDSMPSC_h_
+
+#include "cdscommon.h"
+#include "cdsmpsc_private.h"
+
+
+
+/*----------------+
+ | Types & Macros |
+ +----------------*/
+
+
+/** Opaque type that represents an MPSC queue */
+typedef struct CdsMpscQueue CdsMpscQueue;
+
+
+/** MPSC queue item
+ *
+ * You can "derive" from this structure, as long as it remains at the top of
+ * your own structure definition. For example:
+ *
+ *     typedef struct {
+ *         CdsMpscItem cdsMpscItem;
+ *         int x;
+ *         float y;
+ *         char* z;
+ *     } MyItem;
+ */
+typedef struct CdsMpscItem CdsMpscItem;
+
+
+/** Prototype of a function to remove a reference to an item
+ *
+ * This function should decrement the internal reference counter of the item by
+ * one. If the reference counter of the item drops to 0, the item is not
+ * referenced anymore and must be freed.
+ */
+typedef void (*CdsMpscItemUnref)(CdsMpscItem* item);
+
+
+
+/*------------------------------+
+ | Public function declarations |
+ +------------------------------*/
+
+
+/** Create an MPSC queue
+ *
+ * @param name  [in] Name for this queue; may be NULL
+ * @param unref [in] Function to remove a reference to an item; may be NULL if
+ *                   you don't need it
+ *
+ * @return The newly-allocated queue, never NULL
+ */
+CdsMpscQueue* CdsMpscQueueCreate(const char* name, CdsMpscItemUnref unref);
+
+
+/** Destroy an MPSC queue
+ *
+ * Any item in the queue will be unreferenced. No thread must be using the
+ * queue anymore.
+ *
+ * @param queue [in,out] The queue to destroy; must not be NULL
+ */
+void CdsMpscQueueDestroy(CdsMpscQueue* queue);
+
+
+/** Get the queue's name
+ *
+ * @param queue [in] The queue to query; must not be NULL
+ *
+ * @return The queue's name, which may be NULL
+ */
+const char* CdsMpscQueueName(const CdsMpscQueue* queue);
+
+
+/** Test if a queue is empty
+ *
+ * This may only be called by the consumer. The result is only a snapshot, as
+ * producers may push items at any time.
+ *
+ * @param queue [in] The queue to query; must not be NULL
+ *
+ * @return `true` if the queue is empty, `false` otherwise
+ */
+bool CdsMpscQueueIsEmpty(const CdsMpscQueue* queue);
+
+
+/** Push an item at the back of the queue
+ *
+ * This may be called by any number of threads concurrently. The ownership of
+ * `item` will be transferred to `queue`.
+ *
+ * @param queue [in,out] The queue where to push the item; must not be NULL
+ * @param item  [in,out] The item to push; must not be NULL
+ */
+void CdsMpscQueuePush(CdsMpscQueue* queue, CdsMpscItem* item);
+
+
+/** Pop an item from the front of the queue
+ *
+ * This may only be called by the consumer. The ownership of the item will be
+ * transferred to you.
+ *
+ * @param queue [in,out] The queue from where to pop an item; must not be NULL
+ *
+ * @return The popped item, or NULL if no item is available yet
+ */
+CdsMpscItem* CdsMpscQueuePop(CdsMpscQueue* queue);
+
+
+/** Pop up to `max` items from the front of the queue
+ *
+ * This may only be called by the consumer. It stops at the first item that is
+ * not available yet.
+ *
+ * @param queue [in,out] The queue from where to pop items; must not be NULL
+ * @param items [out]    Where to write the popped items, in order; must not
+ *                       be NULL
+ * @param max   [in]     Max # of items to pop; must be > 0
+ *
+ * @return The number of popped items
+ */
+int64_t CdsMpscQueuePopMany(CdsMpscQueue* queue, CdsMpscItem** items,
+        int64_t max);
+
+
+
+#endif /* CDSMPSC_h_ */
+/* @} */
@@ -0,0 +1,171 @@
+/* Copyright (c) 2016  Fabrice Triboix
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cdsmpsc.h"
+#include <stdlib.h>
+#include <string.h>
+
+
+
+/*----------------+
+ | Macros & Types |
+ +----------------*/
+
+
+/** Size of a cache line, to keep the producers' and consumer's data apart */
+#define CDSMPSC_CACHE_LINE 64
+
+
+struct CdsMpscQueue
+{
+    // Last item pushed; written by the producers
+    CdsMpscItem*        head;
+    char                pad[CDSMPSC_CACHE_LINE - sizeof(CdsMpscItem*)];
+
+    // Next item to pop; only used by the consumer
+    CdsMpscItem*        tail;
+
+    // Placeholder item, so the queue is never really empty
+    CdsMpscItem         stub;
+
+    char*               name;
+    CdsMpscItemUnref    unref;
+    const CdsAllocator* allocator;
+};
+
+
+
+/*---------------------------------+
+ | Public function implementations |
+ +---------------------------------*/
+
+
+CdsMpscQueue* CdsMpscQueueCreate(const char* name, CdsMpscItemUnref unref)
+{
+    const CdsAllocator* allocator = CdsDefaultAllocator();
+    CdsMpscQueue* queue = CdsAllocZ(allocator, sizeof(*queue));
+
+    queue->allocator = allocator;
+    queue->name = CdsStrdup(allocator, name);
+    queue->head = &(queue->stub);
+    queue->tail = &(queue->stub);
+    queue->unref = unref;
+
+    return queue;
+}
+
+
+void CdsMpscQueueDestroy(CdsMpscQueue* queue)
+{
+    CDSASSERT_FULL(queue != NULL);
+
+    CdsMpscItem* item;
+    while ((item = CdsMpscQueuePop(queue)) != NULL) {
+        if (queue->unref != NULL) {
+            queue->unref(item);
+        }
+    }
+    CDSASSERT(CdsMpscQueueIsEmpty(queue));
+    CdsFree(queue->allocator, queue->name);
+    CdsFree(queue->allocator, queue);
+}
+
+
+const char* CdsMpscQueueName(const CdsMpscQueue* queue)
+{
+    CDSASSERT_FULL(queue != NULL);
+    return queue->name;
+}
+
+
+bool CdsMpscQueueIsEmpty(const CdsMpscQueue* queue)
+{
+    CDSASSERT_FULL(queue != NULL);
+    return (queue->tail == &(queue->stub))
+        && (__atomic_load_n(&queue->stub.next, __ATOMIC_ACQUIRE) == NULL);
+}
+
+
+void CdsMpscQueuePush(CdsMpscQueue* queue, CdsMpscItem* item)
+{
+    CDSASSERT_FULL(queue != NULL);
+    CDSASSERT_FULL(item != NULL);
+
+    // NB: Between the exchange and the store, the queue is "broken" at `prev`
+    // and the consumer can't see `item` or any item pushed after it
+    __atomic_store_n(&item->next, NULL, __ATOMIC_RELAXED);
+    CdsMpscItem* prev = __atomic_exchange_n(&queue->head, item,
+            __ATOMIC_ACQ_REL);
+    __atomic_store_n(&prev->next, item, __ATOMIC_RELEASE);
+}
+
+
+CdsMpscItem* CdsMpscQueuePop(CdsMpscQueue* queue)
+{
+    CDSASSERT_FULL(queue != NULL);
+
+    CdsMpscItem* tail = queue->tail;
+    CdsMpscItem* next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+
+    // Skip the stub
+    if (tail == &(queue->stub)) {
+        if (next == NULL) {
+            return NULL;
+        }
+        queue->tail = next;
+        tail = next;
+        next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+    }
+
+    if (next != NULL) {
+        queue->tail = next;
+        return tail;
+    }
+
+    // `tail` looks like the last item; if it isn't, a producer is in the
+    // middle of pushing an item after it
+    CdsMpscItem* head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+    if (tail != head) {
+        return NULL;
+    }
+
+    // Push the stub back, so `tail` is not the last item anymore
+    CdsMpscQueuePush(queue, &(queue->stub));
+    next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+    if (next != NULL) {
+        queue->tail = next;
+        return tail;
+    }
+    return NULL;
+}
+
+
+int64_t CdsMpscQueuePopMany(CdsMpscQueue* queue, CdsMpscItem** items,
+        int64_t max)
+{
+    CDSASSERT_FULL(items != NULL);
+    CDSASSERT(max > 0);
+
+    int64_t n = 0;
+    while (n < max) {
+        CdsMpscItem* item = CdsMpscQueuePop(queue);
+        if (item == NULL) {
+            break;
+        }
+        items[n++] = item;
+    }
+    return n;
+}
@@ -0,0 +1,166 @@
+/* Copyright (c) 2016  Fabrice Triboix
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cdsmpsc.h"
+#include "rttest.h"
+
+#include <string.h>
+#include <sched.h>
+#include <pthread.h>
+
+
+typedef struct {
+    CdsMpscItem cdsMpscItem;
+    int         ref;
+    int         producer;
+    int         x;
+} TestItem;
+
+static int gNumberOfItemsInExistence = 0;
+
+static void testItemUnref(CdsMpscItem* cdsMpscItem)
+{
+    TestItem* item = (TestItem*)cdsMpscItem;
+    item->ref--;
+    if (item->ref <= 0) {
+        free(item);
+        __atomic_sub_fetch(&gNumberOfItemsInExistence, 1, __ATOMIC_RELAXED);
+    }
+}
+
+static TestItem* testItemAlloc(int producer, int x)
+{
+    TestItem* item = malloc(sizeof(*item));
+    memset(item, 0, sizeof(*item));
+    item->ref = 1;
+    item->producer = producer;
+    item->x = x;
+    __atomic_add_fetch(&gNumberOfItemsInExistence, 1, __ATOMIC_RELAXED);
+    return item;
+}
+
+static CdsMpscQueue* gQueue = NULL;
+
+#define TEST_MPSC_PRODUCERS 4
+#define TEST_MPSC_ITEMS 20000
+
+static void* testProducer(void* arg)
+{
+    int producer = *(int*)arg;
+    for (int i = 0; i < TEST_MPSC_ITEMS; i++) {
+        CdsMpscQueuePush(gQueue, (CdsMpscItem*)testItemAlloc(producer, i));
+    }
+    return NULL;
+}
+
+
+RTT_GROUP_START(TestCdsMpscQueue, 0x00080001u, NULL, NULL)
+
+RTT_TEST_START(cds_should_create_mpsc_queue)
+{
+    gQueue = CdsMpscQueueCreate("Mpsc", testItemUnref);
+    RTT_ASSERT(gQueue != NULL);
+    RTT_EXPECT(strcmp(CdsMpscQueueName(gQueue), "Mpsc") == 0);
+    RTT_EXPECT(CdsMpscQueueIsEmpty(gQueue));
+    RTT_EXPECT(CdsMpscQueuePop(gQueue) == NULL);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_push_and_pop_mpsc_items_in_fifo_order)
+{
+    for (int i = 0; i < 5; i++) {
+        CdsMpscQueuePush(gQueue, (CdsMpscItem*)testItemAlloc(0, i));
+    }
+    RTT_EXPECT(!CdsMpscQueueIsEmpty(gQueue));
+    for (int i = 0; i < 3; i++) {
+        TestItem* item = (TestItem*)CdsMpscQueuePop(gQueue);
+        RTT_ASSERT(item != NULL);
+        RTT_EXPECT(item->x == i);
+        testItemUnref((CdsMpscItem*)item);
+    }
+
+    // Interleave pushes and pops, going through the stub again
+    CdsMpscQueuePush(gQueue, (CdsMpscItem*)testItemAlloc(0, 5));
+    CdsMpscItem* items[10];
+    RTT_ASSERT(CdsMpscQueuePopMany(gQueue, items, 10) == 3);
+    for (int i = 0; i < 3; i++) {
+        RTT_EXPECT(((TestItem*)items[i])->x == 3 + i);
+        testItemUnref(items[i]);
+    }
+    RTT_EXPECT(CdsMpscQueueIsEmpty(gQueue));
+    RTT_EXPECT(CdsMpscQueuePop(gQueue) == NULL);
+
+    CdsMpscQueuePush(gQueue, (CdsMpscItem*)testItemAlloc(0, 6));
+    TestItem* item = (TestItem*)CdsMpscQueuePop(gQueue);
+    RTT_ASSERT(item != NULL);
+    RTT_EXPECT(item->x == 6);
+    testItemUnref((CdsMpscItem*)item);
+    RTT_EXPECT(0 == gNumberOfItemsInExistence);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_pass_items_from_many_producers)
+{
+    pthread_t threads[TEST_MPSC_PRODUCERS];
+    int producers[TEST_MPSC_PRODUCERS];
+    int expected[TEST_MPSC_PRODUCERS];
+    for (int i = 0; i < TEST_MPSC_PRODUCERS; i++) {
+        producers[i] = i;
+        expected[i] = 0;
+        RTT_ASSERT(pthread_create(&threads[i], NULL, testProducer,
+                    &producers[i]) == 0);
+    }
+
+    // Items from the same producer must come out in order
+    int total = 0;
+    while (total < TEST_MPSC_PRODUCERS * TEST_MPSC_ITEMS) {
+        CdsMpscItem* items[16];
+        int64_t n = CdsMpscQueuePopMany(gQueue, items, 16);
+        if (n == 0) {
+            sched_yield();
+        }
+        for (int64_t i = 0; i < n; i++) {
+            TestItem* item = (TestItem*)items[i];
+            RTT_ASSERT(item->x == expected[item->producer]);
+            expected[item->producer]++;
+            testItemUnref(items[i]);
+        }
+        total += n;
+    }
+    for (int i = 0; i < TEST_MPSC_PRODUCERS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    RTT_EXPECT(CdsMpscQueueIsEmpty(gQueue));
+    RTT_EXPECT(0 == gNumberOfItemsInExistence);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_destroy_mpsc_queue)
+{
+    for (int i = 0; i < 3; i++) {
+        CdsMpscQueuePush(gQueue, (CdsMpscItem*)testItemAlloc(0, i));
+    }
+    CdsMpscQueueDestroy(gQueue);
+    gQueue = NULL;
+    RTT_ASSERT(0 == gNumberOfItemsInExistence);
+}
+RTT_TEST_END
+
+RTT_GROUP_END(TestCdsMpscQueue,
+        cds_should_create_mpsc_queue,
+        cds_should_push_and_pop_mpsc_items_in_fifo_order,
+        cds_should_pass_items_from_many_producers,
+        cds_should_destroy_mpsc_queue)
@@ -0,0 +1,145 @@
+/* Copyright (c) 2016  Fabrice Triboix
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CDSARENA_h_
+#define CDSARENA_h_
+
+/** Arenas
+ *
+ * @defgroup cdsarena Arenas
+ * @addtogroup cdsarena
+ * @{
+ *
+ * An arena hands out memory by bumping a cursor through large chunks. Memory
+ * is never freed piecemeal: it is all released at once when the arena is
+ * reset or destroyed. This suits containers which are built, queried and then
+ * discarded as a whole; such containers can be destroyed with their
+ * `...DestroyNoUnref()` function, which skips walking the items.
+ *
+ * Arenas are not thread-safe.
+ */
+
+#include "cdscommon.h"
+
+
+
+/*----------------+
+ | Types & Macros |
+ +----------------*/
+
+
+/** Default size of the chunks of an arena, in bytes */
+#define CDSARENA_CHUNK_B (1024 * 1024)
+
+
+/** Opaque type that represents an arena */
+typedef struct CdsArena CdsArena;
+
+
+/** Arena statistics */
+typedef struct {
+    int64_t allocs;     /**< # of allocations since the last reset */
+    int64_t used_B;     /**< Bytes allocated since the last reset */
+    int64_t chunks;     /**< # of chunks taken from the system */
+    int64_t reserved_B; /**< Memory taken from the system, in bytes */
+    int64_t resets;     /**< # of times the arena has been reset */
+} CdsArenaStats;
+
+
+
+/*------------------------------+
+ | Public function declarations |
+ +------------------------------*/
+
+
+/** Create an arena
+ *
+ * If `hugePages` is `true`, the chunks are rounded up to and aligned on the
+ * size of a huge page, and the kernel is asked to back them with huge pages.
+ * If the kernel does not support this, normal pages are used.
+ *
+ * @param name      [in] Name for this arena; may be NULL
+ * @param chunk_B   [in] Size of the chunks, in bytes; 0 for the default
+ * @param hugePages [in] Whether to back the chunks with huge pages
+ *
+ * @return The newly-allocated arena, never NULL
+ */
+CdsArena* CdsArenaCreate(const char* name, size_t chunk_B, bool hugePages);
+
+
+/** Destroy an arena
+ *
+ * All the memory allocated from the arena is released.
+ *
+ * @param arena [in,out] Arena to destroy; must not be NULL
+ */
+void CdsArenaDestroy(CdsArena* arena);
+
+
+/** Get the arena's name
+ *
+ * @param arena [in] Arena to query; must not be NULL
+ *
+ * @return The arena's name, which may be NULL
+ */
+const char* CdsArenaName(const CdsArena* arena);
+
+
+/** Allocate memory from an arena
+ *
+ * The memory is aligned like the memory returned by `malloc()`. Its content is
+ * undefined. Allocations larger than a chunk get a chunk of their own.
+ *
+ * @param arena  [in,out] Arena to allocate from; must not be NULL
+ * @param size_B [in]     Number of bytes to allocate; must be > 0
+ *
+ * @return The allocated memory, never NULL
+ */
+void* CdsArenaAlloc(CdsArena* arena, size_t size_B);
+
+
+/** Release all the memory allocated from an arena, in O(1)
+ *
+ * The chunks are kept and reused by the subsequent allocations.
+ *
+ * @param arena [in,out] Arena to reset; must not be NULL
+ */
+void CdsArenaReset(CdsArena* arena);
+
+
+/** Get an allocator which allocates from an arena
+ *
+ * This allows an arena to be used wherever a `CdsAllocator` is expected.
+ * Freeing memory through this allocator does nothing.
+ *
+ * @param arena [in] Arena to use; must not be NULL
+ *
+ * @return An allocator, valid until the arena is destroyed; never NULL
+ */
+const CdsAllocator* CdsArenaAllocator(CdsArena* arena);
+
+
+/** Get the arena statistics
+ *
+ * @param arena  [in]  Arena to query; must not be NULL
+ * @param pStats [out] Where to write the statistics; must not be NULL
+ */
+void CdsArenaGetStats(const CdsArena* arena, CdsArenaStats* pStats);
+
+
+
+/* @} */
+#endif /* CDSARENA_h_ */
@@ -58,10 +58,57 @@
     } while (0)
 
 
-/** Assert macro */
-#define CDSASSERT(_cond) \
+/** Hint the CPU to bring the memory at `_ptr` into the cache
+ *
+ * This never faults, even if `_ptr` is not a valid address.
+ */
+#define CDSPREFETCH(_ptr) __builtin_prefetch(_ptr)
+
+
+/** Assertion levels
+ *
+ * Set `CDS_ASSERT_LEVEL` to one of these to choose which checks are compiled
+ * in. It defaults to `CDS_ASSERT_FULL`; the Makefile sets it to
+ * `CDS_ASSERT_CHEAP` for release builds (use `make ASSERT=x` to override).
+ *
+ * - `CDS_ASSERT_FULL`: all checks are performed
+ * - `CDS_ASSERT_CHEAP`: only `CDSASSERT()` checks are performed
+ * - `CDS_ASSERT_NONE`: no check is performed
+ *
+ * A check that is not performed is turned into a hint that its condition is
+ * always true, which allows the compiler to optimise the surrounding code. The
+ * condition is still evaluated, so any side effect it has still happens; the
+ * behaviour is undefined if it is false.
+ */
+#define CDS_ASSERT_NONE  0
+#define CDS_ASSERT_CHEAP 1
+#define CDS_ASSERT_FULL  2
+
+#ifndef CDS_ASSERT_LEVEL
+#define CDS_ASSERT_LEVEL CDS_ASSERT_FULL
+#endif
+
+
+/** Tell the compiler that `_cond` is always true */
+#define CDSASSUME(_cond) \
     do { \
         if (!(_cond)) { \
+            __builtin_unreachable(); \
+        } \
+    } while (0)
+
+
+/** Check an assertion, whatever the assertion level
+ *
+ * Use this for conditions that must be checked even when the assertion level
+ * is `CDS_ASSERT_NONE`, in particular the results of calls that can fail at
+ * run time, such as `pthread_mutex_init()`. The levelled macros below are for
+ * contract checks only: a failed check they do not perform is undefined
+ * behaviour.
+ */
+#define CDSASSERT_ALWAYS(_cond) \
+    do { \
+        if (__builtin_expect(!(_cond), 0)) { \
             fprintf(stderr, "CDS ASSERT: %s (at %s:%d)\n", #_cond, \
                     __FILE__, __LINE__); \
             abort(); \
@@ -69,6 +116,70 @@
     } while (0)
 
 
+/** Assert macro
+ *
+ * Use this for invariants that are cheap to check compared to the work of the
+ * function. It is checked unless the assertion level is `CDS_ASSERT_NONE`.
+ */
+#if CDS_ASSERT_LEVEL >= CDS_ASSERT_CHEAP
+#define CDSASSERT(_cond) CDSASSERT_ALWAYS(_cond)
+#else
+#define CDSASSERT(_cond) CDSASSUME(_cond)
+#endif
+
+
+/** Assert macro for hot paths
+ *
+ * Use this for checks which cost about as much as the function itself, such
+ * as checking the arguments of accessors. It is only checked if the assertion
+ * level is `CDS_ASSERT_FULL`. The condition should be a simple expression
+ * without function calls, so the compiler can drop it otherwise.
+ */
+#if CDS_ASSERT_LEVEL >= CDS_ASSERT_FULL
+#define CDSASSERT_FULL(_cond) CDSASSERT_ALWAYS(_cond)
+#else
+#define CDSASSERT_FULL(_cond) CDSASSUME(_cond)
+#endif
+
+
+/** Memory allocator
+ *
+ * This is used by the containers to allocate their own memory (control
+ * structures, names, chunks, etc.). You can also use it to allocate your items,
+ * using `CdsAlloc()` and `CdsFree()`.
+ *
+ * The memory returned by `alloc` must be suitably aligned for any type, like
+ * the memory returned by `malloc()`.
+ */
+typedef struct
+{
+    /** Allocate `size_B` bytes; must return NULL on failure */
+    void* (*alloc)(void* context, size_t size_B);
+
+    /** Free memory allocated by `alloc`; `ptr` is never NULL */
+    void (*free)(void* context, void* ptr);
+
+    /** Allocate `count` blocks of `size_B` bytes into `ptrs`
+     *
+     * This may be NULL, in which case `alloc` is called for each block.
+     *
+     * Returns `true` if all blocks have been allocated, or `false` on
+     * failure, in which case no block must have been allocated.
+     */
+    bool (*allocBatch)(void* context, size_t size_B, void** ptrs,
+            int64_t count);
+
+    /** Free `count` blocks at once
+     *
+     * This may be NULL, in which case `free` is called for each block.
+     */
+    void (*freeBatch)(void* context, void** ptrs, int64_t count);
+
+    /** Context passed to the above functions */
+    void* context;
+} CdsAllocator;
+
+
 
 /*------------------------------+
  | Public function declarations |
@@ -101,6 +212,108 @@ void* _CdsMallocZ(size_t size_B, const char* file, int line);
 /** @endcond */
 
 
+/** Get the system allocator
+ *
+ * This allocator uses `malloc()` and `free()`.
+ *
+ * @return The system allocator, never NULL
+ */
+const CdsAllocator* CdsSystemAllocator(void);
+
+
+/** Set the default allocator
+ *
+ * The default allocator is used by containers which are not given an
+ * allocator when they are created. Each container keeps the allocator it has
+ * been created with, so changing the default allocator does not affect
+ * existing containers.
+ *
+ * This function is not thread-safe: call it before creating any container.
+ *
+ * @param allocator [in] The new default allocator; it must remain valid for as
+ *                       long as it is used; NULL to use the system allocator
+ */
+void CdsSetDefaultAllocator(const CdsAllocator* allocator);
+
+
+/** Get the default allocator
+ *
+ * @return The default allocator, never NULL
+ */
+const CdsAllocator* CdsDefaultAllocator(void);
+
+
+/** Allocate memory
+ *
+ * This function panics if the memory can't be allocated.
+ *
+ * @param allocator [in] Allocator to use; NULL for the default allocator
+ * @param size_B    [in] The number of bytes to allocate; must be > 0
+ *
+ * @return The allocated memory, never NULL
+ */
+void* CdsAlloc(const CdsAllocator* allocator, size_t size_B);
+
+
+/** Allocate memory, and initialise it to zero
+ *
+ * This function panics if the memory can't be allocated.
+ *
+ * @param allocator [in] Allocator to use; NULL for the default allocator
+ * @param size_B    [in] The number of bytes to allocate; must be > 0
+ *
+ * @return The allocated memory, never NULL
+ */
+void* CdsAllocZ(const CdsAllocator* allocator, size_t size_B);
+
+
+/** Free memory
+ *
+ * @param allocator [in]     Allocator `ptr` has been allocated from; NULL for
+ *                           the default allocator
+ * @param ptr       [in,out] Memory to free; may be NULL
+ */
+void CdsFree(const CdsAllocator* allocator, void* ptr);
+
+
+/** Allocate many blocks of the same size in one go
+ *
+ * This function panics if the memory can't be allocated.
+ *
+ * @param allocator [in]  Allocator to use; NULL for the default allocator
+ * @param size_B    [in]  Size of each block, in bytes; must be > 0
+ * @param ptrs      [out] Where to write the addresses of the blocks; must not
+ *                        be NULL
+ * @param count     [in]  Number of blocks to allocate; must be >= 0
+ */
+void CdsAllocBatch(const CdsAllocator* allocator, size_t size_B, void** ptrs,
+        int64_t count);
+
+
+/** Free many blocks in one go
+ *
+ * @param allocator [in]     Allocator the blocks have been allocated from;
+ *                           NULL for the default allocator
+ * @param ptrs      [in,out] Blocks to free; must not be NULL; entries must
+ *                           not be NULL
+ * @param count     [in]     Number of blocks to free; must be >= 0
+ */
+void CdsFreeBatch(const CdsAllocator* allocator, void** ptrs, int64_t count);
+
+
+/** Duplicate a string
+ *
+ * This function panics if the memory can't be allocated.
+ *
+ * @param allocator [in] Allocator to use; NULL for the default allocator
+ * @param str       [in] String to duplicate; may be NULL
+ *
+ * @return The duplicated string, to be freed with `CdsFree()`, or NULL if
+ *         `str` is NULL
+ */
+char* CdsStrdup(const CdsAllocator* allocator, const char* str);
+
+
 
 /* @} */
 #endif /* CDSCOMMON_h_ */
@@ -0,0 +1,76 @@
+/* Copyright (c) 2016  Fabrice Triboix
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CDSHUGEPAGE_h_
+#define CDSHUGEPAGE_h_
+
+/** Huge-page backed memory
+ *
+ * @defgroup cdshugepage Huge pages
+ * @addtogroup cdshugepage
+ * @{
+ *
+ * Large containers walked in random order, like big maps, spend a lot of time
+ * in dTLB misses. Backing their memory with huge pages lets a single TLB entry
+ * cover 2 MiB instead of 4 KiB.
+ *
+ * The huge-page allocator maps memory directly from the kernel, aligned on
+ * huge pages, and asks for transparent huge pages with `MADV_HUGEPAGE`. If the
+ * kernel can't provide huge pages, the memory is backed by normal pages
+ * instead. Every allocation is rounded up to a whole number of huge pages, so
+ * this allocator is meant to provide the slabs of a `CdsPool` or the chunks of
+ * a `CdsArena`, not individual items.
+ */
+
+#include "cdscommon.h"
+
+
+
+/*----------------+
+ | Types & Macros |
+ +----------------*/
+
+
+/** Size of a huge page, in bytes */
+#define CDS_HUGEPAGE_B (2 * 1024 * 1024)
+
+
+
+/*------------------------------+
+ | Public function declarations |
+ +------------------------------*/
+
+
+/** Get the huge-page allocator
+ *
+ * This allocator is thread-safe.
+ *
+ * @return The huge-page allocator, never NULL
+ */
+const CdsAllocator* CdsHugePageAllocator(void);
+
+
+/** Check whether transparent huge pages can be used
+ *
+ * @return `true` if the kernel provides transparent huge pages on request,
+ *         `false` if the huge-page allocator will fall back to normal pages
+ */
+bool CdsHugePagesAvailable(void);
+
+
+
+/* @} */
+#endif /* CDSHUGEPAGE_h_ */
@@ -0,0 +1,186 @@
+/* Copyright (c) 2016  Fabrice Triboix
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CDSPOOL_h_
+#define CDSPOOL_h_
+
+/** Fixed-size object pools
+ *
+ * @defgroup cdspool Pools
+ * @addtogroup cdspool
+ * @{
+ *
+ * A pool hands out blocks of a single size, carved from large slabs. Freed
+ * blocks are kept in an intrusive free list, so allocating and freeing a block
+ * are O(1) and never call the system allocator once the pool is warm. Slabs
+ * are only returned to the system when the pool is destroyed.
+ *
+ * A thread-safe pool gives each thread its own cache of free blocks. Blocks
+ * move between the thread caches and a shared depot in batches, so the depot
+ * lock is only taken once every `CDSPOOL_BATCH` allocations or frees.
+ */
+
+#include "cdscommon.h"
+
+
+
+/*----------------+
+ | Types & Macros |
+ +----------------*/
+
+
+/** Number of blocks moved at once between a thread cache and the depot */
+#define CDSPOOL_BATCH 32
+
+
+/** Opaque type that represents a pool */
+typedef struct CdsPool CdsPool;
+
+
+/** Pool statistics */
+typedef struct {
+    int64_t allocs;     /**< # of blocks allocated */
+    int64_t frees;      /**< # of blocks freed */
+    int64_t inUse;      /**< # of blocks currently allocated */
+    int64_t slabs;      /**< # of slabs taken from the system */
+    int64_t reserved_B; /**< Memory taken from the system, in bytes */
+    int64_t refills;    /**< # of batches moved from the depot to a cache */
+    int64_t flushes;    /**< # of batches moved from a cache to the depot */
+} CdsPoolStats;
+
+
+
+/*------------------------------+
+ | Public function declarations |
+ +------------------------------*/
+
+
+/** Create a pool
+ *
+ * Blocks are aligned like the memory returned by `malloc()`; their size is
+ * rounded up accordingly.
+ *
+ * @param name       [in] Name for this pool; may be NULL
+ * @param size_B     [in] Size of a block, in bytes; must be > 0
+ * @param capacity   [in] Max # of blocks the pool can hand out; 0 = no limit
+ * @param threadSafe [in] Whether the pool can be used by many threads at the
+ *                        same time; if `false`, no locking is performed at
+ *                        all
+ *
+ * @return The newly-allocated pool, never NULL
+ */
+CdsPool* CdsPoolCreate(const char* name, size_t size_B, int64_t capacity,
+        bool threadSafe);
+
+
+/** Create a pool which takes its slabs from a custom allocator
+ *
+ * This is typically used to back the pool with huge pages, by passing
+ * `CdsHugePageAllocator()` and a slab size of `CDS_HUGEPAGE_B`.
+ *
+ * @param name          [in] Name for this pool; may be NULL
+ * @param size_B        [in] Size of a block, in bytes; must be > 0
+ * @param capacity      [in] Max # of blocks the pool can hand out; 0 = no
+ *                           limit
+ * @param threadSafe    [in] Whether the pool can be used by many threads at
+ *                           the same time
+ * @param slab_B        [in] Size of the slabs, in bytes; 0 for the default;
+ *                           it is increased if it can't hold a few blocks
+ * @param slabAllocator [in] Allocator for the slabs; NULL for the system
+ *                           allocator; if thread-safe, it must itself be
+ *                           thread-safe
+ *
+ * @return The newly-allocated pool, never NULL
+ */
+CdsPool* CdsPoolCreateWithAllocator(const char* name, size_t size_B,
+        int64_t capacity, bool threadSafe, size_t slab_B,
+        const CdsAllocator* slabAllocator);
+
+
+/** Destroy a pool
+ *
+ * All the memory of the pool is released, including the blocks which have not
+ * been freed.
+ *
+ * @param pool [in,out] Pool to destroy; must not be NULL
+ */
+void CdsPoolDestroy(CdsPool* pool);
+
+
+/** Get the pool's name
+ *
+ * @param pool [in] Pool to query; must not be NULL
+ *
+ * @return The pool's name, which may be NULL
+ */
+const char* CdsPoolName(const CdsPool* pool);
+
+
+/** Get the size of the blocks of a pool
+ *
+ * @param pool [in] Pool to query; must not be NULL
+ *
+ * @return The size of a block, in bytes; this may be more than the size given
+ *         to `CdsPoolCreate()`
+ */
+size_t CdsPoolBlockSize(const CdsPool* pool);
+
+
+/** Allocate a block
+ *
+ * The content of the block is undefined.
+ *
+ * @param pool [in,out] Pool to allocate from; must not be NULL
+ *
+ * @return The allocated block, or NULL if the pool is at capacity
+ */
+void* CdsPoolAlloc(CdsPool* pool);
+
+
+/** Free a block
+ *
+ * @param pool [in,out] Pool `ptr` has been allocated from; must not be NULL
+ * @param ptr  [in,out] Block to free; must not be NULL
+ */
+void CdsPoolFree(CdsPool* pool, void* ptr);
+
+
+/** Get an allocator which allocates from a pool
+ *
+ * This allows a pool to be used wherever a `CdsAllocator` is expected. The
+ * allocator fails to allocate more than the block size of the pool.
+ *
+ * @param pool [in] Pool to use; must not be NULL
+ *
+ * @return An allocator, valid until the pool is destroyed; never NULL
+ */
+const CdsAllocator* CdsPoolAllocator(CdsPool* pool);
+
+
+/** Get the pool statistics
+ *
+ * For a thread-safe pool, the counters of the thread caches are read without
+ * synchronisation, so they might be slightly out of date.
+ *
+ * @param pool   [in]  Pool to query; must not be NULL
+ * @param pStats [out] Where to write the statistics; must not be NULL
+ */
+void CdsPoolGetStats(CdsPool* pool, CdsPoolStats* pStats);
+
+
+
+/* @} */
+#endif /* CDSPOOL_h_ */
@@ -0,0 +1,148 @@
+/* Copyright (c) 2016  Fabrice Triboix
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CDSTHREADPOOL_h_
+#define CDSTHREADPOOL_h_
+
+/** Work-stealing thread pool
+ *
+ * @defgroup cdsthreadpool Thread pool
+ * @addtogroup cdsthreadpool
+ * @{
+ *
+ * A thread pool runs fork-join style tasks. Each thread of the pool has its
+ * own queue of tasks: a thread pushes the tasks it submits at the back of its
+ * queue and takes its next task from the back too, which keeps the most
+ * recently split work local and cache-hot. A thread which runs out of tasks
+ * steals from the front of the queues of the other threads, where the oldest,
+ * and thus typically largest, pieces of work are.
+ *
+ * Tasks are gathered in groups. A thread which waits for a group to complete
+ * runs queued tasks in the meantime, so tasks may themselves submit tasks and
+ * wait for them without tying up a thread.
+ */
+
+#include "cdscommon.h"
+
+
+
+/*----------------+
+ | Types & Macros |
+ +----------------*/
+
+
+/** Opaque type that represents a thread pool */
+typedef struct CdsThreadPool CdsThreadPool;
+
+
+/** Group of tasks which can be waited on as a whole
+ *
+ * Initialise it with `CdsThreadPoolGroupInit()`; do not access its fields
+ * directly.
+ */
+typedef struct {
+    int64_t pending; /**< # of tasks submitted and not completed yet */
+} CdsThreadPoolGroup;
+
+
+/** Prototype of a task
+ *
+ * @param pool [in,out] Pool running the task; the task may submit more tasks
+ *                      to it
+ * @param arg  [in,out] Argument given to `CdsThreadPoolSubmit()`
+ */
+typedef void (*CdsThreadPoolTask)(CdsThreadPool* pool, void* arg);
+
+
+
+/*------------------------------+
+ | Public function declarations |
+ +------------------------------*/
+
+
+/** Create a thread pool
+ *
+ * @param name    [in] Name for this pool; may be NULL
+ * @param threads [in] Number of threads to start; 0 to start one per online
+ *                     CPU; the threads waiting on a group help too
+ *
+ * @return The newly-allocated pool, never NULL
+ */
+CdsThreadPool* CdsThreadPoolCreate(const char* name, int threads);
+
+
+/** Destroy a thread pool
+ *
+ * All the submitted tasks must have completed.
+ *
+ * @param pool [in,out] Pool to destroy; must not be NULL
+ */
+void CdsThreadPoolDestroy(CdsThreadPool* pool);
+
+
+/** Get the pool's name
+ *
+ * @param pool [in] Pool to query; must not be NULL
+ *
+ * @return The pool's name, which may be NULL
+ */
+const char* CdsThreadPoolName(const CdsThreadPool* pool);
+
+
+/** Get the number of threads of a pool
+ *
+ * @param pool [in] Pool to query; must not be NULL
+ *
+ * @return The number of threads started by the pool, which is > 0
+ */
+int CdsThreadPoolThreads(const CdsThreadPool* pool);
+
+
+/** Initialise a group of tasks
+ *
+ * @param group [out] Group to initialise; must not be NULL
+ */
+void CdsThreadPoolGroupInit(CdsThreadPoolGroup* group);
+
+
+/** Submit a task
+ *
+ * The task is queued in the queue of the calling thread if it belongs to the
+ * pool, or in a queue shared by all the other threads otherwise.
+ *
+ * @param pool  [in,out] Pool to run the task; must not be NULL
+ * @param group [in,out] Group the task belongs to; must not be NULL
+ * @param task  [in]     Task to run; must not be NULL
+ * @param arg   [in,out] Argument for the task
+ */
+void CdsThreadPoolSubmit(CdsThreadPool* pool, CdsThreadPoolGroup* group,
+        CdsThreadPoolTask task, void* arg);
+
+
+/** Wait for all the tasks of a group to complete
+ *
+ * The calling thread runs queued tasks while waiting, including tasks which
+ * belong to other groups.
+ *
+ * @param pool  [in,out] Pool running the tasks; must not be NULL
+ * @param group [in,out] Group to wait for; must not be NULL
+ */
+void CdsThreadPoolWait(CdsThreadPool* pool, CdsThreadPoolGroup* group);
+
+
+
+/* @} */
+#endif /* CDSTHREADPOOL_h_ */
@@ -0,0 +1,275 @@
+/* Copyright (c) 2016  Fabrice Triboix
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cdsarena.h"
+#include "cdshugepage.h"
+#include <stdlib.h>
+#include <string.h>
+
+
+
+/*----------------+
+ | Macros & Types |
+ +----------------*/
+
+
+/** Alignment of the allocations, same as `malloc()` */
+#define CDSARENA_ALIGN 16
+
+
+/** Chunk header, at the beginning of each chunk
+ *
+ * The header takes `CDSARENA_ALIGN` bytes, so the memory which follows it is
+ * properly aligned.
+ */
+typedef struct CdsArenaChunk
+{
+    struct CdsArenaChunk* next;
+    size_t                size_B; // Including the header
+} CdsArenaChunk;
+
+
+struct CdsArena
+{
+    char*               name;
+    size_t              chunk_B;
+    const CdsAllocator* chunkAllocator;
+    CdsAllocator        allocator;
+
+    CdsArenaChunk*      first;   // All the chunks, in the order they are used
+    CdsArenaChunk*      current; // NULL after a reset
+    char*               cursor;  // Next free byte in `current`
+    char*               end;     // End of `current`
+
+    int64_t             allocs;
+    int64_t             used_B;
+    int64_t             nchunks;
+    int64_t             reserved_B;
+    int64_t             resets;
+};
+
+
+
+/*-------------------------------+
+ | Private function declarations |
+ +-------------------------------*/
+
+
+/** Move on to the next chunk which can hold `size_B` bytes
+ *
+ * Chunks left over from before the last reset are reused if they are large
+ * enough; otherwise a new chunk is allocated and inserted after the current
+ * one.
+ *
+ * @param arena  [in,out] Arena to update
+ * @param size_B [in]     Number of bytes the chunk must be able to hold
+ */
+static void cdsArenaNextChunk(CdsArena* arena, size_t size_B);
+
+
+/** Allocate a new chunk from the system
+ *
+ * @param arena  [in,out] Arena the chunk is for
+ * @param size_B [in]     Minimum size of the chunk, including its header
+ *
+ * @return The new chunk, never NULL
+ */
+static CdsArenaChunk* cdsArenaChunkCreate(CdsArena* arena, size_t size_B);
+
+
+/** `CdsAllocator` functions */
+static void* cdsArenaAllocatorAlloc(void* context, size_t size_B);
+static void cdsArenaAllocatorFree(void* context, void* ptr);
+static void cdsArenaAllocatorFreeBatch(void* context, void** ptrs,
+        int64_t count);
+
+
+
+/*---------------------------------+
+ | Public function implementations |
+ +---------------------------------*/
+
+
+CdsArena* CdsArenaCreate(const char* name, size_t chunk_B, bool hugePages)
+{
+    CdsArena* arena = CdsMallocZ(sizeof(*arena));
+    if (name != NULL) {
+        arena->name = strdup(name);
+        CDSASSERT_ALWAYS(arena->name != NULL);
+    }
+    if (chunk_B == 0) {
+        chunk_B = CDSARENA_CHUNK_B;
+    }
+    arena->chunk_B = chunk_B;
+    if (hugePages) {
+        arena->chunkAllocator = CdsHugePageAllocator();
+    } else {
+        arena->chunkAllocator = CdsSystemAllocator();
+    }
+    arena->allocator.alloc = cdsArenaAllocatorAlloc;
+    arena->allocator.free = cdsArenaAllocatorFree;
+    arena->allocator.freeBatch = cdsArenaAllocatorFreeBatch;
+    arena->allocator.context = arena;
+    return arena;
+}
+
+
+void CdsArenaDestroy(CdsArena* arena)
+{
+    CDSASSERT_FULL(arena != NULL);
+
+    while (arena->first != NULL) {
+        CdsArenaChunk* chunk = arena->first;
+        arena->first = chunk->next;
+        CdsFree(arena->chunkAllocator, chunk);
+    }
+    free(arena->name);
+    free(arena);
+}
+
+
+const char* CdsArenaName(const CdsArena* arena)
+{
+    CDSASSERT_FULL(arena != NULL);
+    return arena->name;
+}
+
+
+void* CdsArenaAlloc(CdsArena* arena, size_t size_B)
+{
+    CDSASSERT_FULL(arena != NULL);
+    CDSASSERT(size_B > 0);
+
+    size_B = (size_B + CDSARENA_ALIGN - 1) & ~(size_t)(CDSARENA_ALIGN - 1);
+    if ((size_t)(arena->end - arena->cursor) < size_B) {
+        cdsArenaNextChunk(arena, size_B);
+    }
+    void* ptr = arena->cursor;
+    arena->cursor += size_B;
+    arena->allocs++;
+    arena->used_B += size_B;
+    return ptr;
+}
+
+
+void CdsArenaReset(CdsArena* arena)
+{
+    CDSASSERT_FULL(arena != NULL);
+
+    arena->current = NULL;
+    arena->cursor = NULL;
+    arena->end = NULL;
+    arena->allocs = 0;
+    arena->used_B = 0;
+    arena->resets++;
+}
+
+
+const CdsAllocator* CdsArenaAllocator(CdsArena* arena)
+{
+    CDSASSERT_FULL(arena != NULL);
+    return &arena->allocator;
+}
+
+
+void CdsArenaGetStats(const CdsArena* arena, CdsArenaStats* pStats)
+{
+    CDSASSERT_FULL(arena != NULL);
+    CDSASSERT_FULL(pStats != NULL);
+
+    memset(pStats, 0, sizeof(*pStats));
+    pStats->allocs = arena->allocs;
+    pStats->used_B = arena->used_B;
+    pStats->chunks = arena->nchunks;
+    pStats->reserved_B = arena->reserved_B;
+    pStats->resets = arena->resets;
+}
+
+
+
+/*----------------------------------+
+ | Private function implementations |
+ +----------------------------------*/
+
+
+static void cdsArenaNextChunk(CdsArena* arena, size_t size_B)
+{
+    CdsArenaChunk* chunk;
+    if (arena->current == NULL) {
+        chunk = arena->first;
+    } else {
+        chunk = arena->current->next;
+    }
+
+    if ((chunk == NULL) || (chunk->size_B - CDSARENA_ALIGN < size_B)) {
+        chunk = cdsArenaChunkCreate(arena, size_B + CDSARENA_ALIGN);
+        if (arena->current == NULL) {
+            chunk->next = arena->first;
+            arena->first = chunk;
+        } else {
+            chunk->next = arena->current->next;
+            arena->current->next = chunk;
+        }
+    }
+
+    arena->current = chunk;
+    arena->cursor = (char*)chunk + CDSARENA_ALIGN;
+    arena->end = (char*)chunk + chunk->size_B;
+}
+
+
+static CdsArenaChunk* cdsArenaChunkCreate(CdsArena* arena, size_t size_B)
+{
+    if (size_B < arena->chunk_B) {
+        size_B = arena->chunk_B;
+    }
+
+    // NB: The huge-page allocator rounds up to a whole number of huge pages,
+    // so do it here to make use of all of it
+    if (arena->chunkAllocator == CdsHugePageAllocator()) {
+        size_B = (size_B + CDS_HUGEPAGE_B - 1)
+            & ~(size_t)(CDS_HUGEPAGE_B - 1);
+    }
+    CdsArenaChunk* chunk = CdsAlloc(arena->chunkAllocator, size_B);
+    chunk->next = NULL;
+    chunk->size_B = size_B;
+    arena->nchunks++;
+    arena->reserved_B += size_B;
+    return chunk;
+}
+
+
+static void* cdsArenaAllocatorAlloc(void* context, size_t size_B)
+{
+    return CdsArenaAlloc(context, size_B);
+}
+
+
+static void cdsArenaAllocatorFree(void* context, void* ptr)
+{
+    // NB: Memory is only released when the arena is reset or destroyed
+    (void)context;
+    (void)ptr;
+}
+
+
+static void cdsArenaAllocatorFreeBatch(void* context, void** ptrs,
+        int64_t count)
+{
+    (void)context;
+    (void)ptrs;
+    (void)count;
+}
@@ -20,6 +20,33 @@
 
 
 
+/*-------------------------------+
+ | Private function declarations |
+ +-------------------------------*/
+
+
+static void* cdsSystemAlloc(void* context, size_t size_B);
+static void cdsSystemFree(void* context, void* ptr);
+
+
+
+/*------------------+
+ | Global variables |
+ +------------------*/
+
+
+static const CdsAllocator gCdsSystemAllocator = {
+    .alloc = cdsSystemAlloc,
+    .free = cdsSystemFree,
+    .allocBatch = NULL,
+    .freeBatch = NULL,
+    .context = NULL
+};
+
+static const CdsAllocator* gCdsDefaultAllocator = &gCdsSystemAllocator;
+
+
+
 /*---------------------------------+
  | Public function implementations |
  +---------------------------------*/
@@ -35,7 +62,9 @@ void* _CdsMalloc(size_t size_B, const char* file, int line)
     (void)line;
     void* ptr = malloc(size_B);
 #endif
-    CDSASSERT(ptr != NULL);
+    if (ptr == NULL) {
+        CDSPANIC_MSG("Failed to allocate %zu bytes", size_B);
+    }
     return ptr;
 }
 
@@ -50,7 +79,139 @@ void* _CdsMallocZ(size_t size_B, const char* file, int line)
     (void)line;
     void* ptr = malloc(size_B);
 #endif
-    CDSASSERT(ptr != NULL);
+    if (ptr == NULL) {
+        CDSPANIC_MSG("Failed to allocate %zu bytes", size_B);
+    }
+    memset(ptr, 0, size_B);
+    return ptr;
+}
+
+
+const CdsAllocator* CdsSystemAllocator(void)
+{
+    return &gCdsSystemAllocator;
+}
+
+
+void CdsSetDefaultAllocator(const CdsAllocator* allocator)
+{
+    if (allocator == NULL) {
+        allocator = &gCdsSystemAllocator;
+    }
+    CDSASSERT((allocator->alloc != NULL) && (allocator->free != NULL));
+    gCdsDefaultAllocator = allocator;
+}
+
+
+const CdsAllocator* CdsDefaultAllocator(void)
+{
+    return gCdsDefaultAllocator;
+}
+
+
+void* CdsAlloc(const CdsAllocator* allocator, size_t size_B)
+{
+    CDSASSERT(size_B > 0);
+    if (allocator == NULL) {
+        allocator = gCdsDefaultAllocator;
+    }
+    void* ptr = allocator->alloc(allocator->context, size_B);
+    if (ptr == NULL) {
+        CDSPANIC_MSG("Failed to allocate %zu bytes", size_B);
+    }
+    return ptr;
+}
+
+
+void* CdsAllocZ(const CdsAllocator* allocator, size_t size_B)
+{
+    void* ptr = CdsAlloc(allocator, size_B);
     memset(ptr, 0, size_B);
     return ptr;
 }
+
+
+void CdsFree(const CdsAllocator* allocator, void* ptr)
+{
+    if (ptr != NULL) {
+        if (allocator == NULL) {
+            allocator = gCdsDefaultAllocator;
+        }
+        allocator->free(allocator->context, ptr);
+    }
+}
+
+
+void CdsAllocBatch(const CdsAllocator* allocator, size_t size_B, void** ptrs,
+        int64_t count)
+{
+    CDSASSERT(size_B > 0);
+    CDSASSERT_FULL(ptrs != NULL);
+    CDSASSERT(count >= 0);
+    if (allocator == NULL) {
+        allocator = gCdsDefaultAllocator;
+    }
+    if (allocator->allocBatch != NULL) {
+        if (!allocator->allocBatch(allocator->context, size_B, ptrs, count)) {
+            CDSPANIC_MSG("Failed to allocate %lld blocks of %zu bytes",
+                    (long long)count, size_B);
+        }
+    } else {
+        for (int64_t i = 0; i < count; i++) {
+            ptrs[i] = CdsAlloc(allocator, size_B);
+        }
+    }
+}
+
+
+void CdsFreeBatch(const CdsAllocator* allocator, void** ptrs, int64_t count)
+{
+    CDSASSERT_FULL(ptrs != NULL);
+    CDSASSERT(count >= 0);
+    if (allocator == NULL) {
+        allocator = gCdsDefaultAllocator;
+    }
+    if (allocator->freeBatch != NULL) {
+        allocator->freeBatch(allocator->context, ptrs, count);
+    } else {
+        for (int64_t i = 0; i < count; i++) {
+            allocator->free(allocator->context, ptrs[i]);
+        }
+    }
+}
+
+
+char* CdsStrdup(const CdsAllocator* allocator, const char* str)
+{
+    char* dup = NULL;
+    if (str != NULL) {
+        size_t size_B = strlen(str) + 1;
+        dup = CdsAlloc(allocator, size_B);
+        memcpy(dup, str, size_B);
+    }
+    return dup;
+}
+
+
+
+/*----------------------------------+
+ | Private function implementations |
+ +----------------------------------*/
+
+
+static void* cdsSystemAlloc(void* context, size_t size_B)
+{
+    (void)context;
+#ifdef CDS_WITH_FLLOC
+    return FllocMalloc(size_B, __FILE__, __LINE__);
+#else
+    return malloc(size_B);
+#endif
+}
+
+
+static void cdsSystemFree(void* context, void* ptr)
+{
+    (void)context;
+    free(ptr);
+}
@@ -0,0 +1,144 @@
+/* Copyright (c) 2016  Fabrice Triboix
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cdshugepage.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+
+
+/*----------------+
+ | Macros & Types |
+ +----------------*/
+
+
+/** Header of a mapping
+ *
+ * The header is stored in the normal page which lies just below the memory
+ * returned to the caller, so the memory itself stays aligned on a huge page.
+ */
+typedef struct
+{
+    size_t size_B; // Size of the mapping, excluding the header page
+} CdsHugePageHeader;
+
+
+
+/*-------------------------------+
+ | Private function declarations |
+ +-------------------------------*/
+
+
+/** `CdsAllocator` functions */
+static void* cdsHugePageAlloc(void* context, size_t size_B);
+static void cdsHugePageFree(void* context, void* ptr);
+
+
+
+/*------------------+
+ | Global variables |
+ +------------------*/
+
+
+static const CdsAllocator gCdsHugePageAllocator = {
+    .alloc = cdsHugePageAlloc,
+    .free = cdsHugePageFree,
+    .allocBatch = NULL,
+    .freeBatch = NULL,
+    .context = NULL
+};
+
+
+
+/*---------------------------------+
+ | Public function implementations |
+ +---------------------------------*/
+
+
+const CdsAllocator* CdsHugePageAllocator(void)
+{
+    return &gCdsHugePageAllocator;
+}
+
+
+bool CdsHugePagesAvailable(void)
+{
+    FILE* f = fopen("/sys/kernel/mm/transparent_hugepage/enabled", "r");
+    if (f == NULL) {
+        return false;
+    }
+    char buf[64];
+    bool available = false;
+    if (fgets(buf, sizeof(buf), f) != NULL) {
+        // NB: The current setting is between brackets, e.g. "[madvise]"
+        available = (strstr(buf, "[never]") == NULL);
+    }
+    fclose(f);
+    return available;
+}
+
+
+
+/*----------------------------------+
+ | Private function implementations |
+ +----------------------------------*/
+
+
+static void* cdsHugePageAlloc(void* context, size_t size_B)
+{
+    (void)context;
+    size_t page_B = (size_t)sysconf(_SC_PAGESIZE);
+    size_B = (size_B + CDS_HUGEPAGE_B - 1) & ~(size_t)(CDS_HUGEPAGE_B - 1);
+
+    // Map one extra huge page, so an aligned block with room for the header
+    // page below it can be found inside the mapping
+    size_t map_B = size_B + CDS_HUGEPAGE_B;
+    char* base = mmap(NULL, map_B, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        return NULL;
+    }
+    char* ptr = (char*)((((uintptr_t)base + page_B + CDS_HUGEPAGE_B - 1))
+            & ~(uintptr_t)(CDS_HUGEPAGE_B - 1));
+    char* hdr = ptr - page_B;
+
+    // Give back what is not needed on both sides
+    if (hdr > base) {
+        munmap(base, hdr - base);
+    }
+    char* end = ptr + size_B;
+    if (end < base + map_B) {
+        munmap(end, (base + map_B) - end);
+    }
+
+    // NB: This is only a hint; if the kernel does not support transparent huge
+    // pages, the memory is simply backed by normal pages
+    (void)madvise(ptr, size_B, MADV_HUGEPAGE);
+
+    ((CdsHugePageHeader*)hdr)->size_B = size_B;
+    return ptr;
+}
+
+
+static void cdsHugePageFree(void* context, void* ptr)
+{
+    (void)context;
+    size_t page_B = (size_t)sysconf(_SC_PAGESIZE);
+    char* hdr = (char*)ptr - page_B;
+    munmap(hdr, page_B + ((CdsHugePageHeader*)hdr)->size_B);
+}
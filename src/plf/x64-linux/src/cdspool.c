@@ -0,0 +1,470 @@
+/* Copyright (c) 2016  Fabrice Triboix
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cdspool.h"
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+
+
+/*----------------+
+ | Macros & Types |
+ +----------------*/
+
+
+/** Default size of a slab, in bytes */
+#define CDSPOOL_SLAB_B (64 * 1024)
+
+/** Minimum number of blocks in a slab */
+#define CDSPOOL_SLAB_MIN_BLOCKS 16
+
+/** Alignment of the blocks, same as `malloc()` */
+#define CDSPOOL_ALIGN 16
+
+
+/** Free block; the link is stored in the block itself */
+typedef struct CdsPoolBlock
+{
+    struct CdsPoolBlock* next;
+} CdsPoolBlock;
+
+
+/** Slab header, at the beginning of each slab */
+typedef struct CdsPoolSlab
+{
+    struct CdsPoolSlab* next;
+} CdsPoolSlab;
+
+
+/** Per-thread cache of free blocks */
+typedef struct CdsPoolCache
+{
+    CdsPool*             pool;
+    CdsPoolBlock*        free;   // Free blocks of this thread
+    int64_t              count;  // # of blocks in `free`
+    int64_t              allocs; // Only written by the owner thread
+    int64_t              frees;  // Only written by the owner thread
+    struct CdsPoolCache* next;   // Other caches of the same pool
+    struct CdsPoolCache* prev;
+} CdsPoolCache;
+
+
+struct CdsPool
+{
+    char*               name;
+    size_t              block_B;
+    size_t              slab_B;
+    int64_t             capacity;
+    bool                threadSafe;
+    CdsAllocator        allocator;
+    const CdsAllocator* slabAllocator;
+
+    // Depot; protected by `lock` if the pool is thread-safe
+    pthread_mutex_t     lock;
+    CdsPoolBlock*       free;     // Free blocks
+    char*               cursor;   // Next block never used in the current slab
+    char*               end;      // End of the current slab
+    CdsPoolSlab*        slabs;    // All the slabs, to release them
+    int64_t             nslabs;
+    int64_t             carved;   // # of blocks carved out of the slabs
+    int64_t             allocs;   // Including those of the exited threads
+    int64_t             frees;    // Including those of the exited threads
+    int64_t             refills;
+    int64_t             flushes;
+
+    // Thread caches; the list is protected by `lock`
+    pthread_key_t       key;
+    CdsPoolCache*       caches;
+};
+
+
+
+/*-------------------------------+
+ | Private function declarations |
+ +-------------------------------*/
+
+
+/** Take up to `max` blocks from the depot
+ *
+ * The depot must be locked, if the pool is thread-safe.
+ *
+ * @param pool   [in,out] Pool to take the blocks from
+ * @param max    [in]     Max # of blocks to take; must be > 0
+ * @param pFirst [out]    First block of the NULL-terminated chain of blocks
+ *
+ * @return The number of blocks taken, which is 0 if the pool is at capacity
+ */
+static int64_t cdsPoolDepotTake(CdsPool* pool, int64_t max,
+        CdsPoolBlock** pFirst);
+
+
+/** Return a chain of blocks to the depot
+ *
+ * The depot must be locked, if the pool is thread-safe.
+ *
+ * @param pool  [in,out] Pool to return the blocks to
+ * @param first [in,out] First block of the chain
+ * @param last  [in,out] Last block of the chain
+ */
+static void cdsPoolDepotPut(CdsPool* pool, CdsPoolBlock* first,
+        CdsPoolBlock* last);
+
+
+/** Get the cache of the calling thread, creating it if necessary
+ *
+ * @param pool [in,out] A thread-safe pool
+ *
+ * @return The cache, never NULL
+ */
+static CdsPoolCache* cdsPoolGetCache(CdsPool* pool);
+
+
+/** Return the blocks of a thread cache to the depot, and free the cache
+ *
+ * This is called when a thread exits.
+ *
+ * @param arg [in,out] The `CdsPoolCache`
+ */
+static void cdsPoolReleaseCache(void* arg);
+
+
+/** `CdsAllocator` functions */
+static void* cdsPoolAllocatorAlloc(void* context, size_t size_B);
+static void cdsPoolAllocatorFree(void* context, void* ptr);
+
+
+
+/*---------------------------------+
+ | Public function implementations |
+ +---------------------------------*/
+
+
+CdsPool* CdsPoolCreate(const char* name, size_t size_B, int64_t capacity,
+        bool threadSafe)
+{
+    return CdsPoolCreateWithAllocator(name, size_B, capacity, threadSafe, 0,
+            NULL);
+}
+
+
+CdsPool* CdsPoolCreateWithAllocator(const char* name, size_t size_B,
+        int64_t capacity, bool threadSafe, size_t slab_B,
+        const CdsAllocator* slabAllocator)
+{
+    CDSASSERT(size_B > 0);
+
+    CdsPool* pool = CdsMallocZ(sizeof(*pool));
+    if (name != NULL) {
+        pool->name = strdup(name);
+        CDSASSERT_ALWAYS(pool->name != NULL);
+    }
+    if (size_B < sizeof(CdsPoolBlock)) {
+        size_B = sizeof(CdsPoolBlock);
+    }
+    size_t align_B = CDSPOOL_ALIGN;
+    pool->block_B = (size_B + align_B - 1) & ~(align_B - 1);
+
+    // NB: The slab header takes the space of one aligned block
+    pool->slab_B = (slab_B > 0) ? slab_B : CDSPOOL_SLAB_B;
+    size_t min_B = align_B + (CDSPOOL_SLAB_MIN_BLOCKS * pool->block_B);
+    if (pool->slab_B < min_B) {
+        pool->slab_B = min_B;
+    }
+    if (capacity > 0) {
+        pool->capacity = capacity;
+    }
+    pool->threadSafe = threadSafe;
+    if (slabAllocator == NULL) {
+        slabAllocator = CdsSystemAllocator();
+    }
+    pool->slabAllocator = slabAllocator;
+    pool->allocator.alloc = cdsPoolAllocatorAlloc;
+    pool->allocator.free = cdsPoolAllocatorFree;
+    pool->allocator.context = pool;
+
+    if (threadSafe) {
+        CDSASSERT_ALWAYS(pthread_mutex_init(&pool->lock, NULL) == 0);
+        CDSASSERT_ALWAYS(pthread_key_create(&pool->key, cdsPoolReleaseCache)
+                == 0);
+    }
+    return pool;
+}
+
+
+void CdsPoolDestroy(CdsPool* pool)
+{
+    CDSASSERT_FULL(pool != NULL);
+
+    if (pool->threadSafe) {
+        // NB: Once the key is deleted, the caches of the threads which are
+        // still running won't be released when they exit, so do it here
+        pthread_key_delete(pool->key);
+        while (pool->caches != NULL) {
+            CdsPoolCache* cache = pool->caches;
+            pool->caches = cache->next;
+            free(cache);
+        }
+        pthread_mutex_destroy(&pool->lock);
+    }
+    while (pool->slabs != NULL) {
+        CdsPoolSlab* slab = pool->slabs;
+        pool->slabs = slab->next;
+        CdsFree(pool->slabAllocator, slab);
+    }
+    free(pool->name);
+    free(pool);
+}
+
+
+const char* CdsPoolName(const CdsPool* pool)
+{
+    CDSASSERT_FULL(pool != NULL);
+    return pool->name;
+}
+
+
+size_t CdsPoolBlockSize(const CdsPool* pool)
+{
+    CDSASSERT_FULL(pool != NULL);
+    return pool->block_B;
+}
+
+
+void* CdsPoolAlloc(CdsPool* pool)
+{
+    CDSASSERT_FULL(pool != NULL);
+
+    CdsPoolBlock* block;
+    if (!pool->threadSafe) {
+        block = pool->free;
+        if (block != NULL) {
+            pool->free = block->next;
+        } else if (cdsPoolDepotTake(pool, 1, &block) == 0) {
+            return NULL;
+        }
+        pool->allocs++;
+        return block;
+    }
+
+    CdsPoolCache* cache = cdsPoolGetCache(pool);
+    if (cache->free == NULL) {
+        pthread_mutex_lock(&pool->lock);
+        cache->count = cdsPoolDepotTake(pool, CDSPOOL_BATCH, &cache->free);
+        if (cache->count > 0) {
+            pool->refills++;
+        }
+        pthread_mutex_unlock(&pool->lock);
+        if (cache->free == NULL) {
+            return NULL;
+        }
+    }
+    block = cache->free;
+    cache->free = block->next;
+    cache->count--;
+    __atomic_store_n(&cache->allocs, cache->allocs + 1, __ATOMIC_RELAXED);
+    return block;
+}
+
+
+void CdsPoolFree(CdsPool* pool, void* ptr)
+{
+    CDSASSERT_FULL(pool != NULL);
+    CDSASSERT_FULL(ptr != NULL);
+
+    CdsPoolBlock* block = ptr;
+    if (!pool->threadSafe) {
+        block->next = pool->free;
+        pool->free = block;
+        pool->frees++;
+        return;
+    }
+
+    CdsPoolCache* cache = cdsPoolGetCache(pool);
+    block->next = cache->free;
+    cache->free = block;
+    cache->count++;
+    __atomic_store_n(&cache->frees, cache->frees + 1, __ATOMIC_RELAXED);
+
+    // NB: Keep a batch in the cache, so a thread which alternates between
+    // allocating and freeing does not hit the depot every time
+    if (cache->count >= 2 * CDSPOOL_BATCH) {
+        CdsPoolBlock* first = cache->free;
+        CdsPoolBlock* last = first;
+        for (int i = 1; i < CDSPOOL_BATCH; i++) {
+            last = last->next;
+        }
+        cache->free = last->next;
+        cache->count -= CDSPOOL_BATCH;
+
+        pthread_mutex_lock(&pool->lock);
+        cdsPoolDepotPut(pool, first, last);
+        pool->flushes++;
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+
+const CdsAllocator* CdsPoolAllocator(CdsPool* pool)
+{
+    CDSASSERT_FULL(pool != NULL);
+    return &pool->allocator;
+}
+
+
+void CdsPoolGetStats(CdsPool* pool, CdsPoolStats* pStats)
+{
+    CDSASSERT_FULL(pool != NULL);
+    CDSASSERT_FULL(pStats != NULL);
+
+    if (pool->threadSafe) {
+        pthread_mutex_lock(&pool->lock);
+    }
+    memset(pStats, 0, sizeof(*pStats));
+    pStats->allocs = pool->allocs;
+    pStats->frees = pool->frees;
+    for (CdsPoolCache* cache = pool->caches; cache != NULL;
+            cache = cache->next) {
+        pStats->allocs += __atomic_load_n(&cache->allocs, __ATOMIC_RELAXED);
+        pStats->frees += __atomic_load_n(&cache->frees, __ATOMIC_RELAXED);
+    }
+    pStats->inUse = pStats->allocs - pStats->frees;
+    pStats->slabs = pool->nslabs;
+    pStats->reserved_B = pool->nslabs * (int64_t)pool->slab_B;
+    pStats->refills = pool->refills;
+    pStats->flushes = pool->flushes;
+    if (pool->threadSafe) {
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+
+
+/*----------------------------------+
+ | Private function implementations |
+ +----------------------------------*/
+
+
+static int64_t cdsPoolDepotTake(CdsPool* pool, int64_t max,
+        CdsPoolBlock** pFirst)
+{
+    CdsPoolBlock* first = NULL;
+    int64_t n = 0;
+
+    // Take free blocks first
+    while ((n < max) && (pool->free != NULL)) {
+        CdsPoolBlock* block = pool->free;
+        pool->free = block->next;
+        block->next = first;
+        first = block;
+        n++;
+    }
+
+    // Then carve new blocks out of the slabs
+    while (n < max) {
+        if ((pool->capacity > 0) && (pool->carved >= pool->capacity)) {
+            break;
+        }
+        if (pool->cursor + pool->block_B > pool->end) {
+            CdsPoolSlab* slab = CdsAlloc(pool->slabAllocator, pool->slab_B);
+            slab->next = pool->slabs;
+            pool->slabs = slab;
+            pool->nslabs++;
+            pool->cursor = (char*)slab + CDSPOOL_ALIGN;
+            pool->end = (char*)slab + pool->slab_B;
+        }
+        CdsPoolBlock* block = (CdsPoolBlock*)pool->cursor;
+        pool->cursor += pool->block_B;
+        pool->carved++;
+        block->next = first;
+        first = block;
+        n++;
+    }
+
+    *pFirst = first;
+    return n;
+}
+
+
+static void cdsPoolDepotPut(CdsPool* pool, CdsPoolBlock* first,
+        CdsPoolBlock* last)
+{
+    last->next = pool->free;
+    pool->free = first;
+}
+
+
+static CdsPoolCache* cdsPoolGetCache(CdsPool* pool)
+{
+    CdsPoolCache* cache = pthread_getspecific(pool->key);
+    if (cache == NULL) {
+        cache = CdsMallocZ(sizeof(*cache));
+        cache->pool = pool;
+        pthread_mutex_lock(&pool->lock);
+        cache->next = pool->caches;
+        if (pool->caches != NULL) {
+            pool->caches->prev = cache;
+        }
+        pool->caches = cache;
+        pthread_mutex_unlock(&pool->lock);
+        CDSASSERT_ALWAYS(pthread_setspecific(pool->key, cache) == 0);
+    }
+    return cache;
+}
+
+
+static void cdsPoolReleaseCache(void* arg)
+{
+    CdsPoolCache* cache = arg;
+    CdsPool* pool = cache->pool;
+
+    pthread_mutex_lock(&pool->lock);
+    if (cache->free != NULL) {
+        CdsPoolBlock* last = cache->free;
+        while (last->next != NULL) {
+            last = last->next;
+        }
+        cdsPoolDepotPut(pool, cache->free, last);
+    }
+    pool->allocs += cache->allocs;
+    pool->frees += cache->frees;
+    if (cache->prev != NULL) {
+        cache->prev->next = cache->next;
+    } else {
+        pool->caches = cache->next;
+    }
+    if (cache->next != NULL) {
+        cache->next->prev = cache->prev;
+    }
+    pthread_mutex_unlock(&pool->lock);
+    free(cache);
+}
+
+
+static void* cdsPoolAllocatorAlloc(void* context, size_t size_B)
+{
+    CdsPool* pool = context;
+    if (size_B > pool->block_B) {
+        return NULL;
+    }
+    return CdsPoolAlloc(pool);
+}
+
+
+static void cdsPoolAllocatorFree(void* context, void* ptr)
+{
+    CdsPoolFree(context, ptr);
+}
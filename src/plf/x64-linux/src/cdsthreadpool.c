@@ -0,0 +1,363 @@
+/* Copyright (c) 2016  Fabrice Triboix
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cdsthreadpool.h"
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+
+
+/*----------------+
+ | Macros & Types |
+ +----------------*/
+
+
+/** Initial capacity of a task queue */
+#define CDSTHREADPOOL_QUEUE_CAPACITY 64
+
+
+/** A queued task */
+typedef struct
+{
+    CdsThreadPoolTask   task;
+    void*               arg;
+    CdsThreadPoolGroup* group;
+} CdsThreadPoolItem;
+
+
+/** Task queue of a thread
+ *
+ * This is a ring buffer; the owner thread pushes and pops at the back, the
+ * other threads steal from the front.
+ */
+typedef struct
+{
+    pthread_mutex_t    lock;
+    CdsThreadPoolItem* items;
+    int64_t            capacity;
+    int64_t            head;  // Index of the front item
+    int64_t            count;
+} CdsThreadPoolQueue;
+
+
+struct CdsThreadPool
+{
+    char*               name;
+    int                 nthreads;
+    pthread_t*          threads;
+
+    // One queue per thread, plus one for the threads outside of the pool
+    CdsThreadPoolQueue* queues;
+
+    // Sleeping threads wait on `wakeup`
+    pthread_mutex_t     lock;
+    pthread_cond_t      wakeup;
+    int64_t             queued;   // # of tasks in all queues; atomic
+    int                 sleeping; // # of sleeping threads; atomic
+    bool                stop;
+};
+
+
+/** Arguments of a pool thread */
+typedef struct
+{
+    CdsThreadPool* pool;
+    int            index;
+} CdsThreadPoolThreadArg;
+
+
+
+/*-------------------------------+
+ | Private function declarations |
+ +-------------------------------*/
+
+
+/** Get the index of the queue of the calling thread
+ *
+ * @param pool [in] A thread pool
+ *
+ * @return The index of the queue the calling thread owns, which is the shared
+ *         queue if the calling thread does not belong to `pool`
+ */
+static int cdsThreadPoolSelf(const CdsThreadPool* pool);
+
+
+/** Run one queued task, if any
+ *
+ * @param pool [in,out] A thread pool
+ * @param self [in]     Index of the queue of the calling thread
+ *
+ * @return `true` if a task has been run, `false` if all queues were empty
+ */
+static bool cdsThreadPoolRunOne(CdsThreadPool* pool, int self);
+
+
+/** Main function of the pool threads
+ *
+ * @param arg [in,out] A `CdsThreadPoolThreadArg`, released by this function
+ *
+ * @return Always NULL
+ */
+static void* cdsThreadPoolThread(void* arg);
+
+
+
+/*------------------+
+ | Global variables |
+ +------------------*/
+
+
+/* Pool the current thread belongs to, and the index of its queue */
+static __thread CdsThreadPool* tCdsThreadPool = NULL;
+static __thread int tCdsThreadPoolIndex = 0;
+
+
+
+/*---------------------------------+
+ | Public function implementations |
+ +---------------------------------*/
+
+
+CdsThreadPool* CdsThreadPoolCreate(const char* name, int threads)
+{
+    CDSASSERT(threads >= 0);
+    if (threads == 0) {
+        long ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = (ncpus > 0) ? (int)ncpus : 1;
+    }
+
+    CdsThreadPool* pool = CdsMallocZ(sizeof(*pool));
+    if (name != NULL) {
+        pool->name = strdup(name);
+        CDSASSERT_ALWAYS(pool->name != NULL);
+    }
+    pool->nthreads = threads;
+    pool->queues = CdsMallocZ((threads + 1) * sizeof(*pool->queues));
+    for (int i = 0; i <= threads; i++) {
+        CdsThreadPoolQueue* queue = &pool->queues[i];
+        CDSASSERT_ALWAYS(pthread_mutex_init(&queue->lock, NULL) == 0);
+        queue->capacity = CDSTHREADPOOL_QUEUE_CAPACITY;
+        queue->items = CdsMalloc(queue->capacity * sizeof(*queue->items));
+    }
+    CDSASSERT_ALWAYS(pthread_mutex_init(&pool->lock, NULL) == 0);
+    CDSASSERT_ALWAYS(pthread_cond_init(&pool->wakeup, NULL) == 0);
+
+    pool->threads = CdsMalloc(threads * sizeof(*pool->threads));
+    for (int i = 0; i < threads; i++) {
+        CdsThreadPoolThreadArg* arg = CdsMalloc(sizeof(*arg));
+        arg->pool = pool;
+        arg->index = i;
+        if (pthread_create(&pool->threads[i], NULL, cdsThreadPoolThread,
+                    arg) != 0) {
+            CDSPANIC_MSG("Failed to create thread %d of thread pool", i);
+        }
+    }
+    return pool;
+}
+
+
+void CdsThreadPoolDestroy(CdsThreadPool* pool)
+{
+    CDSASSERT_FULL(pool != NULL);
+    CDSASSERT(__atomic_load_n(&pool->queued, __ATOMIC_SEQ_CST) == 0);
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = true;
+    pthread_cond_broadcast(&pool->wakeup);
+    pthread_mutex_unlock(&pool->lock);
+    for (int i = 0; i < pool->nthreads; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    for (int i = 0; i <= pool->nthreads; i++) {
+        pthread_mutex_destroy(&pool->queues[i].lock);
+        free(pool->queues[i].items);
+    }
+    pthread_cond_destroy(&pool->wakeup);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->threads);
+    free(pool->queues);
+    free(pool->name);
+    free(pool);
+}
+
+
+const char* CdsThreadPoolName(const CdsThreadPool* pool)
+{
+    CDSASSERT_FULL(pool != NULL);
+    return pool->name;
+}
+
+
+int CdsThreadPoolThreads(const CdsThreadPool* pool)
+{
+    CDSASSERT_FULL(pool != NULL);
+    return pool->nthreads;
+}
+
+
+void CdsThreadPoolGroupInit(CdsThreadPoolGroup* group)
+{
+    CDSASSERT_FULL(group != NULL);
+    group->pending = 0;
+}
+
+
+void CdsThreadPoolSubmit(CdsThreadPool* pool, CdsThreadPoolGroup* group,
+        CdsThreadPoolTask task, void* arg)
+{
+    CDSASSERT_FULL(pool != NULL);
+    CDSASSERT_FULL(group != NULL);
+    CDSASSERT_FULL(task != NULL);
+
+    __atomic_add_fetch(&group->pending, 1, __ATOMIC_RELAXED);
+
+    CdsThreadPoolQueue* queue = &pool->queues[cdsThreadPoolSelf(pool)];
+    pthread_mutex_lock(&queue->lock);
+    if (queue->count >= queue->capacity) {
+        // Grow the ring buffer, unwrapping it in the process
+        CdsThreadPoolItem* items = CdsMalloc(2 * queue->capacity
+                * sizeof(*items));
+        for (int64_t i = 0; i < queue->count; i++) {
+            items[i] = queue->items[(queue->head + i) % queue->capacity];
+        }
+        free(queue->items);
+        queue->items = items;
+        queue->capacity *= 2;
+        queue->head = 0;
+    }
+    CdsThreadPoolItem* item =
+        &queue->items[(queue->head + queue->count) % queue->capacity];
+    item->task = task;
+    item->arg = arg;
+    item->group = group;
+    queue->count++;
+    pthread_mutex_unlock(&queue->lock);
+
+    // NB: A thread about to sleep increments `sleeping` before checking
+    // `queued`, and we do the opposite, so either it sees this task or we see
+    // it sleeping
+    __atomic_add_fetch(&pool->queued, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&pool->sleeping, __ATOMIC_SEQ_CST) > 0) {
+        pthread_mutex_lock(&pool->lock);
+        pthread_cond_signal(&pool->wakeup);
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+
+void CdsThreadPoolWait(CdsThreadPool* pool, CdsThreadPoolGroup* group)
+{
+    CDSASSERT_FULL(pool != NULL);
+    CDSASSERT_FULL(group != NULL);
+
+    int self = cdsThreadPoolSelf(pool);
+    while (__atomic_load_n(&group->pending, __ATOMIC_ACQUIRE) > 0) {
+        // NB: The tasks of this group might be running in other threads, so
+        // spin if there is nothing to help with
+        if (!cdsThreadPoolRunOne(pool, self)) {
+            sched_yield();
+        }
+    }
+}
+
+
+
+/*----------------------------------+
+ | Private function implementations |
+ +----------------------------------*/
+
+
+static int cdsThreadPoolSelf(const CdsThreadPool* pool)
+{
+    if (tCdsThreadPool == pool) {
+        return tCdsThreadPoolIndex;
+    }
+    return pool->nthreads;
+}
+
+
+static bool cdsThreadPoolRunOne(CdsThreadPool* pool, int self)
+{
+    if (__atomic_load_n(&pool->queued, __ATOMIC_SEQ_CST) <= 0) {
+        return false;
+    }
+
+    // Take the most recent task of our own queue, or else steal the oldest
+    // task of another queue
+    bool found = false;
+    CdsThreadPoolItem item;
+    int nqueues = pool->nthreads + 1;
+    for (int i = 0; (i < nqueues) && !found; i++) {
+        CdsThreadPoolQueue* queue = &pool->queues[(self + i) % nqueues];
+        pthread_mutex_lock(&queue->lock);
+        if (queue->count > 0) {
+            int64_t index;
+            if (i == 0) {
+                index = (queue->head + queue->count - 1) % queue->capacity;
+            } else {
+                index = queue->head;
+                queue->head = (queue->head + 1) % queue->capacity;
+            }
+            item = queue->items[index];
+            queue->count--;
+            found = true;
+        }
+        pthread_mutex_unlock(&queue->lock);
+    }
+    if (!found) {
+        return false;
+    }
+
+    __atomic_sub_fetch(&pool->queued, 1, __ATOMIC_SEQ_CST);
+    item.task(pool, item.arg);
+    __atomic_sub_fetch(&item.group->pending, 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+
+static void* cdsThreadPoolThread(void* arg)
+{
+    CdsThreadPoolThreadArg* threadArg = arg;
+    CdsThreadPool* pool = threadArg->pool;
+    int self = threadArg->index;
+    free(threadArg);
+    tCdsThreadPool = pool;
+    tCdsThreadPoolIndex = self;
+
+    for (;;) {
+        if (cdsThreadPoolRunOne(pool, self)) {
+            continue;
+        }
+
+        pthread_mutex_lock(&pool->lock);
+        __atomic_add_fetch(&pool->sleeping, 1, __ATOMIC_SEQ_CST);
+        while (!pool->stop
+                && (__atomic_load_n(&pool->queued, __ATOMIC_SEQ_CST) <= 0)) {
+            pthread_cond_wait(&pool->wakeup, &pool->lock);
+        }
+        __atomic_sub_fetch(&pool->sleeping, 1, __ATOMIC_SEQ_CST);
+        bool stop = pool->stop;
+        pthread_mutex_unlock(&pool->lock);
+        if (stop) {
+            break;
+        }
+    }
+    return NULL;
+}
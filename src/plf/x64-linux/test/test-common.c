@@ -0,0 +1,568 @@
+/* Copyright (c) 2016  Fabrice Triboix
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cdscommon.h"
+#include "cdspool.h"
+#include "cdsarena.h"
+#include "cdshugepage.h"
+#include "cdsthreadpool.h"
+#include "cdslist.h"
+#include "cdsmap.h"
+#include "cdsdeque.h"
+#include "cdsring.h"
+#include "cdsbinarytree.h"
+#include "rttest.h"
+
+#include <string.h>
+#include <pthread.h>
+
+
+/* Allocator which counts its calls */
+typedef struct {
+    int64_t allocs;
+    int64_t frees;
+    int64_t batchAllocs;
+    int64_t batchFrees;
+} TestCounters;
+
+static void* testAlloc(void* context, size_t size_B)
+{
+    ((TestCounters*)context)->allocs++;
+    return malloc(size_B);
+}
+
+static void testFree(void* context, void* ptr)
+{
+    ((TestCounters*)context)->frees++;
+    free(ptr);
+}
+
+static bool testAllocBatch(void* context, size_t size_B, void** ptrs,
+        int64_t count)
+{
+    ((TestCounters*)context)->batchAllocs++;
+    for (int64_t i = 0; i < count; i++) {
+        ptrs[i] = testAlloc(context, size_B);
+    }
+    return true;
+}
+
+static void testFreeBatch(void* context, void** ptrs, int64_t count)
+{
+    ((TestCounters*)context)->batchFrees++;
+    for (int64_t i = 0; i < count; i++) {
+        testFree(context, ptrs[i]);
+    }
+}
+
+static int testCompare(void* leftKey, void* rightKey, void* cookie)
+{
+    (void)cookie;
+    return strcmp(leftKey, rightKey);
+}
+
+static TestCounters gCounters;
+
+static CdsAllocator gAllocator = {
+    .alloc = testAlloc,
+    .free = testFree,
+    .allocBatch = NULL,
+    .freeBatch = NULL,
+    .context = &gCounters
+};
+
+static void testReset(void)
+{
+    memset(&gCounters, 0, sizeof(gCounters));
+    gAllocator.allocBatch = NULL;
+    gAllocator.freeBatch = NULL;
+}
+
+
+RTT_GROUP_START(TestCdsAllocator, 0x00020001u, NULL, NULL)
+
+RTT_TEST_START(cds_should_use_system_allocator_by_default)
+{
+    RTT_ASSERT(CdsDefaultAllocator() == CdsSystemAllocator());
+    void* ptr = CdsAllocZ(NULL, 16);
+    RTT_ASSERT(ptr != NULL);
+    RTT_EXPECT(((char*)ptr)[15] == 0);
+    CdsFree(NULL, ptr);
+    CdsFree(NULL, NULL);
+    RTT_EXPECT(CdsStrdup(NULL, NULL) == NULL);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_use_per_container_allocator)
+{
+    testReset();
+    CdsList* list = CdsListCreateWithAllocator("List", 0, NULL, &gAllocator);
+    CdsMap* map = CdsMapCreateWithAllocator("Map", 0, CDSMAP_BALANCING_AVL,
+            testCompare, NULL, NULL, NULL, &gAllocator);
+    CdsDeque* deque = CdsDequeCreateWithAllocator("Deque", 0, sizeof(int),
+            &gAllocator);
+    CdsRing* ring = CdsRingCreateWithAllocator("Ring", 4, sizeof(int),
+            &gAllocator);
+    CdsBinaryTree* tree = CdsBinaryTreeCreateWithAllocator("Tree", 0, NULL,
+            &gAllocator);
+    RTT_EXPECT(strcmp(CdsListName(list), "List") == 0);
+    RTT_EXPECT(strcmp(CdsMapName(map), "Map") == 0);
+
+    int x = 42;
+    RTT_ASSERT(CdsDequePushBack(deque, &x));
+    int64_t allocs = gCounters.allocs;
+    RTT_EXPECT(allocs >= 5);
+
+    // The frozen map, its keys and its items
+    CdsMapFrozen* frozen = CdsMapFreeze(map);
+    RTT_EXPECT(gCounters.allocs == allocs + 3);
+    CdsMapFrozenDestroy(frozen);
+    RTT_EXPECT(gCounters.frees == 3);
+    allocs += 3;
+
+    CdsListDestroy(list);
+    CdsMapDestroy(map);
+    CdsDequeDestroy(deque);
+    CdsRingDestroy(ring);
+    CdsBinaryTreeDestroy(tree);
+    RTT_EXPECT(gCounters.allocs == allocs);
+    RTT_EXPECT(gCounters.frees == allocs);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_use_default_allocator)
+{
+    testReset();
+    CdsSetDefaultAllocator(&gAllocator);
+    RTT_EXPECT(CdsDefaultAllocator() == &gAllocator);
+    CdsList* list = CdsListCreate(NULL, 0, NULL);
+    RTT_EXPECT(gCounters.allocs == 1);
+
+    // NB: Changing the default allocator does not affect existing containers
+    CdsSetDefaultAllocator(NULL);
+    RTT_EXPECT(CdsDefaultAllocator() == CdsSystemAllocator());
+    CdsListDestroy(list);
+    RTT_EXPECT(gCounters.frees == 1);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_allocate_and_free_in_batches)
+{
+    testReset();
+    void* ptrs[10];
+    CdsAllocBatch(&gAllocator, 24, ptrs, 10);
+    RTT_EXPECT(gCounters.allocs == 10);
+    CdsFreeBatch(&gAllocator, ptrs, 10);
+    RTT_EXPECT(gCounters.frees == 10);
+    RTT_EXPECT(gCounters.batchAllocs == 0);
+
+    gAllocator.allocBatch = testAllocBatch;
+    gAllocator.freeBatch = testFreeBatch;
+    CdsAllocBatch(&gAllocator, 24, ptrs, 10);
+    CdsFreeBatch(&gAllocator, ptrs, 10);
+    RTT_EXPECT(gCounters.batchAllocs == 1);
+    RTT_EXPECT(gCounters.batchFrees == 1);
+    RTT_EXPECT(gCounters.allocs == 20);
+    RTT_EXPECT(gCounters.frees == 20);
+}
+RTT_TEST_END
+
+RTT_GROUP_END(TestCdsAllocator,
+        cds_should_use_system_allocator_by_default,
+        cds_should_use_per_container_allocator,
+        cds_should_use_default_allocator,
+        cds_should_allocate_and_free_in_batches)
+
+
+#define TEST_POOL_THREADS 4
+#define TEST_POOL_BLOCKS 1000
+
+static CdsPool* gPool = NULL;
+
+static void* testPoolWorker(void* arg)
+{
+    (void)arg;
+    void* blocks[TEST_POOL_BLOCKS];
+    for (int round = 0; round < 10; round++) {
+        for (int i = 0; i < TEST_POOL_BLOCKS; i++) {
+            blocks[i] = CdsPoolAlloc(gPool);
+            CDSASSERT(blocks[i] != NULL);
+            memset(blocks[i], round, CdsPoolBlockSize(gPool));
+        }
+        for (int i = 0; i < TEST_POOL_BLOCKS; i++) {
+            CDSASSERT(*(unsigned char*)blocks[i] == round);
+            CdsPoolFree(gPool, blocks[i]);
+        }
+    }
+    return NULL;
+}
+
+
+RTT_GROUP_START(TestCdsPool, 0x00020002u, NULL, NULL)
+
+RTT_TEST_START(cds_should_create_pool)
+{
+    gPool = CdsPoolCreate("Pool", 20, 100, false);
+    RTT_ASSERT(gPool != NULL);
+    RTT_EXPECT(strcmp(CdsPoolName(gPool), "Pool") == 0);
+    RTT_EXPECT(CdsPoolBlockSize(gPool) == 32);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_allocate_and_reuse_blocks)
+{
+    void* a = CdsPoolAlloc(gPool);
+    void* b = CdsPoolAlloc(gPool);
+    RTT_ASSERT((a != NULL) && (b != NULL));
+    RTT_EXPECT(a != b);
+    RTT_EXPECT(((uintptr_t)a % 16) == 0);
+    CdsPoolFree(gPool, a);
+    RTT_EXPECT(CdsPoolAlloc(gPool) == a);
+    CdsPoolFree(gPool, a);
+    CdsPoolFree(gPool, b);
+
+    CdsPoolStats stats;
+    CdsPoolGetStats(gPool, &stats);
+    RTT_EXPECT(stats.allocs == 3);
+    RTT_EXPECT(stats.frees == 3);
+    RTT_EXPECT(stats.inUse == 0);
+    RTT_EXPECT(stats.slabs == 1);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_respect_pool_capacity)
+{
+    void* blocks[100];
+    for (int i = 0; i < 100; i++) {
+        blocks[i] = CdsPoolAlloc(gPool);
+        RTT_ASSERT(blocks[i] != NULL);
+    }
+    RTT_EXPECT(CdsPoolAlloc(gPool) == NULL);
+    for (int i = 0; i < 100; i++) {
+        CdsPoolFree(gPool, blocks[i]);
+    }
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_use_pool_as_allocator)
+{
+    const CdsAllocator* allocator = CdsPoolAllocator(gPool);
+    void* ptr = CdsAlloc(allocator, 32);
+    RTT_EXPECT(ptr != NULL);
+    CdsFree(allocator, ptr);
+    RTT_EXPECT(allocator->alloc(allocator->context, 33) == NULL);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_destroy_pool)
+{
+    CdsPoolDestroy(gPool);
+    gPool = NULL;
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_share_pool_between_threads)
+{
+    gPool = CdsPoolCreate(NULL, 40, 0, true);
+    pthread_t threads[TEST_POOL_THREADS];
+    for (int i = 0; i < TEST_POOL_THREADS; i++) {
+        RTT_ASSERT(pthread_create(&threads[i], NULL, testPoolWorker, NULL)
+                == 0);
+    }
+    for (int i = 0; i < TEST_POOL_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    // NB: The caches of the threads are returned to the depot when they exit
+    CdsPoolStats stats;
+    CdsPoolGetStats(gPool, &stats);
+    RTT_EXPECT(stats.allocs == TEST_POOL_THREADS * TEST_POOL_BLOCKS * 10);
+    RTT_EXPECT(stats.inUse == 0);
+    RTT_EXPECT(stats.refills > 0);
+    RTT_EXPECT(stats.flushes > 0);
+    RTT_EXPECT(stats.reserved_B
+            <= (TEST_POOL_THREADS + 1) * TEST_POOL_BLOCKS * 48);
+
+    void* ptr = CdsPoolAlloc(gPool);
+    RTT_EXPECT(ptr != NULL);
+    CdsPoolDestroy(gPool);
+    gPool = NULL;
+}
+RTT_TEST_END
+
+RTT_GROUP_END(TestCdsPool,
+        cds_should_create_pool,
+        cds_should_allocate_and_reuse_blocks,
+        cds_should_respect_pool_capacity,
+        cds_should_use_pool_as_allocator,
+        cds_should_destroy_pool,
+        cds_should_share_pool_between_threads)
+
+
+static CdsArena* gArena = NULL;
+
+typedef struct {
+    CdsMapItem item;
+    int unrefs;
+} TestArenaItem;
+
+static void testArenaItemUnref(CdsMapItem* item)
+{
+    ((TestArenaItem*)item)->unrefs++;
+}
+
+
+RTT_GROUP_START(TestCdsArena, 0x00020003u, NULL, NULL)
+
+RTT_TEST_START(cds_should_create_arena)
+{
+    gArena = CdsArenaCreate("Arena", 1024, false);
+    RTT_ASSERT(gArena != NULL);
+    RTT_EXPECT(strcmp(CdsArenaName(gArena), "Arena") == 0);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_bump_allocate)
+{
+    char* a = CdsArenaAlloc(gArena, 1);
+    char* b = CdsArenaAlloc(gArena, 20);
+    char* c = CdsArenaAlloc(gArena, 16);
+    RTT_EXPECT(((uintptr_t)a % 16) == 0);
+    RTT_EXPECT(b == a + 16);
+    RTT_EXPECT(c == b + 32);
+
+    CdsArenaStats stats;
+    CdsArenaGetStats(gArena, &stats);
+    RTT_EXPECT(stats.allocs == 3);
+    RTT_EXPECT(stats.used_B == 64);
+    RTT_EXPECT(stats.chunks == 1);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_grow_arena)
+{
+    for (int i = 0; i < 100; i++) {
+        memset(CdsArenaAlloc(gArena, 100), i, 100);
+    }
+    // NB: Larger than a chunk
+    memset(CdsArenaAlloc(gArena, 5000), 0xff, 5000);
+
+    CdsArenaStats stats;
+    CdsArenaGetStats(gArena, &stats);
+    RTT_EXPECT(stats.allocs == 104);
+    RTT_EXPECT(stats.chunks > 10);
+    RTT_EXPECT(stats.reserved_B >= stats.used_B);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_reuse_chunks_after_reset)
+{
+    CdsArenaStats before;
+    CdsArenaGetStats(gArena, &before);
+    CdsArenaReset(gArena);
+    for (int i = 0; i < 100; i++) {
+        memset(CdsArenaAlloc(gArena, 100), i, 100);
+    }
+
+    CdsArenaStats after;
+    CdsArenaGetStats(gArena, &after);
+    RTT_EXPECT(after.allocs == 100);
+    RTT_EXPECT(after.chunks == before.chunks);
+    RTT_EXPECT(after.reserved_B == before.reserved_B);
+    RTT_EXPECT(after.resets == 1);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_destroy_map_without_unref)
+{
+    CdsArenaReset(gArena);
+    const CdsAllocator* allocator = CdsArenaAllocator(gArena);
+    CdsMap* map = CdsMapCreateWithAllocator(NULL, 0, CDSMAP_BALANCING_AVL,
+            testCompare, NULL, NULL, testArenaItemUnref, allocator);
+    TestArenaItem* items = CdsAlloc(allocator, 50 * sizeof(*items));
+    char* keys = CdsAlloc(allocator, 50 * 4);
+    for (int i = 0; i < 50; i++) {
+        items[i].unrefs = 0;
+        snprintf(&keys[i * 4], 4, "%02d", i);
+        RTT_ASSERT(CdsMapInsert(map, &keys[i * 4], &items[i].item));
+    }
+    CdsMapDestroyNoUnref(map);
+    for (int i = 0; i < 50; i++) {
+        RTT_EXPECT(items[i].unrefs == 0);
+    }
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_destroy_arena)
+{
+    CdsArenaDestroy(gArena);
+    gArena = NULL;
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_back_arena_with_huge_pages)
+{
+    gArena = CdsArenaCreate(NULL, 0, true);
+    char* ptr = CdsArenaAlloc(gArena, 100);
+    memset(ptr, 0, 100);
+
+    CdsArenaStats stats;
+    CdsArenaGetStats(gArena, &stats);
+    RTT_EXPECT(stats.reserved_B == 2 * 1024 * 1024);
+    CdsArenaDestroy(gArena);
+    gArena = NULL;
+}
+RTT_TEST_END
+
+RTT_GROUP_END(TestCdsArena,
+        cds_should_create_arena,
+        cds_should_bump_allocate,
+        cds_should_grow_arena,
+        cds_should_reuse_chunks_after_reset,
+        cds_should_destroy_map_without_unref,
+        cds_should_destroy_arena,
+        cds_should_back_arena_with_huge_pages)
+
+
+RTT_GROUP_START(TestCdsHugePage, 0x00020004u, NULL, NULL)
+
+RTT_TEST_START(cds_should_allocate_huge_pages)
+{
+    const CdsAllocator* allocator = CdsHugePageAllocator();
+    char* a = CdsAlloc(allocator, 100);
+    char* b = CdsAlloc(allocator, CDS_HUGEPAGE_B + 1);
+    RTT_EXPECT(((uintptr_t)a % CDS_HUGEPAGE_B) == 0);
+    RTT_EXPECT(((uintptr_t)b % CDS_HUGEPAGE_B) == 0);
+    memset(a, 0xaa, CDS_HUGEPAGE_B);
+    memset(b, 0xbb, 2 * CDS_HUGEPAGE_B);
+    RTT_EXPECT(a[CDS_HUGEPAGE_B - 1] == (char)0xaa);
+    RTT_EXPECT(b[0] == (char)0xbb);
+    CdsFree(allocator, a);
+    CdsFree(allocator, b);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_back_pool_with_huge_pages)
+{
+    gPool = CdsPoolCreateWithAllocator(NULL, 48, 0, false, CDS_HUGEPAGE_B,
+            CdsHugePageAllocator());
+    void* first = CdsPoolAlloc(gPool);
+    for (int i = 0; i < 100000; i++) {
+        RTT_ASSERT(CdsPoolAlloc(gPool) != NULL);
+    }
+    // NB: The slab header takes the first 16 bytes of the slab
+    RTT_EXPECT(((uintptr_t)first % CDS_HUGEPAGE_B) == 16);
+
+    CdsPoolStats stats;
+    CdsPoolGetStats(gPool, &stats);
+    RTT_EXPECT(stats.slabs == 3);
+    RTT_EXPECT(stats.reserved_B == 3 * CDS_HUGEPAGE_B);
+    CdsPoolDestroy(gPool);
+    gPool = NULL;
+}
+RTT_TEST_END
+
+RTT_GROUP_END(TestCdsHugePage,
+        cds_should_allocate_huge_pages,
+        cds_should_back_pool_with_huge_pages)
+
+
+#define TEST_THREADPOOL_TASKS 1000
+#define TEST_THREADPOOL_DEPTH 10
+
+static CdsThreadPool* gThreadPool = NULL;
+static int64_t gTaskCount = 0;
+
+static void testTaskCount(CdsThreadPool* pool, void* arg)
+{
+    (void)pool;
+    (void)arg;
+    __atomic_add_fetch(&gTaskCount, 1, __ATOMIC_RELAXED);
+}
+
+static void testTaskForkJoin(CdsThreadPool* pool, void* arg)
+{
+    intptr_t depth = (intptr_t)arg;
+    if (depth <= 0) {
+        __atomic_add_fetch(&gTaskCount, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    CdsThreadPoolGroup group;
+    CdsThreadPoolGroupInit(&group);
+    CdsThreadPoolSubmit(pool, &group, testTaskForkJoin, (void*)(depth - 1));
+    CdsThreadPoolSubmit(pool, &group, testTaskForkJoin, (void*)(depth - 1));
+    CdsThreadPoolWait(pool, &group);
+}
+
+
+RTT_GROUP_START(TestCdsThreadPool, 0x00020005u, NULL, NULL)
+
+RTT_TEST_START(cds_should_create_thread_pool)
+{
+    gThreadPool = CdsThreadPoolCreate("ThreadPool", 4);
+    RTT_ASSERT(gThreadPool != NULL);
+    RTT_EXPECT(strcmp(CdsThreadPoolName(gThreadPool), "ThreadPool") == 0);
+    RTT_EXPECT(CdsThreadPoolThreads(gThreadPool) == 4);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_run_all_tasks)
+{
+    gTaskCount = 0;
+    CdsThreadPoolGroup group;
+    CdsThreadPoolGroupInit(&group);
+    for (int i = 0; i < TEST_THREADPOOL_TASKS; i++) {
+        CdsThreadPoolSubmit(gThreadPool, &group, testTaskCount, NULL);
+    }
+    CdsThreadPoolWait(gThreadPool, &group);
+    RTT_EXPECT(gTaskCount == TEST_THREADPOOL_TASKS);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_run_nested_tasks)
+{
+    gTaskCount = 0;
+    CdsThreadPoolGroup group;
+    CdsThreadPoolGroupInit(&group);
+    CdsThreadPoolSubmit(gThreadPool, &group, testTaskForkJoin,
+            (void*)(intptr_t)TEST_THREADPOOL_DEPTH);
+    CdsThreadPoolWait(gThreadPool, &group);
+    RTT_EXPECT(gTaskCount == (1 << TEST_THREADPOOL_DEPTH));
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_destroy_thread_pool)
+{
+    CdsThreadPoolDestroy(gThreadPool);
+    gThreadPool = NULL;
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_start_one_thread_per_cpu)
+{
+    gThreadPool = CdsThreadPoolCreate(NULL, 0);
+    RTT_EXPECT(CdsThreadPoolThreads(gThreadPool) > 0);
+    CdsThreadPoolDestroy(gThreadPool);
+    gThreadPool = NULL;
+}
+RTT_TEST_END
+
+RTT_GROUP_END(TestCdsThreadPool,
+        cds_should_create_thread_pool,
+        cds_should_run_all_tasks,
+        cds_should_run_nested_tasks,
+        cds_should_destroy_thread_pool,
+        cds_should_start_one_thread_per_cpu)
@@ -0,0 +1,217 @@
+/* Copyright (c) 2016  Fabrice Triboix
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** Bounded blocking queues
+ *
+ * @defgroup cdsqueue Queues
+ * @addtogroup cdsqueue
+ * @{
+ *
+ * A thread-safe FIFO queue of intrusive `CdsListItem`s, for any number of
+ * producers and consumers. Items are pushed at the back and popped at the
+ * front. If the queue has a capacity, producers block (or fail, or time out)
+ * while the queue is full; consumers block (or fail, or time out) while the
+ * queue is empty.
+ *
+ * Waiting threads can optionally spin for a while before going to sleep,
+ * which reduces latency when the other side is expected to be quick, at the
+ * cost of burning CPU time; see `CdsQueueSetSpin()`.
+ *
+ * An item can't be in a `CdsQueue` and in a `CdsList` at the same time.
+ */
+
+#ifndef CDSQUEUE_h_
+#define CDSQUEUE_h_
+
+#include "cdscommon.h"
+#include "cdslist.h"
+
+
+
+/*----------------+
+ | Types & Macros |
+ +----------------*/
+
+
+/** Opaque type that represents a queue */
+typedef struct CdsQueue CdsQueue;
+
+
+
+/*------------------------------+
+ | Public function declarations |
+ +------------------------------*/
+
+
+/** Create a queue
+ *
+ * @param name     [in] Name for this queue; may be NULL
+ * @param capacity [in] Max # of items the queue can store, or 0 for no limit
+ * @param unref    [in] Function to remove a reference to an item; may be NULL
+ *                      if you don't need it
+ *
+ * @return The newly-allocated queue, never NULL
+ */
+CdsQueue* CdsQueueCreate(const char* name, int64_t capacity,
+        CdsListItemUnref unref);
+
+
+/** Destroy a queue
+ *
+ * Any item in the queue will be unreferenced. No thread must be using the
+ * queue anymore.
+ *
+ * @param queue [in,out] The queue to destroy; must not be NULL
+ */
+void CdsQueueDestroy(CdsQueue* queue);
+
+
+/** Set how long waiting threads spin before going to sleep
+ *
+ * By default, waiting threads go to sleep straight away.
+ *
+ * @param queue [in,out] The queue to modify; must not be NULL
+ * @param spins [in]     # of times to check the queue before sleeping; 0 to
+ *                       never spin
+ */
+void CdsQueueSetSpin(CdsQueue* queue, int spins);
+
+
+/** Get the queue's name
+ *
+ * @param queue [in] The queue to query; must not be NULL
+ *
+ * @return The queue's name, which may be NULL
+ */
+const char* CdsQueueName(const CdsQueue* queue);
+
+
+/** Get the number of items currently in the queue
+ *
+ * The returned value may be out-of-date by the time you use it if other
+ * threads are using the queue.
+ *
+ * @param queue [in] The queue to query; must not be NULL
+ */
+int64_t CdsQueueSize(const CdsQueue* queue);
+
+
+/** Get the queue's capacity
+ *
+ * @param queue [in] The queue to query; must not be NULL
+ *
+ * @return The queue capacity, or 0 if no limit
+ */
+int64_t CdsQueueCapacity(const CdsQueue* queue);
+
+
+/** Close a queue
+ *
+ * All threads waiting on the queue are woken up. Pushing items into a closed
+ * queue fails. Items can still be popped from a closed queue; once it is
+ * empty, popping returns straight away with no item.
+ *
+ * @param queue [in,out] The queue to close; must not be NULL
+ */
+void CdsQueueClose(CdsQueue* queue);
+
+
+/** Push an item at the back of the queue, waiting if the queue is full
+ *
+ * The ownership of `item` will be transferred to `queue`.
+ *
+ * @param queue [in,out] The queue where to push the item; must not be NULL
+ * @param item  [in,out] The item to push; must not be NULL
+ *
+ * @return `true` if success, `false` if the queue is closed
+ */
+bool CdsQueuePush(CdsQueue* queue, CdsListItem* item);
+
+
+/** Push an item at the back of the queue, if the queue is not full
+ *
+ * @param queue [in,out] The queue where to push the item; must not be NULL
+ * @param item  [in,out] The item to push; must not be NULL
+ *
+ * @return `true` if success, `false` if the queue is full or closed
+ */
+bool CdsQueueTryPush(CdsQueue* queue, CdsListItem* item);
+
+
+/** Push an item at the back of the queue, waiting at most `timeout_us`
+ *
+ * @param queue      [in,out] The queue where to push the item; must not be
+ *                            NULL
+ * @param item       [in,out] The item to push; must not be NULL
+ * @param timeout_us [in]     Max time to wait for some room, in us
+ *
+ * @return `true` if success, `false` if the queue is closed or still full
+ *         after `timeout_us`
+ */
+bool CdsQueueTimedPush(CdsQueue* queue, CdsListItem* item,
+        int64_t timeout_us);
+
+
+/** Pop an item from the front of the queue, waiting if the queue is empty
+ *
+ * The ownership of the item will be transferred to you.
+ *
+ * @param queue [in,out] The queue from where to pop an item; must not be NULL
+ *
+ * @return The popped item, or NULL if the queue is closed and empty
+ */
+CdsListItem* CdsQueuePop(CdsQueue* queue);
+
+
+/** Pop an item from the front of the queue, if the queue is not empty
+ *
+ * @param queue [in,out] The queue from where to pop an item; must not be NULL
+ *
+ * @return The popped item, or NULL if the queue is empty
+ */
+CdsListItem* CdsQueueTryPop(CdsQueue* queue);
+
+
+/** Pop an item from the front of the queue, waiting at most `timeout_us`
+ *
+ * @param queue      [in,out] The queue from where to pop an item; must not be
+ *                            NULL
+ * @param timeout_us [in]     Max time to wait for an item, in us
+ *
+ * @return The popped item, or NULL if the queue is still empty after
+ *         `timeout_us` or is closed and empty
+ */
+CdsListItem* CdsQueueTimedPop(CdsQueue* queue, int64_t timeout_us);
+
+
+/** Pop up to `max` items from the front of the queue in one go
+ *
+ * This waits until at least one item is available, and then pops as many items
+ * as possible, up to `max`, while holding the queue's lock only once.
+ *
+ * @param queue [in,out] The queue from where to pop items; must not be NULL
+ * @param items [out]    Where to write the popped items, in order; must not
+ *                       be NULL
+ * @param max   [in]     Max # of items to pop; must be > 0
+ *
+ * @return The number of popped items, or 0 if the queue is closed and empty
+ */
+int64_t CdsQueuePopMany(CdsQueue* queue, CdsListItem** items, int64_t max);
+
+
+
+#endif /* CDSQUEUE_h_ */
+/* @} */
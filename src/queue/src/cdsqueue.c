@@ -0,0 +1,381 @@
+/* Copyright (c) 2016  Fabrice Triboix
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cdsqueue.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+
+
+
+/*----------------+
+ | Macros & Types |
+ +----------------*/
+
+
+/** Hint to the CPU that we are in a spin loop */
+#if defined(__x86_64__) || defined(__i386__)
+#define CDSQUEUE_CPU_RELAX() __builtin_ia32_pause()
+#else
+#define CDSQUEUE_CPU_RELAX() do { } while (0)
+#endif
+
+
+struct CdsQueue
+{
+    CdsList*            list;
+    pthread_mutex_t     lock;
+    pthread_cond_t      notEmpty;
+    pthread_cond_t      notFull;
+    int64_t             size;        // Copy of the list size, to spin unlocked
+    int64_t             capacity;
+    int                 waitingPop;  // # of threads waiting for an item
+    int                 waitingPush; // # of threads waiting for some room
+    int                 spins;
+    int                 closed;
+    const CdsAllocator* allocator;
+};
+
+
+
+/*-------------------------------+
+ | Private function declarations |
+ +-------------------------------*/
+
+
+/** Spin until a condition is met or we have spun long enough
+ *
+ * This is done without holding the lock, so the condition might not be met
+ * anymore once the lock is taken.
+ *
+ * @param queue   [in] The queue to check
+ * @param forPush [in] `true` to wait for some room, `false` to wait for an
+ *                     item
+ */
+static void cdsQueueSpin(const CdsQueue* queue, bool forPush);
+
+
+/** Wait on a condition variable of the queue, with the lock held
+ *
+ * @param queue      [in,out] The queue whose lock is held
+ * @param cond       [in,out] The condition variable to wait on
+ * @param waiting    [in,out] Counter of waiting threads to update
+ * @param deadline   [in]     When to stop waiting; NULL to wait forever
+ *
+ * @return `false` if `deadline` has passed, `true` otherwise
+ */
+static bool cdsQueueWait(CdsQueue* queue, pthread_cond_t* cond, int* waiting,
+        const struct timespec* deadline);
+
+
+/** Compute a deadline from a timeout
+ *
+ * @param deadline   [out] The deadline, on the monotonic clock
+ * @param timeout_us [in]  Timeout from now, in us
+ */
+static void cdsQueueDeadline(struct timespec* deadline, int64_t timeout_us);
+
+
+/** Push an item into the queue
+ *
+ * @param queue      [in,out] The queue where to push the item
+ * @param item       [in,out] The item to push
+ * @param timeout_us [in]     Max time to wait for some room, in us; 0 to not
+ *                            wait, < 0 to wait forever
+ *
+ * @return `true` if success, `false` if the queue is closed or full
+ */
+static bool cdsQueuePush(CdsQueue* queue, CdsListItem* item,
+        int64_t timeout_us);
+
+
+/** Pop items from the queue
+ *
+ * @param queue      [in,out] The queue from where to pop items
+ * @param items      [out]    Where to write the popped items
+ * @param max        [in]     Max # of items to pop
+ * @param timeout_us [in]     Max time to wait for an item, in us; 0 to not
+ *                            wait, < 0 to wait forever
+ *
+ * @return The number of popped items
+ */
+static int64_t cdsQueuePop(CdsQueue* queue, CdsListItem** items, int64_t max,
+        int64_t timeout_us);
+
+
+
+/*---------------------------------+
+ | Public function implementations |
+ +---------------------------------*/
+
+
+CdsQueue* CdsQueueCreate(const char* name, int64_t capacity,
+        CdsListItemUnref unref)
+{
+    const CdsAllocator* allocator = CdsDefaultAllocator();
+    CdsQueue* queue = CdsAllocZ(allocator, sizeof(*queue));
+    queue->allocator = allocator;
+    queue->list = CdsListCreateWithAllocator(name, capacity, unref, allocator);
+    queue->capacity = CdsListCapacity(queue->list);
+
+    pthread_condattr_t attr;
+    CDSASSERT_ALWAYS(pthread_condattr_init(&attr) == 0);
+    CDSASSERT_ALWAYS(pthread_condattr_setclock(&attr, CLOCK_MONOTONIC) == 0);
+    CDSASSERT_ALWAYS(pthread_mutex_init(&queue->lock, NULL) == 0);
+    CDSASSERT_ALWAYS(pthread_cond_init(&queue->notEmpty, &attr) == 0);
+    CDSASSERT_ALWAYS(pthread_cond_init(&queue->notFull, &attr) == 0);
+    pthread_condattr_destroy(&attr);
+
+    return queue;
+}
+
+
+void CdsQueueDestroy(CdsQueue* queue)
+{
+    CDSASSERT_FULL(queue != NULL);
+    CDSASSERT(queue->waitingPop == 0);
+    CDSASSERT(queue->waitingPush == 0);
+
+    CdsListDestroy(queue->list);
+    pthread_cond_destroy(&queue->notFull);
+    pthread_cond_destroy(&queue->notEmpty);
+    pthread_mutex_destroy(&queue->lock);
+    CdsFree(queue->allocator, queue);
+}
+
+
+void CdsQueueSetSpin(CdsQueue* queue, int spins)
+{
+    CDSASSERT_FULL(queue != NULL);
+    CDSASSERT(spins >= 0);
+    __atomic_store_n(&queue->spins, spins, __ATOMIC_RELAXED);
+}
+
+
+const char* CdsQueueName(const CdsQueue* queue)
+{
+    CDSASSERT_FULL(queue != NULL);
+    return CdsListName(queue->list);
+}
+
+
+int64_t CdsQueueSize(const CdsQueue* queue)
+{
+    CDSASSERT_FULL(queue != NULL);
+    return __atomic_load_n(&queue->size, __ATOMIC_RELAXED);
+}
+
+
+int64_t CdsQueueCapacity(const CdsQueue* queue)
+{
+    CDSASSERT_FULL(queue != NULL);
+    return queue->capacity;
+}
+
+
+void CdsQueueClose(CdsQueue* queue)
+{
+    CDSASSERT_FULL(queue != NULL);
+    pthread_mutex_lock(&queue->lock);
+    __atomic_store_n(&queue->closed, 1, __ATOMIC_RELAXED);
+    pthread_cond_broadcast(&queue->notEmpty);
+    pthread_cond_broadcast(&queue->notFull);
+    pthread_mutex_unlock(&queue->lock);
+}
+
+
+bool CdsQueuePush(CdsQueue* queue, CdsListItem* item)
+{
+    return cdsQueuePush(queue, item, -1);
+}
+
+
+bool CdsQueueTryPush(CdsQueue* queue, CdsListItem* item)
+{
+    return cdsQueuePush(queue, item, 0);
+}
+
+
+bool CdsQueueTimedPush(CdsQueue* queue, CdsListItem* item,
+        int64_t timeout_us)
+{
+    CDSASSERT(timeout_us >= 0);
+    return cdsQueuePush(queue, item, timeout_us);
+}
+
+
+CdsListItem* CdsQueuePop(CdsQueue* queue)
+{
+    CdsListItem* item = NULL;
+    cdsQueuePop(queue, &item, 1, -1);
+    return item;
+}
+
+
+CdsListItem* CdsQueueTryPop(CdsQueue* queue)
+{
+    CdsListItem* item = NULL;
+    cdsQueuePop(queue, &item, 1, 0);
+    return item;
+}
+
+
+CdsListItem* CdsQueueTimedPop(CdsQueue* queue, int64_t timeout_us)
+{
+    CDSASSERT(timeout_us >= 0);
+    CdsListItem* item = NULL;
+    cdsQueuePop(queue, &item, 1, timeout_us);
+    return item;
+}
+
+
+int64_t CdsQueuePopMany(CdsQueue* queue, CdsListItem** items, int64_t max)
+{
+    CDSASSERT_FULL(items != NULL);
+    CDSASSERT(max > 0);
+    return cdsQueuePop(queue, items, max, -1);
+}
+
+
+
+/*----------------------------------+
+ | Private function implementations |
+ +----------------------------------*/
+
+
+static void cdsQueueSpin(const CdsQueue* queue, bool forPush)
+{
+    int spins = __atomic_load_n(&queue->spins, __ATOMIC_RELAXED);
+    for (int i = 0; i < spins; i++) {
+        if (__atomic_load_n(&queue->closed, __ATOMIC_RELAXED)) {
+            break;
+        }
+        int64_t size = __atomic_load_n(&queue->size, __ATOMIC_RELAXED);
+        if (forPush) {
+            if ((queue->capacity <= 0) || (size < queue->capacity)) {
+                break;
+            }
+        } else if (size > 0) {
+            break;
+        }
+        CDSQUEUE_CPU_RELAX();
+    }
+}
+
+
+static bool cdsQueueWait(CdsQueue* queue, pthread_cond_t* cond, int* waiting,
+        const struct timespec* deadline)
+{
+    int ret = 0;
+    (*waiting)++;
+    if (deadline != NULL) {
+        ret = pthread_cond_timedwait(cond, &queue->lock, deadline);
+    } else {
+        pthread_cond_wait(cond, &queue->lock);
+    }
+    (*waiting)--;
+    return ret != ETIMEDOUT;
+}
+
+
+static void cdsQueueDeadline(struct timespec* deadline, int64_t timeout_us)
+{
+    clock_gettime(CLOCK_MONOTONIC, deadline);
+    deadline->tv_sec += timeout_us / 1000000;
+    deadline->tv_nsec += (timeout_us % 1000000) * 1000;
+    if (deadline->tv_nsec >= 1000000000) {
+        deadline->tv_sec++;
+        deadline->tv_nsec -= 1000000000;
+    }
+}
+
+
+static bool cdsQueuePush(CdsQueue* queue, CdsListItem* item,
+        int64_t timeout_us)
+{
+    CDSASSERT_FULL(queue != NULL);
+    CDSASSERT_FULL(item != NULL);
+
+    struct timespec deadline;
+    if (timeout_us > 0) {
+        cdsQueueDeadline(&deadline, timeout_us);
+    }
+    if (timeout_us != 0) {
+        cdsQueueSpin(queue, true);
+    }
+
+    pthread_mutex_lock(&queue->lock);
+    while (!queue->closed && CdsListIsFull(queue->list)) {
+        if (    (timeout_us == 0)
+             || !cdsQueueWait(queue, &queue->notFull, &queue->waitingPush,
+                     (timeout_us > 0) ? &deadline : NULL)) {
+            break;
+        }
+    }
+    bool pushed = !queue->closed && CdsListPushBack(queue->list, item);
+    if (pushed) {
+        __atomic_store_n(&queue->size, CdsListSize(queue->list),
+                __ATOMIC_RELAXED);
+        if (queue->waitingPop > 0) {
+            pthread_cond_signal(&queue->notEmpty);
+        }
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return pushed;
+}
+
+
+static int64_t cdsQueuePop(CdsQueue* queue, CdsListItem** items, int64_t max,
+        int64_t timeout_us)
+{
+    CDSASSERT_FULL(queue != NULL);
+
+    struct timespec deadline;
+    if (timeout_us > 0) {
+        cdsQueueDeadline(&deadline, timeout_us);
+    }
+    if (timeout_us != 0) {
+        cdsQueueSpin(queue, false);
+    }
+
+    pthread_mutex_lock(&queue->lock);
+    while (!queue->closed && CdsListIsEmpty(queue->list)) {
+        if (    (timeout_us == 0)
+             || !cdsQueueWait(queue, &queue->notEmpty, &queue->waitingPop,
+                     (timeout_us > 0) ? &deadline : NULL)) {
+            break;
+        }
+    }
+    int64_t n = 0;
+    while ((n < max) && !CdsListIsEmpty(queue->list)) {
+        items[n++] = CdsListPopFront(queue->list);
+    }
+    if (n > 0) {
+        __atomic_store_n(&queue->size, CdsListSize(queue->list),
+                __ATOMIC_RELAXED);
+        if (queue->waitingPush > 0) {
+            if (n > 1) {
+                pthread_cond_broadcast(&queue->notFull);
+            } else {
+                pthread_cond_signal(&queue->notFull);
+            }
+        }
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return n;
+}
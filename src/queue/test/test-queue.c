@@ -0,0 +1,193 @@
+/* Copyright (c) 2016  Fabrice Triboix
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cdsqueue.h"
+#include "rttest.h"
+
+#include <string.h>
+#include <pthread.h>
+
+
+typedef struct {
+    CdsListItem cdsListItem;
+    int         ref;
+    int         x;
+} TestItem;
+
+static int gNumberOfItemsInExistence = 0;
+
+static void testItemUnref(CdsListItem* cdsListItem)
+{
+    TestItem* item = (TestItem*)cdsListItem;
+    item->ref--;
+    if (item->ref <= 0) {
+        free(item);
+        __atomic_sub_fetch(&gNumberOfItemsInExistence, 1, __ATOMIC_RELAXED);
+    }
+}
+
+static TestItem* testItemAlloc(int x)
+{
+    TestItem* item = malloc(sizeof(*item));
+    memset(item, 0, sizeof(*item));
+    item->ref = 1;
+    item->x = x;
+    __atomic_add_fetch(&gNumberOfItemsInExistence, 1, __ATOMIC_RELAXED);
+    return item;
+}
+
+static CdsQueue* gQueue = NULL;
+
+#define TEST_QUEUE_THREADS 3
+#define TEST_QUEUE_ITEMS 20000
+
+static void* testProducer(void* arg)
+{
+    int first = *(int*)arg;
+    for (int i = 0; i < TEST_QUEUE_ITEMS; i++) {
+        CDSASSERT(CdsQueuePush(gQueue,
+                    (CdsListItem*)testItemAlloc(first + i)));
+    }
+    return NULL;
+}
+
+// Pop items until the queue is closed; return the sum of their values
+static void* testConsumer(void* arg)
+{
+    long long* sum = arg;
+    CdsListItem* items[7];
+    int64_t n;
+    while ((n = CdsQueuePopMany(gQueue, items, 7)) > 0) {
+        for (int64_t i = 0; i < n; i++) {
+            *sum += ((TestItem*)items[i])->x;
+            testItemUnref(items[i]);
+        }
+    }
+    return NULL;
+}
+
+
+RTT_GROUP_START(TestCdsQueue, 0x00070001u, NULL, NULL)
+
+RTT_TEST_START(cds_should_create_queue)
+{
+    gQueue = CdsQueueCreate("Queue", 3, testItemUnref);
+    RTT_ASSERT(gQueue != NULL);
+    RTT_EXPECT(strcmp(CdsQueueName(gQueue), "Queue") == 0);
+    RTT_EXPECT(CdsQueueCapacity(gQueue) == 3);
+    RTT_EXPECT(CdsQueueSize(gQueue) == 0);
+    RTT_EXPECT(CdsQueueTryPop(gQueue) == NULL);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_push_and_pop_in_fifo_order)
+{
+    RTT_ASSERT(CdsQueuePush(gQueue, (CdsListItem*)testItemAlloc(0)));
+    RTT_ASSERT(CdsQueueTryPush(gQueue, (CdsListItem*)testItemAlloc(1)));
+    RTT_ASSERT(CdsQueueTimedPush(gQueue, (CdsListItem*)testItemAlloc(2), 0));
+    RTT_EXPECT(CdsQueueSize(gQueue) == 3);
+
+    TestItem* item = testItemAlloc(3);
+    RTT_EXPECT(!CdsQueueTryPush(gQueue, (CdsListItem*)item));
+    RTT_EXPECT(!CdsQueueTimedPush(gQueue, (CdsListItem*)item, 10000));
+    testItemUnref((CdsListItem*)item);
+
+    for (int i = 0; i < 3; i++) {
+        item = (TestItem*)CdsQueuePop(gQueue);
+        RTT_ASSERT(item != NULL);
+        RTT_EXPECT(item->x == i);
+        testItemUnref((CdsListItem*)item);
+    }
+    RTT_EXPECT(CdsQueueTimedPop(gQueue, 10000) == NULL);
+    RTT_EXPECT(0 == gNumberOfItemsInExistence);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_pop_many_items)
+{
+    for (int i = 0; i < 3; i++) {
+        RTT_ASSERT(CdsQueueTryPush(gQueue, (CdsListItem*)testItemAlloc(i)));
+    }
+    CdsListItem* items[2];
+    RTT_ASSERT(CdsQueuePopMany(gQueue, items, 2) == 2);
+    RTT_EXPECT(((TestItem*)items[0])->x == 0);
+    RTT_EXPECT(((TestItem*)items[1])->x == 1);
+    testItemUnref(items[0]);
+    testItemUnref(items[1]);
+    RTT_ASSERT(CdsQueuePopMany(gQueue, items, 2) == 1);
+    RTT_EXPECT(((TestItem*)items[0])->x == 2);
+    testItemUnref(items[0]);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_pass_items_between_threads)
+{
+    CdsQueueDestroy(gQueue);
+    gQueue = CdsQueueCreate(NULL, 16, testItemUnref);
+    CdsQueueSetSpin(gQueue, 100);
+
+    pthread_t producers[TEST_QUEUE_THREADS];
+    pthread_t consumers[TEST_QUEUE_THREADS];
+    int firsts[TEST_QUEUE_THREADS];
+    long long sums[TEST_QUEUE_THREADS];
+    for (int i = 0; i < TEST_QUEUE_THREADS; i++) {
+        firsts[i] = i * TEST_QUEUE_ITEMS;
+        sums[i] = 0;
+        RTT_ASSERT(pthread_create(&consumers[i], NULL, testConsumer,
+                    &sums[i]) == 0);
+        RTT_ASSERT(pthread_create(&producers[i], NULL, testProducer,
+                    &firsts[i]) == 0);
+    }
+    for (int i = 0; i < TEST_QUEUE_THREADS; i++) {
+        pthread_join(producers[i], NULL);
+    }
+    CdsQueueClose(gQueue);
+    long long sum = 0;
+    for (int i = 0; i < TEST_QUEUE_THREADS; i++) {
+        pthread_join(consumers[i], NULL);
+        sum += sums[i];
+    }
+    long long n = TEST_QUEUE_THREADS * TEST_QUEUE_ITEMS;
+    RTT_EXPECT(sum == (n * (n - 1)) / 2);
+    RTT_EXPECT(0 == gNumberOfItemsInExistence);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_not_push_into_closed_queue)
+{
+    TestItem* item = testItemAlloc(0);
+    RTT_EXPECT(!CdsQueuePush(gQueue, (CdsListItem*)item));
+    RTT_EXPECT(!CdsQueueTryPush(gQueue, (CdsListItem*)item));
+    testItemUnref((CdsListItem*)item);
+    RTT_EXPECT(CdsQueuePop(gQueue) == NULL);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_destroy_queue)
+{
+    CdsQueueDestroy(gQueue);
+    gQueue = NULL;
+    RTT_ASSERT(0 == gNumberOfItemsInExistence);
+}
+RTT_TEST_END
+
+RTT_GROUP_END(TestCdsQueue,
+        cds_should_create_queue,
+        cds_should_push_and_pop_in_fifo_order,
+        cds_should_pop_many_items,
+        cds_should_pass_items_between_threads,
+        cds_should_not_push_into_closed_queue,
+        cds_should_destroy_queue)
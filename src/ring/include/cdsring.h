@@ -0,0 +1,215 @@
+/* Copyright (c) 2016  Fabrice Triboix
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** Single-producer single-consumer ring buffers
+ *
+ * @defgroup cdsring Ring buffers
+ * @addtogroup cdsring
+ * @{
+ *
+ * A lock-free FIFO of fixed-size records, stored by value in a circular
+ * buffer. One thread may produce records while another thread consumes them.
+ *
+ * Records are not copied in or out of the ring: the producer reserves slots
+ * with `CdsRingReserve()`, writes its records straight into them and makes them
+ * visible to the consumer with `CdsRingCommit()`. Likewise, the consumer gets
+ * the records with `CdsRingPeek()`, reads them in place and gives the slots
+ * back with `CdsRingRelease()`. `CdsRingPush()` and `CdsRingPop()` are
+ * provided for convenience when copying is fine.
+ *
+ * The producer's and consumer's indices live in separate cache lines, and each
+ * side keeps a cached copy of the other side's index, so the shared cache lines
+ * are only touched when the ring looks full or empty.
+ */
+
+#ifndef CDSRING_h_
+#define CDSRING_h_
+
+#include "cdscommon.h"
+
+
+
+/*----------------+
+ | Types & Macros |
+ +----------------*/
+
+
+/** Opaque type that represents a ring buffer */
+typedef struct CdsRing CdsRing;
+
+
+
+/*------------------------------+
+ | Public function declarations |
+ +------------------------------*/
+
+
+/** Create a ring buffer
+ *
+ * @param name     [in] Name for this ring; may be NULL
+ * @param capacity [in] Max # of records the ring can store; must be > 0
+ * @param size_B   [in] Size of a record, in bytes; must be > 0
+ *
+ * @return The newly-allocated ring, never NULL
+ */
+CdsRing* CdsRingCreate(const char* name, int64_t capacity, size_t size_B);
+
+
+/** Create a ring buffer which allocates its memory from the given allocator
+ *
+ * @param name      [in] Name for this ring; may be NULL
+ * @param capacity  [in] Max # of records the ring can store; must be > 0
+ * @param size_B    [in] Size of a record, in bytes; must be > 0
+ * @param allocator [in] Allocator to use; it must remain valid until the ring
+ *                       is destroyed; NULL to use the default allocator
+ *
+ * @return The newly-allocated ring, never NULL
+ */
+CdsRing* CdsRingCreateWithAllocator(const char* name, int64_t capacity,
+        size_t size_B, const CdsAllocator* allocator);
+
+
+/** Destroy a ring buffer
+ *
+ * @param ring [in,out] The ring to destroy; must not be NULL
+ */
+void CdsRingDestroy(CdsRing* ring);
+
+
+/** Get the ring's name
+ *
+ * @param ring [in] The ring to query; must not be NULL
+ *
+ * @return The ring's name, which may be NULL
+ */
+const char* CdsRingName(const CdsRing* ring);
+
+
+/** Get the number of records currently in the ring
+ *
+ * The returned value may be out-of-date by the time you use it if the other
+ * side is using the ring.
+ *
+ * @param ring [in] The ring to query; must not be NULL
+ */
+int64_t CdsRingSize(const CdsRing* ring);
+
+
+/** Get the ring's capacity
+ *
+ * @param ring [in] The ring to query; must not be NULL
+ *
+ * @return The max # of records the ring can store
+ */
+int64_t CdsRingCapacity(const CdsRing* ring);
+
+
+/** Get the size of the records stored in the ring
+ *
+ * @param ring [in] The ring to query; must not be NULL
+ *
+ * @return The size of a record, in bytes
+ */
+size_t CdsRingRecordSize(const CdsRing* ring);
+
+
+/** Reserve slots to write records into
+ *
+ * This may only be called by the producer. The reserved slots are contiguous,
+ * so fewer than `count` slots may be reserved when the ring wraps around, even
+ * if there is more room.
+ *
+ * Calling this function again before `CdsRingCommit()` reserves the same slots.
+ *
+ * @param ring  [in,out] The ring where to reserve slots; must not be NULL
+ * @param count [in]     Max # of slots to reserve; must be > 0
+ * @param slots [out]    Where to write the address of the first slot; must not
+ *                       be NULL
+ *
+ * @return The number of reserved slots, 0 if the ring is full
+ */
+int64_t CdsRingReserve(CdsRing* ring, int64_t count, void** slots);
+
+
+/** Make records written into reserved slots available to the consumer
+ *
+ * This may only be called by the producer.
+ *
+ * @param ring  [in,out] The ring to update; must not be NULL
+ * @param count [in]     # of records to commit; must not be more than the
+ *                       number of slots returned by `CdsRingReserve()`
+ */
+void CdsRingCommit(CdsRing* ring, int64_t count);
+
+
+/** Get records to read
+ *
+ * This may only be called by the consumer. The records are contiguous, so
+ * fewer than `count` records may be returned when the ring wraps around, even
+ * if there are more records.
+ *
+ * Calling this function again before `CdsRingRelease()` returns the same
+ * records.
+ *
+ * @param ring    [in,out] The ring to read; must not be NULL
+ * @param count   [in]     Max # of records to get; must be > 0
+ * @param records [out]    Where to write the address of the first record; must
+ *                         not be NULL
+ *
+ * @return The number of records, 0 if the ring is empty
+ */
+int64_t CdsRingPeek(CdsRing* ring, int64_t count, void** records);
+
+
+/** Give back the slots of records that have been read
+ *
+ * This may only be called by the consumer.
+ *
+ * @param ring  [in,out] The ring to update; must not be NULL
+ * @param count [in]     # of records to release; must not be more than the
+ *                       number of records returned by `CdsRingPeek()`
+ */
+void CdsRingRelease(CdsRing* ring, int64_t count);
+
+
+/** Copy a record into the ring
+ *
+ * This may only be called by the producer.
+ *
+ * @param ring   [in,out] The ring where to push the record; must not be NULL
+ * @param record [in]     The record to copy; must not be NULL
+ *
+ * @return `true` if success, `false` if the ring is full
+ */
+bool CdsRingPush(CdsRing* ring, const void* record);
+
+
+/** Copy a record out of the ring
+ *
+ * This may only be called by the consumer.
+ *
+ * @param ring   [in,out] The ring from where to pop the record; must not be
+ *                        NULL
+ * @param record [out]    Where to copy the record; must not be NULL
+ *
+ * @return `true` if success, `false` if the ring is empty
+ */
+bool CdsRingPop(CdsRing* ring, void* record);
+
+
+
+#endif /* CDSRING_h_ */
+/* @} */
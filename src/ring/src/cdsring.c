@@ -0,0 +1,260 @@
+/* Copyright (c) 2016  Fabrice Triboix
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cdsring.h"
+#include <stdlib.h>
+#include <string.h>
+
+
+
+/*----------------+
+ | Macros & Types |
+ +----------------*/
+
+
+/** Size of a cache line, to keep the producer's and consumer's data apart */
+#define CDSRING_CACHE_LINE 64
+
+
+struct CdsRing
+{
+    // Written by the producer
+    uint64_t            head;       // Index of the next slot to write
+    uint64_t            cachedTail; // Last value of `tail` seen by producer
+    int64_t             reserved;   // # of slots reserved and not committed
+    char                pad1[CDSRING_CACHE_LINE];
+
+    // Written by the consumer
+    uint64_t            tail;       // Index of the next record to read
+    uint64_t            cachedHead; // Last value of `head` seen by consumer
+    int64_t             peeked;     // # of records peeked and not released
+    char                pad2[CDSRING_CACHE_LINE];
+
+    // Read-only
+    char*               buffer;
+    uint64_t            mask;       // # of slots in `buffer` - 1
+    int64_t             capacity;
+    size_t              size_B;
+    char*               name;
+    const CdsAllocator* allocator;
+};
+
+
+
+/*-------------------------------+
+ | Private function declarations |
+ +-------------------------------*/
+
+
+/** Get the address of the slot for the given index
+ *
+ * @param ring  [in] The ring
+ * @param index [in] Index of the slot; may be larger than the number of slots
+ *
+ * @return The address of the slot
+ */
+static inline char* cdsRingSlot(const CdsRing* ring, uint64_t index)
+{
+    return ring->buffer + ((index & ring->mask) * ring->size_B);
+}
+
+
+/** Get the number of contiguous slots from the given index
+ *
+ * @param ring  [in] The ring
+ * @param index [in] Index of the first slot
+ * @param count [in] Max # of slots wanted
+ *
+ * @return The number of slots until the end of the buffer, up to `count`
+ */
+static inline int64_t cdsRingContiguous(const CdsRing* ring, uint64_t index,
+        int64_t count)
+{
+    int64_t n = (int64_t)((ring->mask + 1) - (index & ring->mask));
+    return (n < count) ? n : count;
+}
+
+
+
+/*---------------------------------+
+ | Public function implementations |
+ +---------------------------------*/
+
+
+CdsRing* CdsRingCreate(const char* name, int64_t capacity, size_t size_B)
+{
+    return CdsRingCreateWithAllocator(name, capacity, size_B, NULL);
+}
+
+
+CdsRing* CdsRingCreateWithAllocator(const char* name, int64_t capacity,
+        size_t size_B, const CdsAllocator* allocator)
+{
+    CDSASSERT(capacity > 0);
+    CDSASSERT(size_B > 0);
+
+    if (allocator == NULL) {
+        allocator = CdsDefaultAllocator();
+    }
+    CdsRing* ring = CdsAllocZ(allocator, sizeof(*ring));
+
+    ring->allocator = allocator;
+    ring->name = CdsStrdup(allocator, name);
+    ring->capacity = capacity;
+    ring->size_B = size_B;
+
+    // NB: The number of slots is a power of 2 so the slot of an index can be
+    // found with a mask
+    uint64_t nslots = 1;
+    while (nslots < (uint64_t)capacity) {
+        nslots <<= 1;
+    }
+    ring->mask = nslots - 1;
+    ring->buffer = CdsAlloc(allocator, nslots * size_B);
+
+    return ring;
+}
+
+
+void CdsRingDestroy(CdsRing* ring)
+{
+    CDSASSERT_FULL(ring != NULL);
+    CdsFree(ring->allocator, ring->buffer);
+    CdsFree(ring->allocator, ring->name);
+    CdsFree(ring->allocator, ring);
+}
+
+
+const char* CdsRingName(const CdsRing* ring)
+{
+    CDSASSERT_FULL(ring != NULL);
+    return ring->name;
+}
+
+
+int64_t CdsRingSize(const CdsRing* ring)
+{
+    CDSASSERT_FULL(ring != NULL);
+    uint64_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    return (int64_t)(head - tail);
+}
+
+
+int64_t CdsRingCapacity(const CdsRing* ring)
+{
+    CDSASSERT_FULL(ring != NULL);
+    return ring->capacity;
+}
+
+
+size_t CdsRingRecordSize(const CdsRing* ring)
+{
+    CDSASSERT_FULL(ring != NULL);
+    return ring->size_B;
+}
+
+
+int64_t CdsRingReserve(CdsRing* ring, int64_t count, void** slots)
+{
+    CDSASSERT_FULL(ring != NULL);
+    CDSASSERT(count > 0);
+    CDSASSERT_FULL(slots != NULL);
+
+    uint64_t head = ring->head;
+    int64_t room = ring->capacity - (int64_t)(head - ring->cachedTail);
+    if (room < count) {
+        ring->cachedTail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+        room = ring->capacity - (int64_t)(head - ring->cachedTail);
+    }
+    if (room < count) {
+        count = room;
+    }
+    if (count > 0) {
+        count = cdsRingContiguous(ring, head, count);
+        *slots = cdsRingSlot(ring, head);
+    }
+    ring->reserved = count;
+    return count;
+}
+
+
+void CdsRingCommit(CdsRing* ring, int64_t count)
+{
+    CDSASSERT_FULL(ring != NULL);
+    CDSASSERT((count >= 0) && (count <= ring->reserved));
+    ring->reserved = 0;
+    __atomic_store_n(&ring->head, ring->head + count, __ATOMIC_RELEASE);
+}
+
+
+int64_t CdsRingPeek(CdsRing* ring, int64_t count, void** records)
+{
+    CDSASSERT_FULL(ring != NULL);
+    CDSASSERT(count > 0);
+    CDSASSERT_FULL(records != NULL);
+
+    uint64_t tail = ring->tail;
+    int64_t available = (int64_t)(ring->cachedHead - tail);
+    if (available < count) {
+        ring->cachedHead = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        available = (int64_t)(ring->cachedHead - tail);
+    }
+    if (available < count) {
+        count = available;
+    }
+    if (count > 0) {
+        count = cdsRingContiguous(ring, tail, count);
+        *records = cdsRingSlot(ring, tail);
+    }
+    ring->peeked = count;
+    return count;
+}
+
+
+void CdsRingRelease(CdsRing* ring, int64_t count)
+{
+    CDSASSERT_FULL(ring != NULL);
+    CDSASSERT((count >= 0) && (count <= ring->peeked));
+    ring->peeked = 0;
+    __atomic_store_n(&ring->tail, ring->tail + count, __ATOMIC_RELEASE);
+}
+
+
+bool CdsRingPush(CdsRing* ring, const void* record)
+{
+    CDSASSERT_FULL(record != NULL);
+    void* slot = NULL;
+    if (CdsRingReserve(ring, 1, &slot) == 0) {
+        return false;
+    }
+    memcpy(slot, record, ring->size_B);
+    CdsRingCommit(ring, 1);
+    return true;
+}
+
+
+bool CdsRingPop(CdsRing* ring, void* record)
+{
+    CDSASSERT_FULL(record != NULL);
+    void* slot = NULL;
+    if (CdsRingPeek(ring, 1, &slot) == 0) {
+        return false;
+    }
+    memcpy(record, slot, ring->size_B);
+    CdsRingRelease(ring, 1);
+    return true;
+}
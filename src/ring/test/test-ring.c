@@ -0,0 +1,171 @@
+/* Copyright (c) 2016  Fabrice Triboix
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cdsring.h"
+#include "rttest.h"
+
+#include <string.h>
+#include <sched.h>
+#include <pthread.h>
+
+
+typedef struct {
+    int  x;
+    char tag[12];
+} TestRecord;
+
+static CdsRing* gRing = NULL;
+
+#define TEST_RING_RECORDS 200000
+
+static void* testProducer(void* arg)
+{
+    (void)arg;
+    int x = 0;
+    while (x < TEST_RING_RECORDS) {
+        void* slots;
+        int64_t n = CdsRingReserve(gRing, 7, &slots);
+        if (n == 0) {
+            sched_yield();
+        }
+        TestRecord* records = slots;
+        for (int64_t i = 0; i < n; i++) {
+            records[i].x = x++;
+        }
+        CdsRingCommit(gRing, n);
+    }
+    return NULL;
+}
+
+
+RTT_GROUP_START(TestCdsRing, 0x00090001u, NULL, NULL)
+
+RTT_TEST_START(cds_should_create_ring)
+{
+    gRing = CdsRingCreate("Ring", 6, sizeof(TestRecord));
+    RTT_ASSERT(gRing != NULL);
+    RTT_EXPECT(strcmp(CdsRingName(gRing), "Ring") == 0);
+    RTT_EXPECT(CdsRingCapacity(gRing) == 6);
+    RTT_EXPECT(CdsRingRecordSize(gRing) == sizeof(TestRecord));
+    RTT_EXPECT(CdsRingSize(gRing) == 0);
+
+    TestRecord record;
+    RTT_EXPECT(!CdsRingPop(gRing, &record));
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_push_and_pop_records)
+{
+    TestRecord record;
+    memset(&record, 0, sizeof(record));
+    for (int i = 0; i < 6; i++) {
+        record.x = i;
+        RTT_ASSERT(CdsRingPush(gRing, &record));
+    }
+    RTT_EXPECT(CdsRingSize(gRing) == 6);
+    RTT_EXPECT(!CdsRingPush(gRing, &record));
+    for (int i = 0; i < 4; i++) {
+        RTT_ASSERT(CdsRingPop(gRing, &record));
+        RTT_EXPECT(record.x == i);
+    }
+    RTT_EXPECT(CdsRingSize(gRing) == 2);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_reserve_contiguous_slots)
+{
+    // The ring has 8 slots and a capacity of 6; records 4 and 5 are in slots
+    // 4 and 5, so only 2 slots can be reserved before wrapping around
+    void* slots;
+    RTT_ASSERT(CdsRingReserve(gRing, 10, &slots) == 2);
+    TestRecord* records = slots;
+    records[0].x = 6;
+    records[1].x = 7;
+    CdsRingCommit(gRing, 2);
+
+    RTT_ASSERT(CdsRingReserve(gRing, 10, &slots) == 2);
+    records = slots;
+    records[0].x = 8;
+    records[1].x = 9;
+    CdsRingCommit(gRing, 2);
+
+    // Slots 2 and 3 are free, but the ring is full
+    RTT_EXPECT(CdsRingSize(gRing) == 6);
+    RTT_EXPECT(CdsRingReserve(gRing, 1, &slots) == 0);
+
+    // Read the records up to the end of the buffer
+    void* ptr;
+    RTT_ASSERT(CdsRingPeek(gRing, 10, &ptr) == 4);
+    records = ptr;
+    for (int i = 0; i < 4; i++) {
+        RTT_EXPECT(records[i].x == 4 + i);
+    }
+    CdsRingRelease(gRing, 3);
+    RTT_EXPECT(CdsRingSize(gRing) == 3);
+
+    RTT_ASSERT(CdsRingPeek(gRing, 10, &ptr) == 1);
+    RTT_EXPECT(((TestRecord*)ptr)->x == 7);
+    CdsRingRelease(gRing, 1);
+
+    RTT_ASSERT(CdsRingPeek(gRing, 10, &ptr) == 2);
+    records = ptr;
+    RTT_EXPECT(records[0].x == 8);
+    RTT_EXPECT(records[1].x == 9);
+    CdsRingRelease(gRing, 2);
+    RTT_EXPECT(CdsRingSize(gRing) == 0);
+    RTT_EXPECT(CdsRingPeek(gRing, 1, &ptr) == 0);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_pass_records_between_threads)
+{
+    CdsRingDestroy(gRing);
+    gRing = CdsRingCreate(NULL, 100, sizeof(TestRecord));
+    pthread_t producer;
+    RTT_ASSERT(pthread_create(&producer, NULL, testProducer, NULL) == 0);
+
+    int expected = 0;
+    while (expected < TEST_RING_RECORDS) {
+        void* ptr;
+        int64_t n = CdsRingPeek(gRing, 16, &ptr);
+        if (n == 0) {
+            sched_yield();
+        }
+        TestRecord* records = ptr;
+        for (int64_t i = 0; i < n; i++) {
+            RTT_ASSERT(records[i].x == expected);
+            expected++;
+        }
+        CdsRingRelease(gRing, n);
+    }
+    pthread_join(producer, NULL);
+    RTT_EXPECT(CdsRingSize(gRing) == 0);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_destroy_ring)
+{
+    CdsRingDestroy(gRing);
+    gRing = NULL;
+}
+RTT_TEST_END
+
+RTT_GROUP_END(TestCdsRing,
+        cds_should_create_ring,
+        cds_should_push_and_pop_records,
+        cds_should_reserve_contiguous_slots,
+        cds_should_pass_records_between_threads,
+        cds_should_destroy_ring)
@@ -0,0 +1,291 @@
+/* Copyright (c) 2016  Fabrice Triboix
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** Singly-linked lists
+ *
+ * @defgroup cdsslist Singly-linked lists
+ * @addtogroup cdsslist
+ * @{
+ *
+ * Intrusive singly-linked lists with an 8-byte item, for FIFO queues and LIFO
+ * stacks that never need to walk backwards. Items can be pushed at the front
+ * or at the back, but only popped at the front; use `CdsSListPushBack()` and
+ * `CdsSListPopFront()` for a queue, and `CdsSListPushFront()` and
+ * `CdsSListPopFront()` for a stack.
+ *
+ * The last item of a list has a NULL `next` pointer, so walking through a list
+ * does not need the list itself.
+ */
+
+#ifndef CDSSLIST_h_
+#define CDSSLIST_h_
+
+#include "cdscommon.h"
+#include "cdsslist_private.h"
+
+
+
+/*----------------+
+ | Types & Macros |
+ +----------------*/
+
+
+/** Opaque type that represents a singly-linked list */
+typedef struct CdsSList CdsSList;
+
+
+/** Singly-linked list item
+ *
+ * You can "derive" from this structure, as long as it remains at the top of
+ * your own structure definition. For example:
+ *
+ *     typedef struct {
+ *         CdsSListItem cdsSListItem;
+ *         int x;
+ *         float y;
+ *         char* z;
+ *     } MyItem;
+ */
+typedef struct CdsSListItem CdsSListItem;
+
+
+/** Prototype of a function to remove a reference to an item
+ *
+ * This function should decrement the internal reference counter of the item by
+ * one. If the reference counter of the item drops to 0, the item is not
+ * referenced anymore and must be freed.
+ */
+typedef void (*CdsSListItemUnref)(CdsSListItem* item);
+
+
+/** Macro to walk through a singly-linked list */
+#define CDSSLIST_FOREACH(_list, _type, _iter) \
+    for (   _type* _iter = (_type*)CdsSListFront(_list); \
+            _iter != NULL; \
+            _iter = (_type*)CdsSListNext((CdsSListItem*)_iter) )
+
+
+
+/*------------------------------+
+ | Public function declarations |
+ +------------------------------*/
+
+
+/** Create a singly-linked list
+ *
+ * @param name     [in] Name for this list; may be NULL
+ * @param capacity [in] Max # of items the list can store, or 0 for no limit
+ * @param unref    [in] Function to remove a reference to a list item; may be
+ *                      NULL if you don't need it
+ *
+ * @return The newly-allocated list, never NULL
+ */
+CdsSList* CdsSListCreate(const char* name, int64_t capacity,
+        CdsSListItemUnref unref);
+
+
+/** Create a singly-linked list which allocates its memory from the given
+ * allocator
+ *
+ * Only the memory of the list itself comes from `allocator`; the items are
+ * allocated by you.
+ *
+ * @param name      [in] Name for this list; may be NULL
+ * @param capacity  [in] Max # of items the list can store, or 0 for no limit
+ * @param unref     [in] Function to remove a reference to a list item; may be
+ *                       NULL if you don't need it
+ * @param allocator [in] Allocator to use; it must remain valid until the list
+ *                       is destroyed; NULL to use the default allocator
+ *
+ * @return The newly-allocated list, never NULL
+ */
+CdsSList* CdsSListCreateWithAllocator(const char* name, int64_t capacity,
+        CdsSListItemUnref unref, const CdsAllocator* allocator);
+
+
+/** Destroy a singly-linked list
+ *
+ * Any item in the list will be unreferenced.
+ *
+ * @param list [in,out] The list to destroy; must not be NULL.
+ */
+void CdsSListDestroy(CdsSList* list);
+
+
+/** Get the list's name
+ *
+ * @param list [in] The list to query; must not be NULL
+ *
+ * @return The list's name, which may be NULL
+ */
+const char* CdsSListName(const CdsSList* list);
+
+
+/** Get the number of items currently in the list
+ *
+ * @param list [in] The list to query; must not be NULL
+ */
+int64_t CdsSListSize(const CdsSList* list);
+
+
+/** Get the list's capacity
+ *
+ * @param list [in] The list to query; must not be NULL
+ *
+ * @return The list capacity, or 0 if no limit
+ */
+int64_t CdsSListCapacity(const CdsSList* list);
+
+
+/** Test if a list is empty
+ *
+ * @param list [in] The list to query; must not be NULL
+ *
+ * @return `true` if the list is empty, `false` otherwise
+ */
+bool CdsSListIsEmpty(const CdsSList* list);
+
+
+/** Test is a list is full
+ *
+ * This function will always return `false` if no limit has been set on the list
+ * capacity when `CdsSListCreate()` has been called.
+ *
+ * @param list [in] The list to query; must not be NULL
+ *
+ * @return `true` if the list is full, `false` otherwise
+ */
+bool CdsSListIsFull(const CdsSList* list);
+
+
+/** Insert an item at the front of the list
+ *
+ * The ownership of `item` will be transferred to `list`.
+ *
+ * @param list [in,out] The list where to insert the item; must not be NULL
+ * @param item [in,out] The item to insert; must not be NULL
+ *
+ * @return `true` if success, `false` if the list is full
+ */
+bool CdsSListPushFront(CdsSList* list, CdsSListItem* item);
+
+
+/** Insert an item at the back of the list
+ *
+ * The ownership of `item` will be transferred to `list`.
+ *
+ * @param list [in,out] The list where to insert the item; must not be NULL
+ * @param item [in,out] The item to insert; must not be NULL
+ *
+ * @return `true` if success, `false` if the list is full
+ */
+bool CdsSListPushBack(CdsSList* list, CdsSListItem* item);
+
+
+/** Insert an item after the given item
+ *
+ * The ownership of `item` will be transferred to `list`.
+ *
+ * @param list [in,out] The list `pos` belongs to; must not be NULL
+ * @param pos  [in,out] Item after which to insert new item; must not be NULL
+ * @param item [in,out] The item to insert; must not be NULL
+ *
+ * @return `true` if success, `false` if the list is full
+ */
+bool CdsSListInsertAfter(CdsSList* list, CdsSListItem* pos,
+        CdsSListItem* item);
+
+
+/** Get the item at the front of the list
+ *
+ * The item is not removed from the list.
+ *
+ * @param list [in] The list to query; must not be NULL
+ *
+ * @return The item at the front of the list, or NULL if the list is empty
+ */
+CdsSListItem* CdsSListFront(const CdsSList* list);
+
+
+/** Get the item at the back of the list
+ *
+ * The item is not removed from the list.
+ *
+ * @param list [in] The list to query; must not be NULL
+ *
+ * @return The item at the back of the list, or NULL if the list is empty
+ */
+CdsSListItem* CdsSListBack(const CdsSList* list);
+
+
+/** Get the next item in the list
+ *
+ * @param pos [in] Position item; must not be NULL
+ *
+ * @return The item after `pos`, or NULL if no more items
+ */
+CdsSListItem* CdsSListNext(const CdsSListItem* pos);
+
+
+/** Pop an item at the front of the list
+ *
+ * @param list [in,out] The list from where to pop an item; must not be NULL
+ *
+ * @return The popped item, or NULL if list is empty
+ */
+CdsSListItem* CdsSListPopFront(CdsSList* list);
+
+
+/** Remove the item that follows the given item
+ *
+ * The ownership of the removed item will be transferred to you.
+ *
+ * @param list [in,out] The list `pos` belongs to; must not be NULL
+ * @param pos  [in,out] Item after which to remove an item; NULL to remove the
+ *                      item at the front of the list
+ *
+ * @return The removed item, or NULL if `pos` is the last item of the list
+ */
+CdsSListItem* CdsSListRemoveAfter(CdsSList* list, CdsSListItem* pos);
+
+
+/** Remove all items from the list
+ *
+ * All items in the list will be unreferenced.
+ *
+ * @param list [in,out] The list to clear of all its items; must not be NULL
+ */
+void CdsSListClear(CdsSList* list);
+
+
+/** Move all the items of a list at the back of another list, in O(1)
+ *
+ * The items of `src` are appended to `dst`, in the same order, and `src` is
+ * left empty. Nothing is unreferenced.
+ *
+ * @param dst [in,out] List where to move the items; must not be NULL
+ * @param src [in,out] List to move the items from; must not be NULL and must
+ *                     not be `dst`
+ *
+ * @return `true` if success, `false` if `dst` does not have enough capacity, in
+ *         which case nothing is moved
+ */
+bool CdsSListAppend(CdsSList* dst, CdsSList* src);
+
+
+
+#endif /* CDSSLIST_h_ */
+/* @} */
@@ -0,0 +1,290 @@
+/* Copyright (c) 2016  Fabrice Triboix
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cdsslist.h"
+#include <stdlib.h>
+#include <string.h>
+
+
+
+/*-------+
+ | Types |
+ +-------*/
+
+
+struct CdsSList
+{
+    char*               name;
+    int64_t             size;
+    int64_t             capacity;
+    CdsSListItem*       head;
+    CdsSListItem*       tail;
+    CdsSListItemUnref   unref;
+    const CdsAllocator* allocator;
+};
+
+
+
+/*-------------------------------+
+ | Private function declarations |
+ +-------------------------------*/
+
+
+/** Check whether `count` more items can be inserted into the given list
+ *
+ * @param list  [in] List to query; must not be NULL
+ * @param count [in] Number of items to insert
+ *
+ * @return `true` if there is enough room, `false` otherwise
+ */
+static inline bool cdsSListHasRoom(const CdsSList* list, int64_t count)
+{
+    return (list->capacity <= 0) || (list->size + count <= list->capacity);
+}
+
+
+
+/*---------------------------------+
+ | Public function implementations |
+ +---------------------------------*/
+
+
+CdsSList* CdsSListCreate(const char* name, int64_t capacity,
+        CdsSListItemUnref unref)
+{
+    return CdsSListCreateWithAllocator(name, capacity, unref, NULL);
+}
+
+
+CdsSList* CdsSListCreateWithAllocator(const char* name, int64_t capacity,
+        CdsSListItemUnref unref, const CdsAllocator* allocator)
+{
+    if (allocator == NULL) {
+        allocator = CdsDefaultAllocator();
+    }
+    CdsSList* list = CdsAllocZ(allocator, sizeof(*list));
+
+    list->allocator = allocator;
+    list->name = CdsStrdup(allocator, name);
+    if (capacity > 0) {
+        list->capacity = capacity;
+    }
+    list->unref = unref;
+
+    return list;
+}
+
+
+void CdsSListDestroy(CdsSList* list)
+{
+    CDSASSERT_FULL(list != NULL);
+    CdsSListClear(list);
+    CdsFree(list->allocator, list->name);
+    CdsFree(list->allocator, list);
+}
+
+
+const char* CdsSListName(const CdsSList* list)
+{
+    CDSASSERT_FULL(list != NULL);
+    return list->name;
+}
+
+
+int64_t CdsSListSize(const CdsSList* list)
+{
+    CDSASSERT_FULL(list != NULL);
+    return list->size;
+}
+
+
+int64_t CdsSListCapacity(const CdsSList* list)
+{
+    CDSASSERT_FULL(list != NULL);
+    return list->capacity;
+}
+
+
+bool CdsSListIsEmpty(const CdsSList* list)
+{
+    CDSASSERT_FULL(list != NULL);
+    return list->size <= 0;
+}
+
+
+bool CdsSListIsFull(const CdsSList* list)
+{
+    CDSASSERT_FULL(list != NULL);
+    return !cdsSListHasRoom(list, 1);
+}
+
+
+bool CdsSListPushFront(CdsSList* list, CdsSListItem* item)
+{
+    CDSASSERT_FULL(list != NULL);
+    CDSASSERT_FULL(item != NULL);
+
+    if (!cdsSListHasRoom(list, 1)) {
+        return false;
+    }
+    item->next = list->head;
+    list->head = item;
+    if (list->tail == NULL) {
+        list->tail = item;
+    }
+    list->size++;
+    return true;
+}
+
+
+bool CdsSListPushBack(CdsSList* list, CdsSListItem* item)
+{
+    CDSASSERT_FULL(list != NULL);
+    CDSASSERT_FULL(item != NULL);
+
+    if (!cdsSListHasRoom(list, 1)) {
+        return false;
+    }
+    item->next = NULL;
+    if (list->tail != NULL) {
+        list->tail->next = item;
+    } else {
+        list->head = item;
+    }
+    list->tail = item;
+    list->size++;
+    return true;
+}
+
+
+bool CdsSListInsertAfter(CdsSList* list, CdsSListItem* pos,
+        CdsSListItem* item)
+{
+    CDSASSERT_FULL(list != NULL);
+    CDSASSERT_FULL(pos != NULL);
+    CDSASSERT_FULL(item != NULL);
+
+    if (!cdsSListHasRoom(list, 1)) {
+        return false;
+    }
+    item->next = pos->next;
+    pos->next = item;
+    if (list->tail == pos) {
+        list->tail = item;
+    }
+    list->size++;
+    return true;
+}
+
+
+CdsSListItem* CdsSListFront(const CdsSList* list)
+{
+    CDSASSERT_FULL(list != NULL);
+    return list->head;
+}
+
+
+CdsSListItem* CdsSListBack(const CdsSList* list)
+{
+    CDSASSERT_FULL(list != NULL);
+    return list->tail;
+}
+
+
+CdsSListItem* CdsSListNext(const CdsSListItem* pos)
+{
+    CDSASSERT_FULL(pos != NULL);
+    return pos->next;
+}
+
+
+CdsSListItem* CdsSListPopFront(CdsSList* list)
+{
+    CDSASSERT_FULL(list != NULL);
+
+    CdsSListItem* front = list->head;
+    if (front != NULL) {
+        list->head = front->next;
+        if (list->head == NULL) {
+            list->tail = NULL;
+        }
+        list->size--;
+        front->next = NULL;
+    }
+    return front;
+}
+
+
+CdsSListItem* CdsSListRemoveAfter(CdsSList* list, CdsSListItem* pos)
+{
+    CDSASSERT_FULL(list != NULL);
+
+    if (pos == NULL) {
+        return CdsSListPopFront(list);
+    }
+    CdsSListItem* item = pos->next;
+    if (item != NULL) {
+        pos->next = item->next;
+        if (list->tail == item) {
+            list->tail = pos;
+        }
+        list->size--;
+        item->next = NULL;
+    }
+    return item;
+}
+
+
+void CdsSListClear(CdsSList* list)
+{
+    CDSASSERT_FULL(list != NULL);
+
+    while (!CdsSListIsEmpty(list)) {
+        CdsSListItem* tmp = CdsSListPopFront(list);
+        CDSASSERT_FULL(tmp != NULL);
+        if (list->unref != NULL) {
+            list->unref(tmp);
+        }
+    }
+}
+
+
+bool CdsSListAppend(CdsSList* dst, CdsSList* src)
+{
+    CDSASSERT_FULL(dst != NULL);
+    CDSASSERT_FULL(src != NULL);
+    CDSASSERT(dst != src);
+
+    if (CdsSListIsEmpty(src)) {
+        return true;
+    }
+    if (!cdsSListHasRoom(dst, src->size)) {
+        return false;
+    }
+
+    if (dst->tail != NULL) {
+        dst->tail->next = src->head;
+    } else {
+        dst->head = src->head;
+    }
+    dst->tail = src->tail;
+    dst->size += src->size;
+
+    src->head = NULL;
+    src->tail = NULL;
+    src->size = 0;
+    return true;
+}
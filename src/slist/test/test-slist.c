@@ -0,0 +1,190 @@
+/* Copyright (c) 2016  Fabrice Triboix
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cdsslist.h"
+#include "rttest.h"
+
+#include <string.h>
+
+
+typedef struct {
+    CdsSListItem cdsSListItem;
+    int          ref;
+    int          x;
+} TestItem;
+
+static int gNumberOfItemsInExistence = 0;
+
+static void testItemUnref(CdsSListItem* cdsSListItem)
+{
+    TestItem* item = (TestItem*)cdsSListItem;
+    item->ref--;
+    if (item->ref <= 0) {
+        free(item);
+        gNumberOfItemsInExistence--;
+    }
+}
+
+static TestItem* testItemAlloc(int x)
+{
+    TestItem* item = malloc(sizeof(*item));
+    memset(item, 0, sizeof(*item));
+    item->ref = 1;
+    item->x = x;
+    gNumberOfItemsInExistence++;
+    return item;
+}
+
+// Check the values of a list, and that its back item is the last one
+static bool testCheckList(CdsSList* list, const int* values, int count)
+{
+    if (CdsSListSize(list) != count) {
+        return false;
+    }
+    int i = 0;
+    TestItem* last = NULL;
+    CDSSLIST_FOREACH(list, TestItem, item) {
+        if ((i >= count) || (item->x != values[i])) {
+            return false;
+        }
+        last = item;
+        i++;
+    }
+    return (i == count) && (CdsSListBack(list) == (CdsSListItem*)last);
+}
+
+static CdsSList* gList = NULL;
+static CdsSList* gList2 = NULL;
+
+
+RTT_GROUP_START(TestCdsSList, 0x00060001u, NULL, NULL)
+
+RTT_TEST_START(cds_slist_item_should_be_8_bytes)
+{
+    RTT_EXPECT(sizeof(CdsSListItem) == sizeof(void*));
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_create_slist)
+{
+    gList = CdsSListCreate("SList", 6, testItemUnref);
+    RTT_ASSERT(gList != NULL);
+    RTT_EXPECT(strcmp(CdsSListName(gList), "SList") == 0);
+    RTT_EXPECT(CdsSListCapacity(gList) == 6);
+    RTT_EXPECT(CdsSListIsEmpty(gList));
+    RTT_EXPECT(!CdsSListIsFull(gList));
+    RTT_EXPECT(CdsSListFront(gList) == NULL);
+    RTT_EXPECT(CdsSListBack(gList) == NULL);
+    RTT_EXPECT(CdsSListPopFront(gList) == NULL);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_push_items_to_slist)
+{
+    RTT_ASSERT(CdsSListPushFront(gList, (CdsSListItem*)testItemAlloc(1)));
+    RTT_ASSERT(CdsSListPushBack(gList, (CdsSListItem*)testItemAlloc(2)));
+    RTT_ASSERT(CdsSListPushFront(gList, (CdsSListItem*)testItemAlloc(0)));
+    RTT_ASSERT(CdsSListPushBack(gList, (CdsSListItem*)testItemAlloc(4)));
+    int expected[] = { 0, 1, 2, 4 };
+    RTT_EXPECT(testCheckList(gList, expected, 4));
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_insert_items_into_slist)
+{
+    CdsSListItem* pos = CdsSListNext(CdsSListNext(CdsSListFront(gList)));
+    RTT_ASSERT(CdsSListInsertAfter(gList, pos,
+                (CdsSListItem*)testItemAlloc(3)));
+    RTT_ASSERT(CdsSListInsertAfter(gList, CdsSListBack(gList),
+                (CdsSListItem*)testItemAlloc(5)));
+    int expected[] = { 0, 1, 2, 3, 4, 5 };
+    RTT_EXPECT(testCheckList(gList, expected, 6));
+    RTT_EXPECT(CdsSListIsFull(gList));
+
+    TestItem* item = testItemAlloc(6);
+    RTT_EXPECT(!CdsSListPushBack(gList, (CdsSListItem*)item));
+    RTT_EXPECT(!CdsSListPushFront(gList, (CdsSListItem*)item));
+    testItemUnref((CdsSListItem*)item);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_remove_items_from_slist)
+{
+    CdsSListItem* item = CdsSListPopFront(gList);
+    RTT_ASSERT(((TestItem*)item)->x == 0);
+    testItemUnref(item);
+
+    // Remove the last item; the back of the list must be updated
+    CdsSListItem* pos = CdsSListFront(gList);
+    while (CdsSListNext(CdsSListNext(pos)) != NULL) {
+        pos = CdsSListNext(pos);
+    }
+    item = CdsSListRemoveAfter(gList, pos);
+    RTT_ASSERT(((TestItem*)item)->x == 5);
+    testItemUnref(item);
+    RTT_EXPECT(CdsSListRemoveAfter(gList, CdsSListBack(gList)) == NULL);
+
+    item = CdsSListRemoveAfter(gList, CdsSListFront(gList));
+    RTT_ASSERT(((TestItem*)item)->x == 2);
+    testItemUnref(item);
+
+    int expected[] = { 1, 3, 4 };
+    RTT_EXPECT(testCheckList(gList, expected, 3));
+    RTT_EXPECT(3 == gNumberOfItemsInExistence);
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_append_slists)
+{
+    gList2 = CdsSListCreate(NULL, 0, testItemUnref);
+    RTT_ASSERT(gList2 != NULL);
+    RTT_ASSERT(CdsSListAppend(gList2, gList));
+    int expected1[] = { 1, 3, 4 };
+    RTT_EXPECT(testCheckList(gList2, expected1, 3));
+    RTT_EXPECT(testCheckList(gList, NULL, 0));
+
+    for (int i = 10; i < 14; i++) {
+        RTT_ASSERT(CdsSListPushBack(gList, (CdsSListItem*)testItemAlloc(i)));
+    }
+    RTT_ASSERT(CdsSListAppend(gList2, gList));
+    int expected2[] = { 1, 3, 4, 10, 11, 12, 13 };
+    RTT_EXPECT(testCheckList(gList2, expected2, 7));
+    RTT_EXPECT(CdsSListIsEmpty(gList));
+
+    // Not enough room in the first list
+    RTT_EXPECT(!CdsSListAppend(gList, gList2));
+    RTT_EXPECT(testCheckList(gList2, expected2, 7));
+}
+RTT_TEST_END
+
+RTT_TEST_START(cds_should_destroy_slists)
+{
+    CdsSListDestroy(gList);
+    gList = NULL;
+    CdsSListDestroy(gList2);
+    gList2 = NULL;
+    RTT_ASSERT(0 == gNumberOfItemsInExistence);
+}
+RTT_TEST_END
+
+RTT_GROUP_END(TestCdsSList,
+        cds_slist_item_should_be_8_bytes,
+        cds_should_create_slist,
+        cds_should_push_items_to_slist,
+        cds_should_insert_items_into_slist,
+        cds_should_remove_items_from_slist,
+        cds_should_append_slists,
+        cds_should_destroy_slists)